@@ -0,0 +1,253 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ActorPoolSubsystem.h"
+#include "Tactics.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+
+/** Height prewarmed actors are spawned at, well above the level and out of view of the camera */
+static constexpr double PrewarmHeight = 100000.0;
+
+void UActorPoolSubsystem::Prewarm(TSubclassOf<AActor> ActorClass, int32 Count)
+{
+	if (!ActorClass)
+	{
+		return;
+	}
+
+	FActorClassPool& Pool = Pools.FindOrAdd(ActorClass.Get());
+
+	// Spawn out of view, so anything the actor plays on BeginPlay isn't seen or heard in the level
+	const FTransform PrewarmTransform(FVector(0.0, 0.0, PrewarmHeight));
+
+	// Only top up to the requested count
+	for (int32 Index = Pool.Free.Num() + Pool.NumActive; Index < Count; ++Index)
+	{
+		AActor* Actor = SpawnPooledActor(ActorClass, Pool, PrewarmTransform);
+		if (!Actor)
+		{
+			break;
+		}
+
+		Pool.Free.Add(Actor);
+	}
+}
+
+AActor* UActorPoolSubsystem::AcquireActor(UClass* ActorClass, const FTransform& Transform)
+{
+	if (!ActorClass)
+	{
+		return nullptr;
+	}
+
+	FActorClassPool& Pool = Pools.FindOrAdd(ActorClass);
+
+	// Reuse a free actor, skipping any that were destroyed while pooled
+	AActor* Actor = nullptr;
+	while (Pool.Free.Num() > 0 && !Actor)
+	{
+		Actor = Pool.Free.Pop(EAllowShrinking::No).Get();
+	}
+
+	if (Actor)
+	{
+		++Pool.NumReused;
+	}
+	else
+	{
+		// Spawn straight at the target so the actor doesn't start out somewhere else
+		Actor = SpawnPooledActor(ActorClass, Pool, Transform);
+		if (!Actor)
+		{
+			return nullptr;
+		}
+	}
+
+	FPooledActorState& State = PooledActors.FindChecked(Actor);
+	State.bActive = true;
+	State.ReleaseTime = Pool.AutoReleaseTime > 0.0f ? GetWorld()->GetTimeSeconds() + Pool.AutoReleaseTime : 0.0;
+
+	++Pool.NumAcquired;
+	++Pool.NumActive;
+	Pool.PeakActive = FMath::Max(Pool.PeakActive, Pool.NumActive);
+
+	// Place and wake up the actor
+	Actor->SetActorLocationAndRotation(Transform.GetLocation(), Transform.GetRotation(), false, nullptr, ETeleportType::ResetPhysics);
+	Actor->SetActorHiddenInGame(false);
+	Actor->SetActorEnableCollision(true);
+	Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+
+	if (Actor->Implements<UPooledActor>())
+	{
+		IPooledActor::Execute_OnAcquiredFromPool(Actor);
+	}
+
+	return Actor;
+}
+
+bool UActorPoolSubsystem::ReleaseActor(AActor* Actor)
+{
+	FPooledActorState* State = Actor ? PooledActors.Find(Actor) : nullptr;
+	if (!State)
+	{
+		return false;
+	}
+
+	// Already back in the pool
+	if (!State->bActive)
+	{
+		return true;
+	}
+
+	State->bActive = false;
+	State->ReleaseTime = 0.0;
+
+	FActorClassPool& Pool = Pools.FindChecked(State->Class);
+	--Pool.NumActive;
+	++Pool.NumReleased;
+
+	DeactivateActor(Actor);
+	Pool.Free.Add(Actor);
+
+	return true;
+}
+
+void UActorPoolSubsystem::ReleaseOrDestroy(AActor* Actor)
+{
+	if (!Actor)
+	{
+		return;
+	}
+
+	UActorPoolSubsystem* ActorPool = Actor->GetWorld() ? Actor->GetWorld()->GetSubsystem<UActorPoolSubsystem>() : nullptr;
+
+	if (!ActorPool || !ActorPool->ReleaseActor(Actor))
+	{
+		Actor->Destroy();
+	}
+}
+
+bool UActorPoolSubsystem::IsPooled(const AActor* Actor) const
+{
+	return Actor && PooledActors.Contains(Actor);
+}
+
+void UActorPoolSubsystem::DumpStats() const
+{
+	UE_LOG(LogTactics, Display, TEXT("=== ACTOR POOL ==="));
+
+	for (const TPair<TObjectKey<UClass>, FActorClassPool>& Pair : Pools)
+	{
+		const FActorClassPool& Pool = Pair.Value;
+		const int32 NumMisses = Pool.NumAcquired - Pool.NumReused;
+
+		UE_LOG(LogTactics, Display, TEXT("%s: %d active (%d peak), %d free. %d spawned, %d acquired, %d reused (%.0f%%), %d misses, %d released, %d lost"),
+			*GetNameSafe(Pair.Key.ResolveObjectPtr()), Pool.NumActive, Pool.PeakActive, Pool.Free.Num(), Pool.NumSpawned, Pool.NumAcquired, Pool.NumReused,
+			Pool.NumAcquired > 0 ? 100.0 * Pool.NumReused / Pool.NumAcquired : 0.0, NumMisses, Pool.NumReleased, Pool.NumLost);
+	}
+}
+
+void UActorPoolSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// Collect the actors whose life span ran out first, since their release hooks may acquire other actors
+	TArray<AActor*, TInlineAllocator<16>> DueActors;
+
+	for (auto It = PooledActors.CreateIterator(); It; ++It)
+	{
+		FPooledActorState& State = It.Value();
+
+		// Actors destroyed while pooled just drop out of the pool
+		AActor* Actor = State.Actor.Get();
+		if (!Actor)
+		{
+			if (FActorClassPool* Pool = Pools.Find(State.Class))
+			{
+				Pool->NumActive -= State.bActive ? 1 : 0;
+				++Pool->NumLost;
+			}
+
+			It.RemoveCurrent();
+			continue;
+		}
+
+		if (State.bActive && State.ReleaseTime > 0.0 && Now >= State.ReleaseTime)
+		{
+			DueActors.Add(Actor);
+		}
+	}
+
+	for (AActor* Actor : DueActors)
+	{
+		ReleaseActor(Actor);
+	}
+}
+
+TStatId UActorPoolSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UActorPoolSubsystem, STATGROUP_Tickables);
+}
+
+void UActorPoolSubsystem::Deinitialize()
+{
+	Pools.Empty();
+	PooledActors.Empty();
+
+	Super::Deinitialize();
+}
+
+AActor* UActorPoolSubsystem::SpawnPooledActor(UClass* ActorClass, FActorClassPool& Pool, const FTransform& Transform)
+{
+	AActor* Actor = GetWorld()->SpawnActorDeferred<AActor>(ActorClass, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (!Actor)
+	{
+		UE_LOG(LogTactics, Warning, TEXT("Actor pool failed to spawn %s"), *GetNameSafe(ActorClass));
+		return nullptr;
+	}
+
+	// Start out hidden and without collision, so the actor isn't seen or touched before it's acquired
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->FinishSpawning(Transform);
+
+	// The pool decides when actors go away, so a class life span releases them instead
+	Pool.AutoReleaseTime = Actor->InitialLifeSpan;
+	Actor->SetLifeSpan(0.0f);
+
+	FPooledActorState& State = PooledActors.Add(Actor);
+	State.Actor = Actor;
+	State.Class = ActorClass;
+
+	++Pool.NumSpawned;
+
+	DeactivateActor(Actor);
+
+	return Actor;
+}
+
+void UActorPoolSubsystem::DeactivateActor(AActor* Actor)
+{
+	if (Actor->Implements<UPooledActor>())
+	{
+		IPooledActor::Execute_OnReleasedToPool(Actor);
+	}
+
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ActorPoolDumpCommand(
+	TEXT("Tactics.ActorPool.Dump"),
+	TEXT("Logs the actor pool stats for each pooled class."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UActorPoolSubsystem* ActorPool = World ? World->GetSubsystem<UActorPoolSubsystem>() : nullptr)
+		{
+			ActorPool->DumpStats();
+		}
+	}));
@@ -0,0 +1,155 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/Interface.h"
+#include "UObject/ObjectKey.h"
+#include "ActorPoolSubsystem.generated.h"
+
+/**
+ * Number of actors of a class to spawn into the pool ahead of time
+ */
+USTRUCT(BlueprintType)
+struct FActorPoolPrewarm
+{
+	GENERATED_BODY()
+
+	/** Class of actor to pool */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pooling")
+	TSubclassOf<AActor> ActorClass;
+
+	/** Number of inactive actors to spawn */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pooling", meta = (ClampMin = 0, ClampMax = 200))
+	int32 Count = 0;
+};
+
+UINTERFACE(MinimalAPI, Blueprintable)
+class UPooledActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Pooled Actor - Reset hooks for actors recycled by the actor pool.
+ * The pool shows, hides and toggles collision and ticking on its own; these hooks reset the state it doesn't know about.
+ */
+class TACTICS_API IPooledActor
+{
+	GENERATED_BODY()
+
+public:
+	/** Called after the actor is taken from the pool and placed, to bring it back to its starting state */
+	UFUNCTION(BlueprintNativeEvent, Category = "Pooling")
+	void OnAcquiredFromPool();
+	virtual void OnAcquiredFromPool_Implementation() {}
+
+	/** Called before the actor is hidden and put back in the pool, to stop anything it has running */
+	UFUNCTION(BlueprintNativeEvent, Category = "Pooling")
+	void OnReleasedToPool();
+	virtual void OnReleasedToPool_Implementation() {}
+};
+
+/**
+ * Pooled actors and stats for a single class
+ */
+struct FActorClassPool
+{
+	/** Actors ready to be acquired */
+	TArray<TWeakObjectPtr<AActor>> Free;
+
+	/** Initial life span of the class. Acquired actors go back to the pool once it runs out, instead of being destroyed */
+	float AutoReleaseTime = 0.0f;
+
+	/** Number of actors currently in use */
+	int32 NumActive = 0;
+
+	/** Lifetime stats */
+	int32 NumSpawned = 0;
+	int32 NumAcquired = 0;
+	int32 NumReused = 0;
+	int32 NumReleased = 0;
+	int32 NumLost = 0;
+	int32 PeakActive = 0;
+};
+
+/**
+ * Actor spawned by the pool
+ */
+struct FPooledActorState
+{
+	/** Pooled actor */
+	TWeakObjectPtr<AActor> Actor;
+
+	/** Pool the actor belongs to */
+	TObjectKey<UClass> Class;
+
+	/** True while the actor is in use */
+	bool bActive = false;
+
+	/** Time the actor goes back into the pool on its own, or zero */
+	double ReleaseTime = 0.0;
+};
+
+/**
+ * Actor Pool Subsystem - Recycles gameplay actors of any class instead of spawning and destroying them.
+ * Pooled actors are hidden, with collision and ticking disabled, until they're acquired again.
+ * Actors implementing IPooledActor are told when they're acquired and released so they can reset themselves.
+ * BeginPlay only runs once, at spawn, so actors that play one-shot effects there shouldn't be pooled.
+ * Actors destroyed while pooled just drop out of the pool. Per class stats can be logged with Tactics.ActorPool.Dump.
+ */
+UCLASS()
+class TACTICS_API UActorPoolSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Spawns inactive actors of a class ahead of time, out of view above the level, topping the pool up to the given count */
+	void Prewarm(TSubclassOf<AActor> ActorClass, int32 Count);
+
+	/**
+	 * Takes an actor from the pool (spawning one if empty) and places it.
+	 * Returns the actor, or nullptr if it couldn't be spawned.
+	 */
+	AActor* AcquireActor(UClass* ActorClass, const FTransform& Transform);
+
+	/** Typed version of AcquireActor */
+	template<class T>
+	T* AcquireActor(TSubclassOf<T> ActorClass, const FTransform& Transform)
+	{
+		return Cast<T>(AcquireActor(ActorClass.Get(), Transform));
+	}
+
+	/** Puts an acquired actor back in its pool. Returns false if the actor wasn't spawned by the pool */
+	bool ReleaseActor(AActor* Actor);
+
+	/** Puts an actor back in its pool, or destroys it if it wasn't spawned by the pool */
+	static void ReleaseOrDestroy(AActor* Actor);
+
+	/** Check if an actor was spawned by the pool */
+	bool IsPooled(const AActor* Actor) const;
+
+	/** Logs the pool stats */
+	void DumpStats() const;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+private:
+	/** Pools, by actor class */
+	TMap<TObjectKey<UClass>, FActorClassPool> Pools;
+
+	/** Every actor spawned by the pool */
+	TMap<TObjectKey<AActor>, FPooledActorState> PooledActors;
+
+	/** Spawns a new inactive actor for a pool. It's hidden before BeginPlay runs */
+	AActor* SpawnPooledActor(UClass* ActorClass, FActorClassPool& Pool, const FTransform& Transform);
+
+	/** Hides and disables an actor so it can be reused */
+	void DeactivateActor(AActor* Actor);
+};
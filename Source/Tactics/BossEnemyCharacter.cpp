@@ -4,6 +4,8 @@
 #include "Tactics.h"
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Animation/AnimInstance.h"
 
 ABossEnemyCharacter::ABossEnemyCharacter()
 {
@@ -29,73 +31,116 @@ void ABossEnemyCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
+	// Remember the stats phase modifiers are relative to
+	UnmodifiedBaseDamage = BaseDamage;
+	UnmodifiedChaseSpeed = ChaseSpeed;
+	UnmodifiedAttackInterval = AttackInterval;
+
+	// Copy the phase table, or fall back to the legacy settings
+	if (PhaseTable && PhaseTable->Phases.Num() > 0)
+	{
+		ActivePhases = PhaseTable->Phases;
+	}
+	else
+	{
+		BuildDefaultPhases();
+	}
+
+	// Order phases from full HP downwards so phase numbers follow the fight
+	ActivePhases.Sort([](const FBossPhase& A, const FBossPhase& B) { return A.HPThreshold > B.HPThreshold; });
+
 	// Start at phase 1
+	ActivePhaseIndex = INDEX_NONE;
 	CurrentPhase = 1;
 	bIsEnraged = false;
+	AbilityScheduler.Reset();
+
+	// Don't announce the phase the boss starts in
+	UpdatePhase(false);
 }
 
-void ABossEnemyCharacter::Tick(float DeltaSeconds)
+void ABossEnemyCharacter::BuildDefaultPhases()
 {
-	Super::Tick(DeltaSeconds);
+	ActivePhases.Reset();
+
+	FBossAbility SpecialAttack;
+	SpecialAttack.AbilityName = TEXT("SpecialAttack");
+	SpecialAttack.Cooldown = SpecialAttackCooldown;
+	SpecialAttack.DamageMultiplier = 2.0f;
+	SpecialAttack.RangeMultiplier = 1.5f;
+
+	// Phase 1: basic attacks only
+	FBossPhase& Phase1 = ActivePhases.AddDefaulted_GetRef();
+	Phase1.HPThreshold = 1.0f;
+
+	// Phase 2: special attack unlocked
+	FBossPhase& Phase2 = ActivePhases.AddDefaulted_GetRef();
+	Phase2.HPThreshold = Phase2HPThreshold;
+	Phase2.Abilities.Add(SpecialAttack);
+
+	// Phase 3: enraged
+	FBossPhase& Phase3 = ActivePhases.AddDefaulted_GetRef();
+	Phase3.HPThreshold = Phase3HPThreshold;
+	Phase3.SpeedMultiplier = EnrageSpeedMultiplier;
+	Phase3.DamageMultiplier = EnrageDamageMultiplier;
+	Phase3.bEnraged = true;
+	Phase3.Abilities.Add(SpecialAttack);
+}
 
-	// Update special attack timer
-	if (SpecialAttackTimer > 0.0f)
+float ABossEnemyCharacter::TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+{
+	const float ActualDamage = Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
+
+	// HP only changes here, so this is the only place phases can change
+	if (ActualDamage > 0.0f)
 	{
-		SpecialAttackTimer -= DeltaSeconds;
+		UpdatePhase();
 	}
 
-	// Check for phase changes
-	UpdatePhase();
+	return ActualDamage;
 }
 
-void ABossEnemyCharacter::UpdatePhase()
+void ABossEnemyCharacter::UpdatePhase(bool bAnnounce)
 {
-	if (IsDead())
+	if (IsDead() || MaxHP <= 0.0f)
 	{
 		return;
 	}
 
-	float HPPercent = CurrentHP / MaxHP;
-	int32 NewPhase = CurrentPhase;
+	const int32 NewPhaseIndex = UBossPhaseTable::FindPhaseForHealth(ActivePhases, CurrentHP / MaxHP);
 
-	if (HPPercent <= Phase3HPThreshold)
-	{
-		NewPhase = 3;
-	}
-	else if (HPPercent <= Phase2HPThreshold)
-	{
-		NewPhase = 2;
-	}
-	else
+	if (NewPhaseIndex != INDEX_NONE && NewPhaseIndex != ActivePhaseIndex)
 	{
-		NewPhase = 1;
-	}
+		ActivePhaseIndex = NewPhaseIndex;
+		CurrentPhase = ActivePhaseIndex + 1;
 
-	if (NewPhase != CurrentPhase)
-	{
-		CurrentPhase = NewPhase;
-		OnPhaseChange(CurrentPhase);
+		ApplyPhaseModifiers();
+
+		// Phases entered through damage are always announced, including the first one when the boss starts above every threshold
+		if (bAnnounce)
+		{
+			OnPhaseChange(CurrentPhase);
+		}
 	}
 }
 
+void ABossEnemyCharacter::ApplyPhaseModifiers()
+{
+	const FBossPhase& Phase = ActivePhases[ActivePhaseIndex];
+
+	// Modifiers are always relative to the unmodified stats, so they never stack
+	BaseDamage = UnmodifiedBaseDamage * Phase.DamageMultiplier;
+	ChaseSpeed = UnmodifiedChaseSpeed * Phase.SpeedMultiplier;
+	AttackInterval = UnmodifiedAttackInterval * Phase.AttackIntervalMultiplier;
+	bIsEnraged = Phase.bEnraged;
+}
+
 void ABossEnemyCharacter::OnPhaseChange_Implementation(int32 NewPhase)
 {
 	UE_LOG(LogTactics, Warning, TEXT("BOSS %s entered Phase %d!"), *GetName(), NewPhase);
 
-	// Enrage in phase 3
-	if (NewPhase == 3)
+	if (bIsEnraged)
 	{
-		bIsEnraged = true;
-		
-		// Increase speed
-		if (GetCharacterMovement())
-		{
-			GetCharacterMovement()->MaxWalkSpeed = ChaseSpeed * EnrageSpeedMultiplier;
-		}
-		
-		// Increase damage
-		BaseDamage *= EnrageDamageMultiplier;
-		
 		UE_LOG(LogTactics, Warning, TEXT("BOSS %s is now ENRAGED!"), *GetName());
 	}
 }
@@ -117,13 +162,22 @@ void ABossEnemyCharacter::AttackPlayer()
 	FVector DirectionToPlayer = GetDirectionToPlayer();
 	ForceRotateToDirection(DirectionToPlayer);
 
-	// Try special attack if available
-	if (SpecialAttackTimer <= 0.0f && CurrentPhase >= 2)
+	// Try a special attack if the current phase has one off cooldown
+	if (ActivePhases.IsValidIndex(ActivePhaseIndex))
 	{
-		PerformSpecialAttack();
-		SpecialAttackTimer = SpecialAttackCooldown;
-		AttackCooldownTimer = AttackInterval;
-		return;
+		const TArray<FBossAbility>& Abilities = ActivePhases[ActivePhaseIndex].Abilities;
+		const double Now = GetWorld()->GetTimeSeconds();
+		const int32 AbilityIndex = AbilityScheduler.PickAbility(Abilities, Now);
+
+		if (AbilityIndex != INDEX_NONE)
+		{
+			ActiveAbility = Abilities[AbilityIndex];
+			AbilityScheduler.CommitAbility(ActiveAbility, Now);
+
+			PerformSpecialAttack();
+			AttackCooldownTimer = AttackInterval;
+			return;
+		}
 	}
 
 	// Normal attack
@@ -144,14 +198,21 @@ void ABossEnemyCharacter::AttackPlayer()
 
 void ABossEnemyCharacter::PerformSpecialAttack_Implementation()
 {
-	UE_LOG(LogTactics, Warning, TEXT("BOSS %s performs SPECIAL ATTACK (Phase %d)!"), *GetName(), CurrentPhase);
+	UE_LOG(LogTactics, Warning, TEXT("BOSS %s performs %s (Phase %d)!"), *GetName(), *ActiveAbility.AbilityName.ToString(), CurrentPhase);
 
-	// Play attack animation
-	PlayAttackAnimation();
+	// Play the ability montage, or a random attack animation
+	if (ActiveAbility.Montage && GetMesh() && GetMesh()->GetAnimInstance())
+	{
+		GetMesh()->GetAnimInstance()->Montage_Play(ActiveAbility.Montage);
+	}
+	else
+	{
+		PlayAttackAnimation();
+	}
 
-	// Deal extra damage in a wider area
-	float SpecialDamage = BaseDamage * 2.0f;
-	float SpecialRange = EnemyAttackRange * 1.5f;
+	// Deal scaled damage in a scaled area
+	float SpecialDamage = BaseDamage * ActiveAbility.DamageMultiplier;
+	float SpecialRange = EnemyAttackRange * ActiveAbility.RangeMultiplier;
 
 	if (GetDistanceToPlayer() <= SpecialRange)
 	{
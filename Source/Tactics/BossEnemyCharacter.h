@@ -4,10 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "EnemyCharacter.h"
+#include "BossPhaseTable.h"
 #include "BossEnemyCharacter.generated.h"
 
 /**
  * Boss Enemy Character - Powerful enemy with special attacks and phases
+ * Phases and abilities come from a UBossPhaseTable. Phase changes are evaluated when damage is taken.
  */
 UCLASS(Blueprintable, BlueprintType)
 class TACTICS_API ABossEnemyCharacter : public AEnemyCharacter
@@ -18,9 +20,8 @@ public:
 	ABossEnemyCharacter();
 
 	virtual void BeginPlay() override;
-	virtual void Tick(float DeltaSeconds) override;
 
-	/** Get current phase (1, 2, or 3) */
+	/** Get current phase (1-based) */
 	UFUNCTION(BlueprintPure, Category = "Boss")
 	int32 GetCurrentPhase() const { return CurrentPhase; }
 
@@ -28,23 +29,31 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Boss")
 	bool IsEnraged() const { return bIsEnraged; }
 
+	/** Get the ability being performed by the current special attack */
+	UFUNCTION(BlueprintPure, Category = "Boss")
+	const FBossAbility& GetActiveAbility() const { return ActiveAbility; }
+
 protected:
-	/** Boss phases based on HP percentage */
+	/** Phase and ability table. If not set, a default table is built from the legacy settings below */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Boss")
+	UBossPhaseTable* PhaseTable;
+
+	/** Boss phases based on HP percentage (used when no phase table is set) */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Boss")
 	float Phase2HPThreshold = 0.6f; // 60% HP
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Boss")
 	float Phase3HPThreshold = 0.3f; // 30% HP
 
-	/** Enrage mode speed multiplier */
+	/** Enrage mode speed multiplier (used when no phase table is set) */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Boss")
 	float EnrageSpeedMultiplier = 1.5f;
 
-	/** Enrage mode damage multiplier */
+	/** Enrage mode damage multiplier (used when no phase table is set) */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Boss")
 	float EnrageDamageMultiplier = 1.3f;
 
-	/** Special attack cooldown */
+	/** Special attack cooldown (used when no phase table is set) */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Boss")
 	float SpecialAttackCooldown = 5.0f;
 
@@ -54,13 +63,30 @@ protected:
 	/** Is boss enraged */
 	bool bIsEnraged = false;
 
-	/** Special attack timer */
-	float SpecialAttackTimer = 0.0f;
+	/** Phases in use, copied from the phase table or built from the legacy settings */
+	TArray<FBossPhase> ActivePhases;
+
+	/** Index into ActivePhases of the current phase */
+	int32 ActivePhaseIndex = INDEX_NONE;
+
+	/** Ability picked for the current special attack */
+	FBossAbility ActiveAbility;
+
+	/** Picks abilities by cooldown and weight */
+	FBossAbilityScheduler AbilityScheduler;
+
+	/** Stats before any phase modifiers are applied */
+	float UnmodifiedBaseDamage = 0.0f;
+	float UnmodifiedChaseSpeed = 0.0f;
+	float UnmodifiedAttackInterval = 0.0f;
+
+	/** Evaluate phase changes when damaged */
+	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
 	/** Override attack with boss attacks */
 	virtual void AttackPlayer() override;
 
-	/** Perform special attack based on phase */
+	/** Perform the special attack picked by the ability scheduler */
 	UFUNCTION(BlueprintNativeEvent, Category = "Boss")
 	void PerformSpecialAttack();
 	virtual void PerformSpecialAttack_Implementation();
@@ -70,8 +96,14 @@ protected:
 	void OnPhaseChange(int32 NewPhase);
 	virtual void OnPhaseChange_Implementation(int32 NewPhase);
 
-	/** Check and update phase based on HP */
-	void UpdatePhase();
+	/** Check and update phase based on HP. Phase changes are announced unless bAnnounce is false */
+	void UpdatePhase(bool bAnnounce = true);
+
+	/** Apply the modifiers of the current phase to the unmodified stats */
+	void ApplyPhaseModifiers();
+
+	/** Build the phase list from the legacy threshold and enrage settings */
+	void BuildDefaultPhases();
 
 	/** Override death for boss-specific effects */
 	virtual void OnDeath_Implementation() override;
@@ -0,0 +1,66 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BossPhaseTable.h"
+
+int32 UBossPhaseTable::FindPhaseForHealth(const TArray<FBossPhase>& InPhases, float HPPercent)
+{
+	int32 Found = INDEX_NONE;
+
+	for (int32 Index = 0; Index < InPhases.Num(); ++Index)
+	{
+		// Lowest threshold the HP hasn't dropped below yet
+		if (HPPercent <= InPhases[Index].HPThreshold && (Found == INDEX_NONE || InPhases[Index].HPThreshold < InPhases[Found].HPThreshold))
+		{
+			Found = Index;
+		}
+	}
+
+	return Found;
+}
+
+int32 FBossAbilityScheduler::PickAbility(const TArray<FBossAbility>& Abilities, double Now) const
+{
+	// Sum the weights of every ability that is off cooldown
+	float TotalWeight = 0.0f;
+	for (const FBossAbility& Ability : Abilities)
+	{
+		const double* ReadyTime = ReadyTimes.Find(Ability.AbilityName);
+		if (!ReadyTime || *ReadyTime <= Now)
+		{
+			TotalWeight += Ability.Weight;
+		}
+	}
+
+	if (TotalWeight <= 0.0f)
+	{
+		return INDEX_NONE;
+	}
+
+	// Weighted random pick among the ready abilities
+	float Roll = FMath::FRand() * TotalWeight;
+	int32 LastReady = INDEX_NONE;
+
+	for (int32 Index = 0; Index < Abilities.Num(); ++Index)
+	{
+		const double* ReadyTime = ReadyTimes.Find(Abilities[Index].AbilityName);
+		if (ReadyTime && *ReadyTime > Now)
+		{
+			continue;
+		}
+
+		LastReady = Index;
+		Roll -= Abilities[Index].Weight;
+
+		if (Roll < 0.0f)
+		{
+			return Index;
+		}
+	}
+
+	return LastReady;
+}
+
+void FBossAbilityScheduler::CommitAbility(const FBossAbility& Ability, double Now)
+{
+	ReadyTimes.Add(Ability.AbilityName, Now + Ability.Cooldown);
+}
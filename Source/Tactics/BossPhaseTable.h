@@ -0,0 +1,111 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "BossPhaseTable.generated.h"
+
+class UAnimMontage;
+
+/**
+ * A boss ability that can be scheduled during a phase
+ */
+USTRUCT(BlueprintType)
+struct FBossAbility
+{
+	GENERATED_BODY()
+
+	/** Name used to identify the ability, also shares cooldowns between phases */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ability")
+	FName AbilityName;
+
+	/** Relative chance of being picked among the abilities that are off cooldown */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ability", meta = (ClampMin = 0))
+	float Weight = 1.0f;
+
+	/** Time before the ability can be used again */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ability", meta = (ClampMin = 0, Units = "s"))
+	float Cooldown = 5.0f;
+
+	/** Damage dealt, as a multiple of the boss damage */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ability", meta = (ClampMin = 0))
+	float DamageMultiplier = 2.0f;
+
+	/** Reach of the ability, as a multiple of the boss attack range */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ability", meta = (ClampMin = 0))
+	float RangeMultiplier = 1.5f;
+
+	/** Montage to play. Falls back to a random attack animation if not set */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ability")
+	UAnimMontage* Montage = nullptr;
+};
+
+/**
+ * A boss phase, active while HP is at or below its threshold
+ */
+USTRUCT(BlueprintType)
+struct FBossPhase
+{
+	GENERATED_BODY()
+
+	/** HP fraction (0-1) at or below which this phase becomes active */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Phase", meta = (ClampMin = 0, ClampMax = 1))
+	float HPThreshold = 1.0f;
+
+	/** Chase speed multiplier while in this phase */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Phase", meta = (ClampMin = 0))
+	float SpeedMultiplier = 1.0f;
+
+	/** Damage multiplier while in this phase */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Phase", meta = (ClampMin = 0))
+	float DamageMultiplier = 1.0f;
+
+	/** Attack interval multiplier while in this phase */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Phase", meta = (ClampMin = 0))
+	float AttackIntervalMultiplier = 1.0f;
+
+	/** If true, the boss is considered enraged during this phase */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Phase")
+	bool bEnraged = false;
+
+	/** Abilities available during this phase */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Phase")
+	TArray<FBossAbility> Abilities;
+};
+
+/**
+ * Boss Phase Table - Data asset describing a boss' phases and abilities
+ */
+UCLASS(BlueprintType)
+class TACTICS_API UBossPhaseTable : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	/** Phases, in any order. The active phase is the one with the lowest threshold still at or above the current HP */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Boss")
+	TArray<FBossPhase> Phases;
+
+	/** Returns the index of the phase active at the given HP fraction, or INDEX_NONE */
+	static int32 FindPhaseForHealth(const TArray<FBossPhase>& InPhases, float HPPercent);
+};
+
+/**
+ * Picks boss abilities by cooldown and weight
+ */
+struct TACTICS_API FBossAbilityScheduler
+{
+	/** Returns the index of a ready ability picked by weight, or INDEX_NONE if none is ready */
+	int32 PickAbility(const TArray<FBossAbility>& Abilities, double Now) const;
+
+	/** Starts the cooldown for an ability */
+	void CommitAbility(const FBossAbility& Ability, double Now);
+
+	/** Clears all cooldowns */
+	void Reset() { ReadyTimes.Reset(); }
+
+private:
+	/** Time each ability becomes ready again, by name */
+	TMap<FName, double> ReadyTimes;
+};
@@ -0,0 +1,97 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CursorCacheSubsystem.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+UCursorCacheSubsystem* UCursorCacheSubsystem::Get(const APlayerController* PlayerController)
+{
+	if (!PlayerController)
+	{
+		return nullptr;
+	}
+
+	return ULocalPlayer::GetSubsystem<UCursorCacheSubsystem>(PlayerController->GetLocalPlayer());
+}
+
+bool UCursorCacheSubsystem::GetCursorRay(FVector& OutOrigin, FVector& OutDirection)
+{
+	UpdateRay();
+
+	OutOrigin = RayOrigin;
+	OutDirection = RayDirection;
+
+	return bRayValid;
+}
+
+bool UCursorCacheSubsystem::GetCursorGroundLocation(float PlaneZ, FVector& OutLocation)
+{
+	UpdateRay();
+
+	// A ray parallel to the ground never reaches it
+	if (!bRayValid || FMath::IsNearlyZero(RayDirection.Z))
+	{
+		return false;
+	}
+
+	OutLocation = FMath::LinePlaneIntersection(RayOrigin, RayOrigin + RayDirection, FPlane(FVector(0.0f, 0.0f, PlaneZ), FVector::UpVector));
+
+	return true;
+}
+
+bool UCursorCacheSubsystem::GetCursorHit(TEnumAsByte<ECollisionChannel> TraceChannel, FHitResult& OutHit)
+{
+	FCursorHitCacheEntry& Entry = HitCache.FindOrAdd(TraceChannel.GetValue());
+
+	// Trace each channel at most once per frame
+	if (Entry.Frame != GFrameCounter)
+	{
+		Entry.Frame = GFrameCounter;
+		Entry.Hit = FHitResult();
+
+		UpdateRay();
+
+		const ULocalPlayer* LocalPlayer = GetLocalPlayer();
+		const APlayerController* PlayerController = LocalPlayer ? LocalPlayer->GetPlayerController(LocalPlayer->GetWorld()) : nullptr;
+
+		if (bRayValid && PlayerController)
+		{
+			// Same query the player controller's cursor traces use
+			const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ClickableTrace), true);
+			const FVector TraceEnd = RayOrigin + RayDirection * PlayerController->HitResultTraceDistance;
+
+			PlayerController->GetWorld()->LineTraceSingleByChannel(Entry.Hit, RayOrigin, TraceEnd, TraceChannel, QueryParams);
+		}
+	}
+
+	OutHit = Entry.Hit;
+
+	return Entry.Hit.bBlockingHit;
+}
+
+void UCursorCacheSubsystem::Deinitialize()
+{
+	HitCache.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCursorCacheSubsystem::UpdateRay()
+{
+	if (RayFrame == GFrameCounter)
+	{
+		return;
+	}
+
+	RayFrame = GFrameCounter;
+	bRayValid = false;
+
+	const ULocalPlayer* LocalPlayer = GetLocalPlayer();
+	const APlayerController* PlayerController = LocalPlayer ? LocalPlayer->GetPlayerController(LocalPlayer->GetWorld()) : nullptr;
+
+	if (PlayerController)
+	{
+		bRayValid = PlayerController->DeprojectMousePositionToWorld(RayOrigin, RayDirection);
+	}
+}
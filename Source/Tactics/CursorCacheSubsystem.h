@@ -0,0 +1,65 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/LocalPlayerSubsystem.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/HitResult.h"
+#include "CursorCacheSubsystem.generated.h"
+
+class APlayerController;
+
+/**
+ * Cursor Cache Subsystem - Resolves the cursor's world position once per frame for a local player.
+ * The cursor is deprojected lazily on the first request of a frame, and each trace channel is traced
+ * at most once per frame. Every later request that frame is served from the cache.
+ */
+UCLASS()
+class TACTICS_API UCursorCacheSubsystem : public ULocalPlayerSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Get the cursor cache for a player controller's local player */
+	static UCursorCacheSubsystem* Get(const APlayerController* PlayerController);
+
+	/** Get the cursor ray in world space. Returns false if there's no cursor to deproject */
+	UFUNCTION(BlueprintCallable, Category = "Cursor")
+	bool GetCursorRay(FVector& OutOrigin, FVector& OutDirection);
+
+	/** Ground plane mode: intersect the cursor ray with a horizontal plane at the given height, without tracing */
+	UFUNCTION(BlueprintCallable, Category = "Cursor")
+	bool GetCursorGroundLocation(float PlaneZ, FVector& OutLocation);
+
+	/** Full trace mode: trace the cursor ray against the world on a channel. Returns true on a blocking hit */
+	UFUNCTION(BlueprintCallable, Category = "Cursor")
+	bool GetCursorHit(TEnumAsByte<ECollisionChannel> TraceChannel, FHitResult& OutHit);
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+private:
+	/** Cached trace result for a channel */
+	struct FCursorHitCacheEntry
+	{
+		uint64 Frame = 0;
+		FHitResult Hit;
+	};
+
+	/** Make sure the cursor ray is up to date for this frame */
+	void UpdateRay();
+
+	/** Frame the ray was last deprojected on */
+	uint64 RayFrame = 0;
+
+	/** True if the cursor could be deprojected this frame */
+	bool bRayValid = false;
+
+	/** Cached cursor ray */
+	FVector RayOrigin = FVector::ZeroVector;
+	FVector RayDirection = FVector::ForwardVector;
+
+	/** Cached traces, by channel */
+	TMap<ECollisionChannel, FCursorHitCacheEntry> HitCache;
+};
@@ -3,6 +3,8 @@
 #include "EnemyCharacter.h"
 #include "Tactics.h"
 #include "TacticsCharacter.h"
+#include "PatrolRoute.h"
+#include "EnemyPerceptionSubsystem.h"
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Engine/World.h"
@@ -74,7 +76,28 @@ bool AEnemyCharacter::IsPlayerInRange() const
 		return false;
 	}
 
-	return GetDistanceToPlayer() <= DetectionRange;
+	if (GetDistanceToPlayer() > DetectionRange)
+	{
+		return false;
+	}
+
+	// Line of sight is resolved asynchronously by the perception subsystem
+	if (bRequireLineOfSight)
+	{
+		if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+		{
+			if (Perception->HasLineOfSight(this, PlayerCharacter))
+			{
+				return true;
+			}
+
+			// Keep tracking a player that just ducked out of sight
+			const float TimeSinceSeen = Perception->GetTimeSinceLastSeen(this, PlayerCharacter);
+			return TimeSinceSeen >= 0.0f && TimeSinceSeen <= SightMemoryTime;
+		}
+	}
+
+	return true;
 }
 
 bool AEnemyCharacter::IsPlayerInAttackRange() const
@@ -109,6 +132,17 @@ float AEnemyCharacter::GetDistanceToPlayer() const
 	return FVector::Distance(GetActorLocation(), PlayerCharacter->GetActorLocation());
 }
 
+EEnemyAILODTier AEnemyCharacter::GetAILODTier() const
+{
+	// Only distance counts, so the tier is the same with no renderer (dedicated servers, -nullrhi)
+	if (GetDistanceToPlayer() > LowLODDistance)
+	{
+		return EEnemyAILODTier::Low;
+	}
+
+	return EEnemyAILODTier::High;
+}
+
 void AEnemyCharacter::AttackPlayer()
 {
 	if (!PlayerCharacter || PlayerCharacter->IsDead())
@@ -144,15 +178,27 @@ void AEnemyCharacter::AttackPlayer()
 
 void AEnemyCharacter::UpdateAI(float DeltaSeconds)
 {
-	// Skip if dead or no player
-	if (IsDead() || !PlayerCharacter || PlayerCharacter->IsDead())
+	// Skip if dead
+	if (IsDead())
 	{
 		return;
 	}
 
+	// Squad members only execute the squad's decisions
+	if (Squad)
+	{
+		UpdateSquadMember(DeltaSeconds);
+		return;
+	}
+
 	// Check if player is in detection range
 	if (IsPlayerInRange())
 	{
+		// Leave the patrol route, we'll rejoin it once the player is lost
+		PatrolFromWaypoint = INDEX_NONE;
+		PatrolToWaypoint = INDEX_NONE;
+		PatrolWaitTimer = 0.0f;
+
 		// Set chase speed
 		if (GetCharacterMovement())
 		{
@@ -188,8 +234,137 @@ void AEnemyCharacter::UpdateAI(float DeltaSeconds)
 			GetCharacterMovement()->MaxWalkSpeed = PatrolSpeed;
 		}
 
-		// TODO: Implement patrol behavior
+		UpdatePatrol(DeltaSeconds);
+	}
+}
+
+void AEnemyCharacter::SetSquad(AEnemySquad* InSquad)
+{
+	Squad = InSquad;
+	SquadOrder = FEnemySquadOrder();
+}
+
+void AEnemyCharacter::SetSquadOrder(const FEnemySquadOrder& InOrder)
+{
+	SquadOrder = InOrder;
+
+	// Attack whoever the squad is targeting
+	if (SquadOrder.Target)
+	{
+		PlayerCharacter = SquadOrder.Target;
+	}
+}
+
+void AEnemyCharacter::UpdateSquadMember(float DeltaSeconds)
+{
+	if (!SquadOrder.bEngage)
+	{
+		if (GetCharacterMovement())
+		{
+			GetCharacterMovement()->MaxWalkSpeed = PatrolSpeed;
+		}
+
+		UpdatePatrol(DeltaSeconds);
+		return;
+	}
+
+	// Leave the patrol route, we'll rejoin it once the squad disengages
+	PatrolFromWaypoint = INDEX_NONE;
+	PatrolToWaypoint = INDEX_NONE;
+	PatrolWaitTimer = 0.0f;
+
+	if (GetCharacterMovement())
+	{
+		GetCharacterMovement()->MaxWalkSpeed = ChaseSpeed;
+	}
+
+	// Face the target while engaged
+	FRotator NewRotation = FMath::RInterpTo(GetActorRotation(), GetDirectionToPlayer().Rotation(), DeltaSeconds, 10.0f);
+	SetActorRotation(FRotator(0.0f, NewRotation.Yaw, 0.0f));
+
+	if (SquadOrder.bAllowAttack && IsPlayerInAttackRange())
+	{
+		// Stop moving and attack
+		AttackPlayer();
+		return;
+	}
+
+	// Steer to our formation slot
+	if (SquadOrder.bHasMoveTarget)
+	{
+		FVector Direction = SquadOrder.MoveTarget - GetActorLocation();
+		Direction.Z = 0.0f;
+
+		if (Direction.SizeSquared() > FMath::Square(PatrolAcceptanceRadius))
+		{
+			AddMovementInput(Direction.GetSafeNormal(), 1.0f);
+		}
+	}
+}
+
+void AEnemyCharacter::UpdatePatrol(float DeltaSeconds)
+{
+	if (!PatrolRoute || PatrolRoute->GetNumWaypoints() == 0)
+	{
+		return;
 	}
+
+	// Wait at the last reached waypoint
+	if (PatrolWaitTimer > 0.0f)
+	{
+		PatrolWaitTimer -= DeltaSeconds;
+		return;
+	}
+
+	const FVector CurrentLocation = GetActorLocation();
+
+	// Not on the route yet, head straight for the nearest waypoint
+	if (PatrolToWaypoint == INDEX_NONE)
+	{
+		PatrolFromWaypoint = INDEX_NONE;
+		PatrolToWaypoint = PatrolRoute->FindNearestWaypoint(CurrentLocation);
+		PatrolPointIndex = 0;
+	}
+
+	// Pick the next point on the shared segment polyline
+	const FPatrolSegment* Segment = PatrolRoute->GetSegment(PatrolFromWaypoint, PatrolToWaypoint);
+	const bool bOnSegment = Segment && Segment->Points.IsValidIndex(PatrolPointIndex);
+	const FVector TargetPoint = bOnSegment ? Segment->Points[PatrolPointIndex] : PatrolRoute->GetWaypointLocation(PatrolToWaypoint);
+
+	if (FVector::Dist2D(CurrentLocation, TargetPoint) <= PatrolAcceptanceRadius)
+	{
+		// Advance along the segment
+		if (bOnSegment && PatrolPointIndex < Segment->Points.Num() - 1)
+		{
+			++PatrolPointIndex;
+			return;
+		}
+
+		// Reached the waypoint, choose where to go next
+		const int32 NextWaypoint = PatrolRoute->ChooseNextWaypoint(PatrolToWaypoint, PatrolFromWaypoint);
+		PatrolWaitTimer = PatrolRoute->GetWaypointWaitTime(PatrolToWaypoint);
+
+		if (NextWaypoint != INDEX_NONE)
+		{
+			PatrolFromWaypoint = PatrolToWaypoint;
+			PatrolToWaypoint = NextWaypoint;
+
+			// Point 0 is the waypoint we're standing on
+			PatrolPointIndex = 1;
+		}
+
+		return;
+	}
+
+	FVector Direction = TargetPoint - CurrentLocation;
+	Direction.Z = 0.0f;
+	Direction.Normalize();
+
+	// Smooth rotation towards the patrol direction
+	FRotator NewRotation = FMath::RInterpTo(GetActorRotation(), Direction.Rotation(), DeltaSeconds, 5.0f);
+	SetActorRotation(FRotator(0.0f, NewRotation.Yaw, 0.0f));
+
+	AddMovementInput(Direction, 1.0f);
 }
 
 void AEnemyCharacter::OnDeath_Implementation()
@@ -6,6 +6,68 @@
 #include "TacticsCharacter.h"
 #include "EnemyCharacter.generated.h"
 
+class APatrolRoute;
+class AEnemySquad;
+
+/**
+ * AI level of detail tiers. Low tier enemies may use cheaper behavior
+ */
+UENUM(BlueprintType)
+enum class EEnemyAILODTier : uint8
+{
+	High,
+	Low
+};
+
+/**
+ * Roles handed out by an enemy squad
+ */
+UENUM(BlueprintType)
+enum class EEnemySquadRole : uint8
+{
+	/** Closes in and attacks */
+	Attacker,
+
+	/** Circles to the target's side before attacking */
+	Flanker,
+
+	/** Holds back and waits for an attack slot */
+	Support
+};
+
+/**
+ * Latest decision made by an enemy squad for one of its members
+ */
+USTRUCT(BlueprintType)
+struct FEnemySquadOrder
+{
+	GENERATED_BODY()
+
+	/** True while the squad is engaging a target */
+	UPROPERTY(BlueprintReadOnly, Category = "Squad")
+	bool bEngage = false;
+
+	/** Role assigned by the squad */
+	UPROPERTY(BlueprintReadOnly, Category = "Squad")
+	EEnemySquadRole Role = EEnemySquadRole::Support;
+
+	/** Target picked by the squad */
+	UPROPERTY(BlueprintReadOnly, Category = "Squad")
+	class ATacticsCharacter* Target = nullptr;
+
+	/** Location to steer to (formation slot) */
+	UPROPERTY(BlueprintReadOnly, Category = "Squad")
+	FVector MoveTarget = FVector::ZeroVector;
+
+	/** True if MoveTarget is set */
+	UPROPERTY(BlueprintReadOnly, Category = "Squad")
+	bool bHasMoveTarget = false;
+
+	/** True if the member may attack the target when in range */
+	UPROPERTY(BlueprintReadOnly, Category = "Squad")
+	bool bAllowAttack = false;
+};
+
 /**
  * Enemy Character - AI controlled enemy that can patrol, chase, and attack
  */
@@ -20,7 +82,7 @@ public:
 	virtual void BeginPlay() override;
 	virtual void Tick(float DeltaSeconds) override;
 
-	/** Check if player is in detection range */
+	/** Check if player is in detection range and visible */
 	UFUNCTION(BlueprintPure, Category = "AI")
 	bool IsPlayerInRange() const;
 
@@ -40,11 +102,41 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "AI")
 	virtual void AttackPlayer();
 
+	/** Get the AI level of detail tier, based on distance to the player */
+	UFUNCTION(BlueprintPure, Category = "AI")
+	EEnemyAILODTier GetAILODTier() const;
+
+	/** Get attack range */
+	UFUNCTION(BlueprintPure, Category = "AI")
+	float GetAttackRange() const { return EnemyAttackRange; }
+
+	/** Assign this enemy to a squad. While in a squad, the squad makes decisions and this enemy executes its orders */
+	void SetSquad(AEnemySquad* InSquad);
+
+	/** Get the squad this enemy belongs to, if any */
+	UFUNCTION(BlueprintPure, Category = "AI|Squad")
+	AEnemySquad* GetSquad() const { return Squad; }
+
+	/** Receive the latest order from the squad */
+	void SetSquadOrder(const FEnemySquadOrder& InOrder);
+
+	/** Get the latest order from the squad */
+	UFUNCTION(BlueprintPure, Category = "AI|Squad")
+	const FEnemySquadOrder& GetSquadOrder() const { return SquadOrder; }
+
 protected:
 	/** Detection range - how far the enemy can see the player */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
 	float DetectionRange = 1000.0f;
 
+	/** If true, the player must also be in line of sight to be detected */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
+	bool bRequireLineOfSight = true;
+
+	/** Time the enemy keeps tracking the player after losing sight of them */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI", meta = (ClampMin = 0, Units = "s"))
+	float SightMemoryTime = 1.0f;
+
 	/** Attack range - how close the enemy needs to be to attack */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
 	float EnemyAttackRange = 150.0f;
@@ -61,6 +153,18 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
 	float AttackInterval = 1.5f;
 
+	/** Beyond this distance from the player the enemy drops to the low AI LOD tier */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|LOD")
+	float LowLODDistance = 2000.0f;
+
+	/** Patrol route to follow while the player is not detected */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Patrol")
+	APatrolRoute* PatrolRoute;
+
+	/** Distance at which a patrol path point counts as reached */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Patrol")
+	float PatrolAcceptanceRadius = 50.0f;
+
 	/** Points awarded when killed */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rewards")
 	int32 ScoreValue = 100;
@@ -76,6 +180,13 @@ protected:
 	/** Timer for attack cooldown */
 	float AttackCooldownTimer = 0.0f;
 
+	/** Squad making decisions for this enemy */
+	UPROPERTY()
+	AEnemySquad* Squad;
+
+	/** Latest order from the squad */
+	FEnemySquadOrder SquadOrder;
+
 	/** Called when this enemy dies */
 	virtual void OnDeath_Implementation() override;
 
@@ -85,4 +196,22 @@ private:
 
 	/** Simple AI behavior - chase and attack */
 	void UpdateAI(float DeltaSeconds);
+
+	/** Execute the squad's orders instead of making our own decisions */
+	void UpdateSquadMember(float DeltaSeconds);
+
+	/** Follow the cached patrol route polylines */
+	void UpdatePatrol(float DeltaSeconds);
+
+	/** Waypoint the current patrol segment starts at (INDEX_NONE while rejoining the route) */
+	int32 PatrolFromWaypoint = INDEX_NONE;
+
+	/** Waypoint the current patrol segment leads to (INDEX_NONE if not patrolling) */
+	int32 PatrolToWaypoint = INDEX_NONE;
+
+	/** Index of the next point on the current patrol segment */
+	int32 PatrolPointIndex = 0;
+
+	/** Time left to wait at the current waypoint */
+	float PatrolWaitTimer = 0.0f;
 };
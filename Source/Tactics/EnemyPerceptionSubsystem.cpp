@@ -0,0 +1,166 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "EnemyPerceptionSubsystem.h"
+#include "Tactics.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarPerceptionMaxTracesPerFrame(
+	TEXT("Tactics.Perception.MaxTracesPerFrame"),
+	8,
+	TEXT("Maximum number of line of sight traces the enemy perception subsystem issues per frame."));
+
+static TAutoConsoleVariable<float> CVarPerceptionCacheExpiry(
+	TEXT("Tactics.Perception.CacheExpiry"),
+	0.25f,
+	TEXT("Seconds before a cached line of sight result is considered stale and queued for a refresh."));
+
+/** Pairs nobody asked about for this long are dropped from the cache */
+static constexpr double SightCachePruneTime = 5.0;
+
+bool UEnemyPerceptionSubsystem::HasLineOfSight(const AActor* Observer, const AActor* Target)
+{
+	if (!Observer || !Target)
+	{
+		return false;
+	}
+
+	FSightCacheEntry& Entry = SightCache.FindOrAdd(FSightKey(FObjectKey(Observer), FObjectKey(Target)));
+	Entry.Observer = Observer;
+	Entry.Target = Target;
+	Entry.LastRequestTime = GetWorld()->GetTimeSeconds();
+	Entry.Distance = FVector::Dist(Observer->GetActorLocation(), Target->GetActorLocation());
+
+	// Unknown pairs report no sight until their first trace comes back
+	return Entry.bVisible;
+}
+
+float UEnemyPerceptionSubsystem::GetTimeSinceLastSeen(const AActor* Observer, const AActor* Target) const
+{
+	const FSightCacheEntry* Entry = SightCache.Find(FSightKey(FObjectKey(Observer), FObjectKey(Target)));
+	if (!Entry || Entry->LastSeenTime < 0.0)
+	{
+		return -1.0f;
+	}
+
+	return static_cast<float>(GetWorld()->GetTimeSeconds() - Entry->LastSeenTime);
+}
+
+void UEnemyPerceptionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float Expiry = FMath::Max(CVarPerceptionCacheExpiry.GetValueOnGameThread(), 0.0f);
+
+	RefreshCandidates.Reset();
+
+	for (auto It = SightCache.CreateIterator(); It; ++It)
+	{
+		FSightCacheEntry& Entry = It.Value();
+
+		// Drop pairs whose actors are gone or that nobody cares about anymore
+		if (!Entry.bTracePending && (!Entry.Observer.IsValid() || !Entry.Target.IsValid() || Now - Entry.LastRequestTime > SightCachePruneTime))
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		// Only refresh pairs that are still being asked about
+		if (Entry.bTracePending || Now - Entry.LastRequestTime > Expiry)
+		{
+			continue;
+		}
+
+		// Never traced pairs count as maximally stale
+		const double Age = Entry.ResultTime < 0.0 ? Expiry * 4.0 : Now - Entry.ResultTime;
+		if (Age < Expiry)
+		{
+			continue;
+		}
+
+		// Older results and closer targets first. Targets seen recently get a boost so chases stay responsive
+		const bool bSeenRecently = Entry.LastSeenTime >= 0.0 && Now - Entry.LastSeenTime < 2.0;
+		const float Priority = static_cast<float>(Age) * (bSeenRecently ? 2.0f : 1.0f) / FMath::Max(Entry.Distance, 100.0f);
+
+		RefreshCandidates.Emplace(Priority, It.Key());
+	}
+
+	// Issue the highest priority traces within the per-frame budget
+	const int32 Budget = FMath::Min(RefreshCandidates.Num(), FMath::Max(CVarPerceptionMaxTracesPerFrame.GetValueOnGameThread(), 0));
+	if (Budget < RefreshCandidates.Num())
+	{
+		RefreshCandidates.Sort([](const TPair<float, FSightKey>& A, const TPair<float, FSightKey>& B) { return A.Key > B.Key; });
+	}
+
+	for (int32 Index = 0; Index < Budget; ++Index)
+	{
+		const FSightKey& Key = RefreshCandidates[Index].Value;
+		IssueTrace(Key, SightCache[Key]);
+	}
+}
+
+TStatId UEnemyPerceptionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyPerceptionSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemyPerceptionSubsystem::Deinitialize()
+{
+	SightCache.Empty();
+	PendingTraces.Empty();
+
+	Super::Deinitialize();
+}
+
+void UEnemyPerceptionSubsystem::IssueTrace(const FSightKey& Key, FSightCacheEntry& Entry)
+{
+	const AActor* Observer = Entry.Observer.Get();
+	const AActor* Target = Entry.Target.Get();
+
+	// Trace from the observer's eyes to the target, ignoring both
+	FVector EyeLocation;
+	FRotator EyeRotation;
+	Observer->GetActorEyesViewPoint(EyeLocation, EyeRotation);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(EnemySight), false);
+	QueryParams.AddIgnoredActor(Observer);
+	QueryParams.AddIgnoredActor(Target);
+
+	const uint32 TraceId = NextTraceId++;
+	FTraceDelegate TraceDelegate = FTraceDelegate::CreateUObject(this, &UEnemyPerceptionSubsystem::OnTraceCompleted);
+
+	GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, EyeLocation, Target->GetActorLocation(), SightChannel, QueryParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, TraceId);
+
+	Entry.bTracePending = true;
+	PendingTraces.Add(TraceId, Key);
+}
+
+void UEnemyPerceptionSubsystem::OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Data)
+{
+	FSightKey Key;
+	if (!PendingTraces.RemoveAndCopyValue(Data.UserData, Key))
+	{
+		return;
+	}
+
+	FSightCacheEntry* Entry = SightCache.Find(Key);
+	if (!Entry)
+	{
+		return;
+	}
+
+	// Anything blocking between the two actors breaks line of sight
+	const bool bBlocked = Data.OutHits.Num() > 0 && Data.OutHits[0].bBlockingHit;
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	Entry->bTracePending = false;
+	Entry->bVisible = !bBlocked;
+	Entry->ResultTime = Now;
+
+	if (Entry->bVisible)
+	{
+		Entry->LastSeenTime = Now;
+	}
+}
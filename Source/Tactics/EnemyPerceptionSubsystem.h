@@ -0,0 +1,93 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineTypes.h"
+#include "UObject/ObjectKey.h"
+#include "EnemyPerceptionSubsystem.generated.h"
+
+struct FTraceHandle;
+struct FTraceDatum;
+
+/**
+ * Cached line of sight result for a single (observer, target) pair
+ */
+struct FSightCacheEntry
+{
+	/** Observer doing the looking */
+	TWeakObjectPtr<const AActor> Observer;
+
+	/** Actor being looked at */
+	TWeakObjectPtr<const AActor> Target;
+
+	/** Result of the last completed trace */
+	bool bVisible = false;
+
+	/** True while a trace for this pair is in flight */
+	bool bTracePending = false;
+
+	/** Time the last trace result arrived (negative if never traced) */
+	double ResultTime = -1.0;
+
+	/** Last time the target was visible to the observer */
+	double LastSeenTime = -1.0;
+
+	/** Last time anyone asked about this pair */
+	double LastRequestTime = 0.0;
+
+	/** Distance between observer and target at the last request */
+	float Distance = 0.0f;
+};
+
+/**
+ * Enemy Perception Subsystem - Batched, asynchronous line of sight checks.
+ * Callers read the cached visibility for an (observer, target) pair. Stale pairs are
+ * queued and refreshed with AsyncLineTraceByChannel, a bounded number per frame,
+ * ordered by distance and age. Results are consumed on the following frame.
+ */
+UCLASS()
+class TACTICS_API UEnemyPerceptionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Returns the cached line of sight between Observer and Target, and schedules a refresh if it has expired */
+	bool HasLineOfSight(const AActor* Observer, const AActor* Target);
+
+	/** Returns the time since Observer last saw Target, or a negative value if it never did */
+	float GetTimeSinceLastSeen(const AActor* Observer, const AActor* Target) const;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+protected:
+	/** Trace channel used for sight checks */
+	ECollisionChannel SightChannel = ECC_Visibility;
+
+private:
+	using FSightKey = TPair<FObjectKey, FObjectKey>;
+
+	/** Cached results per (observer, target) pair */
+	TMap<FSightKey, FSightCacheEntry> SightCache;
+
+	/** In-flight traces, keyed by the user data passed to the trace */
+	TMap<uint32, FSightKey> PendingTraces;
+
+	/** Id handed to the next trace */
+	uint32 NextTraceId = 1;
+
+	/** Scratch list of pairs to refresh this frame */
+	TArray<TPair<float, FSightKey>> RefreshCandidates;
+
+	/** Issue the trace for a single pair */
+	void IssueTrace(const FSightKey& Key, FSightCacheEntry& Entry);
+
+	/** Async trace completion callback */
+	void OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Data);
+};
@@ -0,0 +1,376 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "EnemySquad.h"
+#include "Tactics.h"
+#include "TacticsCharacter.h"
+#include "EnemyPerceptionSubsystem.h"
+#include "Components/SceneComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "NavigationSystem.h"
+#include "NavigationPath.h"
+#include "Engine/World.h"
+
+AEnemySquad::AEnemySquad()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void AEnemySquad::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Squad decisions run slower than member steering
+	SetActorTickInterval(DecisionInterval);
+
+	for (AEnemyCharacter* Member : Members)
+	{
+		if (Member)
+		{
+			Member->SetSquad(this);
+		}
+	}
+}
+
+void AEnemySquad::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Hand the members back to their own AI
+	for (AEnemyCharacter* Member : Members)
+	{
+		if (Member && Member->GetSquad() == this)
+		{
+			Member->SetSquad(nullptr);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AEnemySquad::AddMember(AEnemyCharacter* Member)
+{
+	if (!Member || Members.Contains(Member))
+	{
+		return;
+	}
+
+	// Members belong to a single squad
+	if (AEnemySquad* PreviousSquad = Member->GetSquad())
+	{
+		PreviousSquad->RemoveMember(Member);
+	}
+
+	Members.Add(Member);
+	Member->SetSquad(this);
+}
+
+void AEnemySquad::RemoveMember(AEnemyCharacter* Member)
+{
+	if (Member && Members.Remove(Member) > 0 && Member->GetSquad() == this)
+	{
+		Member->SetSquad(nullptr);
+	}
+}
+
+void AEnemySquad::Tick(float DeltaSeconds)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_EnemySquad_Decide);
+
+	Super::Tick(DeltaSeconds);
+
+	PruneMembers();
+
+	if (Members.Num() == 0)
+	{
+		return;
+	}
+
+	// Find the player once for the whole squad
+	if (!Target)
+	{
+		Target = Cast<ATacticsCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+	}
+
+	UpdatePerception();
+	UpdatePath();
+	AssignOrders();
+}
+
+void AEnemySquad::PruneMembers()
+{
+	Members.RemoveAll([](const AEnemyCharacter* Member)
+	{
+		return !IsValid(Member) || Member->IsDead();
+	});
+}
+
+void AEnemySquad::UpdatePerception()
+{
+	const bool bWasEngaged = bEngaged;
+
+	if (!Target || Target->IsDead())
+	{
+		bEngaged = false;
+		PathPoints.Reset();
+		return;
+	}
+
+	const FVector TargetLocation = Target->GetActorLocation();
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// The member closest to the target is the squad's only spotter
+	AEnemyCharacter* Spotter = nullptr;
+	float SpotterDistSquared = FLT_MAX;
+
+	for (AEnemyCharacter* Member : Members)
+	{
+		const float DistSquared = FVector::DistSquared(Member->GetActorLocation(), TargetLocation);
+		if (DistSquared < SpotterDistSquared)
+		{
+			Spotter = Member;
+			SpotterDistSquared = DistSquared;
+		}
+	}
+
+	bool bSeen = Spotter && SpotterDistSquared <= FMath::Square(DetectionRange);
+
+	if (bSeen && bRequireLineOfSight)
+	{
+		if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+		{
+			bSeen = Perception->HasLineOfSight(Spotter, Target);
+		}
+	}
+
+	if (bSeen)
+	{
+		LastSeenTime = Now;
+	}
+
+	// Keep engaging a target that just ducked out of sight
+	bEngaged = LastSeenTime >= 0.0 && Now - LastSeenTime <= SightMemoryTime;
+
+	if (bEngaged && !bWasEngaged)
+	{
+		// Path right away when first spotting the target
+		NextPathQueryTime = 0.0;
+
+		UE_LOG(LogTactics, Log, TEXT("%s engaging %s with %d members"), *GetName(), *Target->GetName(), Members.Num());
+	}
+	else if (!bEngaged)
+	{
+		PathPoints.Reset();
+	}
+}
+
+void AEnemySquad::UpdatePath()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	if (!bEngaged || Now < NextPathQueryTime)
+	{
+		return;
+	}
+
+	NextPathQueryTime = Now + PathQueryInterval;
+
+	AEnemyCharacter* Anchor = FindAnchorMember();
+	if (!Anchor)
+	{
+		return;
+	}
+
+	// A single path query for the whole squad
+	UNavigationPath* Path = UNavigationSystemV1::FindPathToLocationSynchronously(GetWorld(), Anchor->GetActorLocation(), Target->GetActorLocation(), Anchor);
+
+	if (Path && Path->IsValid())
+	{
+		PathPoints = Path->PathPoints;
+	}
+	else
+	{
+		PathPoints.Reset();
+	}
+}
+
+void AEnemySquad::AssignOrders()
+{
+	if (!bEngaged)
+	{
+		for (AEnemyCharacter* Member : Members)
+		{
+			Member->SetSquadOrder(FEnemySquadOrder());
+		}
+
+		return;
+	}
+
+	const FVector TargetLocation = Target->GetActorLocation();
+
+	// Closest members get the attack slots
+	TArray<AEnemyCharacter*, TInlineAllocator<32>> SortedMembers(Members);
+	SortedMembers.Sort([&TargetLocation](const AEnemyCharacter& A, const AEnemyCharacter& B)
+	{
+		return FVector::DistSquared(A.GetActorLocation(), TargetLocation) < FVector::DistSquared(B.GetActorLocation(), TargetLocation);
+	});
+
+	FVector Centroid = FVector::ZeroVector;
+	for (const AEnemyCharacter* Member : SortedMembers)
+	{
+		Centroid += Member->GetActorLocation();
+	}
+	Centroid /= SortedMembers.Num();
+
+	// Slots are laid out facing the squad so members don't cross the target to reach them
+	FVector BaseDirection = (Centroid - TargetLocation).GetSafeNormal2D();
+	if (BaseDirection.IsNearlyZero())
+	{
+		BaseDirection = FVector::ForwardVector;
+	}
+
+	const int32 NumAttackers = FMath::Min(MaxAttackers, SortedMembers.Num());
+	const int32 NumFlankers = FMath::Min(MaxFlankers, SortedMembers.Num() - NumAttackers);
+	const int32 NumSupport = SortedMembers.Num() - NumAttackers - NumFlankers;
+
+	// Far away with obstacles in between, travel along the shared path in a wedge
+	const bool bTravel = PathPoints.Num() > 2 && FVector::Dist2D(Centroid, TargetLocation) > SupportDistance;
+
+	FVector TravelPoint = FVector::ZeroVector;
+	FVector TravelForward = FVector::ForwardVector;
+
+	if (bTravel)
+	{
+		const FVector AnchorLocation = SortedMembers[0]->GetActorLocation();
+
+		// The path is only refreshed now and then, so skip the points the anchor already passed
+		int32 ClosestIndex = 0;
+		float ClosestDistSquared = MAX_flt;
+
+		for (int32 Index = 0; Index < PathPoints.Num(); ++Index)
+		{
+			const float DistSquared = FVector::DistSquared2D(AnchorLocation, PathPoints[Index]);
+			if (DistSquared < ClosestDistSquared)
+			{
+				ClosestIndex = Index;
+				ClosestDistSquared = DistSquared;
+			}
+		}
+
+		// Head for the first point past the closest one that's far enough away to lead the wedge
+		TravelPoint = PathPoints.Last();
+		for (int32 Index = ClosestIndex + 1; Index < PathPoints.Num(); ++Index)
+		{
+			if (FVector::Dist2D(AnchorLocation, PathPoints[Index]) > FormationSpacing)
+			{
+				TravelPoint = PathPoints[Index];
+				break;
+			}
+		}
+
+		TravelForward = (TravelPoint - AnchorLocation).GetSafeNormal2D();
+		if (TravelForward.IsNearlyZero())
+		{
+			TravelForward = -BaseDirection;
+		}
+	}
+
+	const FVector TravelRight(-TravelForward.Y, TravelForward.X, 0.0f);
+
+	for (int32 Index = 0; Index < SortedMembers.Num(); ++Index)
+	{
+		AEnemyCharacter* Member = SortedMembers[Index];
+
+		FEnemySquadOrder Order;
+		Order.bEngage = true;
+		Order.Target = Target;
+		Order.bHasMoveTarget = true;
+
+		if (Index < NumAttackers)
+		{
+			Order.Role = EEnemySquadRole::Attacker;
+		}
+		else if (Index < NumAttackers + NumFlankers)
+		{
+			Order.Role = EEnemySquadRole::Flanker;
+		}
+		else
+		{
+			Order.Role = EEnemySquadRole::Support;
+		}
+
+		if (bTravel)
+		{
+			// Wedge behind the lead member, anyone who gets in range may attack
+			const int32 Row = (Index + 1) / 2;
+			const float Side = (Index % 2 == 1) ? -1.0f : 1.0f;
+
+			Order.MoveTarget = TravelPoint - TravelForward * Row * FormationSpacing + TravelRight * Side * Row * FormationSpacing;
+			Order.bAllowAttack = true;
+		}
+		else
+		{
+			const float SlotRadius = Member->GetAttackRange() * 0.8f;
+			float SlotAngle = 0.0f;
+			float Radius = SlotRadius;
+
+			switch (Order.Role)
+			{
+			case EEnemySquadRole::Attacker:
+				// Spread the attackers around the side facing the squad
+				SlotAngle = (Index - (NumAttackers - 1) * 0.5f) * AttackSlotSpacing;
+				Order.bAllowAttack = true;
+				break;
+
+			case EEnemySquadRole::Flanker:
+			{
+				// Alternate sides, moving further around the target for each pair
+				const int32 FlankIndex = Index - NumAttackers;
+				const float Side = (FlankIndex % 2 == 1) ? -1.0f : 1.0f;
+				SlotAngle = Side * (90.0f + AttackSlotSpacing * (FlankIndex / 2));
+				Order.bAllowAttack = true;
+				break;
+			}
+
+			case EEnemySquadRole::Support:
+			{
+				// Hold back and only attack if we can reach from there
+				const int32 SupportIndex = Index - NumAttackers - NumFlankers;
+				SlotAngle = (SupportIndex - (NumSupport - 1) * 0.5f) * AttackSlotSpacing * 0.5f;
+				Radius = FMath::Max(SupportDistance, SlotRadius);
+				Order.bAllowAttack = Member->GetAttackRange() >= Radius;
+				break;
+			}
+			}
+
+			Order.MoveTarget = TargetLocation + BaseDirection.RotateAngleAxis(SlotAngle, FVector::UpVector) * Radius;
+		}
+
+		Member->SetSquadOrder(Order);
+	}
+}
+
+AEnemyCharacter* AEnemySquad::FindAnchorMember() const
+{
+	FVector Centroid = FVector::ZeroVector;
+	for (const AEnemyCharacter* Member : Members)
+	{
+		Centroid += Member->GetActorLocation();
+	}
+	Centroid /= FMath::Max(Members.Num(), 1);
+
+	AEnemyCharacter* Anchor = nullptr;
+	float AnchorDistSquared = FLT_MAX;
+
+	for (AEnemyCharacter* Member : Members)
+	{
+		const float DistSquared = FVector::DistSquared(Member->GetActorLocation(), Centroid);
+		if (DistSquared < AnchorDistSquared)
+		{
+			Anchor = Member;
+			AnchorDistSquared = DistSquared;
+		}
+	}
+
+	return Anchor;
+}
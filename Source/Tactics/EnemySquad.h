@@ -0,0 +1,119 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "EnemyCharacter.h"
+#include "EnemySquad.generated.h"
+
+/**
+ * Enemy Squad - Makes perception, targeting and pathing decisions for a group of enemies.
+ * Decisions run at a lower rate than member steering: one sight check and one path query per squad,
+ * instead of one per member. Members receive formation slots and roles and just execute them.
+ */
+UCLASS(Blueprintable, BlueprintType)
+class TACTICS_API AEnemySquad : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AEnemySquad();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** Add an enemy to the squad */
+	UFUNCTION(BlueprintCallable, Category = "Squad")
+	void AddMember(AEnemyCharacter* Member);
+
+	/** Remove an enemy from the squad, returning it to its own AI */
+	UFUNCTION(BlueprintCallable, Category = "Squad")
+	void RemoveMember(AEnemyCharacter* Member);
+
+	/** Get the squad members */
+	UFUNCTION(BlueprintPure, Category = "Squad")
+	const TArray<AEnemyCharacter*>& GetMembers() const { return Members; }
+
+	/** Check if the squad is engaging its target */
+	UFUNCTION(BlueprintPure, Category = "Squad")
+	bool IsEngaged() const { return bEngaged; }
+
+protected:
+	/** Enemies in this squad */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Squad")
+	TArray<AEnemyCharacter*> Members;
+
+	/** Time between squad decisions. Members keep steering every frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Squad", meta = (ClampMin = 0, Units = "s"))
+	float DecisionInterval = 0.25f;
+
+	/** Time between path queries while engaged */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Squad", meta = (ClampMin = 0, Units = "s"))
+	float PathQueryInterval = 1.0f;
+
+	/** How far the squad can see the player */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Squad")
+	float DetectionRange = 1000.0f;
+
+	/** If true, the squad's spotter must also have line of sight to the player */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Squad")
+	bool bRequireLineOfSight = true;
+
+	/** Time the squad keeps engaging after losing sight of the player */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Squad", meta = (ClampMin = 0, Units = "s"))
+	float SightMemoryTime = 2.0f;
+
+	/** Maximum number of members attacking from the front at once */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Squad", meta = (ClampMin = 0))
+	int32 MaxAttackers = 3;
+
+	/** Maximum number of members flanking at once */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Squad", meta = (ClampMin = 0))
+	int32 MaxFlankers = 2;
+
+	/** Angle between neighboring attack slots around the target */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Squad", meta = (ClampMin = 0, ClampMax = 180, Units = "deg"))
+	float AttackSlotSpacing = 35.0f;
+
+	/** Distance from the target support members hold at */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Squad")
+	float SupportDistance = 700.0f;
+
+	/** Spacing between members in the travel formation */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Squad")
+	float FormationSpacing = 150.0f;
+
+	/** Cached reference to the player character */
+	UPROPERTY()
+	ATacticsCharacter* Target;
+
+	/** True while the squad is engaging the target */
+	bool bEngaged = false;
+
+	/** Last time any member had sight of the target */
+	double LastSeenTime = -1.0;
+
+	/** Time of the next path query */
+	double NextPathQueryTime = 0.0;
+
+	/** Shared path from the squad to the target */
+	TArray<FVector> PathPoints;
+
+private:
+	/** Drop dead or destroyed members */
+	void PruneMembers();
+
+	/** Decide if the squad can see the target, using a single spotter */
+	void UpdatePerception();
+
+	/** Refresh the shared path to the target */
+	void UpdatePath();
+
+	/** Hand out roles and formation slots */
+	void AssignOrders();
+
+	/** Member closest to the squad's center, used as the path start */
+	AEnemyCharacter* FindAnchorMember() const;
+};
@@ -0,0 +1,433 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InputLatencySubsystem.h"
+#include "Tactics.h"
+#include "InputAction.h"
+#include "EnhancedInputSubsystems.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Animation/AnimInstance.h"
+#include "Animation/AnimMontage.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/AutomationTest.h"
+#include "TacticsAutomation.h"
+
+static TAutoConsoleVariable<float> CVarInputLatencyBudgetMs(
+	TEXT("Tactics.InputLatency.BudgetMs"),
+	100.0f,
+	TEXT("Input to motion latency budget, in milliseconds. The Tactics.InputLatency.Budget test fails if any action's p99 exceeds it."));
+
+static TAutoConsoleVariable<float> CVarInputLatencyTimeout(
+	TEXT("Tactics.InputLatency.Timeout"),
+	0.5f,
+	TEXT("Seconds to wait for the pawn to respond to an input before counting it as unanswered."));
+
+/** Frames a synthetic press is held, and the length of a full press cycle */
+static constexpr int32 InjectionHoldFrames = 3;
+static constexpr int32 InjectionCycleFrames = 40;
+
+/** Minimum change in velocity that counts as a response */
+static constexpr float VelocityResponseThreshold = 1.0f;
+
+/** Current time for latency measurements. Input is sampled at the start of the frame, so use the frame start when it is real time */
+static double GetInputLatencyTime()
+{
+	return FApp::UseFixedTimeStep() ? FPlatformTime::Seconds() : FApp::GetCurrentTime();
+}
+
+void UInputLatencySubsystem::MarkInput(const UInputAction* Action, APawn* Pawn)
+{
+	if (!Action || !Pawn)
+	{
+		return;
+	}
+
+	const FName ActionName = Action->GetFName();
+
+	// Held inputs trigger every frame, only the first frame of a press is a new sample
+	uint64& LastFrame = LastInputFrames.FindOrAdd(ActionName);
+	const bool bHeld = LastFrame + 1 >= GFrameCounter && LastFrame != 0;
+	LastFrame = GFrameCounter;
+
+	if (bHeld || PendingInputs.Contains(ActionName))
+	{
+		return;
+	}
+
+	FPendingInput& Pending = PendingInputs.Add(ActionName);
+	Pending.Pawn = Pawn;
+	Pending.StartVelocity = Pawn->GetVelocity();
+	Pending.StartMontage = GetPawnMontage(Pawn);
+
+	// Synthetic input is timed from when it was injected
+	double InjectionTime = 0.0;
+	Pending.StartTime = InjectionTimes.RemoveAndCopyValue(ActionName, InjectionTime) ? InjectionTime : GetInputLatencyTime();
+}
+
+void UInputLatencySubsystem::RegisterInjectableAction(APlayerController* PlayerController, const UInputAction* Action, const FInputActionValue& Value)
+{
+	if (!PlayerController || !Action || !PlayerController->IsLocalPlayerController())
+	{
+		return;
+	}
+
+	// Re-registering replaces the previous entry
+	InjectableActions.RemoveAll([Action](const FInjectableAction& Entry)
+	{
+		return !Entry.PlayerController.IsValid() || Entry.Action.Get() == Action;
+	});
+
+	FInjectableAction& Entry = InjectableActions.AddDefaulted_GetRef();
+	Entry.PlayerController = PlayerController;
+	Entry.Action = Action;
+	Entry.Value = Value;
+}
+
+void UInputLatencySubsystem::StartCheck(int32 NumPresses)
+{
+	ResetStats();
+
+	InjectionPressesLeft = FMath::Max(NumPresses, 1);
+	InjectionFrame = 0;
+	InjectionSign = 1.0f;
+
+	UE_LOG(LogTactics, Display, TEXT("Input latency check started: %d presses on %d actions"), InjectionPressesLeft, InjectableActions.Num());
+}
+
+bool UInputLatencySubsystem::CheckBudget() const
+{
+	const float BudgetMs = CVarInputLatencyBudgetMs.GetValueOnGameThread();
+	bool bPassed = Stats.Num() > 0;
+
+	for (const TPair<FName, FTimingStats>& Pair : Stats)
+	{
+		const float P99 = Pair.Value.GetPercentile(99.0f);
+		if (Pair.Value.Count == 0 || P99 > BudgetMs)
+		{
+			UE_LOG(LogTactics, Error, TEXT("Input latency over budget for %s: p99 %.1f ms, budget %.1f ms, %d samples"), *Pair.Key.ToString(), P99, BudgetMs, Pair.Value.Count);
+			bPassed = false;
+		}
+	}
+
+	return bPassed;
+}
+
+void UInputLatencySubsystem::DumpStats() const
+{
+	UE_LOG(LogTactics, Display, TEXT("=== INPUT LATENCY ==="));
+
+	for (const TPair<FName, FTimingStats>& Pair : Stats)
+	{
+		const FTimingStats& Action = Pair.Value;
+		UE_LOG(LogTactics, Display, TEXT("%s: %d samples, mean %.1f ms, p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms, %d unanswered"),
+			*Pair.Key.ToString(), Action.Count, Action.GetMean(), Action.GetPercentile(50.0f), Action.GetPercentile(95.0f), Action.GetPercentile(99.0f), Action.MaxMs, Action.NoResponseCount);
+	}
+}
+
+void UInputLatencySubsystem::ResetStats()
+{
+	Stats.Reset();
+	PendingInputs.Reset();
+	InjectionTimes.Reset();
+}
+
+FString UInputLatencySubsystem::ExportStats(bool bAsJson) const
+{
+	const FString FileName = FPaths::ProjectSavedDir() / TEXT("Profiling") / FString::Printf(TEXT("InputLatency-%s.%s"), *FDateTime::Now().ToString(), bAsJson ? TEXT("json") : TEXT("csv"));
+	const float BudgetMs = CVarInputLatencyBudgetMs.GetValueOnGameThread();
+
+	FString Output;
+
+	if (bAsJson)
+	{
+		Output += FString::Printf(TEXT("{\n\t\"budgetMs\": %.3f,\n\t\"bucketWidthMs\": %.3f,\n\t\"actions\": [\n"), BudgetMs, FTimingStats::BucketWidthMs);
+
+		int32 Index = 0;
+		for (const TPair<FName, FTimingStats>& Pair : Stats)
+		{
+			const FTimingStats& Action = Pair.Value;
+
+			FString Buckets;
+			for (int32 Bucket = 0; Bucket < Action.Buckets.Num(); ++Bucket)
+			{
+				Buckets += FString::Printf(Bucket > 0 ? TEXT(", %d") : TEXT("%d"), Action.Buckets[Bucket]);
+			}
+
+			Output += FString::Printf(TEXT("\t\t{ \"action\": \"%s\", \"count\": %d, \"unanswered\": %d, \"meanMs\": %.3f, \"p50Ms\": %.3f, \"p95Ms\": %.3f, \"p99Ms\": %.3f, \"maxMs\": %.3f, \"histogram\": [%s] }%s\n"),
+				*Pair.Key.ToString(), Action.Count, Action.NoResponseCount, Action.GetMean(), Action.GetPercentile(50.0f), Action.GetPercentile(95.0f), Action.GetPercentile(99.0f), Action.MaxMs, *Buckets,
+				++Index < Stats.Num() ? TEXT(",") : TEXT(""));
+		}
+
+		Output += TEXT("\t]\n}\n");
+	}
+	else
+	{
+		Output += TEXT("Action,Count,Unanswered,MeanMs,P50Ms,P95Ms,P99Ms,MaxMs,BudgetMs\n");
+
+		for (const TPair<FName, FTimingStats>& Pair : Stats)
+		{
+			const FTimingStats& Action = Pair.Value;
+			Output += FString::Printf(TEXT("%s,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n"),
+				*Pair.Key.ToString(), Action.Count, Action.NoResponseCount, Action.GetMean(), Action.GetPercentile(50.0f), Action.GetPercentile(95.0f), Action.GetPercentile(99.0f), Action.MaxMs, BudgetMs);
+		}
+	}
+
+	if (!FFileHelper::SaveStringToFile(Output, *FileName))
+	{
+		UE_LOG(LogTactics, Error, TEXT("Failed to write input latency results to %s"), *FileName);
+		return FString();
+	}
+
+	UE_LOG(LogTactics, Display, TEXT("Input latency results written to %s"), *FileName);
+	return FileName;
+}
+
+void UInputLatencySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Tickables run after the actors, so responses to this frame's input are already visible
+	const double Now = GetInputLatencyTime();
+	const double Timeout = FMath::Max(CVarInputLatencyTimeout.GetValueOnGameThread(), 0.0f);
+
+	for (auto It = PendingInputs.CreateIterator(); It; ++It)
+	{
+		const FPendingInput& Pending = It.Value();
+		const APawn* Pawn = Pending.Pawn.Get();
+
+		if (!Pawn)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		const bool bVelocityChanged = !Pawn->GetVelocity().Equals(Pending.StartVelocity, VelocityResponseThreshold);
+
+		const UAnimMontage* Montage = GetPawnMontage(Pawn);
+		const bool bMontageStarted = Montage && Montage != Pending.StartMontage.Get();
+
+		if (bVelocityChanged || bMontageStarted)
+		{
+			Stats.FindOrAdd(It.Key()).AddSample(static_cast<float>((Now - Pending.StartTime) * 1000.0));
+			It.RemoveCurrent();
+		}
+		else if (Now - Pending.StartTime > Timeout)
+		{
+			++Stats.FindOrAdd(It.Key()).NoResponseCount;
+			It.RemoveCurrent();
+		}
+	}
+
+	UpdateInjection();
+}
+
+TStatId UInputLatencySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UInputLatencySubsystem, STATGROUP_Tickables);
+}
+
+void UInputLatencySubsystem::Deinitialize()
+{
+	Stats.Empty();
+	PendingInputs.Empty();
+	LastInputFrames.Empty();
+	InjectionTimes.Empty();
+	InjectableActions.Empty();
+
+	Super::Deinitialize();
+}
+
+UAnimMontage* UInputLatencySubsystem::GetPawnMontage(const APawn* Pawn)
+{
+	const ACharacter* Character = Cast<ACharacter>(Pawn);
+	if (!Character || !Character->GetMesh())
+	{
+		return nullptr;
+	}
+
+	const UAnimInstance* AnimInstance = Character->GetMesh()->GetAnimInstance();
+	return AnimInstance ? AnimInstance->GetCurrentActiveMontage() : nullptr;
+}
+
+void UInputLatencySubsystem::UpdateInjection()
+{
+	if (InjectionPressesLeft <= 0)
+	{
+		return;
+	}
+
+	// Hold each press for a few frames, then let the pawn settle before the next one
+	if (InjectionFrame < InjectionHoldFrames)
+	{
+		for (const FInjectableAction& Entry : InjectableActions)
+		{
+			APlayerController* PlayerController = Entry.PlayerController.Get();
+			const UInputAction* Action = Entry.Action.Get();
+
+			if (!PlayerController || !Action)
+			{
+				continue;
+			}
+
+			if (UEnhancedInputLocalPlayerSubsystem* InputSubsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()))
+			{
+				if (InjectionFrame == 0)
+				{
+					InjectionTimes.Add(Action->GetFName(), GetInputLatencyTime());
+				}
+
+				// Flip the direction every press so movement always has to change
+				InputSubsystem->InjectInputForAction(Action, FInputActionValue(Entry.Value.GetValueType(), Entry.Value.Get<FVector>() * InjectionSign));
+			}
+		}
+	}
+
+	if (++InjectionFrame < InjectionCycleFrames)
+	{
+		return;
+	}
+
+	InjectionFrame = 0;
+	InjectionSign = -InjectionSign;
+
+	if (--InjectionPressesLeft > 0)
+	{
+		return;
+	}
+
+	UE_LOG(LogTactics, Display, TEXT("Input latency check finished"));
+}
+
+static FAutoConsoleCommandWithWorldAndArgs InputLatencyDumpCommand(
+	TEXT("Tactics.InputLatency.Dump"),
+	TEXT("Logs the input latency results of every action."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UInputLatencySubsystem* Latency = World ? World->GetSubsystem<UInputLatencySubsystem>() : nullptr)
+		{
+			Latency->DumpStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs InputLatencyResetCommand(
+	TEXT("Tactics.InputLatency.Reset"),
+	TEXT("Clears the input latency results."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UInputLatencySubsystem* Latency = World ? World->GetSubsystem<UInputLatencySubsystem>() : nullptr)
+		{
+			Latency->ResetStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs InputLatencyExportCommand(
+	TEXT("Tactics.InputLatency.Export"),
+	TEXT("Writes the input latency results to Saved/Profiling. Usage: Tactics.InputLatency.Export [json|csv]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UInputLatencySubsystem* Latency = World ? World->GetSubsystem<UInputLatencySubsystem>() : nullptr)
+		{
+			Latency->ExportStats(Args.Num() == 0 || !Args[0].Equals(TEXT("csv"), ESearchCase::IgnoreCase));
+		}
+	}));
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/** Synthetic presses injected into each action by the budget test */
+static constexpr int32 InputLatencyTestPresses = 20;
+
+/** Seconds the budget test waits for a game world with registered actions, and for the whole check */
+static constexpr double InputLatencyTestStartTimeout = 30.0;
+static constexpr double InputLatencyTestTimeout = 120.0;
+
+/**
+ * Starts the input latency check once a game world has registered its actions, waits for it to finish
+ * and checks the results against the budget
+ */
+class FInputLatencyCheckCommand : public IAutomationLatentCommand
+{
+public:
+	explicit FInputLatencyCheckCommand(FAutomationTestBase* InTest)
+		: Test(InTest)
+	{
+	}
+
+	virtual bool Update() override
+	{
+		UWorld* World = TacticsAutomation::FindGameWorld();
+		UInputLatencySubsystem* Latency = World ? World->GetSubsystem<UInputLatencySubsystem>() : nullptr;
+
+		if (!bStarted)
+		{
+			// Wait for the player to be set up and register the actions
+			if (!Latency || !Latency->HasInjectableActions())
+			{
+				if (GetCurrentRunTime() > InputLatencyTestStartTimeout)
+				{
+					Test->AddError(TEXT("No game world registered any input actions. Run the test in -game or PIE on a map with a player."));
+					return true;
+				}
+
+				return false;
+			}
+
+			Latency->StartCheck(InputLatencyTestPresses);
+			CheckedSubsystem = Latency;
+			bStarted = true;
+			return false;
+		}
+
+		if (!Latency || Latency != CheckedSubsystem.Get())
+		{
+			Test->AddError(TEXT("The game world went away during the input latency check"));
+			return true;
+		}
+
+		if (Latency->IsCheckRunning())
+		{
+			if (GetCurrentRunTime() > InputLatencyTestTimeout)
+			{
+				Test->AddError(TEXT("The input latency check timed out"));
+				return true;
+			}
+
+			return false;
+		}
+
+		Latency->DumpStats();
+		Latency->ExportStats(true);
+
+		Test->TestTrue(TEXT("Every action's p99 input latency is within Tactics.InputLatency.BudgetMs"), Latency->CheckBudget());
+		return true;
+	}
+
+private:
+	/** Test to report to */
+	FAutomationTestBase* Test;
+
+	/** Subsystem running the check */
+	TWeakObjectPtr<UInputLatencySubsystem> CheckedSubsystem;
+
+	/** True once the synthetic presses started */
+	bool bStarted = false;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInputLatencyBudgetTest, "Tactics.InputLatency.Budget", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInputLatencyBudgetTest::RunTest(const FString& Parameters)
+{
+	TacticsAutomation::OpenDefaultMapIfNeeded();
+
+	ADD_LATENT_AUTOMATION_COMMAND(FInputLatencyCheckCommand(this));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
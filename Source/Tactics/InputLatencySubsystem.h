@@ -0,0 +1,110 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "InputActionValue.h"
+#include "TimingStats.h"
+#include "InputLatencySubsystem.generated.h"
+
+class APawn;
+class APlayerController;
+class UAnimMontage;
+class UInputAction;
+
+/**
+ * Input Latency Subsystem - Measures the time from an input event to the first frame where the
+ * controlled pawn responds, either with a change of velocity or a new montage.
+ * Input handlers report their actions with MarkInput. Results are kept per action and can be
+ * exported as JSON or CSV. The Tactics.InputLatency.Budget automation test injects synthetic input and
+ * checks the results against the latency budget, so it can run in headless builds.
+ */
+UCLASS()
+class TACTICS_API UInputLatencySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Report an input event for an action driving a pawn. Held inputs only start a sample on the first frame */
+	void MarkInput(const UInputAction* Action, APawn* Pawn);
+
+	/** Register an action that synthetic input can be injected into, with the value to inject */
+	void RegisterInjectableAction(APlayerController* PlayerController, const UInputAction* Action, const FInputActionValue& Value);
+
+	/** Start injecting synthetic presses for every registered action */
+	void StartCheck(int32 NumPresses);
+
+	/** Check if synthetic presses are still being injected */
+	bool IsCheckRunning() const { return InjectionPressesLeft > 0; }
+
+	/** Check if any action was registered for synthetic input */
+	bool HasInjectableActions() const { return InjectableActions.Num() > 0; }
+
+	/** Check every action's results against the latency budget. Returns false if any action exceeds it */
+	bool CheckBudget() const;
+
+	/** Log the results of every action */
+	void DumpStats() const;
+
+	/** Clear all results */
+	void ResetStats();
+
+	/** Write the results to the saved profiling directory. Returns the file name, or an empty string on failure */
+	FString ExportStats(bool bAsJson) const;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+private:
+	/** Input waiting for the pawn to respond */
+	struct FPendingInput
+	{
+		TWeakObjectPtr<APawn> Pawn;
+		double StartTime = 0.0;
+		FVector StartVelocity = FVector::ZeroVector;
+		TWeakObjectPtr<UAnimMontage> StartMontage;
+	};
+
+	/** Action synthetic input can be injected into */
+	struct FInjectableAction
+	{
+		TWeakObjectPtr<APlayerController> PlayerController;
+		TWeakObjectPtr<const UInputAction> Action;
+		FInputActionValue Value;
+	};
+
+	/** Get the current montage of a pawn, if it has one */
+	static UAnimMontage* GetPawnMontage(const APawn* Pawn);
+
+	/** Inject the synthetic presses for this frame */
+	void UpdateInjection();
+
+	/** Results, by action name */
+	TMap<FName, FTimingStats> Stats;
+
+	/** Inputs waiting for a response, by action name */
+	TMap<FName, FPendingInput> PendingInputs;
+
+	/** Last frame each action was reported on, to detect held inputs */
+	TMap<FName, uint64> LastInputFrames;
+
+	/** Time synthetic presses were injected, by action name. Used as the start time of the next sample */
+	TMap<FName, double> InjectionTimes;
+
+	/** Actions synthetic input can be injected into */
+	TArray<FInjectableAction> InjectableActions;
+
+	/** Synthetic presses left to inject */
+	int32 InjectionPressesLeft = 0;
+
+	/** Frames into the current synthetic press cycle */
+	int32 InjectionFrame = 0;
+
+	/** Sign of the value injected by the current press, flipped each press so movement changes direction */
+	float InjectionSign = 1.0f;
+};
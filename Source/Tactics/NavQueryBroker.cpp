@@ -0,0 +1,334 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "NavQueryBroker.h"
+#include "Tactics.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "AI/Navigation/NavAgentInterface.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarNavBrokerMaxPathsPerFrame(
+	TEXT("Tactics.NavBroker.MaxPathsPerFrame"),
+	8,
+	TEXT("Max number of async path queries the navigation query broker starts each frame."));
+
+static TAutoConsoleVariable<int32> CVarNavBrokerMaxRunningPaths(
+	TEXT("Tactics.NavBroker.MaxRunningPaths"),
+	32,
+	TEXT("Max number of async path queries the navigation query broker keeps running at once."));
+
+static TAutoConsoleVariable<float> CVarNavBrokerBudgetMs(
+	TEXT("Tactics.NavBroker.BudgetMs"),
+	1.0f,
+	TEXT("Game thread time the navigation query broker can spend each frame, in milliseconds."));
+
+/** Display names of the query types, for the stats */
+static const TCHAR* NavQueryTypeNames[] = { TEXT("Path"), TEXT("Projection"), TEXT("RandomPoint"), TEXT("RandomReachablePoint") };
+static_assert(UE_ARRAY_COUNT(NavQueryTypeNames) == static_cast<int32>(ENavQueryType::Num), "Missing navigation query type names");
+
+uint32 UNavQueryBroker::RequestPath(const FVector& Start, const FVector& End, const AActor* Querier, TSubclassOf<UNavigationQueryFilter> FilterClass, ENavQueryPriority Priority, FNavQueryPathDelegate Callback)
+{
+	FNavQueryRequest Request;
+	Request.Type = ENavQueryType::Path;
+	Request.Priority = Priority;
+	Request.Start = Start;
+	Request.End = End;
+	Request.Querier = Querier;
+	Request.FilterClass = FilterClass;
+	Request.PathCallback = MoveTemp(Callback);
+
+	return Enqueue(MoveTemp(Request));
+}
+
+uint32 UNavQueryBroker::RequestProjection(const FVector& Point, const FVector& Extent, ENavQueryPriority Priority, FNavQueryPointDelegate Callback)
+{
+	FNavQueryRequest Request;
+	Request.Type = ENavQueryType::Projection;
+	Request.Priority = Priority;
+	Request.Start = Point;
+	Request.End = Extent;
+	Request.PointCallback = MoveTemp(Callback);
+
+	return Enqueue(MoveTemp(Request));
+}
+
+uint32 UNavQueryBroker::RequestRandomPoint(const FVector& Origin, float Radius, bool bReachable, const ANavigationData* NavData, ENavQueryPriority Priority, FNavQueryPointDelegate Callback)
+{
+	FNavQueryRequest Request;
+	Request.Type = bReachable ? ENavQueryType::RandomReachablePoint : ENavQueryType::RandomPoint;
+	Request.Priority = Priority;
+	Request.Start = Origin;
+	Request.Radius = Radius;
+	Request.NavData = NavData;
+	Request.PointCallback = MoveTemp(Callback);
+
+	return Enqueue(MoveTemp(Request));
+}
+
+void UNavQueryBroker::CancelQuery(uint32 QueryId)
+{
+	if (QueryId == INVALID_NAVQUERYID)
+	{
+		return;
+	}
+
+	// Still queued?
+	const int32 Removed = Queue.RemoveAll([QueryId](const FNavQueryRequest& Request)
+	{
+		return Request.Id == QueryId;
+	});
+
+	if (Removed > 0)
+	{
+		Queue.Heapify(FNavQueryOrder());
+		return;
+	}
+
+	// Already running
+	for (auto It = RunningPaths.CreateIterator(); It; ++It)
+	{
+		if (It.Value().Id == QueryId)
+		{
+			if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+			{
+				NavSys->AbortAsyncFindPathRequest(It.Key());
+			}
+
+			It.RemoveCurrent();
+			return;
+		}
+	}
+}
+
+void UNavQueryBroker::DumpStats() const
+{
+	UE_LOG(LogTactics, Display, TEXT("=== NAV QUERY BROKER ==="));
+	UE_LOG(LogTactics, Display, TEXT("Queue depth: %d now, %.1f average, %d peak. %d running paths. Budget exceeded on %d frames"),
+		Queue.Num(), QueueDepthFrames > 0 ? double(QueueDepthSum) / QueueDepthFrames : 0.0, PeakQueueDepth, RunningPaths.Num(), BudgetExceededFrames);
+
+	for (int32 Type = 0; Type < static_cast<int32>(ENavQueryType::Num); ++Type)
+	{
+		const FTimingStats& Stats = LatencyStats[Type];
+		UE_LOG(LogTactics, Display, TEXT("%s: %d queries, mean %.1f ms, p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms"),
+			NavQueryTypeNames[Type], Stats.Count, Stats.GetMean(), Stats.GetPercentile(50.0f), Stats.GetPercentile(95.0f), Stats.GetPercentile(99.0f), Stats.MaxMs);
+	}
+}
+
+void UNavQueryBroker::ResetStats()
+{
+	for (FTimingStats& Stats : LatencyStats)
+	{
+		Stats = FTimingStats();
+	}
+
+	PeakQueueDepth = 0;
+	QueueDepthSum = 0;
+	QueueDepthFrames = 0;
+	BudgetExceededFrames = 0;
+}
+
+void UNavQueryBroker::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_NavQueryBroker_Tick);
+
+	QueueDepthSum += Queue.Num();
+	++QueueDepthFrames;
+
+	if (Queue.Num() == 0)
+	{
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double Budget = CVarNavBrokerBudgetMs.GetValueOnGameThread() / 1000.0;
+	const int32 MaxPathsPerFrame = CVarNavBrokerMaxPathsPerFrame.GetValueOnGameThread();
+	const int32 MaxRunningPaths = CVarNavBrokerMaxRunningPaths.GetValueOnGameThread();
+
+	int32 PathsStarted = 0;
+
+	// Serve queries in priority order until we run out of budget. Always serve at least one so the queue can't stall
+	while (Queue.Num() > 0)
+	{
+		const FNavQueryRequest& Top = Queue.HeapTop();
+
+		if (Top.Type == ENavQueryType::Path && (PathsStarted >= MaxPathsPerFrame || RunningPaths.Num() >= MaxRunningPaths))
+		{
+			break;
+		}
+
+		FNavQueryRequest Request;
+		Queue.HeapPop(Request, FNavQueryOrder(), EAllowShrinking::No);
+
+		if (Request.Type == ENavQueryType::Path)
+		{
+			if (DispatchPath(MoveTemp(Request)))
+			{
+				++PathsStarted;
+			}
+		}
+		else
+		{
+			RunPointQuery(Request);
+		}
+
+		if (FPlatformTime::Seconds() - StartTime > Budget)
+		{
+			break;
+		}
+	}
+
+	if (Queue.Num() > 0)
+	{
+		++BudgetExceededFrames;
+	}
+}
+
+TStatId UNavQueryBroker::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UNavQueryBroker, STATGROUP_Tickables);
+}
+
+void UNavQueryBroker::Deinitialize()
+{
+	// Abort anything still running so the navigation system doesn't call back into us
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		for (const TPair<uint32, FNavQueryRequest>& Pair : RunningPaths)
+		{
+			NavSys->AbortAsyncFindPathRequest(Pair.Key);
+		}
+	}
+
+	RunningPaths.Empty();
+	Queue.Empty();
+
+	Super::Deinitialize();
+}
+
+uint32 UNavQueryBroker::Enqueue(FNavQueryRequest&& Request)
+{
+	Request.Id = NextQueryId++;
+
+	// Skip the invalid id when wrapping around
+	if (NextQueryId == INVALID_NAVQUERYID)
+	{
+		++NextQueryId;
+	}
+
+	Request.RequestTime = FPlatformTime::Seconds();
+
+	const uint32 QueryId = Request.Id;
+	Queue.HeapPush(MoveTemp(Request), FNavQueryOrder());
+
+	PeakQueueDepth = FMath::Max(PeakQueueDepth, Queue.Num());
+
+	return QueryId;
+}
+
+bool UNavQueryBroker::DispatchPath(FNavQueryRequest&& Request)
+{
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	// Use the querier's agent properties if it has them
+	const INavAgentInterface* Agent = Cast<const INavAgentInterface>(Request.Querier.Get());
+	const FNavAgentProperties& AgentProperties = Agent ? Agent->GetNavAgentPropertiesRef() : FNavAgentProperties::DefaultProperties;
+
+	const ANavigationData* NavData = NavSys ? NavSys->GetNavDataForProps(AgentProperties, Request.Start) : nullptr;
+
+	if (!NavData)
+	{
+		RecordLatency(Request);
+		Request.PathCallback.ExecuteIfBound(Request.Id, false, nullptr);
+		return false;
+	}
+
+	const AActor* Querier = Request.Querier.Get();
+
+	FPathFindingQuery Query(Querier, *NavData, Request.Start, Request.End, UNavigationQueryFilter::GetQueryFilter(*NavData, Querier, Request.FilterClass));
+	Query.SetAllowPartialPaths(true);
+
+	const uint32 NavQueryId = NavSys->FindPathAsync(AgentProperties, Query, FNavPathQueryDelegate::CreateUObject(this, &UNavQueryBroker::OnPathFound));
+	RunningPaths.Add(NavQueryId, MoveTemp(Request));
+
+	return true;
+}
+
+void UNavQueryBroker::RunPointQuery(const FNavQueryRequest& Request)
+{
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	FNavLocation Result;
+	bool bSuccess = false;
+
+	if (NavSys)
+	{
+		ANavigationData* NavData = const_cast<ANavigationData*>(Request.NavData.Get());
+
+		switch (Request.Type)
+		{
+		case ENavQueryType::Projection:
+			bSuccess = NavSys->ProjectPointToNavigation(Request.Start, Result, Request.End);
+			break;
+
+		case ENavQueryType::RandomPoint:
+			bSuccess = NavSys->GetRandomPointInNavigableRadius(Request.Start, Request.Radius, Result, NavData);
+			break;
+
+		case ENavQueryType::RandomReachablePoint:
+			bSuccess = NavSys->GetRandomReachablePointInRadius(Request.Start, Request.Radius, Result, NavData);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	RecordLatency(Request);
+	Request.PointCallback.ExecuteIfBound(Request.Id, bSuccess, Result.Location);
+}
+
+void UNavQueryBroker::OnPathFound(uint32 NavQueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+	FNavQueryRequest Request;
+
+	// Ignore queries that were cancelled
+	if (!RunningPaths.RemoveAndCopyValue(NavQueryId, Request))
+	{
+		return;
+	}
+
+	RecordLatency(Request);
+
+	const bool bSuccess = Result == ENavigationQueryResult::Success && Path.IsValid() && Path->IsValid();
+	Request.PathCallback.ExecuteIfBound(Request.Id, bSuccess, Path);
+}
+
+void UNavQueryBroker::RecordLatency(const FNavQueryRequest& Request)
+{
+	LatencyStats[static_cast<int32>(Request.Type)].AddSample(static_cast<float>((FPlatformTime::Seconds() - Request.RequestTime) * 1000.0));
+}
+
+static FAutoConsoleCommandWithWorldAndArgs NavBrokerDumpCommand(
+	TEXT("Tactics.NavBroker.Dump"),
+	TEXT("Logs the navigation query broker's queue depth and latency stats."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UNavQueryBroker* Broker = World ? World->GetSubsystem<UNavQueryBroker>() : nullptr)
+		{
+			Broker->DumpStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs NavBrokerResetCommand(
+	TEXT("Tactics.NavBroker.Reset"),
+	TEXT("Clears the navigation query broker stats."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UNavQueryBroker* Broker = World ? World->GetSubsystem<UNavQueryBroker>() : nullptr)
+		{
+			Broker->ResetStats();
+		}
+	}));
@@ -0,0 +1,150 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "NavFilters/NavigationQueryFilter.h"
+#include "TimingStats.h"
+#include "NavQueryBroker.generated.h"
+
+class ANavigationData;
+
+/** Priority of a navigation query. Higher priorities are served first */
+enum class ENavQueryPriority : uint8
+{
+	Low,
+	Normal,
+	High
+};
+
+/** Kind of navigation query */
+enum class ENavQueryType : uint8
+{
+	Path,
+	Projection,
+	RandomPoint,
+	RandomReachablePoint,
+
+	Num
+};
+
+/** Called with the result of a path query */
+DECLARE_DELEGATE_ThreeParams(FNavQueryPathDelegate, uint32 /* QueryId */, bool /* bSuccess */, FNavPathSharedPtr /* Path */);
+
+/** Called with the result of a projection or random point query */
+DECLARE_DELEGATE_ThreeParams(FNavQueryPointDelegate, uint32 /* QueryId */, bool /* bSuccess */, const FVector& /* Location */);
+
+/**
+ * Navigation Query Broker - Queues navigation queries and runs them in priority order with a per-frame budget,
+ * so a large order doesn't hitch the game thread.
+ * Paths run as async pathfinding tasks, capped per frame. Projections and random points are cheap and run on
+ * the game thread until the frame's time budget is spent.
+ * Results are handed back through delegates, which are skipped if their object was destroyed.
+ * Queue depth and the latency from request to result are tracked per query type, see Tactics.NavBroker.Dump.
+ */
+UCLASS()
+class TACTICS_API UNavQueryBroker : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Queue a path query. Returns the query id */
+	uint32 RequestPath(const FVector& Start, const FVector& End, const AActor* Querier, TSubclassOf<UNavigationQueryFilter> FilterClass, ENavQueryPriority Priority, FNavQueryPathDelegate Callback);
+
+	/** Queue a query that projects a point onto the navmesh. Returns the query id */
+	uint32 RequestProjection(const FVector& Point, const FVector& Extent, ENavQueryPriority Priority, FNavQueryPointDelegate Callback);
+
+	/** Queue a query for a random navigable point, optionally one reachable from the origin. Returns the query id */
+	uint32 RequestRandomPoint(const FVector& Origin, float Radius, bool bReachable, const ANavigationData* NavData, ENavQueryPriority Priority, FNavQueryPointDelegate Callback);
+
+	/** Cancel a queued or running query. Its callback won't be called */
+	void CancelQuery(uint32 QueryId);
+
+	/** Log the queue and latency stats */
+	void DumpStats() const;
+
+	/** Clear the stats */
+	void ResetStats();
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+private:
+	/** Queued navigation query */
+	struct FNavQueryRequest
+	{
+		uint32 Id = 0;
+		ENavQueryType Type = ENavQueryType::Path;
+		ENavQueryPriority Priority = ENavQueryPriority::Normal;
+		double RequestTime = 0.0;
+
+		/** Path start, projection point or random point origin */
+		FVector Start = FVector::ZeroVector;
+
+		/** Path end, or projection extent */
+		FVector End = FVector::ZeroVector;
+
+		float Radius = 0.0f;
+
+		TWeakObjectPtr<const AActor> Querier;
+		TWeakObjectPtr<const ANavigationData> NavData;
+		TSubclassOf<UNavigationQueryFilter> FilterClass;
+
+		FNavQueryPathDelegate PathCallback;
+		FNavQueryPointDelegate PointCallback;
+	};
+
+	/** Orders the queue by priority, then by request order */
+	struct FNavQueryOrder
+	{
+		bool operator()(const FNavQueryRequest& A, const FNavQueryRequest& B) const
+		{
+			return A.Priority != B.Priority ? A.Priority > B.Priority : A.Id < B.Id;
+		}
+	};
+
+	/** Add a request to the queue and return its id */
+	uint32 Enqueue(FNavQueryRequest&& Request);
+
+	/** Start an async path query. Returns false if it completed right away */
+	bool DispatchPath(FNavQueryRequest&& Request);
+
+	/** Run a projection or random point query */
+	void RunPointQuery(const FNavQueryRequest& Request);
+
+	/** Async path query finished */
+	void OnPathFound(uint32 NavQueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
+	/** Record the latency of a finished query */
+	void RecordLatency(const FNavQueryRequest& Request);
+
+	/** Queued requests, kept as a heap */
+	TArray<FNavQueryRequest> Queue;
+
+	/** Running path queries, by navigation system query id */
+	TMap<uint32, FNavQueryRequest> RunningPaths;
+
+	/** Latency from request to result, by query type */
+	FTimingStats LatencyStats[static_cast<int32>(ENavQueryType::Num)];
+
+	/** Largest queue depth seen */
+	int32 PeakQueueDepth = 0;
+
+	/** Sum of the queue depth at the start of each frame, for the average */
+	int64 QueueDepthSum = 0;
+
+	/** Number of frames the queue depth was sampled on */
+	int32 QueueDepthFrames = 0;
+
+	/** Number of frames the budget ran out with queries left in the queue */
+	int32 BudgetExceededFrames = 0;
+
+	/** Id of the next query */
+	uint32 NextQueryId = 1;
+};
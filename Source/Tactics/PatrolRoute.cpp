@@ -0,0 +1,216 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PatrolRoute.h"
+#include "Tactics.h"
+#include "Components/SceneComponent.h"
+#include "NavigationSystem.h"
+#include "NavigationPath.h"
+#include "Engine/World.h"
+
+APatrolRoute::APatrolRoute()
+{
+	// Routes are static data, no need to tick
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void APatrolRoute::BeginPlay()
+{
+	Super::BeginPlay();
+
+	BuildAdjacency();
+
+	// Use the baked segments if they still match the authored links
+	int32 NumLinks = 0;
+	for (const TArray<int32>& Links : Adjacency)
+	{
+		NumLinks += Links.Num();
+	}
+
+	if (Segments.Num() != NumLinks)
+	{
+		BuildSegments();
+	}
+
+	BuildSegmentLookup();
+}
+
+#if WITH_EDITOR
+void APatrolRoute::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Any change to the graph invalidates the baked segments
+	Segments.Reset();
+}
+
+void APatrolRoute::PostEditMove(bool bFinished)
+{
+	Super::PostEditMove(bFinished);
+
+	// Segments are stored in world space
+	if (bFinished)
+	{
+		Segments.Reset();
+	}
+}
+
+void APatrolRoute::BakeSegments()
+{
+	BuildAdjacency();
+	BuildSegments();
+
+	UE_LOG(LogTactics, Log, TEXT("%s baked %d patrol segments"), *GetName(), Segments.Num());
+}
+#endif
+
+FVector APatrolRoute::GetWaypointLocation(int32 Index) const
+{
+	if (!Waypoints.IsValidIndex(Index))
+	{
+		return GetActorLocation();
+	}
+
+	return GetActorTransform().TransformPosition(Waypoints[Index].Location);
+}
+
+float APatrolRoute::GetWaypointWaitTime(int32 Index) const
+{
+	return Waypoints.IsValidIndex(Index) ? Waypoints[Index].WaitTime : 0.0f;
+}
+
+int32 APatrolRoute::FindNearestWaypoint(const FVector& WorldLocation) const
+{
+	int32 Nearest = INDEX_NONE;
+	float NearestDistSq = TNumericLimits<float>::Max();
+
+	for (int32 Index = 0; Index < Waypoints.Num(); ++Index)
+	{
+		const float DistSq = FVector::DistSquared2D(WorldLocation, GetWaypointLocation(Index));
+		if (DistSq < NearestDistSq)
+		{
+			Nearest = Index;
+			NearestDistSq = DistSq;
+		}
+	}
+
+	return Nearest;
+}
+
+int32 APatrolRoute::ChooseNextWaypoint(int32 Current, int32 Previous) const
+{
+	if (!Adjacency.IsValidIndex(Current) || Adjacency[Current].Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	const TArray<int32>& Links = Adjacency[Current];
+
+	// Don't turn back unless it's the only way to go
+	if (Links.Num() > 1 && Links.Contains(Previous))
+	{
+		const int32 Pick = FMath::RandRange(0, Links.Num() - 2);
+		const int32 PreviousIndex = Links.IndexOfByKey(Previous);
+		return Links[Pick >= PreviousIndex ? Pick + 1 : Pick];
+	}
+
+	return Links[FMath::RandRange(0, Links.Num() - 1)];
+}
+
+const FPatrolSegment* APatrolRoute::GetSegment(int32 From, int32 To) const
+{
+	if (const int32* SegmentIndex = SegmentLookup.Find(FIntPoint(From, To)))
+	{
+		return &Segments[*SegmentIndex];
+	}
+
+	return nullptr;
+}
+
+void APatrolRoute::BuildAdjacency()
+{
+	const int32 NumWaypoints = Waypoints.Num();
+
+	Adjacency.Reset();
+	Adjacency.SetNum(NumWaypoints);
+
+	for (int32 Index = 0; Index < NumWaypoints; ++Index)
+	{
+		if (Waypoints[Index].Links.Num() > 0)
+		{
+			// Explicit links
+			for (int32 Link : Waypoints[Index].Links)
+			{
+				if (Waypoints.IsValidIndex(Link) && Link != Index)
+				{
+					Adjacency[Index].AddUnique(Link);
+				}
+			}
+		}
+		else if (NumWaypoints > 1)
+		{
+			// Implicit links follow the route order. Open routes walk back and forth
+			if (Index + 1 < NumWaypoints)
+			{
+				Adjacency[Index].AddUnique(Index + 1);
+			}
+			else if (bClosedLoop)
+			{
+				Adjacency[Index].AddUnique(0);
+			}
+
+			if (!bClosedLoop && Index > 0)
+			{
+				Adjacency[Index].AddUnique(Index - 1);
+			}
+		}
+	}
+}
+
+void APatrolRoute::BuildSegments()
+{
+	Segments.Reset();
+
+	UWorld* World = GetWorld();
+
+	for (int32 From = 0; From < Adjacency.Num(); ++From)
+	{
+		for (int32 To : Adjacency[From])
+		{
+			FPatrolSegment& Segment = Segments.AddDefaulted_GetRef();
+			Segment.From = From;
+			Segment.To = To;
+
+			const FVector Start = GetWaypointLocation(From);
+			const FVector End = GetWaypointLocation(To);
+
+			// Ask the navmesh once for the segment shape
+			if (bUseNavigation && World)
+			{
+				if (UNavigationPath* Path = UNavigationSystemV1::FindPathToLocationSynchronously(World, Start, End))
+				{
+					if (Path->IsValid() && Path->PathPoints.Num() > 1)
+					{
+						Segment.Points = Path->PathPoints;
+						continue;
+					}
+				}
+
+				UE_LOG(LogTactics, Warning, TEXT("%s: no navigation path between waypoints %d and %d, using a straight line"), *GetName(), From, To);
+			}
+
+			Segment.Points = { Start, End };
+		}
+	}
+}
+
+void APatrolRoute::BuildSegmentLookup()
+{
+	SegmentLookup.Reset();
+
+	for (int32 Index = 0; Index < Segments.Num(); ++Index)
+	{
+		SegmentLookup.Add(FIntPoint(Segments[Index].From, Segments[Index].To), Index);
+	}
+}
@@ -0,0 +1,127 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "PatrolRoute.generated.h"
+
+/**
+ * Single level-authored patrol waypoint
+ */
+USTRUCT(BlueprintType)
+struct FPatrolWaypoint
+{
+	GENERATED_BODY()
+
+	/** Waypoint location, relative to the owning route */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Patrol", meta = (MakeEditWidget = true))
+	FVector Location = FVector::ZeroVector;
+
+	/** Waypoints reachable from this one. If empty, the route order is used instead */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Patrol")
+	TArray<int32> Links;
+
+	/** Time to wait after reaching this waypoint */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Patrol", meta = (ClampMin = 0, Units = "s"))
+	float WaitTime = 0.0f;
+};
+
+/**
+ * Precomputed polyline between two linked waypoints, in world space
+ */
+USTRUCT()
+struct FPatrolSegment
+{
+	GENERATED_BODY()
+
+	/** Waypoint the segment starts at */
+	UPROPERTY()
+	int32 From = INDEX_NONE;
+
+	/** Waypoint the segment ends at */
+	UPROPERTY()
+	int32 To = INDEX_NONE;
+
+	/** Path points, including both waypoint locations */
+	UPROPERTY()
+	TArray<FVector> Points;
+};
+
+/**
+ * Patrol Route - A waypoint graph placed in the level.
+ * Path segments between linked waypoints are computed once (baked in the editor, or on BeginPlay)
+ * and shared by every enemy patrolling the route, so patrolling never issues navigation queries.
+ */
+UCLASS(Blueprintable, BlueprintType)
+class TACTICS_API APatrolRoute : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	APatrolRoute();
+
+	virtual void BeginPlay() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void PostEditMove(bool bFinished) override;
+
+	/** Computes and stores the path segments so they are saved and cooked with the level */
+	UFUNCTION(CallInEditor, Category = "Patrol")
+	void BakeSegments();
+#endif
+
+	/** Number of waypoints on this route */
+	UFUNCTION(BlueprintPure, Category = "Patrol")
+	int32 GetNumWaypoints() const { return Waypoints.Num(); }
+
+	/** Get a waypoint location in world space */
+	UFUNCTION(BlueprintPure, Category = "Patrol")
+	FVector GetWaypointLocation(int32 Index) const;
+
+	/** Get the time to wait at a waypoint */
+	float GetWaypointWaitTime(int32 Index) const;
+
+	/** Find the waypoint closest to a world location */
+	int32 FindNearestWaypoint(const FVector& WorldLocation) const;
+
+	/** Pick the waypoint to walk to after reaching Current, avoiding Previous when there is a choice */
+	int32 ChooseNextWaypoint(int32 Current, int32 Previous) const;
+
+	/** Get the cached polyline between two linked waypoints, or nullptr if they aren't linked */
+	const FPatrolSegment* GetSegment(int32 From, int32 To) const;
+
+protected:
+	/** Waypoints making up the route graph */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Patrol")
+	TArray<FPatrolWaypoint> Waypoints;
+
+	/** If true, waypoints without explicit links connect the last waypoint back to the first */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Patrol")
+	bool bClosedLoop = true;
+
+	/** If true, segments follow the navmesh. Otherwise waypoints are connected by straight lines */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Patrol")
+	bool bUseNavigation = true;
+
+	/** Segments baked in the editor. Rebuilt on BeginPlay if empty */
+	UPROPERTY()
+	TArray<FPatrolSegment> Segments;
+
+private:
+	/** Effective outgoing links for each waypoint */
+	TArray<TArray<int32>> Adjacency;
+
+	/** Lookup from (From, To) to an index into Segments */
+	TMap<FIntPoint, int32> SegmentLookup;
+
+	/** Build the adjacency lists from the authored links */
+	void BuildAdjacency();
+
+	/** Compute the polyline for every link */
+	void BuildSegments();
+
+	/** Build the segment lookup table */
+	void BuildSegmentLookup();
+};
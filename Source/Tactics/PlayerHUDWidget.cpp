@@ -2,8 +2,11 @@
 
 #include "PlayerHUDWidget.h"
 #include "TacticsCharacter.h"
+#include "TacticsMinimapSubsystem.h"
 #include "Components/ProgressBar.h"
 #include "Components/TextBlock.h"
+#include "Components/Image.h"
+#include "Engine/Texture2D.h"
 
 void UPlayerHUDWidget::NativeConstruct()
 {
@@ -12,6 +15,10 @@ void UPlayerHUDWidget::NativeConstruct()
 	// Find health bar and HP text widgets
 	HealthBar = Cast<UProgressBar>(GetWidgetFromName(TEXT("HealthBar")));
 	HPText = Cast<UTextBlock>(GetWidgetFromName(TEXT("HPDisplay")));
+
+	// The minimap is optional
+	MinimapImage = Cast<UImage>(GetWidgetFromName(TEXT("Minimap")));
+	UpdateMinimapImage();
 }
 
 void UPlayerHUDWidget::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
@@ -22,6 +29,8 @@ void UPlayerHUDWidget::NativeTick(const FGeometry& MyGeometry, float InDeltaTime
 	{
 		UpdateHealthDisplay();
 	}
+
+	UpdateMinimapImage();
 }
 
 void UPlayerHUDWidget::SetCharacter(ATacticsCharacter* InCharacter)
@@ -73,3 +82,19 @@ void UPlayerHUDWidget::UpdateHealthDisplay()
 		}
 	}
 }
+
+void UPlayerHUDWidget::UpdateMinimapImage()
+{
+	if (!MinimapImage)
+	{
+		return;
+	}
+
+	const UTacticsMinimapSubsystem* Minimap = GetWorld() ? GetWorld()->GetSubsystem<UTacticsMinimapSubsystem>() : nullptr;
+	UTexture2D* Texture = Minimap ? Minimap->GetTexture() : nullptr;
+
+	if (Texture && MinimapImage->GetBrush().GetResourceObject() != Texture)
+	{
+		MinimapImage->SetBrushFromTexture(Texture);
+	}
+}
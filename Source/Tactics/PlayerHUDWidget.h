@@ -6,6 +6,7 @@
 #include "Blueprint/UserWidget.h"
 #include "Components/ProgressBar.h"
 #include "Components/TextBlock.h"
+#include "Components/Image.h"
 #include "PlayerHUDWidget.generated.h"
 
 class ATacticsCharacter;
@@ -39,6 +40,13 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "UI")
 	UTextBlock* HPText;
 
+	/** Optional minimap image widget */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "UI")
+	UImage* MinimapImage;
+
 	/** Update health display */
 	void UpdateHealthDisplay();
+
+	/** Point the minimap image at the minimap texture, which is recreated when its size changes */
+	void UpdateMinimapImage();
 };
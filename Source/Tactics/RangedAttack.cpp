@@ -0,0 +1,64 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "RangedAttack.h"
+
+bool RangedAttack::ComputeLeadDirection(const FVector& Start, const FVector& TargetLocation, const FVector& TargetVelocity, float ProjectileSpeed, FVector& OutDirection, float* OutTimeToImpact)
+{
+	const FVector ToTarget = TargetLocation - Start;
+	OutDirection = ToTarget.GetSafeNormal();
+
+	if (ProjectileSpeed <= KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	// Solve |ToTarget + TargetVelocity * t| = ProjectileSpeed * t for the earliest positive t
+	const double A = TargetVelocity.SizeSquared() - FMath::Square(ProjectileSpeed);
+	const double B = 2.0 * FVector::DotProduct(ToTarget, TargetVelocity);
+	const double C = ToTarget.SizeSquared();
+
+	double Time = -1.0;
+
+	if (FMath::Abs(A) < KINDA_SMALL_NUMBER)
+	{
+		// Target moves as fast as the projectile, the equation is linear
+		if (B < 0.0)
+		{
+			Time = -C / B;
+		}
+	}
+	else
+	{
+		const double Discriminant = B * B - 4.0 * A * C;
+		if (Discriminant >= 0.0)
+		{
+			const double Root = FMath::Sqrt(Discriminant);
+			const double T1 = (-B - Root) / (2.0 * A);
+			const double T2 = (-B + Root) / (2.0 * A);
+
+			if (T1 > 0.0 && (T2 <= 0.0 || T1 < T2))
+			{
+				Time = T1;
+			}
+			else if (T2 > 0.0)
+			{
+				Time = T2;
+			}
+		}
+	}
+
+	if (Time <= 0.0)
+	{
+		return false;
+	}
+
+	// Aim at where the target will be when the projectile gets there
+	OutDirection = (ToTarget + TargetVelocity * Time).GetSafeNormal();
+
+	if (OutTimeToImpact)
+	{
+		*OutTimeToImpact = static_cast<float>(Time);
+	}
+
+	return true;
+}
@@ -0,0 +1,17 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Ranged attack helpers
+ */
+namespace RangedAttack
+{
+	/**
+	 * Computes the direction to fire a projectile so it intercepts a target moving at constant velocity.
+	 * Returns false (and the direct aim direction) if the projectile is too slow to ever catch the target.
+	 */
+	TACTICS_API bool ComputeLeadDirection(const FVector& Start, const FVector& TargetLocation, const FVector& TargetVelocity, float ProjectileSpeed, FVector& OutDirection, float* OutTimeToImpact = nullptr);
+}
@@ -3,7 +3,9 @@
 #include "RangedEnemyCharacter.h"
 #include "Tactics.h"
 #include "Kismet/GameplayStatics.h"
-#include "GameFramework/ProjectileMovementComponent.h"
+#include "RangedAttack.h"
+#include "ActorPoolSubsystem.h"
+#include "Engine/World.h"
 
 ARangedEnemyCharacter::ARangedEnemyCharacter()
 {
@@ -23,6 +25,20 @@ ARangedEnemyCharacter::ARangedEnemyCharacter()
 	ExpValue = 40;
 }
 
+void ARangedEnemyCharacter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Warm up the projectile pool so the first shots don't spawn actors
+	if (ProjectileClass && ProjectilePrewarmCount > 0)
+	{
+		if (UActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UActorPoolSubsystem>())
+		{
+			Pool->Prewarm(ProjectileClass, ProjectilePrewarmCount);
+		}
+	}
+}
+
 void ARangedEnemyCharacter::AttackPlayer()
 {
 	if (!PlayerCharacter || PlayerCharacter->IsDead())
@@ -36,50 +52,95 @@ void ARangedEnemyCharacter::AttackPlayer()
 		return;
 	}
 
-	// Face the player
-	FVector DirectionToPlayer = GetDirectionToPlayer();
-	ForceRotateToDirection(DirectionToPlayer);
-
 	// Play attack animation
 	PlayAttackAnimation();
 
-	// Spawn projectile if class is set
-	if (ProjectileClass && GetWorld())
+	// Enemies outside the high AI LOD tier, which is picked by distance to the player, skip the projectile and use a hitscan
+	if (ProjectileClass && GetAILODTier() == EEnemyAILODTier::High)
 	{
-		// Calculate spawn location
-		FVector SpawnLocation = GetActorLocation() + GetActorRotation().RotateVector(ProjectileSpawnOffset);
-		FRotator SpawnRotation = DirectionToPlayer.Rotation();
-		
-		// Spawn projectile
-		FActorSpawnParameters SpawnParams;
-		SpawnParams.Owner = this;
-		SpawnParams.Instigator = this;
-		
-		AActor* Projectile = GetWorld()->SpawnActor<AActor>(ProjectileClass, SpawnLocation, SpawnRotation, SpawnParams);
-		
-		if (Projectile)
-		{
-			// If projectile has ProjectileMovementComponent, set velocity
-			if (UProjectileMovementComponent* ProjMovement = Projectile->FindComponentByClass<UProjectileMovementComponent>())
-			{
-				ProjMovement->Velocity = DirectionToPlayer * ProjectileSpeed;
-			}
-			
-			UE_LOG(LogTactics, Log, TEXT("%s fired projectile at player"), *GetName());
-		}
+		FireProjectile();
 	}
 	else
 	{
-		// Fallback: Apply damage directly if no projectile class (like hitscan)
-		if (IsPlayerInAttackRange())
-		{
-			float Damage = CalculateDamage(0.0f);
-			UGameplayStatics::ApplyDamage(PlayerCharacter, Damage, GetController(), this, nullptr);
-			
-			UE_LOG(LogTactics, Log, TEXT("%s hit player with ranged attack for %f damage"), *GetName(), Damage);
-		}
+		ForceRotateToDirection(GetDirectionToPlayer());
+		FireHitscan();
 	}
 
 	// Set cooldown
 	AttackCooldownTimer = AttackInterval;
 }
+
+void ARangedEnemyCharacter::FireProjectile()
+{
+	UActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+	if (!Pool)
+	{
+		return;
+	}
+
+	// Calculate spawn location
+	FVector SpawnLocation = GetActorLocation() + GetActorRotation().RotateVector(ProjectileSpawnOffset);
+
+	// Keep the shot horizontal, at the height it is fired from
+	FVector TargetLocation = PlayerCharacter->GetActorLocation();
+	TargetLocation.Z = SpawnLocation.Z;
+
+	FVector TargetVelocity = PlayerCharacter->GetVelocity();
+	TargetVelocity.Z = 0.0f;
+
+	FVector AimDirection = (TargetLocation - SpawnLocation).GetSafeNormal();
+	if (bLeadTarget)
+	{
+		// Falls back to the direct aim if the player outruns the projectile
+		RangedAttack::ComputeLeadDirection(SpawnLocation, TargetLocation, TargetVelocity, ProjectileSpeed, AimDirection);
+	}
+
+	// Face the aim direction and fire from the rotated offset
+	ForceRotateToDirection(AimDirection);
+	SpawnLocation = GetActorLocation() + GetActorRotation().RotateVector(ProjectileSpawnOffset);
+
+	if (ARangedProjectile* Projectile = Pool->AcquireActor(ProjectileClass, FTransform(AimDirection.Rotation(), SpawnLocation)))
+	{
+		Projectile->SetOwner(this);
+		Projectile->SetInstigator(this);
+		Projectile->Launch(AimDirection * ProjectileSpeed);
+
+		UE_LOG(LogTactics, Log, TEXT("%s fired projectile at player"), *GetName());
+	}
+}
+
+void ARangedEnemyCharacter::FireHitscan()
+{
+	if (!IsPlayerInAttackRange())
+	{
+		return;
+	}
+
+	const FVector Start = GetActorLocation() + GetActorRotation().RotateVector(ProjectileSpawnOffset);
+
+	// Anything blocking between us and the player stops the shot
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(RangedHitscan), false);
+	QueryParams.AddIgnoredActor(this);
+	QueryParams.AddIgnoredActor(PlayerCharacter);
+
+	FTraceDelegate TraceDelegate = FTraceDelegate::CreateUObject(this, &ARangedEnemyCharacter::OnHitscanTraceCompleted);
+	GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, PlayerCharacter->GetActorLocation(), ECC_Visibility, QueryParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate);
+}
+
+void ARangedEnemyCharacter::OnHitscanTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Data)
+{
+	if (IsDead() || !PlayerCharacter || PlayerCharacter->IsDead())
+	{
+		return;
+	}
+
+	if (Data.OutHits.Num() > 0 && Data.OutHits[0].bBlockingHit)
+	{
+		return;
+	}
+
+	float Damage = CalculateDamage(0.0f);
+	UGameplayStatics::ApplyDamage(PlayerCharacter, Damage, GetController(), this, nullptr);
+
+	UE_LOG(LogTactics, Log, TEXT("%s hit player with ranged attack for %f damage"), *GetName(), Damage);
+}
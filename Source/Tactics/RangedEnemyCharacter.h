@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "EnemyCharacter.h"
+#include "WorldCollision.h"
+#include "RangedProjectile.h"
 #include "RangedEnemyCharacter.generated.h"
 
 /**
@@ -17,10 +19,12 @@ class TACTICS_API ARangedEnemyCharacter : public AEnemyCharacter
 public:
 	ARangedEnemyCharacter();
 
+	virtual void BeginPlay() override;
+
 protected:
-	/** Projectile class to spawn */
+	/** Projectile class to fire. Its life span sets how long a fired projectile stays out of the pool */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
-	TSubclassOf<class AActor> ProjectileClass;
+	TSubclassOf<ARangedProjectile> ProjectileClass;
 
 	/** Projectile spawn offset from character */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
@@ -30,6 +34,23 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
 	float ProjectileSpeed = 1000.0f;
 
+	/** If true, aim where the player will be when the projectile arrives */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
+	bool bLeadTarget = true;
+
+	/** Number of projectiles to spawn into the pool on begin play */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (ClampMin = 0))
+	int32 ProjectilePrewarmCount = 3;
+
 	/** Override attack to fire projectile instead */
 	virtual void AttackPlayer() override;
+
+	/** Fire a pooled projectile from the spawn offset */
+	void FireProjectile();
+
+	/** Cheap hitscan used in the low AI LOD tier or when no projectile class is set */
+	void FireHitscan();
+
+	/** Apply hitscan damage once the async trace comes back */
+	void OnHitscanTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Data);
 };
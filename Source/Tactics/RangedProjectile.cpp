@@ -0,0 +1,48 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "RangedProjectile.h"
+#include "Components/SphereComponent.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+
+ARangedProjectile::ARangedProjectile()
+{
+	// The actor pool takes this over as the time before the projectile is released
+	InitialLifeSpan = 3.0f;
+
+	RootComponent = CollisionSphere = CreateDefaultSubobject<USphereComponent>(TEXT("Collision Sphere"));
+	CollisionSphere->SetSphereRadius(20.0f);
+	CollisionSphere->SetCollisionProfileName(FName("BlockAllDynamic"));
+
+	ProjectileMovement = CreateDefaultSubobject<UProjectileMovementComponent>(TEXT("Projectile Movement"));
+	ProjectileMovement->ProjectileGravityScale = 0.0f;
+	ProjectileMovement->bRotationFollowsVelocity = true;
+	ProjectileMovement->OnProjectileStop.AddDynamic(this, &ARangedProjectile::OnProjectileStop);
+}
+
+void ARangedProjectile::Launch(const FVector& Velocity)
+{
+	ProjectileMovement->Velocity = Velocity;
+	ProjectileMovement->UpdateComponentVelocity();
+}
+
+void ARangedProjectile::OnAcquiredFromPool_Implementation()
+{
+	// Stopped projectiles let go of their updated component
+	if (!ProjectileMovement->UpdatedComponent)
+	{
+		ProjectileMovement->SetUpdatedComponent(RootComponent);
+	}
+
+	ProjectileMovement->Activate(true);
+}
+
+void ARangedProjectile::OnReleasedToPool_Implementation()
+{
+	ProjectileMovement->StopMovementImmediately();
+	ProjectileMovement->Deactivate();
+}
+
+void ARangedProjectile::OnProjectileStop(const FHitResult& ImpactResult)
+{
+	UActorPoolSubsystem::ReleaseOrDestroy(this);
+}
@@ -0,0 +1,48 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ActorPoolSubsystem.h"
+#include "RangedProjectile.generated.h"
+
+class USphereComponent;
+class UProjectileMovementComponent;
+
+/**
+ * Ranged Projectile - Enemy projectile recycled through the actor pool.
+ * Its life span is the pool's release time, and it goes back to the pool early when its movement stops on impact.
+ * Blueprint subclasses add the mesh and the hit response.
+ */
+UCLASS(Blueprintable, BlueprintType)
+class TACTICS_API ARangedProjectile : public AActor, public IPooledActor
+{
+	GENERATED_BODY()
+
+	/** Projectile collision sphere */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components", meta = (AllowPrivateAccess = "true"))
+	USphereComponent* CollisionSphere;
+
+	/** Moves the projectile */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components", meta = (AllowPrivateAccess = "true"))
+	UProjectileMovementComponent* ProjectileMovement;
+
+public:
+	ARangedProjectile();
+
+	/** Sends the projectile off with the given velocity */
+	void Launch(const FVector& Velocity);
+
+	/** Returns the projectile movement component */
+	UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
+
+	// IPooledActor interface
+	virtual void OnAcquiredFromPool_Implementation() override;
+	virtual void OnReleasedToPool_Implementation() override;
+
+protected:
+	/** Returns the projectile to the pool once it stops on impact */
+	UFUNCTION()
+	void OnProjectileStop(const FHitResult& ImpactResult);
+};
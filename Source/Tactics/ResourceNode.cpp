@@ -2,6 +2,7 @@
 
 #include "ResourceNode.h"
 #include "ResourceManager.h"
+#include "TacticsMinimapSubsystem.h"
 #include "Components/StaticMeshComponent.h"
 #include "Components/SphereComponent.h"
 #include "Kismet/GameplayStatics.h"
@@ -61,6 +62,12 @@ void AResourceNode::BeginPlay()
     }
 
     UpdateVisual(GatherState);
+
+    // 미니맵에 자원 마커 등록
+    if (UTacticsMinimapSubsystem* Minimap = GetWorld()->GetSubsystem<UTacticsMinimapSubsystem>())
+    {
+        Minimap->TrackActor(this, ETacticsMinimapMarker::Resource);
+    }
 }
 
 void AResourceNode::Tick(float DeltaTime)
@@ -18,12 +18,14 @@ public class Tactics : ModuleRules
 			"NavigationSystem",
 			"StateTreeModule",
 			"GameplayStateTreeModule",
+			"MassEntity",
+			"MassCommon",
 			"Niagara",
 			"UMG",
 			"Slate"
 		});
 
-		PrivateDependencyModuleNames.AddRange(new string[] { });
+		PrivateDependencyModuleNames.AddRange(new string[] { "RenderCore", "ImageCore" });
 
 		PublicIncludePaths.AddRange(new string[] {
 			"Tactics",
@@ -0,0 +1,219 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TacticsAssetPreloader.h"
+#include "Tactics.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/HUD.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "GameFramework/WorldSettings.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/DataValidation.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/UObjectIterator.h"
+
+void UTacticsAssetPreloader::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PreloadStartTime = FPlatformTime::Seconds();
+
+	FWorldDelegates::OnPostWorldInitialization.AddUObject(this, &UTacticsAssetPreloader::OnPostWorldInitialization);
+
+	// Read the default game mode straight from config, it may be a Blueprint that needs loading too
+	FString GameModeName;
+	GConfig->GetString(TEXT("/Script/EngineSettings.GameMapsSettings"), TEXT("GlobalDefaultGameMode"), GameModeName, GEngineIni);
+	GameModeClassPath = FSoftClassPath(GameModeName);
+
+	if (GameModeClassPath.IsNull())
+	{
+		OnGameModeLoaded();
+		return;
+	}
+
+	GameModeHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(GameModeClassPath, FStreamableDelegate::CreateUObject(this, &UTacticsAssetPreloader::OnGameModeLoaded), FStreamableManager::AsyncLoadHighPriority);
+
+	// No handle means nothing could be requested, so the delegate won't be called. Assets already in memory still get a handle and the delegate
+	if (!GameModeHandle.IsValid())
+	{
+		OnGameModeLoaded();
+	}
+}
+
+void UTacticsAssetPreloader::Deinitialize()
+{
+	FWorldDelegates::OnPostWorldInitialization.RemoveAll(this);
+
+	if (GameModeHandle.IsValid())
+	{
+		GameModeHandle->CancelHandle();
+		GameModeHandle.Reset();
+	}
+
+	if (PreloadHandle.IsValid())
+	{
+		PreloadHandle->CancelHandle();
+		PreloadHandle.Reset();
+	}
+
+	for (const TSharedPtr<FStreamableHandle>& Handle : MapPreloadHandles)
+	{
+		Handle->CancelHandle();
+	}
+
+	MapPreloadHandles.Empty();
+
+	Super::Deinitialize();
+}
+
+void UTacticsAssetPreloader::OnGameModeLoaded()
+{
+	// Collect the soft defaults of the game mode, its player controller and its HUD
+	TArray<FSoftObjectPath> Assets;
+
+	const UClass* GameModeClass = GameModeClassPath.ResolveClass();
+	if (GetGameModePreloadAssets(GameModeClass, Assets))
+	{
+		PreloadedGameModes.Add(GameModeClass->GetFName());
+	}
+
+	UE_LOG(LogTactics, Log, TEXT("Preloading %d assets for %s (game mode loaded in %.2f ms)"), Assets.Num(), *GetNameSafe(GameModeClass), (FPlatformTime::Seconds() - PreloadStartTime) * 1000.0);
+
+	if (Assets.Num() == 0)
+	{
+		OnPreloadComplete();
+		return;
+	}
+
+	PreloadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Assets, FStreamableDelegate::CreateUObject(this, &UTacticsAssetPreloader::OnPreloadComplete), FStreamableManager::AsyncLoadHighPriority);
+
+	// Nothing could be requested, so the delegate won't be called
+	if (!PreloadHandle.IsValid())
+	{
+		OnPreloadComplete();
+	}
+}
+
+void UTacticsAssetPreloader::OnPreloadComplete()
+{
+	bPreloadComplete = true;
+
+	UE_LOG(LogTactics, Log, TEXT("Preload complete in %.2f ms"), (FPlatformTime::Seconds() - PreloadStartTime) * 1000.0);
+}
+
+void UTacticsAssetPreloader::OnPostWorldInitialization(UWorld* World, const UWorld::InitializationValues IVS)
+{
+	if (!World || !World->IsGameWorld() || World->GetGameInstance() != GetGameInstance())
+	{
+		return;
+	}
+
+	// Maps without an override use the default game mode, which is preloaded at startup
+	const AWorldSettings* WorldSettings = World->GetWorldSettings();
+	const UClass* GameModeClass = WorldSettings ? WorldSettings->DefaultGameMode.Get() : nullptr;
+
+	if (!GameModeClass || PreloadedGameModes.Contains(GameModeClass->GetFName()))
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> Assets;
+	if (!GetGameModePreloadAssets(GameModeClass, Assets))
+	{
+		return;
+	}
+
+	PreloadedGameModes.Add(GameModeClass->GetFName());
+
+	if (Assets.Num() == 0)
+	{
+		return;
+	}
+
+	UE_LOG(LogTactics, Log, TEXT("Preloading %d assets for %s, the game mode of %s"), Assets.Num(), *GetNameSafe(GameModeClass), *World->GetMapName());
+
+	// The pawn spawns soon after, so this mostly overlaps the rest of the map load. Anything still loading is flushed on first use
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Assets, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+
+	if (Handle.IsValid())
+	{
+		MapPreloadHandles.Add(Handle);
+	}
+}
+
+/** Adds the preload assets of a class's defaults, if it has any */
+static void AddClassPreloadAssets(const UClass* Class, TArray<FSoftObjectPath>& OutAssets)
+{
+	if (const ITacticsPreloadSource* Source = Class ? Cast<ITacticsPreloadSource>(Class->GetDefaultObject()) : nullptr)
+	{
+		Source->GetPreloadAssets(OutAssets);
+	}
+}
+
+bool UTacticsAssetPreloader::GetGameModePreloadAssets(const UClass* GameModeClass, TArray<FSoftObjectPath>& OutAssets)
+{
+	if (!GameModeClass || !GameModeClass->IsChildOf<AGameModeBase>())
+	{
+		return false;
+	}
+
+	const AGameModeBase* GameMode = GameModeClass->GetDefaultObject<AGameModeBase>();
+
+	AddClassPreloadAssets(GameModeClass, OutAssets);
+	AddClassPreloadAssets(GameMode->PlayerControllerClass, OutAssets);
+	AddClassPreloadAssets(GameMode->HUDClass, OutAssets);
+	return true;
+}
+
+#if WITH_EDITOR
+EDataValidationResult ITacticsPreloadSource::ValidatePreloadAssets(FDataValidationContext& Context) const
+{
+	EDataValidationResult Result = EDataValidationResult::Valid;
+
+	TArray<FSoftObjectPath> Assets;
+	GetPreloadAssets(Assets);
+
+	for (const FSoftObjectPath& Path : Assets)
+	{
+		FAssetData AssetData;
+		if (!UAssetManager::Get().GetAssetDataForPath(Path, AssetData))
+		{
+			Context.AddError(FText::Format(NSLOCTEXT("Tactics", "MissingPreloadAsset", "Default asset {0} does not exist"), FText::FromString(Path.ToString())));
+			Result = EDataValidationResult::Invalid;
+		}
+	}
+
+	return Result;
+}
+#endif
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTacticsNativePreloadAssetsTest, "Tactics.Preload.NativeDefaults", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTacticsNativePreloadAssetsTest::RunTest(const FString& Parameters)
+{
+	// IsDataValid only runs on assets, so the soft defaults set in native constructors are checked here
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		const UClass* Class = *It;
+
+		if (!Class->HasAnyClassFlags(CLASS_Native) || !Class->ImplementsInterface(UTacticsPreloadSource::StaticClass()))
+		{
+			continue;
+		}
+
+		TArray<FSoftObjectPath> Assets;
+		Cast<ITacticsPreloadSource>(Class->GetDefaultObject())->GetPreloadAssets(Assets);
+
+		for (const FSoftObjectPath& Path : Assets)
+		{
+			TestNotNull(FString::Printf(TEXT("%s default asset %s"), *Class->GetName(), *Path.ToString()), Path.TryLoad());
+		}
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,90 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Engine/World.h"
+#include "UObject/Interface.h"
+#include "TacticsAssetPreloader.generated.h"
+
+struct FStreamableHandle;
+
+UINTERFACE(MinimalAPI, meta = (CannotImplementInterfaceInBlueprint))
+class UTacticsPreloadSource : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Tactics Preload Source - Gameplay framework classes with soft default assets.
+ * The preloader collects them from the game mode, its player controller and its HUD defaults.
+ */
+class TACTICS_API ITacticsPreloadSource
+{
+	GENERATED_BODY()
+
+public:
+	/** Get the default assets to preload for this class */
+	virtual void GetPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const = 0;
+
+#if WITH_EDITOR
+	/** Report preload assets that don't exist. Call from IsDataValid, so Blueprint subclasses are checked at validation and cook time */
+	EDataValidationResult ValidatePreloadAssets(class FDataValidationContext& Context) const;
+#endif
+};
+
+/**
+ * Tactics Asset Preloader - Asynchronously loads the default gameplay assets while the game starts up.
+ * Loads the default game mode class first, then the soft default assets it, its player controller and its HUD
+ * reference, through the Asset Manager's streamable manager. Load times are logged so startup can be tracked.
+ * Maps that override the game mode in their world settings get that game mode's assets preloaded as they're initialized.
+ */
+UCLASS()
+class TACTICS_API UTacticsAssetPreloader : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Check if all preload assets finished loading */
+	UFUNCTION(BlueprintPure, Category = "Loading")
+	bool IsPreloadComplete() const { return bPreloadComplete; }
+
+private:
+	/** Called when the default game mode class is loaded */
+	void OnGameModeLoaded();
+
+	/** Called when the preload assets are loaded */
+	void OnPreloadComplete();
+
+	/** Called when a world is initialized, to preload the assets of its game mode override */
+	void OnPostWorldInitialization(UWorld* World, const UWorld::InitializationValues IVS);
+
+	/** Collect the preload assets of a game mode class and the classes it spawns. Returns false if it isn't a game mode */
+	static bool GetGameModePreloadAssets(const UClass* GameModeClass, TArray<FSoftObjectPath>& OutAssets);
+
+	/** Keeps the game mode class loaded */
+	TSharedPtr<FStreamableHandle> GameModeHandle;
+
+	/** Keeps the preload assets loaded */
+	TSharedPtr<FStreamableHandle> PreloadHandle;
+
+	/** Keeps the assets of map game mode overrides loaded */
+	TArray<TSharedPtr<FStreamableHandle>> MapPreloadHandles;
+
+	/** Game mode classes whose assets were already requested */
+	TSet<FName> PreloadedGameModes;
+
+	/** Default game mode class path */
+	FSoftClassPath GameModeClassPath;
+
+	/** Time the preload started */
+	double PreloadStartTime = 0.0;
+
+	/** True once all preload assets are loaded */
+	bool bPreloadComplete = false;
+};
@@ -0,0 +1,51 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TacticsAutomation.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameMapsSettings.h"
+#include "Tests/AutomationCommon.h"
+
+UWorld* TacticsAutomation::FindGameWorld()
+{
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		if ((Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE) && Context.World())
+		{
+			return Context.World();
+		}
+	}
+
+	return nullptr;
+}
+
+void TacticsAutomation::OpenDefaultMapIfNeeded()
+{
+	if (!FindGameWorld())
+	{
+		AutomationOpenMap(UGameMapsSettings::GetGameDefaultMap());
+	}
+}
+
+UWorld* TacticsAutomation::CreateScratchWorld()
+{
+	// A game world type, so the world subsystems are created and initialized like in a running game
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("TacticsAutomationScratch"));
+	World->AddToRoot();
+
+	return World;
+}
+
+void TacticsAutomation::DestroyScratchWorld(UWorld* World)
+{
+	if (World)
+	{
+		World->RemoveFromRoot();
+		World->DestroyWorld(false);
+	}
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
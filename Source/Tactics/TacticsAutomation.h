@@ -0,0 +1,32 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+class UWorld;
+
+/**
+ * Helpers shared by the automation tests that run against a live game
+ */
+namespace TacticsAutomation
+{
+	/** Returns the running game or PIE world, if any */
+	UWorld* FindGameWorld();
+
+	/** Opens the default game map, unless the test runs in a game that's already going */
+	void OpenDefaultMapIfNeeded();
+
+	/**
+	 * Creates an empty world with its subsystems initialized, for tests that need systems of their own next to the game's.
+	 * It has no world context, so FindGameWorld never returns it. Destroy it with DestroyScratchWorld
+	 */
+	UWorld* CreateScratchWorld();
+
+	/** Tears down a world made by CreateScratchWorld */
+	void DestroyScratchWorld(UWorld* World);
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
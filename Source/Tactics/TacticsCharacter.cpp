@@ -3,6 +3,8 @@
 #include "TacticsCharacter.h"
 #include "DamageNumberWidget.h"
 #include "Tactics.h"
+#include "CursorCacheSubsystem.h"
+#include "TacticsMinimapSubsystem.h"
 
 // Core
 #include "Engine/World.h"
@@ -78,6 +80,12 @@ void ATacticsCharacter::BeginPlay()
 	CurrentHP = MaxHP;
 
 	// TODO: Register with HUD when HUD system is implemented
+
+	// Show up on the minimap. Player or enemy is decided by whoever controls us
+	if (UTacticsMinimapSubsystem* Minimap = GetWorld()->GetSubsystem<UTacticsMinimapSubsystem>())
+	{
+		Minimap->TrackActor(this, ETacticsMinimapMarker::Character);
+	}
 }
 
 void ATacticsCharacter::Tick(float DeltaSeconds)
@@ -414,23 +422,13 @@ void ATacticsCharacter::SpawnImpactEffect(FVector Location)
 
 FVector ATacticsCharacter::GetAttackDirection() const
 {
-	// Get player controller
-	if (APlayerController* PC = Cast<APlayerController>(GetController()))
+	// Get the cursor cache of the controlling player
+	if (UCursorCacheSubsystem* CursorCache = UCursorCacheSubsystem::Get(Cast<APlayerController>(GetController())))
 	{
-		// Get mouse cursor position in world space
-		FVector MouseWorldLocation, MouseWorldDirection;
-		if (PC->DeprojectMousePositionToWorld(MouseWorldLocation, MouseWorldDirection))
+		// Intersect the cached cursor ray with a plane at character's Z level
+		FVector IntersectionPoint;
+		if (CursorCache->GetCursorGroundLocation(GetActorLocation().Z, IntersectionPoint))
 		{
-			// Create a plane at character's Z level
-			FPlane GroundPlane(GetActorLocation(), FVector::UpVector);
-			
-			// Find intersection with ground plane
-			FVector IntersectionPoint = FMath::LinePlaneIntersection(
-				MouseWorldLocation,
-				MouseWorldLocation + MouseWorldDirection * 10000.0f,
-				GroundPlane
-			);
-			
 			// Calculate direction from character to mouse position
 			FVector AttackDirection = (IntersectionPoint - GetActorLocation()).GetSafeNormal();
 			AttackDirection.Z = 0.0f; // Keep it horizontal
@@ -3,7 +3,8 @@
 #include "TacticsGameMode.h"
 #include "TacticsPlayerController.h"
 #include "TacticsCharacter.h"
-#include "UObject/ConstructorHelpers.h"
+#include "Tactics.h"
+#include "Misc/DataValidation.h"
 
 ATacticsGameMode::ATacticsGameMode()
 {
@@ -11,27 +12,54 @@ ATacticsGameMode::ATacticsGameMode()
 	PlayerControllerClass = ATacticsPlayerController::StaticClass();
 	// TODO: HUD disabled for now - causes crash on initialization
 	// HUDClass = ATacticsHUD::StaticClass();
-	
-	// Try to load BP_TacticsCharacter first, fallback to C++ class
-	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnBPClass(TEXT("/Game/TopDown/Blueprints/BP_TacticsCharacter"));
-	if (PlayerPawnBPClass.Class != nullptr)
+
+	// Prefer BP_TacticsCharacter, resolved from the preload bundle at runtime. The C++ class is the fallback
+	DefaultPawnClass = ATacticsCharacter::StaticClass();
+	DefaultPawnClassAsset = TSoftClassPtr<APawn>(FSoftObjectPath(TEXT("/Game/TopDown/Blueprints/BP_TacticsCharacter.BP_TacticsCharacter_C")));
+}
+
+bool ATacticsGameMode::UsesDefaultPawnClassAsset() const
+{
+	// A DefaultPawnClass set in a Blueprint subclass takes precedence
+	return !DefaultPawnClassAsset.IsNull() && DefaultPawnClass == ATacticsCharacter::StaticClass();
+}
+
+void ATacticsGameMode::GetPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const
+{
+	if (UsesDefaultPawnClassAsset())
 	{
-		DefaultPawnClass = PlayerPawnBPClass.Class;
-		UE_LOG(LogTemp, Warning, TEXT("Using BP_TacticsCharacter as default pawn from TopDown/Blueprints"));
+		OutAssets.Add(DefaultPawnClassAsset.ToSoftObjectPath());
 	}
-	else
+}
+
+UClass* ATacticsGameMode::GetDefaultPawnClassForController_Implementation(AController* InController)
+{
+	if (UsesDefaultPawnClassAsset())
 	{
-		// Try alternative path
-		static ConstructorHelpers::FClassFinder<APawn> PlayerPawnBPClass2(TEXT("/Game/Characters/BP_TacticsCharacter"));
-		if (PlayerPawnBPClass2.Class != nullptr)
+		if (UClass* PawnClass = DefaultPawnClassAsset.Get())
 		{
-			DefaultPawnClass = PlayerPawnBPClass2.Class;
-			UE_LOG(LogTemp, Warning, TEXT("Using BP_TacticsCharacter as default pawn from Characters"));
+			return PawnClass;
 		}
-		else
+
+		// Log the cost of the fallback, since it stalls the game thread
+		const double LoadStartTime = FPlatformTime::Seconds();
+		UClass* PawnClass = DefaultPawnClassAsset.LoadSynchronous();
+
+		UE_LOG(LogTactics, Warning, TEXT("%s was not preloaded, loaded synchronously in %.2f ms"), *DefaultPawnClassAsset.ToString(), (FPlatformTime::Seconds() - LoadStartTime) * 1000.0);
+
+		if (PawnClass)
 		{
-			DefaultPawnClass = ATacticsCharacter::StaticClass();
-			UE_LOG(LogTemp, Warning, TEXT("Using C++ TacticsCharacter as default pawn"));
+			return PawnClass;
 		}
 	}
-}
\ No newline at end of file
+
+	return Super::GetDefaultPawnClassForController_Implementation(InController);
+}
+
+#if WITH_EDITOR
+EDataValidationResult ATacticsGameMode::IsDataValid(FDataValidationContext& Context) const
+{
+	// Catch a missing pawn Blueprint at validation and cook time instead of at runtime
+	return CombineDataValidationResults(Super::IsDataValid(Context), ValidatePreloadAssets(Context));
+}
+#endif
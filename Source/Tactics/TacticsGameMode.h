@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "TacticsAssetPreloader.h"
 #include "TacticsGameMode.generated.h"
 
 /**
@@ -12,7 +13,7 @@
  *  Check the Blueprint derived class for the set values
  */
 UCLASS(Blueprintable)
-class TACTICS_API ATacticsGameMode : public AGameModeBase
+class TACTICS_API ATacticsGameMode : public AGameModeBase, public ITacticsPreloadSource
 {
 	GENERATED_BODY()
 
@@ -20,7 +21,24 @@ public:
 
 	/** Constructor */
 	ATacticsGameMode();
-};
 
+	/** Get the default assets to preload for this game mode */
+	virtual void GetPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const override;
+
+	/** Use the preloaded default pawn Blueprint, unless a Blueprint subclass set its own DefaultPawnClass */
+	virtual UClass* GetDefaultPawnClassForController_Implementation(AController* InController) override;
+
+#if WITH_EDITOR
+	/** Validate that the default pawn Blueprint exists */
+	virtual EDataValidationResult IsDataValid(class FDataValidationContext& Context) const override;
+#endif
 
+protected:
 
+	/** Default pawn Blueprint, preloaded by UTacticsAssetPreloader. Only used while DefaultPawnClass is left at the native default */
+	UPROPERTY(EditDefaultsOnly, Category="Classes")
+	TSoftClassPtr<APawn> DefaultPawnClassAsset;
+
+	/** Check if the default pawn Blueprint is used instead of DefaultPawnClass */
+	bool UsesDefaultPawnClassAsset() const;
+};
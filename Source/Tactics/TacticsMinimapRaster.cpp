@@ -0,0 +1,222 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TacticsMinimapRaster.h"
+#include "ImageCore.h"
+#include "ImageUtils.h"
+
+void FTacticsMinimapRaster::Initialize(int32 InSize, const FBox2D& InWorldBounds)
+{
+	Size = Align(FMath::Max(InSize, TileSize), TileSize);
+	TilesPerSide = Size / TileSize;
+	WorldBounds = InWorldBounds;
+
+	// Guard against empty bounds, everything lands on the same pixel
+	const FVector2D Extent = WorldBounds.bIsValid ? WorldBounds.GetSize() : FVector2D::ZeroVector;
+	WorldToPixelScale.X = Extent.X > UE_KINDA_SMALL_NUMBER ? Size / Extent.X : 0.0f;
+	WorldToPixelScale.Y = Extent.Y > UE_KINDA_SMALL_NUMBER ? Size / Extent.Y : 0.0f;
+
+	Pixels.Init(BackgroundColor, Size * Size);
+	TileHashes.Init(0, TilesPerSide * TilesPerSide);
+	Markers.Reset();
+	DirtyTiles.Reset();
+
+	bFullRedraw = true;
+}
+
+void FTacticsMinimapRaster::SetBackgroundColor(const FColor& InColor)
+{
+	if (InColor != BackgroundColor)
+	{
+		BackgroundColor = InColor;
+		Invalidate();
+	}
+}
+
+void FTacticsMinimapRaster::Invalidate()
+{
+	bFullRedraw = true;
+}
+
+FIntPoint FTacticsMinimapRaster::WorldToPixel(const FVector2D& WorldLocation) const
+{
+	// Top down view, +X is up and +Y is right
+	const int32 Column = FMath::FloorToInt32((WorldLocation.Y - WorldBounds.Min.Y) * WorldToPixelScale.Y);
+	const int32 Row = FMath::FloorToInt32((WorldBounds.Max.X - WorldLocation.X) * WorldToPixelScale.X);
+
+	return FIntPoint(FMath::Clamp(Column, 0, Size - 1), FMath::Clamp(Row, 0, Size - 1));
+}
+
+void FTacticsMinimapRaster::AddMarker(const FVector2D& WorldLocation, const FColor& Color, int32 Radius)
+{
+	if (Size <= 0)
+	{
+		return;
+	}
+
+	// Larger markers would spread over too many tiles
+	Markers.Add({ WorldToPixel(WorldLocation), Color, FMath::Clamp(Radius, 0, TileSize) });
+}
+
+void FTacticsMinimapRaster::GetMarkerTiles(const FPixelMarker& Marker, FIntPoint& OutMin, FIntPoint& OutMax) const
+{
+	OutMin.X = FMath::Max(Marker.Center.X - Marker.Radius, 0) / TileSize;
+	OutMin.Y = FMath::Max(Marker.Center.Y - Marker.Radius, 0) / TileSize;
+	OutMax.X = FMath::Min(Marker.Center.X + Marker.Radius, Size - 1) / TileSize;
+	OutMax.Y = FMath::Min(Marker.Center.Y + Marker.Radius, Size - 1) / TileSize;
+}
+
+int32 FTacticsMinimapRaster::Rasterize()
+{
+	DirtyTiles.Reset();
+
+	if (Size <= 0)
+	{
+		return 0;
+	}
+
+	const int32 NumTiles = TilesPerSide * TilesPerSide;
+
+	// Count the markers overlapping each tile
+	TileMarkerStarts.Init(0, NumTiles + 1);
+
+	for (const FPixelMarker& Marker : Markers)
+	{
+		FIntPoint MinTile, MaxTile;
+		GetMarkerTiles(Marker, MinTile, MaxTile);
+
+		for (int32 TileY = MinTile.Y; TileY <= MaxTile.Y; ++TileY)
+		{
+			for (int32 TileX = MinTile.X; TileX <= MaxTile.X; ++TileX)
+			{
+				++TileMarkerStarts[TileY * TilesPerSide + TileX + 1];
+			}
+		}
+	}
+
+	for (int32 TileIndex = 0; TileIndex < NumTiles; ++TileIndex)
+	{
+		TileMarkerStarts[TileIndex + 1] += TileMarkerStarts[TileIndex];
+	}
+
+	// Bin the markers in draw order, and hash each tile's contents on the way
+	TileMarkers.SetNumUninitialized(TileMarkerStarts[NumTiles], EAllowShrinking::No);
+	TileCursors = TileMarkerStarts;
+	NewTileHashes.Init(0, NumTiles);
+
+	for (int32 MarkerIndex = 0; MarkerIndex < Markers.Num(); ++MarkerIndex)
+	{
+		const FPixelMarker& Marker = Markers[MarkerIndex];
+		const uint32 MarkerHash = HashCombineFast(HashCombineFast(GetTypeHash(Marker.Center), Marker.Color.DWColor()), ::GetTypeHash(Marker.Radius));
+
+		FIntPoint MinTile, MaxTile;
+		GetMarkerTiles(Marker, MinTile, MaxTile);
+
+		for (int32 TileY = MinTile.Y; TileY <= MaxTile.Y; ++TileY)
+		{
+			for (int32 TileX = MinTile.X; TileX <= MaxTile.X; ++TileX)
+			{
+				const int32 TileIndex = TileY * TilesPerSide + TileX;
+
+				TileMarkers[TileCursors[TileIndex]++] = MarkerIndex;
+				NewTileHashes[TileIndex] = HashCombineFast(NewTileHashes[TileIndex], MarkerHash);
+			}
+		}
+	}
+
+	// Only redraw the tiles whose markers changed
+	for (int32 TileIndex = 0; TileIndex < NumTiles; ++TileIndex)
+	{
+		if (bFullRedraw || NewTileHashes[TileIndex] != TileHashes[TileIndex])
+		{
+			DrawTile(TileIndex);
+			DirtyTiles.Add(TileIndex);
+		}
+	}
+
+	Swap(TileHashes, NewTileHashes);
+	bFullRedraw = false;
+
+	return DirtyTiles.Num();
+}
+
+void FTacticsMinimapRaster::DrawTile(int32 TileIndex)
+{
+	const int32 MinX = (TileIndex % TilesPerSide) * TileSize;
+	const int32 MinY = (TileIndex / TilesPerSide) * TileSize;
+	const int32 MaxX = MinX + TileSize - 1;
+	const int32 MaxY = MinY + TileSize - 1;
+
+	// Clear the tile
+	for (int32 Y = MinY; Y <= MaxY; ++Y)
+	{
+		FColor* Row = Pixels.GetData() + Y * Size;
+
+		for (int32 X = MinX; X <= MaxX; ++X)
+		{
+			Row[X] = BackgroundColor;
+		}
+	}
+
+	// Draw the markers as dots, clipped to the tile
+	for (int32 BinIndex = TileMarkerStarts[TileIndex]; BinIndex < TileMarkerStarts[TileIndex + 1]; ++BinIndex)
+	{
+		const FPixelMarker& Marker = Markers[TileMarkers[BinIndex]];
+
+		// Radius squared plus radius gives rounder small dots than radius squared alone
+		const int32 RadiusLimit = Marker.Radius * Marker.Radius + Marker.Radius;
+
+		const int32 StartY = FMath::Max(Marker.Center.Y - Marker.Radius, MinY);
+		const int32 EndY = FMath::Min(Marker.Center.Y + Marker.Radius, MaxY);
+
+		for (int32 Y = StartY; Y <= EndY; ++Y)
+		{
+			const int32 OffsetY = Y - Marker.Center.Y;
+			const int32 HalfWidth = FMath::FloorToInt32(FMath::Sqrt(static_cast<float>(RadiusLimit - OffsetY * OffsetY)));
+
+			const int32 StartX = FMath::Max(Marker.Center.X - HalfWidth, MinX);
+			const int32 EndX = FMath::Min(Marker.Center.X + HalfWidth, MaxX);
+
+			FColor* Row = Pixels.GetData() + Y * Size;
+
+			for (int32 X = StartX; X <= EndX; ++X)
+			{
+				Row[X] = Marker.Color;
+			}
+		}
+	}
+}
+
+bool FTacticsMinimapRaster::SaveImage(const FString& FileName) const
+{
+	if (Size <= 0)
+	{
+		return false;
+	}
+
+	return FImageUtils::SaveImageByExtension(*FileName, FImageView(const_cast<FColor*>(Pixels.GetData()), Size, Size));
+}
+
+bool FTacticsMinimapRaster::CompareWithImage(const FString& FileName, int32& OutMismatchedPixels) const
+{
+	OutMismatchedPixels = 0;
+
+	FImage Golden;
+
+	if (!FImageUtils::LoadImage(*FileName, Golden) || Golden.SizeX != Size || Golden.SizeY != Size)
+	{
+		return false;
+	}
+
+	Golden.ChangeFormat(ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+	const TArrayView64<FColor> GoldenPixels = Golden.AsBGRA8();
+
+	for (int32 PixelIndex = 0; PixelIndex < Pixels.Num(); ++PixelIndex)
+	{
+		if (Pixels[PixelIndex] != GoldenPixels[PixelIndex])
+		{
+			++OutMismatchedPixels;
+		}
+	}
+
+	return OutMismatchedPixels == 0;
+}
@@ -0,0 +1,118 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Minimap Raster - Draws minimap markers into a square CPU image, split in fixed size tiles.
+ * Markers are collected every update and binned into the tiles they overlap. Each tile keeps a
+ * hash of its markers, and only tiles whose hash changed are cleared and drawn again.
+ * It doesn't touch any engine objects, so its output can be checked headless against golden images.
+ */
+class TACTICS_API FTacticsMinimapRaster
+{
+public:
+	/** Width and height of a tile, in pixels */
+	static constexpr int32 TileSize = 16;
+
+	/** Set the image size, rounded up to a whole number of tiles, and the world area it covers. Marks every tile dirty */
+	void Initialize(int32 InSize, const FBox2D& InWorldBounds);
+
+	/** Set the color drawn under the markers. Marks every tile dirty */
+	void SetBackgroundColor(const FColor& InColor);
+
+	/** Clear the markers for a new update. The image keeps the last rasterized markers until Rasterize */
+	void ResetMarkers() { Markers.Reset(); }
+
+	/** Add a marker at a world location. Markers added later are drawn on top */
+	void AddMarker(const FVector2D& WorldLocation, const FColor& Color, int32 Radius);
+
+	/** Redraw the tiles whose markers changed since the last call. Returns the number of tiles redrawn */
+	int32 Rasterize();
+
+	/** Mark every tile dirty, so the next Rasterize redraws the whole image */
+	void Invalidate();
+
+	/** Convert a world location to pixel coordinates. +X points up and +Y points right. Locations outside the bounds are clamped to the edge */
+	FIntPoint WorldToPixel(const FVector2D& WorldLocation) const;
+
+	/** Image size, in pixels */
+	int32 GetSize() const { return Size; }
+
+	/** Number of tiles along each side */
+	int32 GetNumTilesPerSide() const { return TilesPerSide; }
+
+	/** World area covered by the image */
+	const FBox2D& GetWorldBounds() const { return WorldBounds; }
+
+	/** Number of markers added since the last reset */
+	int32 GetNumMarkers() const { return Markers.Num(); }
+
+	/** Image pixels, row by row */
+	const TArray<FColor>& GetPixels() const { return Pixels; }
+
+	/** Tiles redrawn by the last Rasterize, as tile indices */
+	const TArray<int32>& GetDirtyTiles() const { return DirtyTiles; }
+
+	/** Save the image as a PNG. Returns false if it couldn't be written */
+	bool SaveImage(const FString& FileName) const;
+
+	/** Compare the image with a golden image on disk. Returns false if it's missing, a different size, or any pixel differs */
+	bool CompareWithImage(const FString& FileName, int32& OutMismatchedPixels) const;
+
+private:
+	/** Marker already converted to pixel space */
+	struct FPixelMarker
+	{
+		FIntPoint Center;
+		FColor Color;
+		int32 Radius;
+	};
+
+	/** Image size, in pixels */
+	int32 Size = 0;
+
+	/** Number of tiles along each side */
+	int32 TilesPerSide = 0;
+
+	/** World area covered by the image */
+	FBox2D WorldBounds = FBox2D(ForceInit);
+
+	/** Pixels per world unit */
+	FVector2D WorldToPixelScale = FVector2D::ZeroVector;
+
+	/** Color drawn under the markers */
+	FColor BackgroundColor = FColor(16, 20, 24, 255);
+
+	/** Image pixels, row by row */
+	TArray<FColor> Pixels;
+
+	/** Markers for the next Rasterize, in draw order */
+	TArray<FPixelMarker> Markers;
+
+	/** Hash of each tile's markers at the last Rasterize */
+	TArray<uint32> TileHashes;
+
+	/** Start of each tile's markers in TileMarkers, plus one past the end */
+	TArray<int32> TileMarkerStarts;
+
+	/** Marker indices binned by tile, in draw order */
+	TArray<int32> TileMarkers;
+
+	/** Scratch hashes and fill cursors for binning */
+	TArray<uint32> NewTileHashes;
+	TArray<int32> TileCursors;
+
+	/** Tiles redrawn by the last Rasterize */
+	TArray<int32> DirtyTiles;
+
+	/** If true, every tile is redrawn on the next Rasterize regardless of its hash */
+	bool bFullRedraw = true;
+
+	/** Get the range of tiles a marker overlaps, inclusive */
+	void GetMarkerTiles(const FPixelMarker& Marker, FIntPoint& OutMin, FIntPoint& OutMax) const;
+
+	/** Clear a tile and draw its binned markers */
+	void DrawTile(int32 TileIndex);
+};
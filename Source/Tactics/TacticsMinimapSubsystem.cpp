@@ -0,0 +1,536 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TacticsMinimapSubsystem.h"
+#include "Tactics.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "Engine/LevelBounds.h"
+#include "Engine/Texture2D.h"
+#include "GameFramework/Pawn.h"
+#include "NavigationSystem.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+
+static TAutoConsoleVariable<int32> CVarMinimapSize(
+	TEXT("Tactics.Minimap.Size"),
+	256,
+	TEXT("Width and height of the minimap texture, in pixels. Rounded up to a whole number of tiles."));
+
+static TAutoConsoleVariable<float> CVarMinimapUpdateInterval(
+	TEXT("Tactics.Minimap.UpdateInterval"),
+	0.1f,
+	TEXT("Seconds between minimap updates."));
+
+/** Marker colors and radii, in pixels */
+static const FColor MinimapResourceColor(230, 190, 60);
+static const FColor MinimapEnemyColor(220, 50, 40);
+static const FColor MinimapPlayerColor(60, 220, 90);
+static constexpr int32 MinimapResourceRadius = 2;
+static constexpr int32 MinimapCharacterRadius = 2;
+static constexpr int32 MinimapPlayerRadius = 3;
+
+/** Golden test scene. Changing any of these invalidates the golden images */
+static constexpr int32 GoldenTestSize = 128;
+static constexpr int32 GoldenTestMarkers = 2000;
+static constexpr int32 GoldenTestSeed = 47;
+static constexpr int32 GoldenTestSteps = 4;
+static constexpr float GoldenTestExtent = 10000.0f;
+
+/** Minimap size setting, rounded up to a whole number of tiles */
+static int32 GetMinimapSize()
+{
+	return Align(FMath::Max(CVarMinimapSize.GetValueOnGameThread(), FTacticsMinimapRaster::TileSize), FTacticsMinimapRaster::TileSize);
+}
+
+void UTacticsMinimapSubsystem::TrackActor(AActor* Actor, ETacticsMinimapMarker Type)
+{
+	if (!IsValid(Actor))
+	{
+		return;
+	}
+
+	// Re-registering only updates the marker kind
+	for (FTrackedActor& Entry : TrackedActors)
+	{
+		if (Entry.Actor.Get() == Actor)
+		{
+			Entry.Type = Type;
+			return;
+		}
+	}
+
+	TrackedActors.Add({ Actor, Type });
+}
+
+void UTacticsMinimapSubsystem::SetWorldBounds(const FBox2D& Bounds)
+{
+	// Square up the bounds so markers aren't stretched
+	const FVector2D Center = Bounds.GetCenter();
+	const FVector2D HalfExtent(Bounds.GetExtent().GetMax());
+
+	Raster.Initialize(GetMinimapSize(), FBox2D(Center - HalfExtent, Center + HalfExtent));
+	EnsureTexture();
+}
+
+void UTacticsMinimapSubsystem::EnsureTexture()
+{
+	// Headless builds only keep the raster
+	if (!FApp::CanEverRender())
+	{
+		return;
+	}
+
+	const int32 Size = Raster.GetSize();
+
+	if (Texture && Texture->GetSizeX() == Size)
+	{
+		return;
+	}
+
+	Texture = UTexture2D::CreateTransient(Size, Size, PF_B8G8R8A8, TEXT("TacticsMinimap"));
+
+	if (Texture)
+	{
+		Texture->Filter = TF_Nearest;
+		Texture->SRGB = true;
+		Texture->AddressX = TA_Clamp;
+		Texture->AddressY = TA_Clamp;
+		Texture->UpdateResource();
+
+		// The new texture needs every tile
+		Raster.Invalidate();
+	}
+}
+
+void UTacticsMinimapSubsystem::UpdateMinimap()
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_TacticsMinimapSubsystem_UpdateMinimap);
+
+	// Pick up size changes
+	if (GetMinimapSize() != Raster.GetSize())
+	{
+		Raster.Initialize(GetMinimapSize(), Raster.GetWorldBounds());
+		EnsureTexture();
+	}
+
+	TrackedActors.RemoveAll([](const FTrackedActor& Entry) { return !Entry.Actor.IsValid(); });
+
+	// Resources at the bottom, then other systems' markers, then characters on top
+	const double StartTime = FPlatformTime::Seconds();
+
+	Raster.ResetMarkers();
+	AddTrackedMarkers(ETacticsMinimapMarker::Resource);
+	OnGatherMarkers.Broadcast(Raster);
+	AddTrackedMarkers(ETacticsMinimapMarker::Character);
+
+	const int32 NumDirtyTiles = Raster.Rasterize();
+
+	RasterStats.AddSample((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	++NumUpdates;
+
+	if (NumDirtyTiles > 0 && Texture)
+	{
+		UploadDirtyTiles();
+
+		++NumUploads;
+		NumUploadedTiles += NumDirtyTiles;
+	}
+}
+
+void UTacticsMinimapSubsystem::AddTrackedMarkers(ETacticsMinimapMarker Type)
+{
+	// Player characters go on top of everything else
+	TArray<const AActor*, TInlineAllocator<4>> PlayerActors;
+
+	for (const FTrackedActor& Entry : TrackedActors)
+	{
+		const AActor* Actor = Entry.Actor.Get();
+
+		if (Entry.Type != Type || !Actor || Actor->IsHidden())
+		{
+			continue;
+		}
+
+		const FVector2D Location(Actor->GetActorLocation());
+
+		if (Type == ETacticsMinimapMarker::Resource)
+		{
+			Raster.AddMarker(Location, MinimapResourceColor, MinimapResourceRadius);
+		}
+		else if (const APawn* Pawn = Cast<APawn>(Actor); Pawn && Pawn->IsPlayerControlled())
+		{
+			PlayerActors.Add(Actor);
+		}
+		else
+		{
+			Raster.AddMarker(Location, MinimapEnemyColor, MinimapCharacterRadius);
+		}
+	}
+
+	for (const AActor* Actor : PlayerActors)
+	{
+		Raster.AddMarker(FVector2D(Actor->GetActorLocation()), MinimapPlayerColor, MinimapPlayerRadius);
+	}
+}
+
+void UTacticsMinimapSubsystem::UploadDirtyTiles()
+{
+	const TArray<int32>& DirtyTiles = Raster.GetDirtyTiles();
+
+	if (DirtyTiles.Num() == 0)
+	{
+		return;
+	}
+
+	const int32 Size = Raster.GetSize();
+	const int32 TilesPerSide = Raster.GetNumTilesPerSide();
+	const int32 TileSize = FTacticsMinimapRaster::TileSize;
+
+	// Only copy the band of rows holding dirty tiles. Dirty tiles are sorted, so it spans the first to the last
+	const int32 BandStart = (DirtyTiles[0] / TilesPerSide) * TileSize;
+	const int32 BandEnd = (DirtyTiles.Last() / TilesPerSide + 1) * TileSize;
+	const uint32 Pitch = Size * sizeof(FColor);
+
+	// Merge runs of dirty tiles along a tile row into a single region
+	TArray<FUpdateTextureRegion2D> Regions;
+
+	for (int32 Index = 0; Index < DirtyTiles.Num(); ++Index)
+	{
+		const int32 FirstTile = DirtyTiles[Index];
+		int32 LastTile = FirstTile;
+
+		while (Index + 1 < DirtyTiles.Num() && DirtyTiles[Index + 1] == LastTile + 1 && (LastTile + 1) % TilesPerSide != 0)
+		{
+			++LastTile;
+			++Index;
+		}
+
+		const int32 X = (FirstTile % TilesPerSide) * TileSize;
+		const int32 Y = (FirstTile / TilesPerSide) * TileSize;
+
+		Regions.Emplace(X, Y, X, Y - BandStart, (LastTile - FirstTile + 1) * TileSize, TileSize);
+	}
+
+	// The render thread reads the data later, so it gets its own copy
+	const SIZE_T BandBytes = static_cast<SIZE_T>(BandEnd - BandStart) * Pitch;
+	uint8* SrcData = static_cast<uint8*>(FMemory::Malloc(BandBytes));
+	FMemory::Memcpy(SrcData, Raster.GetPixels().GetData() + BandStart * Size, BandBytes);
+
+	FUpdateTextureRegion2D* RegionData = new FUpdateTextureRegion2D[Regions.Num()];
+	FMemory::Memcpy(RegionData, Regions.GetData(), Regions.Num() * sizeof(FUpdateTextureRegion2D));
+
+	Texture->UpdateTextureRegions(0, Regions.Num(), RegionData, Pitch, sizeof(FColor), SrcData,
+		[](uint8* InSrcData, const FUpdateTextureRegion2D* InRegions)
+		{
+			FMemory::Free(InSrcData);
+			delete[] InRegions;
+		});
+}
+
+void UTacticsMinimapSubsystem::DumpStats() const
+{
+	const FBox2D& Bounds = Raster.GetWorldBounds();
+
+	UE_LOG(LogTactics, Display, TEXT("Minimap: %dx%d px, %d tiles, bounds %s - %s, %d tracked actors, %d markers"),
+		Raster.GetSize(), Raster.GetSize(), Raster.GetNumTilesPerSide() * Raster.GetNumTilesPerSide(),
+		*Bounds.Min.ToString(), *Bounds.Max.ToString(), TrackedActors.Num(), Raster.GetNumMarkers());
+
+	UE_LOG(LogTactics, Display, TEXT("Minimap: %d updates, %d uploads, %.1f tiles per upload. Raster mean %.3f ms, p99 %.3f ms, max %.3f ms"),
+		NumUpdates, NumUploads, NumUploads > 0 ? static_cast<double>(NumUploadedTiles) / NumUploads : 0.0,
+		RasterStats.GetMean(), RasterStats.GetPercentile(99.0f), RasterStats.MaxMs);
+}
+
+bool UTacticsMinimapSubsystem::RunGoldenTest(bool bUpdateGoldens, int32* OutNumMissingGoldens)
+{
+	int32 NumMissingGoldens = 0;
+
+	const FString GoldenDir = FPaths::ProjectDir() / TEXT("Tests/Minimap");
+	const FString OutputDir = FPaths::ProjectSavedDir() / TEXT("Minimap");
+	const FBox2D Bounds(FVector2D(-GoldenTestExtent), FVector2D(GoldenTestExtent));
+
+	// Fixed scene, so the golden images stay valid
+	FRandomStream Random(GoldenTestSeed);
+
+	TArray<FVector2D> Locations;
+	TArray<FColor> Colors;
+
+	for (int32 Index = 0; Index < GoldenTestMarkers; ++Index)
+	{
+		Locations.Add(FVector2D(Random.FRandRange(-GoldenTestExtent, GoldenTestExtent), Random.FRandRange(-GoldenTestExtent, GoldenTestExtent)));
+		Colors.Add(Index % 4 == 0 ? MinimapEnemyColor : MinimapPlayerColor);
+	}
+
+	const auto AddMarkers = [&Locations, &Colors](FTacticsMinimapRaster& Target)
+	{
+		Target.ResetMarkers();
+
+		for (int32 Index = 0; Index < Locations.Num(); ++Index)
+		{
+			Target.AddMarker(Locations[Index], Colors[Index], Index % 8 == 0 ? MinimapResourceRadius : 1);
+		}
+	};
+
+	FTacticsMinimapRaster Incremental;
+	Incremental.Initialize(GoldenTestSize, Bounds);
+
+	const int32 NumTiles = Incremental.GetNumTilesPerSide() * Incremental.GetNumTilesPerSide();
+	bool bPassed = true;
+
+	for (int32 Step = 0; Step < GoldenTestSteps; ++Step)
+	{
+		// Step 0 draws everything, step 1 moves a few markers, step 2 removes a quarter of them and step 3 changes nothing
+		if (Step == 1)
+		{
+			for (int32 Index = 0; Index < Locations.Num(); Index += 50)
+			{
+				Locations[Index] += FVector2D(300.0f, -300.0f);
+			}
+		}
+		else if (Step == 2)
+		{
+			Locations.SetNum(Locations.Num() * 3 / 4);
+		}
+
+		AddMarkers(Incremental);
+		const int32 NumDirtyTiles = Incremental.Rasterize();
+
+		// The incremental image has to match a full redraw of the same markers
+		FTacticsMinimapRaster Full;
+		Full.Initialize(GoldenTestSize, Bounds);
+		AddMarkers(Full);
+		Full.Rasterize();
+
+		const bool bMatchesFull = Incremental.GetPixels() == Full.GetPixels();
+
+		// Only the first step may redraw everything, and nothing changes in the last one
+		const bool bDirtyTilesOk = (Step == 0) || (Step == GoldenTestSteps - 1 ? NumDirtyTiles == 0 : NumDirtyTiles < NumTiles);
+
+		const FString GoldenFile = GoldenDir / FString::Printf(TEXT("Minimap_%d.png"), Step);
+		int32 MismatchedPixels = 0;
+		bool bMatchesGolden = false;
+
+		if (bUpdateGoldens)
+		{
+			bMatchesGolden = Incremental.SaveImage(GoldenFile);
+		}
+		else if (!IFileManager::Get().FileExists(*GoldenFile))
+		{
+			// The goldens have to come from the engine's own raster, so they're written in-engine with Tactics.Minimap.UpdateGoldens
+			UE_LOG(LogTactics, Warning, TEXT("Minimap test step %d: no golden image at %s, skipping the comparison. Run Tactics.Minimap.UpdateGoldens in-engine to write it"), Step, *GoldenFile);
+
+			++NumMissingGoldens;
+			bMatchesGolden = true;
+		}
+		else
+		{
+			bMatchesGolden = Incremental.CompareWithImage(GoldenFile, MismatchedPixels);
+
+			// Keep the failed image around for comparison
+			if (!bMatchesGolden)
+			{
+				Incremental.SaveImage(OutputDir / FString::Printf(TEXT("Minimap_%d_Actual.png"), Step));
+			}
+		}
+
+		UE_LOG(LogTactics, Display, TEXT("Minimap test step %d: %d markers, %d of %d tiles redrawn. Full redraw %s, golden %s (%d pixels differ)"),
+			Step, Locations.Num(), NumDirtyTiles, NumTiles, bMatchesFull ? TEXT("matches") : TEXT("DIFFERS"),
+			bUpdateGoldens ? (bMatchesGolden ? TEXT("written") : TEXT("NOT WRITTEN")) : (bMatchesGolden ? TEXT("matches") : TEXT("DIFFERS")), MismatchedPixels);
+
+		bPassed &= bMatchesFull && bDirtyTilesOk && bMatchesGolden;
+	}
+
+	UE_LOG(LogTactics, Display, TEXT("Minimap test %s. Golden images in %s"), bPassed ? TEXT("PASSED") : TEXT("FAILED"), *GoldenDir);
+
+	if (OutNumMissingGoldens)
+	{
+		*OutNumMissingGoldens = NumMissingGoldens;
+	}
+
+	return bPassed;
+}
+
+void UTacticsMinimapSubsystem::RunBenchmark(int32 NumMarkers, int32 NumIterations)
+{
+	if (NumMarkers <= 0 || NumIterations <= 0)
+	{
+		return;
+	}
+
+	const float Extent = 50000.0f;
+	FRandomStream Random(GoldenTestSeed);
+
+	TArray<FVector2D> Locations;
+
+	for (int32 Index = 0; Index < NumMarkers; ++Index)
+	{
+		Locations.Add(FVector2D(Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent)));
+	}
+
+	FTacticsMinimapRaster Bench;
+	Bench.Initialize(GetMinimapSize(), FBox2D(FVector2D(-Extent), FVector2D(Extent)));
+
+	// Time a full update, adding the markers included
+	const auto TimeUpdate = [&Bench, &Locations](int32& OutDirtyTiles)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		Bench.ResetMarkers();
+
+		for (const FVector2D& Location : Locations)
+		{
+			Bench.AddMarker(Location, MinimapPlayerColor, 1);
+		}
+
+		OutDirtyTiles = Bench.Rasterize();
+
+		return static_cast<float>((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	};
+
+	// Every pass moves one in MoveEvery markers each update
+	const auto RunPass = [&](int32 MoveEvery, FTimingStats& OutStats, double& OutTilesPerUpdate)
+	{
+		int64 TotalDirtyTiles = 0;
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			for (int32 Index = Iteration % MoveEvery; Index < Locations.Num(); Index += MoveEvery)
+			{
+				Locations[Index] += FVector2D(Random.FRandRange(-200.0f, 200.0f), Random.FRandRange(-200.0f, 200.0f));
+			}
+
+			int32 NumDirtyTiles = 0;
+			OutStats.AddSample(TimeUpdate(NumDirtyTiles));
+			TotalDirtyTiles += NumDirtyTiles;
+		}
+
+		OutTilesPerUpdate = static_cast<double>(TotalDirtyTiles) / NumIterations;
+	};
+
+	int32 InitialDirtyTiles = 0;
+	const float InitialMs = TimeUpdate(InitialDirtyTiles);
+
+	FTimingStats SomeMovingStats;
+	double SomeMovingTiles = 0.0;
+	RunPass(10, SomeMovingStats, SomeMovingTiles);
+
+	FTimingStats AllMovingStats;
+	double AllMovingTiles = 0.0;
+	RunPass(1, AllMovingStats, AllMovingTiles);
+
+	UE_LOG(LogTactics, Display, TEXT("Minimap, %d markers at %d px: initial %.3f ms (%d tiles)"), NumMarkers, Bench.GetSize(), InitialMs, InitialDirtyTiles);
+
+	UE_LOG(LogTactics, Display, TEXT("Minimap, 10%% moving: mean %.3f ms, p99 %.3f ms, %.1f tiles per update. All moving: mean %.3f ms, p99 %.3f ms, %.1f tiles per update"),
+		SomeMovingStats.GetMean(), SomeMovingStats.GetPercentile(99.0f), SomeMovingTiles,
+		AllMovingStats.GetMean(), AllMovingStats.GetPercentile(99.0f), AllMovingTiles);
+}
+
+void UTacticsMinimapSubsystem::Tick(float DeltaTime)
+{
+	if (!bStarted)
+	{
+		return;
+	}
+
+	TimeSinceUpdate += DeltaTime;
+
+	if (TimeSinceUpdate < CVarMinimapUpdateInterval.GetValueOnGameThread())
+	{
+		return;
+	}
+
+	TimeSinceUpdate = 0.0f;
+	UpdateMinimap();
+}
+
+TStatId UTacticsMinimapSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTacticsMinimapSubsystem, STATGROUP_Tickables);
+}
+
+void UTacticsMinimapSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Cover the navigable area, or the whole level if there's no navigation
+	FBox Bounds(ForceInit);
+
+	if (const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(&InWorld))
+	{
+		for (const FNavigationBounds& NavBounds : NavSys->GetNavigationBounds())
+		{
+			Bounds += NavBounds.AreaBox;
+		}
+	}
+
+	if (!Bounds.IsValid && InWorld.PersistentLevel)
+	{
+		Bounds = ALevelBounds::CalculateLevelBounds(InWorld.PersistentLevel);
+	}
+
+	SetWorldBounds(Bounds.IsValid ? FBox2D(FVector2D(Bounds.Min), FVector2D(Bounds.Max)) : FBox2D(FVector2D(-10000.0f), FVector2D(10000.0f)));
+
+	bStarted = true;
+}
+
+void UTacticsMinimapSubsystem::Deinitialize()
+{
+	OnGatherMarkers.Clear();
+	TrackedActors.Reset();
+	Texture = nullptr;
+	bStarted = false;
+
+	Super::Deinitialize();
+}
+
+static FAutoConsoleCommandWithWorldAndArgs MinimapDumpCommand(
+	TEXT("Tactics.Minimap.Dump"),
+	TEXT("Logs the minimap stats."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UTacticsMinimapSubsystem* Minimap = World ? World->GetSubsystem<UTacticsMinimapSubsystem>() : nullptr)
+		{
+			Minimap->DumpStats();
+		}
+	}));
+
+static FAutoConsoleCommand MinimapUpdateGoldensCommand(
+	TEXT("Tactics.Minimap.UpdateGoldens"),
+	TEXT("Rewrites the golden images in Tests/Minimap from the current minimap raster. Only needed after an intended change to the raster or the test scene."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		UTacticsMinimapSubsystem::RunGoldenTest(true);
+	}));
+
+static FAutoConsoleCommand MinimapBenchmarkCommand(
+	TEXT("Tactics.Minimap.Benchmark"),
+	TEXT("Times minimap updates with placeholder markers, with a tenth and then all of them moving every update. Usage: Tactics.Minimap.Benchmark [Markers] [Iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumMarkers = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 5000;
+		const int32 NumIterations = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 100;
+
+		UTacticsMinimapSubsystem::RunBenchmark(NumMarkers, NumIterations);
+	}));
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinimapGoldenTest, "Tactics.Minimap.Golden", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMinimapGoldenTest::RunTest(const FString& Parameters)
+{
+	// The raster doesn't need a world, so this runs the same in editor, game and headless builds
+	int32 NumMissingGoldens = 0;
+	const bool bPassed = UTacticsMinimapSubsystem::RunGoldenTest(false, &NumMissingGoldens);
+
+	if (NumMissingGoldens > 0)
+	{
+		AddWarning(FString::Printf(TEXT("%d golden images are missing from Tests/Minimap, so only the full redraw comparison ran. Write them in-engine with Tactics.Minimap.UpdateGoldens"), NumMissingGoldens));
+	}
+
+	return TestTrue(TEXT("Every step matches a full redraw and the golden images in Tests/Minimap"), bPassed);
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,120 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TacticsMinimapRaster.h"
+#include "TimingStats.h"
+#include "TacticsMinimapSubsystem.generated.h"
+
+class UTexture2D;
+
+/**
+ * Kinds of actors tracked by the minimap
+ */
+enum class ETacticsMinimapMarker : uint8
+{
+	/** Player or enemy character, picked by whoever controls it */
+	Character,
+
+	/** Resource node */
+	Resource
+};
+
+/** Delegate to let other systems add their markers to a minimap update */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnGatherMinimapMarkersDelegate, FTacticsMinimapRaster& /* Raster */);
+
+/**
+ * Minimap Subsystem - Draws a minimap of the tracked actors and registry markers without a scene capture.
+ * Markers are rasterized on the CPU into a small texture at a fixed rate. Only the tiles whose markers
+ * changed are redrawn, and they are uploaded together with a single texture update.
+ * Actors register themselves with TrackActor. Systems with their own registries, like the strategy
+ * unit registry, add their markers through OnGatherMarkers.
+ * The Tactics.Minimap.Golden automation test checks the raster against golden images, so it can run in headless builds.
+ */
+UCLASS()
+class TACTICS_API UTacticsMinimapSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Start drawing an actor on the minimap. Destroyed actors are dropped automatically */
+	void TrackActor(AActor* Actor, ETacticsMinimapMarker Type);
+
+	/** Set the world area shown by the minimap. It's squared up around its center */
+	void SetWorldBounds(const FBox2D& Bounds);
+
+	/** Gather the markers, redraw the dirty tiles and upload them */
+	void UpdateMinimap();
+
+	/** Returns the minimap texture, or nullptr in headless builds */
+	UFUNCTION(BlueprintPure, Category = "Minimap")
+	UTexture2D* GetTexture() const { return Texture; }
+
+	/** Called on every update to collect markers from other systems. Drawn above resources and below characters */
+	FOnGatherMinimapMarkersDelegate OnGatherMarkers;
+
+	/** Log the minimap stats */
+	void DumpStats() const;
+
+	/**
+	 * Rasterize a fixed scene in several steps and compare every step with a full redraw and with the golden images. Returns false if any step fails.
+	 * Steps without a golden image skip that comparison and are counted in OutNumMissingGoldens
+	 */
+	static bool RunGoldenTest(bool bUpdateGoldens, int32* OutNumMissingGoldens = nullptr);
+
+	/** Time rasterizing placeholder markers with part or all of them moving every update */
+	static void RunBenchmark(int32 NumMarkers, int32 NumIterations);
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// UWorldSubsystem interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+private:
+	/** Tracked actor and its marker kind */
+	struct FTrackedActor
+	{
+		TWeakObjectPtr<AActor> Actor;
+		ETacticsMinimapMarker Type = ETacticsMinimapMarker::Character;
+	};
+
+	/** Raster holding the minimap image */
+	FTacticsMinimapRaster Raster;
+
+	/** Texture the raster is uploaded to */
+	UPROPERTY(Transient)
+	TObjectPtr<UTexture2D> Texture;
+
+	/** Actors drawn on the minimap */
+	TArray<FTrackedActor> TrackedActors;
+
+	/** Time since the last update */
+	float TimeSinceUpdate = 0.0f;
+
+	/** True once the world has begun play */
+	bool bStarted = false;
+
+	/** Marker gathering and rasterize times, in milliseconds */
+	FTimingStats RasterStats;
+
+	/** Number of updates and texture uploads, and the tiles uploaded */
+	int32 NumUpdates = 0;
+	int32 NumUploads = 0;
+	int64 NumUploadedTiles = 0;
+
+	/** Create the texture, or recreate it if the raster changed size */
+	void EnsureTexture();
+
+	/** Add the markers of the tracked actors of one kind */
+	void AddTrackedMarkers(ETacticsMinimapMarker Type);
+
+	/** Copy the dirty tiles to the texture in one update */
+	void UploadDirtyTiles();
+};
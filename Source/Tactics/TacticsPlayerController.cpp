@@ -3,17 +3,23 @@
 #include "TacticsPlayerController.h"
 #include "PlayerHUDWidget.h"
 #include "GameFramework/Pawn.h"
-#include "Blueprint/AIBlueprintHelperLibrary.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "NavFilters/NavigationQueryFilter.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "AITypes.h"
 #include "NiagaraSystem.h"
 #include "NiagaraFunctionLibrary.h"
 #include "TacticsCharacter.h"
+#include "CursorCacheSubsystem.h"
+#include "InputLatencySubsystem.h"
 #include "Engine/World.h"
 #include "EnhancedInputComponent.h"
 #include "InputActionValue.h"
 #include "EnhancedInputSubsystems.h"
 #include "InputAction.h"
 #include "InputMappingContext.h"
-#include "UObject/ConstructorHelpers.h"
+#include "Misc/DataValidation.h"
 #include "Engine/LocalPlayer.h"
 #include "Tactics.h"
 #include "Blueprint/UserWidget.h"
@@ -29,69 +35,52 @@ ATacticsPlayerController::ATacticsPlayerController()
 	CachedDestination = FVector::ZeroVector;
 	FollowTime = 0.f;
 
-	// Fallback: Auto-load input assets if not set via Blueprint
-	// Mapping Context - try both old and new
-	if (!DefaultMappingContext)
-	{
-		static ConstructorHelpers::FObjectFinder<UInputMappingContext> IMC_New(TEXT("/Game/TopDown/Input/IMC_TacticsDefault.IMC_TacticsDefault"));
-		if (IMC_New.Succeeded())
-		{
-			DefaultMappingContext = IMC_New.Object;
-			UE_LOG(LogTactics, Warning, TEXT("Loaded IMC_TacticsDefault successfully"));
-		}
-		else
-		{
-			// Fallback to original
-			static ConstructorHelpers::FObjectFinder<UInputMappingContext> IMC_Old(TEXT("/Game/TopDown/Input/IMC_Default.IMC_Default"));
-			if (IMC_Old.Succeeded())
-			{
-				DefaultMappingContext = IMC_Old.Object;
-				UE_LOG(LogTactics, Warning, TEXT("Loaded IMC_Default as fallback"));
-			}
-			else
-			{
-				UE_LOG(LogTactics, Error, TEXT("Failed to load both IMC_TacticsDefault and IMC_Default"));
-			}
-		}
-	}
+	// Default input assets. These are soft references preloaded by UTacticsAssetPreloader,
+	// only used if the Blueprint doesn't set the input properties directly
+	DefaultMappingContextAsset = TSoftObjectPtr<UInputMappingContext>(FSoftObjectPath(TEXT("/Game/TopDown/Input/IMC_TacticsDefault.IMC_TacticsDefault")));
+	SetDestinationClickActionAsset = TSoftObjectPtr<UInputAction>(FSoftObjectPath(TEXT("/Game/TopDown/Input/Actions/IA_SetDestination_Click.IA_SetDestination_Click")));
+	SetDestinationTouchActionAsset = TSoftObjectPtr<UInputAction>(FSoftObjectPath(TEXT("/Game/TopDown/Input/Actions/IA_SetDestination_Touch.IA_SetDestination_Touch")));
+	MoveActionAsset = TSoftObjectPtr<UInputAction>(FSoftObjectPath(TEXT("/Game/TopDown/Input/Actions/IA_Move.IA_Move")));
+	AttackActionAsset = TSoftObjectPtr<UInputAction>(FSoftObjectPath(TEXT("/Game/TopDown/Input/Actions/IA_Attack.IA_Attack")));
+}
 
-	// Click/Touch actions (from template)
-	if (!SetDestinationClickAction)
+/** Returns an asset set on a property, or resolves its soft default. Assets should be preloaded, a sync load here is a hitch */
+template<typename T>
+static T* ResolveInputAsset(T* Asset, const TSoftObjectPtr<T>& DefaultAsset)
+{
+	if (Asset || DefaultAsset.IsNull())
 	{
-		static ConstructorHelpers::FObjectFinder<UInputAction> IA_Click(TEXT("/Game/TopDown/Input/Actions/IA_SetDestination_Click.IA_SetDestination_Click"));
-		if (IA_Click.Succeeded())
-		{
-			SetDestinationClickAction = IA_Click.Object;
-		}
-	}
-	if (!SetDestinationTouchAction)
-	{
-		static ConstructorHelpers::FObjectFinder<UInputAction> IA_Touch(TEXT("/Game/TopDown/Input/Actions/IA_SetDestination_Touch.IA_SetDestination_Touch"));
-		if (IA_Touch.Succeeded())
-		{
-			SetDestinationTouchAction = IA_Touch.Object;
-		}
+		return Asset;
 	}
 
-	// New actions (WASD move & attack)
-	if (!MoveAction)
+	if (T* Loaded = DefaultAsset.Get())
 	{
-		static ConstructorHelpers::FObjectFinder<UInputAction> IA_Move(TEXT("/Game/TopDown/Input/Actions/IA_Move.IA_Move"));
-		if (IA_Move.Succeeded())
-		{
-			MoveAction = IA_Move.Object;
-		}
+		return Loaded;
 	}
-	if (!AttackAction)
+
+	UE_LOG(LogTactics, Warning, TEXT("%s was not preloaded, loading synchronously"), *DefaultAsset.ToString());
+	return DefaultAsset.LoadSynchronous();
+}
+
+void ATacticsPlayerController::GetPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const
+{
+	for (const FSoftObjectPath& Path : { DefaultMappingContextAsset.ToSoftObjectPath(), SetDestinationClickActionAsset.ToSoftObjectPath(), SetDestinationTouchActionAsset.ToSoftObjectPath(), MoveActionAsset.ToSoftObjectPath(), AttackActionAsset.ToSoftObjectPath() })
 	{
-		static ConstructorHelpers::FObjectFinder<UInputAction> IA_Attack(TEXT("/Game/TopDown/Input/Actions/IA_Attack.IA_Attack"));
-		if (IA_Attack.Succeeded())
+		if (!Path.IsNull())
 		{
-			AttackAction = IA_Attack.Object;
+			OutAssets.Add(Path);
 		}
 	}
 }
 
+#if WITH_EDITOR
+EDataValidationResult ATacticsPlayerController::IsDataValid(FDataValidationContext& Context) const
+{
+	// Catch missing default input assets at validation and cook time instead of at runtime
+	return CombineDataValidationResults(Super::IsDataValid(Context), ValidatePreloadAssets(Context));
+}
+#endif
+
 void ATacticsPlayerController::SetupInputComponent()
 {
 	UE_LOG(LogTactics, Warning, TEXT("SetupInputComponent called for %s"), *GetNameSafe(this));
@@ -102,6 +91,13 @@ void ATacticsPlayerController::SetupInputComponent()
 	// Only set up input on local player controllers
 	if (IsLocalPlayerController())
 	{
+		// Fill in any input assets the Blueprint didn't set from the preloaded defaults
+		DefaultMappingContext = ResolveInputAsset(DefaultMappingContext, DefaultMappingContextAsset);
+		SetDestinationClickAction = ResolveInputAsset(SetDestinationClickAction, SetDestinationClickActionAsset);
+		SetDestinationTouchAction = ResolveInputAsset(SetDestinationTouchAction, SetDestinationTouchActionAsset);
+		MoveAction = ResolveInputAsset(MoveAction, MoveActionAsset);
+		AttackAction = ResolveInputAsset(AttackAction, AttackActionAsset);
+
 		UE_LOG(LogTactics, Warning, TEXT("Is Local Player Controller - setting up input"));
 		UE_LOG(LogTactics, Warning, TEXT("DefaultMappingContext: %s"), DefaultMappingContext ? TEXT("Valid") : TEXT("NULL"));
 		UE_LOG(LogTactics, Warning, TEXT("AttackAction: %s"), AttackAction ? TEXT("Valid") : TEXT("NULL"));
@@ -193,6 +189,13 @@ void ATacticsPlayerController::BeginPlay()
 	{
 		UE_LOG(LogTactics, Warning, TEXT("HUDWidgetClass not set in PlayerController!"));
 	}
+
+	// Let the latency check inject synthetic movement and attacks
+	if (UInputLatencySubsystem* Latency = GetWorld()->GetSubsystem<UInputLatencySubsystem>())
+	{
+		Latency->RegisterInjectableAction(this, MoveAction, FInputActionValue(FVector2D(0.0f, 1.0f)));
+		Latency->RegisterInjectableAction(this, AttackAction, FInputActionValue(true));
+	}
 }
 
 void ATacticsPlayerController::OnPossess(APawn* InPawn)
@@ -204,6 +207,7 @@ void ATacticsPlayerController::OnPossess(APawn* InPawn)
 
 void ATacticsPlayerController::OnInputStarted()
 {
+	CancelPathRequest();
 	StopMovement();
 }
 
@@ -211,6 +215,11 @@ void ATacticsPlayerController::OnSetDestinationTriggered()
 {
 	// We flag that the input is being pressed
 	FollowTime += GetWorld()->GetDeltaSeconds();
+
+	if (UInputLatencySubsystem* Latency = GetWorld()->GetSubsystem<UInputLatencySubsystem>())
+	{
+		Latency->MarkInput(bIsTouch ? SetDestinationTouchAction : SetDestinationClickAction, GetPawn());
+	}
 	
 	// We look for the location in the world where the player has pressed the input
 	FHitResult Hit;
@@ -219,9 +228,9 @@ void ATacticsPlayerController::OnSetDestinationTriggered()
 	{
 		bHitSuccessful = GetHitResultUnderFinger(ETouchIndex::Touch1, ECollisionChannel::ECC_Visibility, true, Hit);
 	}
-	else
+	else if (UCursorCacheSubsystem* CursorCache = UCursorCacheSubsystem::Get(this))
 	{
-		bHitSuccessful = GetHitResultUnderCursor(ECollisionChannel::ECC_Visibility, true, Hit);
+		bHitSuccessful = CursorCache->GetCursorHit(ECollisionChannel::ECC_Visibility, Hit);
 	}
 
 	// If we hit a surface, cache the location
@@ -230,9 +239,18 @@ void ATacticsPlayerController::OnSetDestinationTriggered()
 		CachedDestination = Hit.Location;
 	}
 	
-	// Move towards mouse pointer or touch
+	// Keep re-planning towards the held pointer, throttled so holding doesn't flood the navmesh
+	const float Now = GetWorld()->GetTimeSeconds();
+	if (bHitSuccessful && (LastPathRequestTime < 0.0f || Now - LastPathRequestTime >= HeldPathRequestInterval))
+	{
+		RequestPathTo(CachedDestination);
+	}
+
+	// Steer straight towards the pointer until the first path comes back
 	APawn* ControlledPawn = GetPawn();
-	if (ControlledPawn != nullptr)
+	UPathFollowingComponent* PathFollowing = FindComponentByClass<UPathFollowingComponent>();
+
+	if (ControlledPawn != nullptr && (!PathFollowing || PathFollowing->GetStatus() != EPathFollowingStatus::Moving))
 	{
 		FVector WorldDirection = (CachedDestination - ControlledPawn->GetActorLocation()).GetSafeNormal();
 		ControlledPawn->AddMovementInput(WorldDirection, 1.0, false);
@@ -245,11 +263,19 @@ void ATacticsPlayerController::OnSetDestinationReleased()
 	if (FollowTime <= ShortPressThreshold)
 	{
 		// We move there and spawn some particles
-		UAIBlueprintHelperLibrary::SimpleMoveToLocation(this, CachedDestination);
+		RequestPathTo(CachedDestination);
 		UNiagaraFunctionLibrary::SpawnSystemAtLocation(this, FXCursor, CachedDestination, FRotator::ZeroRotator, FVector(1.f, 1.f, 1.f), true, true, ENCPoolMethod::None, true);
 	}
 
+	else
+	{
+		// Long presses only move while held
+		CancelPathRequest();
+		StopMovement();
+	}
+
 	FollowTime = 0.f;
+	LastPathRequestTime = -1.0f;
 }
 
 // Triggered every frame when the input is held down
@@ -274,6 +300,12 @@ void ATacticsPlayerController::OnMoveTriggered(const FInputActionValue& Value)
 	APawn* ControlledPawn = GetPawn();
 	if (ControlledPawn != nullptr)
 	{
+		// Time the input until the pawn starts moving
+		if (UInputLatencySubsystem* Latency = GetWorld()->GetSubsystem<UInputLatencySubsystem>())
+		{
+			Latency->MarkInput(MoveAction, ControlledPawn);
+		}
+
 		// Calculate movement direction based on camera rotation
 		const FRotator YawRotation(0.0f, GetControlRotation().Yaw, 0.0f);
 		
@@ -295,6 +327,12 @@ void ATacticsPlayerController::OnAttackTriggered()
 	// Get the controlled character and perform attack
 	if (ATacticsCharacter* ControlledCharacter = Cast<ATacticsCharacter>(GetPawn()))
 	{
+		// Time the input until the attack montage starts
+		if (UInputLatencySubsystem* Latency = GetWorld()->GetSubsystem<UInputLatencySubsystem>())
+		{
+			Latency->MarkInput(AttackAction, ControlledCharacter);
+		}
+
 		ControlledCharacter->PerformAttack();
 	}
 	else
@@ -305,14 +343,26 @@ void ATacticsPlayerController::OnAttackTriggered()
 
 void ATacticsPlayerController::UpdateCharacterRotation()
 {
-	// Get hit result under cursor
-	FHitResult Hit;
-	GetHitResultUnderCursor(ECollisionChannel::ECC_Visibility, true, Hit);
+	UCursorCacheSubsystem* CursorCache = UCursorCacheSubsystem::Get(this);
+	APawn* ControlledPawn = GetPawn();
 
-	if (APawn* ControlledPawn = GetPawn())
+	if (CursorCache && ControlledPawn)
 	{
+		// Get the cursor location, shared with every other cursor query this frame
+		FHitResult Hit;
+		FVector CursorLocation;
+
+		if (CursorCache->GetCursorHit(ECollisionChannel::ECC_Visibility, Hit))
+		{
+			CursorLocation = Hit.Location;
+		}
+		else if (!CursorCache->GetCursorGroundLocation(ControlledPawn->GetActorLocation().Z, CursorLocation))
+		{
+			return;
+		}
+
 		// Calculate direction from character to cursor
-		const FVector Direction = Hit.Location - ControlledPawn->GetActorLocation();
+		const FVector Direction = CursorLocation - ControlledPawn->GetActorLocation();
 		const FRotator NewRotation = FRotator(0.0f, Direction.Rotation().Yaw, 0.0f);
 		
 		// Smoothly rotate character
@@ -320,6 +370,180 @@ void ATacticsPlayerController::UpdateCharacterRotation()
 	}
 }
 
+void ATacticsPlayerController::RequestPathTo(const FVector& Destination)
+{
+	APawn* ControlledPawn = GetPawn();
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	if (!ControlledPawn || !NavSys)
+	{
+		return;
+	}
+
+	// Any pending result is stale now
+	CancelPathRequest();
+
+	LastPathRequestTime = GetWorld()->GetTimeSeconds();
+
+	const FNavAgentProperties& AgentProperties = GetNavAgentPropertiesRef();
+	const FVector PawnLocation = ControlledPawn->GetActorLocation();
+
+	FVector QueryStart = PawnLocation;
+
+	// Reuse the corridor when the destination only moved a little: keep the path up to
+	// its point closest to the new destination and only plan the tail from there
+	UPathFollowingComponent* PathFollowing = FindComponentByClass<UPathFollowingComponent>();
+	if (CurrentPath.IsValid() && CurrentPath->IsValid() && PathFollowing && PathFollowing->GetStatus() == EPathFollowingStatus::Moving
+		&& FVector::Dist(CurrentPath->GetDestinationLocation(), Destination) <= PathReuseRadius)
+	{
+		const TArray<FNavPathPoint>& Points = CurrentPath->GetPathPoints();
+		const int32 FirstIndex = FMath::Clamp(static_cast<int32>(PathFollowing->GetNextPathIndex()), 1, Points.Num() - 1);
+
+		int32 SpliceIndex = FirstIndex;
+		for (int32 Index = FirstIndex + 1; Index < Points.Num(); ++Index)
+		{
+			if (FVector::DistSquared(Points[Index].Location, Destination) < FVector::DistSquared(Points[SpliceIndex].Location, Destination))
+			{
+				SpliceIndex = Index;
+			}
+		}
+
+		PendingPathPrefix.Add(PawnLocation);
+		for (int32 Index = FirstIndex; Index <= SpliceIndex; ++Index)
+		{
+			PendingPathPrefix.Add(Points[Index].Location);
+		}
+
+		QueryStart = Points[SpliceIndex].Location;
+	}
+
+	const ANavigationData* NavData = NavSys->GetNavDataForProps(AgentProperties, QueryStart);
+	if (!NavData)
+	{
+		PendingPathPrefix.Reset();
+		return;
+	}
+
+	FPathFindingQuery Query(this, *NavData, QueryStart, Destination, UNavigationQueryFilter::GetQueryFilter(*NavData, this, nullptr));
+	Query.SetAllowPartialPaths(true);
+
+	PendingPathGoal = Destination;
+	PendingPathQueryId = NavSys->FindPathAsync(AgentProperties, Query, FNavPathQueryDelegate::CreateUObject(this, &ATacticsPlayerController::OnPathFound));
+}
+
+void ATacticsPlayerController::OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+	// Ignore results of superseded requests
+	if (QueryId != PendingPathQueryId)
+	{
+		return;
+	}
+
+	PendingPathQueryId = INVALID_NAVQUERYID;
+
+	APawn* ControlledPawn = GetPawn();
+	if (Result != ENavigationQueryResult::Success || !Path.IsValid() || !Path->IsValid() || !ControlledPawn)
+	{
+		PendingPathPrefix.Reset();
+		return;
+	}
+
+	TArray<FNavPathPoint>& Points = Path->GetPathPoints();
+
+	if (PendingPathPrefix.Num() > 0)
+	{
+		// Splice the re-planned tail onto the kept part of the old path. The tail starts on the last kept point
+		TArray<FNavPathPoint> Spliced;
+		Spliced.Reserve(PendingPathPrefix.Num() + Points.Num() - 1);
+
+		for (const FVector& Location : PendingPathPrefix)
+		{
+			Spliced.Add(FNavPathPoint(Location));
+		}
+
+		Spliced.Append(Points.GetData() + 1, Points.Num() - 1);
+		Points = MoveTemp(Spliced);
+
+		SmoothPathSplice(*Path, PendingPathPrefix.Num() - 1);
+		PendingPathPrefix.Reset();
+	}
+
+	// The pawn kept moving while the query ran, start from where it is now
+	Points[0].Location = ControlledPawn->GetActorLocation();
+
+	UPathFollowingComponent* PathFollowing = GetPathFollowingComponent();
+	if (!PathFollowing || !PathFollowing->IsPathFollowingAllowed())
+	{
+		return;
+	}
+
+	if (PathFollowing->GetStatus() != EPathFollowingStatus::Idle)
+	{
+		PathFollowing->AbortMove(*this, FPathFollowingResultFlags::ForcedScript | FPathFollowingResultFlags::NewRequest, FAIRequestID::CurrentRequest, EPathFollowingVelocityMode::Keep);
+	}
+
+	CurrentPath = Path;
+
+	FAIMoveRequest MoveRequest(PendingPathGoal);
+	MoveRequest.SetAcceptanceRadius(5.0f);
+
+	PathFollowing->RequestMove(MoveRequest, Path);
+}
+
+void ATacticsPlayerController::SmoothPathSplice(FNavigationPath& Path, int32 SpliceIndex) const
+{
+	// Both parts are string-pulled already, only the corners around the splice can be redundant
+	TArray<FNavPathPoint>& Points = Path.GetPathPoints();
+
+	int32 Index = FMath::Max(SpliceIndex - 1, 1);
+	const int32 NumChecks = SpliceIndex + 2 - Index;
+
+	for (int32 Check = 0; Check < NumChecks && Index < Points.Num() - 1; ++Check)
+	{
+		// Drop the corner if its neighbors can see each other on the navmesh
+		FVector HitLocation;
+		const bool bBlocked = UNavigationSystemV1::NavigationRaycast(GetWorld(), Points[Index - 1].Location, Points[Index + 1].Location, HitLocation, nullptr, const_cast<ATacticsPlayerController*>(this));
+
+		if (bBlocked)
+		{
+			++Index;
+		}
+		else
+		{
+			Points.RemoveAt(Index);
+		}
+	}
+}
+
+UPathFollowingComponent* ATacticsPlayerController::GetPathFollowingComponent()
+{
+	// Same setup SimpleMoveToLocation does for player controllers
+	UPathFollowingComponent* PathFollowing = FindComponentByClass<UPathFollowingComponent>();
+	if (!PathFollowing)
+	{
+		PathFollowing = NewObject<UPathFollowingComponent>(this);
+		PathFollowing->RegisterComponentWithWorld(GetWorld());
+		PathFollowing->Initialize();
+	}
+
+	return PathFollowing;
+}
+
+void ATacticsPlayerController::CancelPathRequest()
+{
+	if (PendingPathQueryId != INVALID_NAVQUERYID)
+	{
+		if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+		{
+			NavSys->AbortAsyncFindPathRequest(PendingPathQueryId);
+		}
+
+		PendingPathQueryId = INVALID_NAVQUERYID;
+	}
+
+	PendingPathPrefix.Reset();
+}
+
 void ATacticsPlayerController::TestInputSystem()
 {
 	UE_LOG(LogTactics, Warning, TEXT("=== INPUT SYSTEM TEST ==="));
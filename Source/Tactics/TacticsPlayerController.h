@@ -5,12 +5,15 @@
 #include "CoreMinimal.h"
 #include "Templates/SubclassOf.h"
 #include "GameFramework/PlayerController.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "TacticsAssetPreloader.h"
 #include "TacticsPlayerController.generated.h"
 
 class UNiagaraSystem;
 class UInputMappingContext;
 class UInputAction;
 class UPlayerHUDWidget;
+class UPathFollowingComponent;
 struct FInputActionValue;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
@@ -20,7 +23,7 @@ DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
  *  Implements point and click based controls
  */
 UCLASS(Blueprintable)
-class TACTICS_API ATacticsPlayerController : public APlayerController
+class TACTICS_API ATacticsPlayerController : public APlayerController, public ITacticsPreloadSource
 {
 	GENERATED_BODY()
 
@@ -54,6 +57,26 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Input")
 	UInputAction* AttackAction;
 
+	/** Default MappingContext, used if DefaultMappingContext is not set */
+	UPROPERTY(EditDefaultsOnly, Category="Input|Defaults")
+	TSoftObjectPtr<UInputMappingContext> DefaultMappingContextAsset;
+
+	/** Default click action, used if SetDestinationClickAction is not set */
+	UPROPERTY(EditDefaultsOnly, Category="Input|Defaults")
+	TSoftObjectPtr<UInputAction> SetDestinationClickActionAsset;
+
+	/** Default touch action, used if SetDestinationTouchAction is not set */
+	UPROPERTY(EditDefaultsOnly, Category="Input|Defaults")
+	TSoftObjectPtr<UInputAction> SetDestinationTouchActionAsset;
+
+	/** Default move action, used if MoveAction is not set */
+	UPROPERTY(EditDefaultsOnly, Category="Input|Defaults")
+	TSoftObjectPtr<UInputAction> MoveActionAsset;
+
+	/** Default attack action, used if AttackAction is not set */
+	UPROPERTY(EditDefaultsOnly, Category="Input|Defaults")
+	TSoftObjectPtr<UInputAction> AttackActionAsset;
+
 	/** HUD Widget Class */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="UI")
 	TSubclassOf<UPlayerHUDWidget> HUDWidgetClass;
@@ -70,11 +93,27 @@ protected:
 	/** Time that the click input has been pressed */
 	float FollowTime = 0.0f;
 
+	/** If a new destination is this close to the current path's goal, only the tail of the path is re-planned */
+	UPROPERTY(EditAnywhere, Category="Input|Pathing")
+	float PathReuseRadius = 300.0f;
+
+	/** Minimum time between path requests while the click input is held */
+	UPROPERTY(EditAnywhere, Category="Input|Pathing")
+	float HeldPathRequestInterval = 0.15f;
+
 public:
 
 	/** Constructor */
 	ATacticsPlayerController();
 
+	/** Get the default assets to preload for this controller */
+	virtual void GetPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const override;
+
+#if WITH_EDITOR
+	/** Validate that the default input assets exist */
+	virtual EDataValidationResult IsDataValid(class FDataValidationContext& Context) const override;
+#endif
+
 protected:
 
 	/** Initialize input bindings */
@@ -108,6 +147,36 @@ private:
 	/** Update character rotation to face mouse cursor */
 	void UpdateCharacterRotation();
 
+	/** Request an async path to a destination and follow it once it's found. Supersedes any pending request */
+	void RequestPathTo(const FVector& Destination);
+
+	/** Async path query callback */
+	void OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
+	/** Drop shortcut-able corners around the splice point of a re-planned path */
+	void SmoothPathSplice(FNavigationPath& Path, int32 SpliceIndex) const;
+
+	/** Get the path following component, creating it if needed */
+	UPathFollowingComponent* GetPathFollowingComponent();
+
+	/** Abort the pending path query, if any */
+	void CancelPathRequest();
+
+	/** Id of the pending async path query, results from any other query are stale */
+	uint32 PendingPathQueryId = INVALID_NAVQUERYID;
+
+	/** Goal of the pending path query */
+	FVector PendingPathGoal = FVector::ZeroVector;
+
+	/** Points of the current path kept in front of the re-planned tail */
+	TArray<FVector> PendingPathPrefix;
+
+	/** Path currently being followed */
+	FNavPathSharedPtr CurrentPath;
+
+	/** Time of the last path request */
+	float LastPathRequestTime = -1.0f;
+
 	/** Debug function to test input system */
 	UFUNCTION(Exec)
 	void TestInputSystem();
@@ -0,0 +1,44 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TimingStats.h"
+
+void FTimingStats::AddSample(float SampleMs)
+{
+	if (Buckets.Num() == 0)
+	{
+		Buckets.SetNumZeroed(NumBuckets);
+	}
+
+	// Keep a bounded window of recent samples
+	if (SamplesMs.Num() < MaxSamples)
+	{
+		SamplesMs.Add(SampleMs);
+	}
+	else
+	{
+		SamplesMs[NextSample] = SampleMs;
+		NextSample = (NextSample + 1) % MaxSamples;
+	}
+
+	const int32 Bucket = FMath::Clamp(FMath::FloorToInt(SampleMs / BucketWidthMs), 0, NumBuckets - 1);
+	++Buckets[Bucket];
+
+	++Count;
+	SumMs += SampleMs;
+	MaxMs = FMath::Max(MaxMs, SampleMs);
+}
+
+float FTimingStats::GetPercentile(float Percentile) const
+{
+	if (SamplesMs.Num() == 0)
+	{
+		return 0.0f;
+	}
+
+	TArray<float> Sorted(SamplesMs);
+	Sorted.Sort();
+
+	// Nearest rank
+	const int32 Rank = FMath::CeilToInt(Percentile / 100.0f * Sorted.Num()) - 1;
+	return Sorted[FMath::Clamp(Rank, 0, Sorted.Num() - 1)];
+}
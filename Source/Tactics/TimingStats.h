@@ -0,0 +1,50 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Timing samples and summary, in milliseconds. Used for input latency, query latency and per-frame work budgets
+ */
+struct FTimingStats
+{
+	/** Number of recent samples kept for the percentiles */
+	static constexpr int32 MaxSamples = 4096;
+
+	/** Width of a histogram bucket, in milliseconds */
+	static constexpr float BucketWidthMs = 5.0f;
+
+	/** Number of histogram buckets. The last one holds everything above the range */
+	static constexpr int32 NumBuckets = 41;
+
+	/** Most recent samples, in milliseconds, used for the percentiles */
+	TArray<float> SamplesMs;
+
+	/** Index the next sample overwrites once SamplesMs is full */
+	int32 NextSample = 0;
+
+	/** Sample counts per bucket */
+	TArray<int32> Buckets;
+
+	/** Number of samples recorded */
+	int32 Count = 0;
+
+	/** Sum of all samples, in milliseconds */
+	double SumMs = 0.0;
+
+	/** Largest sample, in milliseconds */
+	float MaxMs = 0.0f;
+
+	/** Inputs that didn't produce a response before timing out */
+	int32 NoResponseCount = 0;
+
+	/** Add a sample */
+	void AddSample(float SampleMs);
+
+	/** Mean of all samples */
+	float GetMean() const { return Count > 0 ? static_cast<float>(SumMs / Count) : 0.0f; }
+
+	/** Percentile (0-100) of the recent samples */
+	float GetPercentile(float Percentile) const;
+};
@@ -0,0 +1,292 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyAICommander.h"
+#include "StrategyUnit.h"
+#include "StrategyOrderExecutor.h"
+#include "StrategyUnitRegistry.h"
+#include "StrategyReplaySubsystem.h"
+#include "StrategyGameMode.h"
+#include "StrategyCommand.h"
+#include "ResourceNode.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Tactics.h"
+
+static TAutoConsoleVariable<float> CVarAICommanderBudgetMs(
+	TEXT("Tactics.AICommander.BudgetMs"),
+	0.0f,
+	TEXT("Worker thread time a single AI commander plan may take, in milliseconds. 0 uses the game mode setting. Lower it in device profiles for slow devices."),
+	ECVF_Scalability);
+
+bool UStrategyAICommander::ControlsUnit(int32 UnitId) const
+{
+	return bActive && UnitRegistry && UnitRegistry->IsRegistered(UnitId) && UnitRegistry->GetUnitTeam(UnitId) == TeamId;
+}
+
+bool UStrategyAICommander::ExecuteCommand(const FStrategyCommand& Command)
+{
+	// control groups and the camera belong to the player
+	return OrderExecutor && OrderExecutor->ExecuteCommand(Command, Selection);
+}
+
+void UStrategyAICommander::DumpStats() const
+{
+	if (!bActive)
+	{
+		UE_LOG(LogTactics, Display, TEXT("AI commander inactive"));
+		return;
+	}
+
+	UE_LOG(LogTactics, Display, TEXT("AI commander, team %d: %d plans, %d out of budget, %d orders issued, %d active. %d snapshot allocations. Plan in flight: %s"),
+		TeamId, NumPlans, NumOutOfBudgetPlans, NumOrders, OrderExecutor->GetNumActiveOrders(), NumSnapshotAllocations, PlanTask.IsValid() ? TEXT("yes") : TEXT("no"));
+	UE_LOG(LogTactics, Display, TEXT("Last plan: %d of %d groups planned, %d visible enemies, %d orders"),
+		LastPlan.NumPlannedGroups, LastPlan.NumGroups, LastPlan.NumVisibleEnemies, LastPlan.Orders.Num());
+	UE_LOG(LogTactics, Display, TEXT("Plan (worker): mean %.3f ms, p99 %.3f ms, max %.3f ms. Capture: mean %.3f ms, max %.3f ms. Apply: mean %.3f ms, max %.3f ms"),
+		PlanStats.GetMean(), PlanStats.GetPercentile(99.0f), PlanStats.MaxMs, CaptureStats.GetMean(), CaptureStats.MaxMs, ApplyStats.GetMean(), ApplyStats.MaxMs);
+}
+
+void UStrategyAICommander::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!bActive || !UnitRegistry)
+	{
+		return;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyAICommander_Tick);
+
+	// a replay already holds our commands, so apply them on their frames instead of planning
+	if (ReplaySubsystem && ReplaySubsystem->IsReplaying())
+	{
+		ReplaySubsystem->ApplyDueCommands(TeamId, [this](const FStrategyCommand& Command)
+		{
+			return ExecuteCommand(Command);
+		});
+
+		return;
+	}
+
+	// units that got stuck on the way are planned for again
+	OrderExecutor->ExpireOrders(OrderTimeout);
+
+	// pick up a finished plan. One that's still running is left alone until a later tick
+	if (PlanTask.IsValid() && PlanTask.IsCompleted())
+	{
+		ApplyPlan(PlanTask.GetResult());
+		PlanTask = UE::Tasks::TTask<FStrategyCommanderPlan>();
+	}
+
+	TimeSincePlan += DeltaTime;
+
+	if (!PlanTask.IsValid() && TimeSincePlan >= PlanInterval)
+	{
+		TimeSincePlan = 0.0f;
+		StartPlan();
+	}
+}
+
+TStatId UStrategyAICommander::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyAICommander, STATGROUP_Tickables);
+}
+
+void UStrategyAICommander::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// the commander only plays in the strategy game mode, when enabled
+	const AStrategyGameMode* GameMode = Cast<AStrategyGameMode>(InWorld.GetAuthGameMode());
+
+	if (!GameMode || !GameMode->IsAICommanderEnabled())
+	{
+		return;
+	}
+
+	UnitRegistry = InWorld.GetSubsystem<UStrategyUnitRegistry>();
+
+	if (!UnitRegistry)
+	{
+		return;
+	}
+
+	UnitRegistry->OnUnitUnregistered.AddUObject(this, &UStrategyAICommander::OnUnitUnregistered);
+
+	ReplaySubsystem = InWorld.GetSubsystem<UStrategyReplaySubsystem>();
+
+	TeamId = GameMode->GetAICommanderTeamId();
+	PlanInterval = GameMode->GetAICommanderPlanInterval();
+	PlanBudgetMs = GameMode->GetAICommanderPlanBudget();
+	OrderTimeout = GameMode->GetAICommanderOrderTimeout();
+	CrowdSightRadius = GameMode->GetCrowdSightRadius();
+
+	// moves go through the same executor as the player's, selecting only our own units
+	OrderExecutor = NewObject<UStrategyOrderExecutor>(this);
+	OrderExecutor->Initialize(&InWorld, InteractionRadius, FormationShape, FormationSpacing, [this](int32 UnitId)
+	{
+		return ControlsUnit(UnitId);
+	});
+
+	PlanParams.TeamId = TeamId;
+	PlanParams.GroupRadius = GameMode->GetAICommanderGroupRadius();
+	PlanParams.MaxGroupSize = GameMode->GetAICommanderMaxGroupSize();
+	PlanParams.MaxOrders = GameMode->GetAICommanderMaxOrdersPerPlan();
+	PlanParams.Seed = FMath::Rand();
+
+	bActive = true;
+}
+
+void UStrategyAICommander::Deinitialize()
+{
+	if (UnitRegistry)
+	{
+		UnitRegistry->OnUnitUnregistered.RemoveAll(this);
+	}
+
+	if (OrderExecutor)
+	{
+		OrderExecutor->Shutdown();
+	}
+
+	// the planner task only holds its own snapshot reference, so it can finish on its own without us waiting for it
+	PlanTask = UE::Tasks::TTask<FStrategyCommanderPlan>();
+	PlanSnapshot.Reset();
+
+	Selection.Empty();
+	bActive = false;
+
+	Super::Deinitialize();
+}
+
+void UStrategyAICommander::CaptureSnapshot(FStrategyCommanderSnapshot& Snapshot) const
+{
+	Snapshot.Reset();
+	Snapshot.Frame = static_cast<uint32>(GFrameCounter);
+
+	// units carrying out a recent order are left alone by the planner
+	FStrategyUnitSet BusyUnits;
+	OrderExecutor->GetOrderedUnits(BusyUnits);
+
+	const TArray<int32>& UnitIds = UnitRegistry->GetUnitIds();
+	Snapshot.Units.Reserve(UnitIds.Num());
+
+	for (const int32 UnitId : UnitIds)
+	{
+		FStrategyCommanderSnapshot::FUnit& Unit = Snapshot.Units.AddDefaulted_GetRef();
+		Unit.UnitId = UnitId;
+		Unit.TeamId = UnitRegistry->GetUnitTeam(UnitId);
+		Unit.bBusy = BusyUnits.Contains(UnitId);
+
+		UnitRegistry->GetUnitLocation(UnitId, Unit.Location);
+
+		const AStrategyUnit* UnitActor = UnitRegistry->GetUnit(UnitId);
+		Unit.SightRadius = UnitActor ? UnitActor->GetSightRadius() : CrowdSightRadius;
+	}
+
+	// only nodes that can be gathered right now are worth heading for
+	for (TActorIterator<AResourceNode> It(GetWorld()); It; ++It)
+	{
+		if (It->GetGatherState() == EGatherState::Idle)
+		{
+			Snapshot.Resources.Add({ It->GetActorLocation(), static_cast<uint8>(It->ResourceType) });
+		}
+	}
+}
+
+void UStrategyAICommander::StartPlan()
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	// the previous plan is done by now, so its snapshot is refilled in place unless the finished task still holds on to it
+	if (!PlanSnapshot.IsValid() || !PlanSnapshot.IsUnique())
+	{
+		PlanSnapshot = MakeShared<FStrategyCommanderSnapshot, ESPMode::ThreadSafe>();
+		++NumSnapshotAllocations;
+	}
+
+	CaptureSnapshot(*PlanSnapshot);
+
+	// the budget is read every plan, so device profiles and the console can change it at runtime
+	const float BudgetOverrideMs = CVarAICommanderBudgetMs.GetValueOnGameThread();
+
+	FStrategyCommanderPlanParams Params = PlanParams;
+	Params.TimeBudget = (BudgetOverrideMs > 0.0f ? BudgetOverrideMs : PlanBudgetMs) / 1000.0;
+
+	CaptureStats.AddSample((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	// the task only sees its own copies, never this subsystem
+	PlanTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [PlannedSnapshot = TSharedPtr<const FStrategyCommanderSnapshot, ESPMode::ThreadSafe>(PlanSnapshot), Params]()
+	{
+		return StrategyCommanderPlanner::Plan(*PlannedSnapshot, Params);
+	});
+}
+
+void UStrategyAICommander::ApplyPlan(const FStrategyCommanderPlan& Plan)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyAICommander_ApplyPlan);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	++NumPlans;
+	PlanStats.AddSample(Plan.PlanMs);
+
+	if (Plan.bOutOfBudget)
+	{
+		++NumOutOfBudgetPlans;
+	}
+
+	// each order is a selection and a move, like a player's
+	for (const FStrategyCommanderOrder& Order : Plan.Orders)
+	{
+		FStrategyCommand SelectCommand(EStrategyCommandType::SetSelection);
+		SelectCommand.Units = Order.Units;
+		SubmitCommand(SelectCommand);
+
+		FStrategyCommand MoveCommand(EStrategyCommandType::Move);
+		MoveCommand.Location = Order.Goal;
+		MoveCommand.bInteract = Order.bInteract;
+
+		if (SubmitCommand(MoveCommand))
+		{
+			++NumOrders;
+		}
+	}
+
+	LastPlan = Plan;
+
+	ApplyStats.AddSample((FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+bool UStrategyAICommander::SubmitCommand(const FStrategyCommand& Command)
+{
+	// stamp the command with our team, so the replay can tell it apart from the player's
+	FStrategyCommand TeamCommand = Command;
+	TeamCommand.TeamId = TeamId;
+
+	// plans finish on whatever frame the worker gets to them, so the commands are recorded to replay exactly
+	if (ReplaySubsystem)
+	{
+		ReplaySubsystem->RecordCommand(TeamCommand);
+	}
+
+	return ExecuteCommand(TeamCommand);
+}
+
+void UStrategyAICommander::OnUnitUnregistered(int32 UnitId)
+{
+	// drop the id before the registry hands it to another unit. The executor drops it from the orders
+	Selection.Remove(UnitId);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs AICommanderDumpCommand(
+	TEXT("Tactics.AICommander.Dump"),
+	TEXT("Logs the AI commander's plan and order stats."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UStrategyAICommander* Commander = World ? World->GetSubsystem<UStrategyAICommander>() : nullptr)
+		{
+			Commander->DumpStats();
+		}
+	}));
@@ -0,0 +1,147 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "StrategyUnitSet.h"
+#include "StrategyFormation.h"
+#include "StrategyCommanderPlanner.h"
+#include "TimingStats.h"
+#include "StrategyAICommander.generated.h"
+
+class UStrategyUnitRegistry;
+class UStrategyReplaySubsystem;
+class UStrategyOrderExecutor;
+struct FStrategyCommand;
+
+/**
+ *  Computer opponent that commands the units of one team.
+ *  At a fixed interval the game thread copies the world state into a snapshot, and a worker thread plans from it.
+ *  Only one plan runs at a time, so a single snapshot is reused, and only reallocated if the last task still holds it.
+ *  The game thread never waits for a plan. It picks up the result on a later tick, and the plan stops early if it runs over its time budget.
+ *  Plans are applied as strategy commands, through the same order executor as the player's input,
+ *  and recorded by the replay subsystem so a replay applies them on the same frames without planning again.
+ *  Settings are read from the strategy game mode. The time budget can be lowered per device with Tactics.AICommander.BudgetMs.
+ */
+UCLASS()
+class UStrategyAICommander : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns true if the commander is playing */
+	bool IsActive() const { return bActive; }
+
+	/** Returns the team played by the commander */
+	uint8 GetTeamId() const { return TeamId; }
+
+	/** Returns true if the unit belongs to the commander's team */
+	bool ControlsUnit(int32 UnitId) const;
+
+	/** Applies a strategy command to the commander's units. Returns false if it had no effect, or a move couldn't be started */
+	bool ExecuteCommand(const FStrategyCommand& Command);
+
+	/** Logs the planning stats */
+	void DumpStats() const;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// UWorldSubsystem interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+protected:
+
+	/** Snapshot shared with the planner task */
+	using FSnapshotPtr = TSharedPtr<FStrategyCommanderSnapshot, ESPMode::ThreadSafe>;
+
+	/** Unit registry for this world */
+	UPROPERTY(Transient)
+	TObjectPtr<UStrategyUnitRegistry> UnitRegistry;
+
+	/** Command recorder and replayer */
+	UPROPERTY(Transient)
+	TObjectPtr<UStrategyReplaySubsystem> ReplaySubsystem;
+
+	/** Moves the commander's units and follows their orders */
+	UPROPERTY(Transient)
+	TObjectPtr<UStrategyOrderExecutor> OrderExecutor;
+
+	/** If true, the commander is playing */
+	bool bActive = false;
+
+	/** Team played by the commander */
+	uint8 TeamId = 1;
+
+	/** Time between plans */
+	float PlanInterval = 1.0f;
+
+	/** Plan settings, minus the budget which is read every plan */
+	FStrategyCommanderPlanParams PlanParams;
+
+	/** Game mode plan budget, in milliseconds */
+	float PlanBudgetMs = 2.0f;
+
+	/** Time after which an order's units count as idle again */
+	float OrderTimeout = 30.0f;
+
+	/** Sight radius of crowd units, which have no actor to ask */
+	float CrowdSightRadius = 0.0f;
+
+	/** Max distance to look for targets around an interaction goal */
+	float InteractionRadius = 250.0f;
+
+	/** Slot layout and spacing used for group moves */
+	EStrategyFormationShape FormationShape = EStrategyFormationShape::Box;
+	float FormationSpacing = 150.0f;
+
+	/** Units picked by the last selection command. Not shown to the player, so units aren't notified */
+	FStrategyUnitSet Selection;
+
+	/** World state the plans are made from */
+	FSnapshotPtr PlanSnapshot;
+
+	/** Plan running on a worker thread, if any */
+	UE::Tasks::TTask<FStrategyCommanderPlan> PlanTask;
+
+	/** Time since the last plan started */
+	float TimeSincePlan = 0.0f;
+
+	/** Snapshot capture and plan application times on the game thread, in milliseconds */
+	FTimingStats CaptureStats;
+	FTimingStats ApplyStats;
+
+	/** Worker thread plan times, in milliseconds */
+	FTimingStats PlanStats;
+
+	/** Lifetime stats */
+	int32 NumPlans = 0;
+	int32 NumOutOfBudgetPlans = 0;
+	int32 NumSnapshotAllocations = 0;
+	int32 NumOrders = 0;
+
+	/** Result of the last plan */
+	FStrategyCommanderPlan LastPlan;
+
+	/** Fills a snapshot from the registry and the resource nodes */
+	void CaptureSnapshot(FStrategyCommanderSnapshot& Snapshot) const;
+
+	/** Captures a snapshot and starts planning on a worker thread */
+	void StartPlan();
+
+	/** Turns a finished plan into commands */
+	void ApplyPlan(const FStrategyCommanderPlan& Plan);
+
+	/** Records a command and applies it */
+	bool SubmitCommand(const FStrategyCommand& Command);
+
+	/** Called when a unit leaves the registry */
+	void OnUnitUnregistered(int32 UnitId);
+};
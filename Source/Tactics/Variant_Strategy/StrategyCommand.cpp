@@ -0,0 +1,131 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyCommand.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+/** Identifies a command stream file */
+static constexpr uint32 CommandStreamMagic = 0x53434D44;
+
+/** Bumped whenever the stream layout changes */
+static constexpr uint32 CommandStreamVersion = 2;
+
+bool FStrategyCommandStream::SaveToFile(const FString& FileName) const
+{
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+
+	// serialization is symmetric, so it takes a mutable stream even when saving
+	Writer << const_cast<FStrategyCommandStream&>(*this);
+
+	return FFileHelper::SaveArrayToFile(Data, *FileName);
+}
+
+bool FStrategyCommandStream::LoadFromFile(const FString& FileName)
+{
+	TArray<uint8> Data;
+
+	if (!FFileHelper::LoadFileToArray(Data, *FileName))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+	Reader << *this;
+
+	return !Reader.IsError();
+}
+
+FArchive& operator<<(FArchive& Ar, FStrategyCommandStream& Stream)
+{
+	uint32 Magic = CommandStreamMagic;
+	uint32 Version = CommandStreamVersion;
+
+	Ar << Magic;
+	Ar << Version;
+
+	// refuse anything we didn't write
+	if (Ar.IsLoading() && (Magic != CommandStreamMagic || Version != CommandStreamVersion))
+	{
+		Ar.SetError();
+		return Ar;
+	}
+
+	Ar << Stream.MapName;
+	Ar << Stream.Seed;
+	Ar << Stream.FixedDeltaTime;
+
+	int32 NumCommands = Stream.Commands.Num();
+	Ar << NumCommands;
+
+	if (Ar.IsLoading())
+	{
+		// don't trust the count of a damaged file
+		if (NumCommands < 0 || NumCommands > Ar.TotalSize())
+		{
+			Ar.SetError();
+			return Ar;
+		}
+
+		Stream.Commands.SetNum(NumCommands);
+	}
+
+	uint32 PreviousFrame = 0;
+
+	for (FStrategyCommand& Command : Stream.Commands)
+	{
+		// commands are in frame order and mostly close together, so deltas pack into a byte or two
+		uint32 FrameDelta = Command.Frame - PreviousFrame;
+		Ar.SerializeIntPacked(FrameDelta);
+		Command.Frame = PreviousFrame + FrameDelta;
+		PreviousFrame = Command.Frame;
+
+		uint8 Type = static_cast<uint8>(Command.Type);
+		Ar << Type;
+
+		if (Type >= static_cast<uint8>(EStrategyCommandType::Num))
+		{
+			Ar.SetError();
+			return Ar;
+		}
+
+		Command.Type = static_cast<EStrategyCommandType>(Type);
+
+		Ar << Command.TeamId;
+
+		// only the fields the command type uses
+		switch (Command.Type)
+		{
+		case EStrategyCommandType::Select:
+		case EStrategyCommandType::Deselect:
+		case EStrategyCommandType::SetSelection:
+			Ar << Command.Units;
+			break;
+
+		case EStrategyCommandType::SaveControlGroup:
+		case EStrategyCommandType::RecallControlGroup:
+			Ar << Command.GroupIndex;
+			break;
+
+		case EStrategyCommandType::Move:
+			Ar << Command.Location;
+			Ar << Command.bInteract;
+			break;
+
+		case EStrategyCommandType::CameraLocation:
+			Ar << Command.Location;
+			break;
+
+		case EStrategyCommandType::CameraZoom:
+			Ar << Command.Zoom;
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	return Ar;
+}
@@ -0,0 +1,103 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StrategyUnitSet.h"
+
+/** Operations a player or AI commander can apply to the strategy game */
+enum class EStrategyCommandType : uint8
+{
+	/** Adds units to the selection */
+	Select,
+
+	/** Removes units from the selection */
+	Deselect,
+
+	/** Clears the selection */
+	DeselectAll,
+
+	/** Replaces the selection */
+	SetSelection,
+
+	/** Saves the selection into a control group */
+	SaveControlGroup,
+
+	/** Replaces the selection with a control group */
+	RecallControlGroup,
+
+	/** Moves the selection to a location, optionally interacting with the units around it */
+	Move,
+
+	/** Moves the camera to a location */
+	CameraLocation,
+
+	/** Sets the camera zoom level */
+	CameraZoom,
+
+	Num
+};
+
+/**
+ *  A single player operation, already resolved from mouse or touch input into unit ids and world locations.
+ *  AI commanders issue the same commands, stamped with their own team.
+ *  Applying the same commands on the same frames to the same starting state gives the same game.
+ */
+struct FStrategyCommand
+{
+	/** Frame the command was applied on, counted from the start of play */
+	uint32 Frame = 0;
+
+	/** Team of the player or AI commander that issued the command */
+	uint8 TeamId = 0;
+
+	/** Operation */
+	EStrategyCommandType Type = EStrategyCommandType::DeselectAll;
+
+	/** Units to select, deselect or set as the selection */
+	FStrategyUnitSet Units;
+
+	/** Move goal or camera location */
+	FVector Location = FVector::ZeroVector;
+
+	/** Camera zoom level */
+	float Zoom = 0.0f;
+
+	/** Control group index */
+	int32 GroupIndex = 0;
+
+	/** If true, a move interacts with the units around the goal */
+	bool bInteract = true;
+
+	FStrategyCommand() = default;
+	explicit FStrategyCommand(EStrategyCommandType InType) : Type(InType) {}
+};
+
+/**
+ *  Frame stamped stream of strategy commands, along with what's needed to replay it:
+ *  the map, the random seed and the fixed timestep the session ran with.
+ *  Commands only store the fields their type uses, and frames are stored as packed deltas.
+ */
+struct FStrategyCommandStream
+{
+	/** Map the stream was recorded on */
+	FString MapName;
+
+	/** Random seed the session started with */
+	int32 Seed = 0;
+
+	/** Fixed timestep the session ran with */
+	float FixedDeltaTime = 1.0f / 30.0f;
+
+	/** Commands in frame order */
+	TArray<FStrategyCommand> Commands;
+
+	/** Writes the stream to a file. Returns false if the file couldn't be written */
+	bool SaveToFile(const FString& FileName) const;
+
+	/** Reads the stream from a file. Returns false if the file is missing, not a command stream, or from another version */
+	bool LoadFromFile(const FString& FileName);
+
+	/** Serializes the stream */
+	friend FArchive& operator<<(FArchive& Ar, FStrategyCommandStream& Stream);
+};
@@ -0,0 +1,265 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyCommanderPlanner.h"
+
+/** Size of the cells the commander's sight is tracked in */
+static constexpr float VisibilityCellSize = 500.0f;
+
+/** Groups smaller than this fraction of an enemy cluster leave it alone */
+static constexpr float MinAttackStrength = 0.5f;
+
+/** Distance past the units' bounds where scouting goals can land */
+static constexpr float ScoutingMargin = 2000.0f;
+
+/** Units of the commander grouped for a single order */
+struct FCommanderGroup
+{
+	/** Indices of the units in the snapshot */
+	TArray<int32> UnitIndices;
+
+	/** Average unit location */
+	FVector Center = FVector::ZeroVector;
+
+	/** Grouping cell, used to vary the scouting goals */
+	FIntPoint Cell = FIntPoint::ZeroValue;
+};
+
+/** Visible enemies in a grouping cell */
+struct FCommanderEnemyCluster
+{
+	/** Sum of the enemy locations, divided by the count once they're all in */
+	FVector Center = FVector::ZeroVector;
+
+	/** Number of enemies */
+	int32 Count = 0;
+};
+
+void FStrategyCommanderSnapshot::Reset()
+{
+	Frame = 0;
+	Units.Reset();
+	Resources.Reset();
+}
+
+/** Returns the cell containing a location on the XY plane */
+static FIntPoint GetPlannerCell(const FVector& Location, float CellSize)
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+FStrategyCommanderPlan StrategyCommanderPlanner::Plan(const FStrategyCommanderSnapshot& Snapshot, const FStrategyCommanderPlanParams& Params)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	const double Deadline = StartTime + Params.TimeBudget;
+
+	FStrategyCommanderPlan Result;
+
+	const auto StampTime = [&Result, StartTime]()
+	{
+		Result.PlanMs = static_cast<float>((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	};
+
+	const float GroupCellSize = FMath::Max(Params.GroupRadius * 2.0f, 1.0f);
+
+	// keep the widest sight in each cell, so packed armies stamp their sight once
+	TMap<FIntPoint, float> SightByCell;
+	FBox2D UnitBounds(ForceInit);
+
+	for (const FStrategyCommanderSnapshot::FUnit& Unit : Snapshot.Units)
+	{
+		UnitBounds += FVector2D(Unit.Location);
+
+		if (Unit.TeamId == Params.TeamId && Unit.SightRadius > 0.0f)
+		{
+			float& Sight = SightByCell.FindOrAdd(GetPlannerCell(Unit.Location, VisibilityCellSize), 0.0f);
+			Sight = FMath::Max(Sight, Unit.SightRadius);
+		}
+	}
+
+	// mark the cells the commander can see
+	TSet<FIntPoint> SeenCells;
+
+	for (const TPair<FIntPoint, float>& Entry : SightByCell)
+	{
+		const int32 CellRadius = FMath::CeilToInt32(Entry.Value / VisibilityCellSize);
+		const int32 CellRadiusSquared = CellRadius * CellRadius;
+
+		for (int32 Y = -CellRadius; Y <= CellRadius; ++Y)
+		{
+			for (int32 X = -CellRadius; X <= CellRadius; ++X)
+			{
+				if (X * X + Y * Y <= CellRadiusSquared)
+				{
+					SeenCells.Add(Entry.Key + FIntPoint(X, Y));
+				}
+			}
+		}
+	}
+
+	if (FPlatformTime::Seconds() > Deadline)
+	{
+		Result.bOutOfBudget = true;
+		StampTime();
+		return Result;
+	}
+
+	// cluster the visible enemies, and group the idle units, by area
+	TMap<FIntPoint, FCommanderEnemyCluster> EnemyCells;
+	TMap<FIntPoint, TArray<int32>> IdleCells;
+
+	for (int32 Index = 0; Index < Snapshot.Units.Num(); ++Index)
+	{
+		const FStrategyCommanderSnapshot::FUnit& Unit = Snapshot.Units[Index];
+
+		if (Unit.TeamId != Params.TeamId)
+		{
+			if (SeenCells.Contains(GetPlannerCell(Unit.Location, VisibilityCellSize)))
+			{
+				FCommanderEnemyCluster& Cluster = EnemyCells.FindOrAdd(GetPlannerCell(Unit.Location, GroupCellSize));
+				Cluster.Center += Unit.Location;
+				++Cluster.Count;
+
+				++Result.NumVisibleEnemies;
+			}
+
+		} else if (!Unit.bBusy) {
+
+			IdleCells.FindOrAdd(GetPlannerCell(Unit.Location, GroupCellSize)).Add(Index);
+		}
+	}
+
+	TArray<FCommanderEnemyCluster> EnemyClusters;
+	EnemyClusters.Reserve(EnemyCells.Num());
+
+	for (TPair<FIntPoint, FCommanderEnemyCluster>& Entry : EnemyCells)
+	{
+		Entry.Value.Center /= Entry.Value.Count;
+		EnemyClusters.Add(Entry.Value);
+	}
+
+	// map iteration order isn't stable, so sort the cells before splitting them into groups
+	IdleCells.KeySort([](const FIntPoint& A, const FIntPoint& B)
+	{
+		return A.Y != B.Y ? A.Y < B.Y : A.X < B.X;
+	});
+
+	TArray<FCommanderGroup> Groups;
+
+	for (const TPair<FIntPoint, TArray<int32>>& Entry : IdleCells)
+	{
+		for (int32 First = 0; First < Entry.Value.Num(); First += FMath::Max(Params.MaxGroupSize, 1))
+		{
+			FCommanderGroup& Group = Groups.AddDefaulted_GetRef();
+			Group.Cell = Entry.Key;
+
+			const int32 Last = FMath::Min(First + FMath::Max(Params.MaxGroupSize, 1), Entry.Value.Num());
+
+			for (int32 Index = First; Index < Last; ++Index)
+			{
+				Group.UnitIndices.Add(Entry.Value[Index]);
+				Group.Center += Snapshot.Units[Entry.Value[Index]].Location;
+			}
+
+			Group.Center /= Group.UnitIndices.Num();
+		}
+	}
+
+	Result.NumGroups = Groups.Num();
+
+	// larger groups matter more, so they go first in case the budget runs out
+	Algo::StableSortBy(Groups, [](const FCommanderGroup& Group) { return -Group.UnitIndices.Num(); });
+
+	TBitArray<> ClaimedResources(false, Snapshot.Resources.Num());
+	const FBox2D ScoutingBounds = UnitBounds.bIsValid ? UnitBounds.ExpandBy(ScoutingMargin) : FBox2D(FVector2D(-ScoutingMargin), FVector2D(ScoutingMargin));
+
+	for (const FCommanderGroup& Group : Groups)
+	{
+		if (Result.Orders.Num() >= Params.MaxOrders)
+		{
+			break;
+		}
+
+		if (FPlatformTime::Seconds() > Deadline)
+		{
+			Result.bOutOfBudget = true;
+			break;
+		}
+
+		++Result.NumPlannedGroups;
+
+		FStrategyCommanderOrder Order;
+
+		// attack the visible enemy cluster with the best size to distance ratio that we can take on
+		const FCommanderEnemyCluster* Target = nullptr;
+		float BestScore = 0.0f;
+
+		for (const FCommanderEnemyCluster& Cluster : EnemyClusters)
+		{
+			if (Group.UnitIndices.Num() < Cluster.Count * MinAttackStrength)
+			{
+				continue;
+			}
+
+			const float Score = Cluster.Count / (1.0f + FVector::Dist2D(Group.Center, Cluster.Center) / GroupCellSize);
+
+			if (Score > BestScore)
+			{
+				BestScore = Score;
+				Target = &Cluster;
+			}
+		}
+
+		if (Target)
+		{
+			Order.Goal = Target->Center;
+			Order.bInteract = true;
+
+		} else {
+
+			// head for the closest resource node no other group is going to
+			int32 ResourceIndex = INDEX_NONE;
+			float BestDistance = TNumericLimits<float>::Max();
+
+			for (int32 Index = 0; Index < Snapshot.Resources.Num(); ++Index)
+			{
+				const float Distance = FVector::DistSquared2D(Group.Center, Snapshot.Resources[Index].Location);
+
+				if (!ClaimedResources[Index] && Distance < BestDistance)
+				{
+					BestDistance = Distance;
+					ResourceIndex = Index;
+				}
+			}
+
+			if (ResourceIndex != INDEX_NONE)
+			{
+				ClaimedResources[ResourceIndex] = true;
+				Order.Goal = Snapshot.Resources[ResourceIndex].Location;
+
+			} else {
+
+				// nothing to go for, so scout. The goal only depends on the seed, frame and area, so plans are repeatable
+				FRandomStream Random(HashCombineFast(HashCombineFast(::GetTypeHash(Params.Seed), ::GetTypeHash(Snapshot.Frame)), GetTypeHash(Group.Cell)));
+
+				Order.Goal = FVector(Random.FRandRange(ScoutingBounds.Min.X, ScoutingBounds.Max.X), Random.FRandRange(ScoutingBounds.Min.Y, ScoutingBounds.Max.Y), Group.Center.Z);
+			}
+		}
+
+		// the group is already there
+		if (!Order.bInteract && FVector::Dist2D(Order.Goal, Group.Center) < Params.GroupRadius * 0.5f)
+		{
+			continue;
+		}
+
+		for (const int32 Index : Group.UnitIndices)
+		{
+			Order.Units.Add(Snapshot.Units[Index].UnitId);
+		}
+
+		Result.Orders.Add(MoveTemp(Order));
+	}
+
+	StampTime();
+	return Result;
+}
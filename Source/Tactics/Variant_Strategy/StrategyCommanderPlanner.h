@@ -0,0 +1,122 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StrategyUnitSet.h"
+
+/**
+ *  Read only copy of the world state an AI commander plans from.
+ *  It's filled on the game thread and never changed once it's handed to the planner,
+ *  so the planner can read it from a worker thread without locks.
+ */
+struct FStrategyCommanderSnapshot
+{
+	/** A unit as seen by the commander */
+	struct FUnit
+	{
+		/** Id in the unit registry */
+		int32 UnitId = INDEX_NONE;
+
+		/** Last known location */
+		FVector Location = FVector::ZeroVector;
+
+		/** Distance the unit can see, used for the commander's own units */
+		float SightRadius = 0.0f;
+
+		/** Team the unit belongs to */
+		uint8 TeamId = 0;
+
+		/** If true, the unit is carrying out a recent commander order */
+		bool bBusy = false;
+	};
+
+	/** A resource node that can be gathered */
+	struct FResource
+	{
+		/** Node location */
+		FVector Location = FVector::ZeroVector;
+
+		/** Resource type, as its enum value */
+		uint8 Type = 0;
+	};
+
+	/** Frame the snapshot was taken on */
+	uint32 Frame = 0;
+
+	/** All registered units, in registry order */
+	TArray<FUnit> Units;
+
+	/** Resource nodes that can be gathered */
+	TArray<FResource> Resources;
+
+	/** Empties the snapshot, keeping its allocations for reuse */
+	void Reset();
+};
+
+/** Settings for a single plan */
+struct FStrategyCommanderPlanParams
+{
+	/** Team played by the commander */
+	uint8 TeamId = 1;
+
+	/** Time the plan may take, in seconds. Groups left over are planned next time */
+	double TimeBudget = 0.002;
+
+	/** Radius of the area units are grouped in */
+	float GroupRadius = 1500.0f;
+
+	/** Max number of units in a group */
+	int32 MaxGroupSize = 16;
+
+	/** Max number of orders in a plan */
+	int32 MaxOrders = 8;
+
+	/** Seed for the scouting goals, combined with the snapshot frame */
+	int32 Seed = 0;
+};
+
+/** Group move picked by the planner */
+struct FStrategyCommanderOrder
+{
+	/** Units to move */
+	FStrategyUnitSet Units;
+
+	/** Move goal */
+	FVector Goal = FVector::ZeroVector;
+
+	/** If true, the units interact with the enemies around the goal */
+	bool bInteract = false;
+};
+
+/** Result of a plan */
+struct FStrategyCommanderPlan
+{
+	/** Orders to apply, most important first */
+	TArray<FStrategyCommanderOrder> Orders;
+
+	/** Number of idle groups found, and how many of them were planned before the budget ran out */
+	int32 NumGroups = 0;
+	int32 NumPlannedGroups = 0;
+
+	/** Number of enemy units the commander's units can see */
+	int32 NumVisibleEnemies = 0;
+
+	/** Worker thread time spent planning, in milliseconds */
+	float PlanMs = 0.0f;
+
+	/** If true, the plan stopped early because it ran out of time */
+	bool bOutOfBudget = false;
+};
+
+/**
+ *  Planning for the AI commander. Runs on any thread, reading nothing but the snapshot.
+ *  Idle units are grouped by area. Each group attacks the closest visible enemy cluster it can take on,
+ *  or heads for the closest unclaimed resource node, or scouts a random point.
+ *  Larger groups are planned first, and planning stops when the time budget runs out.
+ */
+namespace StrategyCommanderPlanner
+{
+	/** Plans orders for the commander's idle units */
+	FStrategyCommanderPlan Plan(const FStrategyCommanderSnapshot& Snapshot, const FStrategyCommanderPlanParams& Params);
+}
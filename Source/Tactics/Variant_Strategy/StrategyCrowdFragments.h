@@ -0,0 +1,86 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "StrategyCrowdFragments.generated.h"
+
+class AStrategyUnit;
+
+/** Links a crowd entity to its unit registry id and the actor class it's promoted to */
+USTRUCT()
+struct FStrategyCrowdUnitFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** Id in the unit registry, shared with the actor when promoted */
+	int32 UnitId = INDEX_NONE;
+
+	/** Actor class to spawn when promoted */
+	TSubclassOf<AStrategyUnit> UnitClass;
+};
+
+/** Crowd unit velocity */
+USTRUCT()
+struct FStrategyCrowdVelocityFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** Current velocity */
+	FVector Value = FVector::ZeroVector;
+
+	/** Separation from nearby units, written by the avoidance processor */
+	FVector Avoidance = FVector::ZeroVector;
+};
+
+/** Crowd unit selection state */
+USTRUCT()
+struct FStrategyCrowdSelectionFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** If true, the unit is in the player's selection and should be promoted */
+	bool bSelected = false;
+};
+
+/** Move order carried by a crowd unit */
+USTRUCT()
+struct FStrategyCrowdOrderFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** Move goal */
+	FVector Goal = FVector::ZeroVector;
+
+	/** Distance to the goal that counts as arrived */
+	float AcceptanceRadius = 0.0f;
+
+	/** If true, the unit is moving to the goal */
+	bool bActive = false;
+
+	/** If true, the unit arrived this frame and the arrival still has to be reported */
+	bool bArrived = false;
+};
+
+/** Movement parameters shared by all crowd units, taken from the unit class */
+USTRUCT()
+struct FStrategyCrowdParamsFragment : public FMassConstSharedFragment
+{
+	GENERATED_BODY()
+
+	/** Max movement speed */
+	float MaxSpeed = 500.0f;
+
+	/** Distance under which units push each other apart */
+	float AvoidanceRadius = 100.0f;
+
+	/** Speed of the separation push at zero distance */
+	float AvoidanceStrength = 300.0f;
+
+	/** Distance to the goal where units start slowing down */
+	float SlowdownDistance = 200.0f;
+
+	/** Height of the unit's origin over the ground */
+	float HalfHeight = 90.0f;
+};
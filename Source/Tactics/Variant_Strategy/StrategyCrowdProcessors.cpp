@@ -0,0 +1,261 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyCrowdProcessors.h"
+#include "StrategyCrowdFragments.h"
+#include "StrategyCrowdSubsystem.h"
+#include "StrategyUnitRegistry.h"
+#include "MassCommonFragments.h"
+#include "MassCommonTypes.h"
+#include "MassExecutionContext.h"
+
+/** Crowd processors run in every net mode. Leaving out EProcessorExecutionFlags::Editor keeps them out of editor worlds, which have no crowd subsystem anyway */
+static const int32 CrowdExecutionFlags = int32(EProcessorExecutionFlags::Standalone | EProcessorExecutionFlags::Server | EProcessorExecutionFlags::Client);
+
+UStrategyCrowdAvoidanceProcessor::UStrategyCrowdAvoidanceProcessor()
+	: EntityQuery(*this)
+{
+	ExecutionFlags = CrowdExecutionFlags;
+	ExecutionOrder.ExecuteInGroup = UE::Mass::ProcessorGroupNames::Avoidance;
+	ExecutionOrder.ExecuteBefore.Add(UE::Mass::ProcessorGroupNames::Movement);
+}
+
+void UStrategyCrowdAvoidanceProcessor::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FStrategyCrowdVelocityFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddConstSharedRequirement<FStrategyCrowdParamsFragment>();
+}
+
+void UStrategyCrowdAvoidanceProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyCrowdAvoidanceProcessor_Execute);
+
+	// gather all the unit locations
+	Locations.Reset();
+	float Radius = 0.0f;
+
+	EntityQuery.ForEachEntityChunk(Context, [this, &Radius](FMassExecutionContext& Context)
+	{
+		const TConstArrayView<FTransformFragment> Transforms = Context.GetFragmentView<FTransformFragment>();
+		Radius = Context.GetConstSharedFragment<FStrategyCrowdParamsFragment>().AvoidanceRadius;
+
+		for (int32 EntityIndex = 0; EntityIndex < Context.GetNumEntities(); ++EntityIndex)
+		{
+			Locations.Add(Transforms[EntityIndex].GetTransform().GetLocation());
+		}
+	});
+
+	if (Locations.Num() == 0 || Radius <= 0.0f)
+	{
+		return;
+	}
+
+	// bucket them into cells the size of the avoidance radius
+	auto GetCell = [Radius](const FVector& Location)
+	{
+		return FIntPoint(FMath::FloorToInt32(Location.X / Radius), FMath::FloorToInt32(Location.Y / Radius));
+	};
+
+	for (TPair<FIntPoint, TArray<int32>>& Pair : Grid)
+	{
+		Pair.Value.Reset();
+	}
+
+	for (int32 Index = 0; Index < Locations.Num(); ++Index)
+	{
+		Grid.FindOrAdd(GetCell(Locations[Index])).Add(Index);
+	}
+
+	// push each unit away from its neighbours. The query visits the units in the same order as before
+	const float RadiusSquared = FMath::Square(Radius);
+	int32 Index = 0;
+
+	EntityQuery.ForEachEntityChunk(Context, [&](FMassExecutionContext& Context)
+	{
+		const FStrategyCrowdParamsFragment& Params = Context.GetConstSharedFragment<FStrategyCrowdParamsFragment>();
+		const TArrayView<FStrategyCrowdVelocityFragment> Velocities = Context.GetMutableFragmentView<FStrategyCrowdVelocityFragment>();
+
+		for (int32 EntityIndex = 0; EntityIndex < Context.GetNumEntities(); ++EntityIndex, ++Index)
+		{
+			const FVector& Location = Locations[Index];
+			const FIntPoint Cell = GetCell(Location);
+
+			FVector Push = FVector::ZeroVector;
+
+			for (int32 CellX = Cell.X - 1; CellX <= Cell.X + 1; ++CellX)
+			{
+				for (int32 CellY = Cell.Y - 1; CellY <= Cell.Y + 1; ++CellY)
+				{
+					if (const TArray<int32>* CellIndices = Grid.Find(FIntPoint(CellX, CellY)))
+					{
+						for (const int32 Other : *CellIndices)
+						{
+							FVector Delta = Location - Locations[Other];
+							Delta.Z = 0.0f;
+
+							const float DistanceSquared = Delta.SizeSquared();
+
+							// stronger the closer we are. Units on the exact same spot can't pick a side, so skip them
+							if (Other != Index && DistanceSquared < RadiusSquared && DistanceSquared > UE_KINDA_SMALL_NUMBER)
+							{
+								const float Distance = FMath::Sqrt(DistanceSquared);
+								Push += (Delta / Distance) * (1.0f - Distance / Radius);
+							}
+						}
+					}
+				}
+			}
+
+			Velocities[EntityIndex].Avoidance = Push * Params.AvoidanceStrength;
+		}
+	});
+
+	// drop the cells nobody is in anymore
+	for (auto It = Grid.CreateIterator(); It; ++It)
+	{
+		if (It.Value().Num() == 0)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+UStrategyCrowdMovementProcessor::UStrategyCrowdMovementProcessor()
+	: EntityQuery(*this)
+{
+	ExecutionFlags = CrowdExecutionFlags;
+	ExecutionOrder.ExecuteInGroup = UE::Mass::ProcessorGroupNames::Movement;
+}
+
+void UStrategyCrowdMovementProcessor::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FStrategyCrowdVelocityFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FStrategyCrowdOrderFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddConstSharedRequirement<FStrategyCrowdParamsFragment>();
+}
+
+void UStrategyCrowdMovementProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyCrowdMovementProcessor_Execute);
+
+	EntityQuery.ForEachEntityChunk(Context, [](FMassExecutionContext& Context)
+	{
+		const FStrategyCrowdParamsFragment& Params = Context.GetConstSharedFragment<FStrategyCrowdParamsFragment>();
+		const TArrayView<FTransformFragment> Transforms = Context.GetMutableFragmentView<FTransformFragment>();
+		const TArrayView<FStrategyCrowdVelocityFragment> Velocities = Context.GetMutableFragmentView<FStrategyCrowdVelocityFragment>();
+		const TArrayView<FStrategyCrowdOrderFragment> Orders = Context.GetMutableFragmentView<FStrategyCrowdOrderFragment>();
+
+		const float DeltaTime = Context.GetDeltaTimeSeconds();
+
+		for (int32 EntityIndex = 0; EntityIndex < Context.GetNumEntities(); ++EntityIndex)
+		{
+			FTransform& Transform = Transforms[EntityIndex].GetMutableTransform();
+			FStrategyCrowdVelocityFragment& Velocity = Velocities[EntityIndex];
+			FStrategyCrowdOrderFragment& Order = Orders[EntityIndex];
+
+			FVector Location = Transform.GetLocation();
+			FVector Desired = FVector::ZeroVector;
+
+			// head for the goal, slowing down as we get close
+			if (Order.bActive)
+			{
+				FVector ToGoal = Order.Goal - Location;
+				ToGoal.Z = 0.0f;
+
+				const float Distance = ToGoal.Size();
+
+				if (Distance <= Order.AcceptanceRadius)
+				{
+					Order.bActive = false;
+					Order.bArrived = true;
+
+				} else {
+
+					const float Scale = Params.SlowdownDistance > 0.0f ? FMath::Clamp(Distance / Params.SlowdownDistance, 0.1f, 1.0f) : 1.0f;
+					Desired = (ToGoal / Distance) * Params.MaxSpeed * Scale;
+				}
+			}
+
+			// add the avoidance push and move
+			Velocity.Value = (Desired + Velocity.Avoidance).GetClampedToMaxSize2D(Params.MaxSpeed);
+			Velocity.Value.Z = 0.0f;
+
+			Location += Velocity.Value * DeltaTime;
+			Transform.SetLocation(Location);
+
+			// face the direction of travel
+			if (!Velocity.Value.IsNearlyZero(1.0f))
+			{
+				Transform.SetRotation(Velocity.Value.ToOrientationQuat());
+			}
+		}
+	});
+}
+
+UStrategyCrowdSyncProcessor::UStrategyCrowdSyncProcessor()
+	: EntityQuery(*this)
+{
+	ExecutionFlags = CrowdExecutionFlags;
+	ExecutionOrder.ExecuteInGroup = UE::Mass::ProcessorGroupNames::UpdateWorldFromMass;
+	ExecutionOrder.ExecuteAfter.Add(UE::Mass::ProcessorGroupNames::Movement);
+
+	// writes to the registry and the crowd subsystem
+	bRequiresGameThreadExecution = true;
+}
+
+void UStrategyCrowdSyncProcessor::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FStrategyCrowdUnitFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FStrategyCrowdOrderFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddConstSharedRequirement<FStrategyCrowdParamsFragment>();
+}
+
+void UStrategyCrowdSyncProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyCrowdSyncProcessor_Execute);
+
+	const UWorld* World = EntityManager.GetWorld();
+	UStrategyCrowdSubsystem* Crowd = World ? World->GetSubsystem<UStrategyCrowdSubsystem>() : nullptr;
+	UStrategyUnitRegistry* Registry = World ? World->GetSubsystem<UStrategyUnitRegistry>() : nullptr;
+
+	if (!Crowd || !Registry)
+	{
+		return;
+	}
+
+	// rebuild the instance list from scratch every frame
+	Crowd->InstanceTransforms.Reset();
+	Crowd->InstanceUnitIds.Reset();
+
+	EntityQuery.ForEachEntityChunk(Context, [Crowd, Registry](FMassExecutionContext& Context)
+	{
+		const FStrategyCrowdParamsFragment& Params = Context.GetConstSharedFragment<FStrategyCrowdParamsFragment>();
+		const TConstArrayView<FTransformFragment> Transforms = Context.GetFragmentView<FTransformFragment>();
+		const TConstArrayView<FStrategyCrowdUnitFragment> Units = Context.GetFragmentView<FStrategyCrowdUnitFragment>();
+		const TArrayView<FStrategyCrowdOrderFragment> Orders = Context.GetMutableFragmentView<FStrategyCrowdOrderFragment>();
+
+		for (int32 EntityIndex = 0; EntityIndex < Context.GetNumEntities(); ++EntityIndex)
+		{
+			const FTransform& Transform = Transforms[EntityIndex].GetTransform();
+			const int32 UnitId = Units[EntityIndex].UnitId;
+
+			Registry->SetCrowdUnitLocation(UnitId, Transform.GetLocation());
+
+			// the mesh is drawn from the unit's feet
+			Crowd->InstanceTransforms.Emplace(Transform.GetRotation(), Transform.GetLocation() - FVector(0.0f, 0.0f, Params.HalfHeight));
+			Crowd->InstanceUnitIds.Add(UnitId);
+
+			// report arrivals outside of Mass processing
+			if (Orders[EntityIndex].bArrived)
+			{
+				Orders[EntityIndex].bArrived = false;
+				Crowd->PendingArrivals.Add(UnitId);
+			}
+		}
+	});
+
+	Crowd->bInstancesDirty = true;
+}
@@ -0,0 +1,83 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "MassEntityQuery.h"
+#include "StrategyCrowdProcessors.generated.h"
+
+/**
+ *  Pushes crowd units apart when they get closer than the avoidance radius.
+ *  Units are bucketed into a grid the size of the avoidance radius, so each unit only checks the neighbouring cells.
+ */
+UCLASS()
+class UStrategyCrowdAvoidanceProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Constructor */
+	UStrategyCrowdAvoidanceProcessor();
+
+protected:
+
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	/** Crowd units */
+	FMassEntityQuery EntityQuery;
+
+	/** Unit locations gathered this frame, in query order */
+	TArray<FVector> Locations;
+
+	/** Indices into the locations array, by grid cell */
+	TMap<FIntPoint, TArray<int32>> Grid;
+};
+
+/**
+ *  Steers crowd units straight towards their order's goal, adds the avoidance push and moves them.
+ *  Units that reach the goal are flagged so the arrival can be reported on the game thread.
+ */
+UCLASS()
+class UStrategyCrowdMovementProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Constructor */
+	UStrategyCrowdMovementProcessor();
+
+protected:
+
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	/** Crowd units */
+	FMassEntityQuery EntityQuery;
+};
+
+/**
+ *  Copies crowd unit state back to the game: locations go to the unit registry,
+ *  transforms to the crowd's instanced mesh, and arrivals to the crowd subsystem.
+ */
+UCLASS()
+class UStrategyCrowdSyncProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Constructor */
+	UStrategyCrowdSyncProcessor();
+
+protected:
+
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	/** Crowd units */
+	FMassEntityQuery EntityQuery;
+};
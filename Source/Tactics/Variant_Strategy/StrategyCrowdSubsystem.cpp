@@ -0,0 +1,496 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyCrowdSubsystem.h"
+#include "StrategyCrowdFragments.h"
+#include "StrategyUnit.h"
+#include "StrategyUnitRegistry.h"
+#include "StrategyGameMode.h"
+#include "MassEntitySubsystem.h"
+#include "MassEntityManager.h"
+#include "MassCommonFragments.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerStart.h"
+#include "NavigationSystem.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Tactics.h"
+
+void UStrategyCrowdSubsystem::SpawnCrowdUnits(int32 Count, const FVector& Center, float Radius, int32 TeamId)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyCrowdSubsystem_SpawnCrowdUnits);
+
+	const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	if (!UnitRegistry || !NavSys || !EnsureArchetype())
+	{
+		return;
+	}
+
+	// unless told otherwise, crowd units join the team of the class they're promoted to
+	const uint8 UnitTeamId = TeamId != INDEX_NONE ? static_cast<uint8>(TeamId) : DefaultUnitClass ? GetDefault<AStrategyUnit>(DefaultUnitClass)->GetTeamId() : 0;
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		FNavLocation Point;
+
+		if (!NavSys->GetRandomPointInNavigableRadius(Center, Radius, Point))
+		{
+			continue;
+		}
+
+		// stand on the navmesh like a spawned actor would
+		const FVector Location = Point.Location + FVector(0.0f, 0.0f, UnitHalfHeight);
+		const FTransform Transform(FRotator(0.0f, FMath::FRandRange(0.0f, 360.0f), 0.0f), Location);
+
+		const int32 UnitId = UnitRegistry->RegisterCrowdUnit(Location, UnitTeamId);
+		CreateCrowdEntity(UnitId, DefaultUnitClass, Transform);
+
+		InstanceTransforms.Emplace(Transform.GetRotation(), Point.Location);
+		InstanceUnitIds.Add(UnitId);
+	}
+
+	bInstancesDirty = true;
+}
+
+AStrategyUnit* UStrategyCrowdSubsystem::PromoteUnit(int32 UnitId)
+{
+	if (!UnitRegistry)
+	{
+		return nullptr;
+	}
+
+	// already an actor?
+	if (AStrategyUnit* Existing = UnitRegistry->GetUnit(UnitId))
+	{
+		return Existing;
+	}
+
+	const FMassEntityHandle* FoundEntity = Entities.Find(UnitId);
+	FMassEntityManager* EntityManager = GetEntityManager();
+
+	if (!FoundEntity || !EntityManager)
+	{
+		return nullptr;
+	}
+
+	const FMassEntityHandle Entity = *FoundEntity;
+
+	const FStrategyCrowdUnitFragment& UnitFragment = EntityManager->GetFragmentDataChecked<FStrategyCrowdUnitFragment>(Entity);
+	const TSubclassOf<AStrategyUnit> UnitClass = UnitFragment.UnitClass ? UnitFragment.UnitClass : DefaultUnitClass;
+
+	if (!UnitClass)
+	{
+		return nullptr;
+	}
+
+	// keep the order to hand over once the actor is up
+	const FStrategyCrowdOrderFragment Order = EntityManager->GetFragmentDataChecked<FStrategyCrowdOrderFragment>(Entity);
+
+	const FTransform& EntityTransform = EntityManager->GetFragmentDataChecked<FTransformFragment>(Entity).GetTransform();
+	const FTransform SpawnTransform(FRotator(0.0f, EntityTransform.Rotator().Yaw, 0.0f), EntityTransform.GetLocation());
+
+	// the actor takes over the crowd unit's registry id when it begins play
+	AStrategyUnit* Unit = GetWorld()->SpawnActorDeferred<AStrategyUnit>(UnitClass, SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+
+	if (!Unit)
+	{
+		return nullptr;
+	}
+
+	// keep the team the unit had in the crowd
+	Unit->ClaimRegistryId(UnitId);
+	Unit->SetTeamId(UnitRegistry->GetUnitTeam(UnitId));
+	Unit->FinishSpawning(SpawnTransform);
+
+	// the entity is no longer needed
+	EntityManager->DestroyEntity(Entity);
+	Entities.Remove(UnitId);
+
+	const int32 InstanceIndex = InstanceUnitIds.Find(UnitId);
+
+	if (InstanceIndex != INDEX_NONE)
+	{
+		InstanceUnitIds.RemoveAtSwap(InstanceIndex, EAllowShrinking::No);
+		InstanceTransforms.RemoveAtSwap(InstanceIndex, EAllowShrinking::No);
+		bInstancesDirty = true;
+	}
+
+	PromotionTimes.Add(UnitId, GetWorld()->GetTimeSeconds());
+	++NumPromotions;
+
+	// let listeners restore the selection and subscribe to the move before it resumes
+	OnUnitPromoted.Broadcast(Unit);
+
+	if (Order.bActive)
+	{
+		Unit->MoveToLocation(Order.Goal, Order.AcceptanceRadius);
+	}
+
+	return Unit;
+}
+
+bool UStrategyCrowdSubsystem::DemoteUnit(AStrategyUnit* Unit)
+{
+	if (!IsValid(Unit) || !UnitRegistry || UnitRegistry->GetUnit(Unit->GetRegistryId()) != Unit || !EnsureArchetype())
+	{
+		return false;
+	}
+
+	const int32 UnitId = Unit->GetRegistryId();
+
+	// hand over the move in progress
+	FVector Goal;
+	float AcceptanceRadius = 0.0f;
+	const bool bMoving = Unit->GetMoveGoal(Goal, AcceptanceRadius);
+
+	const FTransform Transform(FRotator(0.0f, Unit->GetActorRotation().Yaw, 0.0f), Unit->GetActorLocation());
+
+	// keep the id alive through the actor's EndPlay
+	UnitRegistry->DetachUnit(Unit);
+
+	const FMassEntityHandle Entity = CreateCrowdEntity(UnitId, Unit->GetClass(), Transform);
+
+	FMassEntityManager* EntityManager = GetEntityManager();
+
+	FStrategyCrowdOrderFragment& Order = EntityManager->GetFragmentDataChecked<FStrategyCrowdOrderFragment>(Entity);
+	Order.Goal = Goal;
+	Order.AcceptanceRadius = AcceptanceRadius;
+	Order.bActive = bMoving;
+
+	EntityManager->GetFragmentDataChecked<FStrategyCrowdSelectionFragment>(Entity).bSelected = Unit->IsSelected();
+
+	// aborting the actor's move would report a false arrival, the crowd reports the real one
+	Unit->OnMoveCompleted.Clear();
+	Unit->Destroy();
+
+	InstanceTransforms.Emplace(Transform.GetRotation(), Transform.GetLocation() - FVector(0.0f, 0.0f, UnitHalfHeight));
+	InstanceUnitIds.Add(UnitId);
+	bInstancesDirty = true;
+
+	PromotionTimes.Remove(UnitId);
+	++NumDemotions;
+
+	return true;
+}
+
+void UStrategyCrowdSubsystem::SetUnitSelected(int32 UnitId, bool bSelected)
+{
+	const FMassEntityHandle* Entity = Entities.Find(UnitId);
+	FMassEntityManager* EntityManager = GetEntityManager();
+
+	if (Entity && EntityManager)
+	{
+		EntityManager->GetFragmentDataChecked<FStrategyCrowdSelectionFragment>(*Entity).bSelected = bSelected;
+	}
+}
+
+void UStrategyCrowdSubsystem::MoveUnit(int32 UnitId, const FVector& Goal, float AcceptanceRadius)
+{
+	const FMassEntityHandle* Entity = Entities.Find(UnitId);
+	FMassEntityManager* EntityManager = GetEntityManager();
+
+	if (Entity && EntityManager)
+	{
+		FStrategyCrowdOrderFragment& Order = EntityManager->GetFragmentDataChecked<FStrategyCrowdOrderFragment>(*Entity);
+		Order.Goal = Goal;
+		Order.AcceptanceRadius = AcceptanceRadius;
+		Order.bActive = true;
+		Order.bArrived = false;
+	}
+}
+
+void UStrategyCrowdSubsystem::DumpStats() const
+{
+	const int32 NumUnits = UnitRegistry ? UnitRegistry->GetNumUnits() : 0;
+
+	UE_LOG(LogTactics, Display, TEXT("Strategy crowd: %d crowd units, %d actors, %d instances. Promotions %d, demotions %d"),
+		Entities.Num(), NumUnits - Entities.Num(), InstanceTransforms.Num(), NumPromotions, NumDemotions);
+}
+
+void UStrategyCrowdSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyCrowdSubsystem_Tick);
+
+	// report the arrivals gathered during Mass processing
+	if (PendingArrivals.Num() > 0)
+	{
+		const TArray<int32> Arrivals = MoveTemp(PendingArrivals);
+		PendingArrivals.Reset();
+
+		for (const int32 UnitId : Arrivals)
+		{
+			OnUnitArrived.Broadcast(UnitId);
+		}
+	}
+
+	UpdateConversions();
+	UpdateInstances();
+}
+
+TStatId UStrategyCrowdSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyCrowdSubsystem, STATGROUP_Tickables);
+}
+
+bool UStrategyCrowdSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	// the crowd only exists in game worlds, so editor worlds have no crowd entities for the processors to run on
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UStrategyCrowdSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	UnitRegistry = InWorld.GetSubsystem<UStrategyUnitRegistry>();
+
+	// the crowd is only used by the strategy game mode
+	const AStrategyGameMode* GameMode = Cast<AStrategyGameMode>(InWorld.GetAuthGameMode());
+
+	if (!GameMode)
+	{
+		return;
+	}
+
+	DefaultUnitClass = GameMode->GetCrowdUnitClass();
+	PromotionMargin = GameMode->GetCrowdPromotionMargin();
+	DemotionMargin = FMath::Max(GameMode->GetCrowdDemotionMargin(), PromotionMargin);
+	MinPromotedTime = GameMode->GetCrowdMinPromotedTime();
+	MaxConversionsPerFrame = GameMode->GetCrowdMaxConversionsPerFrame();
+
+	// set up the instanced mesh on a transient actor
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	RenderActor = InWorld.SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+
+	if (RenderActor)
+	{
+		Instances = NewObject<UInstancedStaticMeshComponent>(RenderActor, TEXT("CrowdInstances"));
+		Instances->SetStaticMesh(GameMode->GetCrowdMesh());
+		Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Instances->SetCanEverAffectNavigation(false);
+		Instances->SetMobility(EComponentMobility::Movable);
+
+		RenderActor->SetRootComponent(Instances);
+		Instances->RegisterComponent();
+	}
+
+	// spawn the initial crowd around the player start
+	if (GameMode->GetInitialCrowdUnits() > 0)
+	{
+		FVector Center = FVector::ZeroVector;
+
+		for (TActorIterator<APlayerStart> It(&InWorld); It; ++It)
+		{
+			Center = It->GetActorLocation();
+			break;
+		}
+
+		SpawnCrowdUnits(GameMode->GetInitialCrowdUnits(), Center, GameMode->GetInitialCrowdRadius());
+	}
+}
+
+void UStrategyCrowdSubsystem::Deinitialize()
+{
+	// the entities go away with the world's entity manager
+	Entities.Empty();
+	PromotionTimes.Empty();
+	InstanceTransforms.Empty();
+	InstanceUnitIds.Empty();
+	PendingArrivals.Empty();
+
+	Super::Deinitialize();
+}
+
+FMassEntityManager* UStrategyCrowdSubsystem::GetEntityManager() const
+{
+	UMassEntitySubsystem* EntitySubsystem = GetWorld() ? GetWorld()->GetSubsystem<UMassEntitySubsystem>() : nullptr;
+
+	return EntitySubsystem ? &EntitySubsystem->GetMutableEntityManager() : nullptr;
+}
+
+bool UStrategyCrowdSubsystem::EnsureArchetype()
+{
+	if (Archetype.IsValid())
+	{
+		return true;
+	}
+
+	FMassEntityManager* EntityManager = GetEntityManager();
+
+	if (!EntityManager)
+	{
+		return false;
+	}
+
+	// take the movement parameters from the unit class, so crowd units move like the actors
+	FStrategyCrowdParamsFragment Params;
+
+	if (const AStrategyUnit* DefaultUnit = DefaultUnitClass ? DefaultUnitClass->GetDefaultObject<AStrategyUnit>() : nullptr)
+	{
+		Params.MaxSpeed = DefaultUnit->GetCharacterMovement()->MaxWalkSpeed;
+		Params.AvoidanceRadius = DefaultUnit->GetCapsuleComponent()->GetScaledCapsuleRadius() * 2.0f;
+		Params.HalfHeight = DefaultUnit->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+	}
+
+	UnitHalfHeight = Params.HalfHeight;
+
+	SharedValues = FMassArchetypeSharedFragmentValues();
+	SharedValues.AddConstSharedFragment(EntityManager->GetOrCreateConstSharedFragment(Params));
+	SharedValues.Sort();
+
+	Archetype = EntityManager->CreateArchetype({
+		FTransformFragment::StaticStruct(),
+		FStrategyCrowdUnitFragment::StaticStruct(),
+		FStrategyCrowdVelocityFragment::StaticStruct(),
+		FStrategyCrowdSelectionFragment::StaticStruct(),
+		FStrategyCrowdOrderFragment::StaticStruct(),
+		FStrategyCrowdParamsFragment::StaticStruct()
+	});
+
+	return Archetype.IsValid();
+}
+
+FMassEntityHandle UStrategyCrowdSubsystem::CreateCrowdEntity(int32 UnitId, TSubclassOf<AStrategyUnit> UnitClass, const FTransform& Transform)
+{
+	FMassEntityManager* EntityManager = GetEntityManager();
+
+	const FMassEntityHandle Entity = EntityManager->CreateEntity(Archetype, SharedValues);
+
+	EntityManager->GetFragmentDataChecked<FTransformFragment>(Entity).SetTransform(Transform);
+
+	FStrategyCrowdUnitFragment& UnitFragment = EntityManager->GetFragmentDataChecked<FStrategyCrowdUnitFragment>(Entity);
+	UnitFragment.UnitId = UnitId;
+	UnitFragment.UnitClass = UnitClass;
+
+	Entities.Add(UnitId, Entity);
+
+	return Entity;
+}
+
+void UStrategyCrowdSubsystem::UpdateConversions()
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyCrowdSubsystem_UpdateConversions);
+
+	FMassEntityManager* EntityManager = GetEntityManager();
+
+	if (!UnitRegistry || !EntityManager || !Archetype.IsValid())
+	{
+		return;
+	}
+
+	// without a camera there's nothing to convert for
+	FBox2D ViewBounds;
+
+	if (!UStrategyUnitRegistry::GetPlayerViewBounds(GetWorld()->GetFirstPlayerController(), UnitRegistry->GetAverageUnitHeight(), ViewBounds))
+	{
+		return;
+	}
+
+	const FBox2D PromotionBounds = ViewBounds.ExpandBy(PromotionMargin);
+	const FBox2D DemotionBounds = ViewBounds.ExpandBy(DemotionMargin);
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// decide first, since converting changes the registry
+	TArray<int32> ToPromote;
+	TArray<AStrategyUnit*> ToDemote;
+
+	for (const int32 UnitId : UnitRegistry->GetUnitIds())
+	{
+		FVector Location;
+		UnitRegistry->GetUnitLocation(UnitId, Location);
+
+		if (Entities.Contains(UnitId))
+		{
+			// only crowd units near the camera are promoted. Selected ones carry their selection and orders as crowd units,
+			// and the units an order interacts with are promoted when it's resolved
+			if (PromotionBounds.IsInside(FVector2D(Location)))
+			{
+				ToPromote.Add(UnitId);
+			}
+
+		} else if (AStrategyUnit* Unit = UnitRegistry->GetUnit(UnitId)) {
+
+			// keep selected units and recently promoted ones as actors
+			const double* PromotionTime = PromotionTimes.Find(UnitId);
+
+			if (!Unit->IsSelected() && !DemotionBounds.IsInside(FVector2D(Location)) && (!PromotionTime || Now - *PromotionTime >= MinPromotedTime))
+			{
+				ToDemote.Add(Unit);
+			}
+		}
+	}
+
+	int32 Budget = MaxConversionsPerFrame;
+
+	for (int32 Index = 0; Index < ToPromote.Num() && Budget > 0; ++Index, --Budget)
+	{
+		PromoteUnit(ToPromote[Index]);
+	}
+
+	for (int32 Index = 0; Index < ToDemote.Num() && Budget > 0; ++Index, --Budget)
+	{
+		DemoteUnit(ToDemote[Index]);
+	}
+}
+
+void UStrategyCrowdSubsystem::UpdateInstances()
+{
+	if (!bInstancesDirty || !Instances)
+	{
+		return;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyCrowdSubsystem_UpdateInstances);
+
+	bInstancesDirty = false;
+
+	// rebuild the instances when the count changes, otherwise update them in place
+	if (Instances->GetInstanceCount() != InstanceTransforms.Num())
+	{
+		Instances->ClearInstances();
+		Instances->AddInstances(InstanceTransforms, false, true);
+
+	} else {
+
+		Instances->BatchUpdateInstancesTransforms(0, InstanceTransforms, true, true);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CrowdSpawnCommand(
+	TEXT("Tactics.Crowd.Spawn"),
+	TEXT("Spawns strategy crowd units around the player's camera. Usage: Tactics.Crowd.Spawn [Count] [Radius] [TeamId]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UStrategyCrowdSubsystem* Crowd = World ? World->GetSubsystem<UStrategyCrowdSubsystem>() : nullptr;
+		const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+
+		if (Crowd && PlayerController && PlayerController->GetPawn())
+		{
+			const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000;
+			const float Radius = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 10000.0f;
+			const int32 TeamId = Args.Num() > 2 ? FMath::Clamp(FCString::Atoi(*Args[2]), 0, 255) : INDEX_NONE;
+
+			Crowd->SpawnCrowdUnits(Count, PlayerController->GetPawn()->GetActorLocation(), Radius, TeamId);
+			Crowd->DumpStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs CrowdDumpCommand(
+	TEXT("Tactics.Crowd.Dump"),
+	TEXT("Logs the number of crowd units and actors, and the promotion and demotion counts."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UStrategyCrowdSubsystem* Crowd = World ? World->GetSubsystem<UStrategyCrowdSubsystem>() : nullptr)
+		{
+			Crowd->DumpStats();
+		}
+	}));
@@ -0,0 +1,150 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MassEntityTypes.h"
+#include "StrategyCrowdSubsystem.generated.h"
+
+class AStrategyUnit;
+class UInstancedStaticMeshComponent;
+class UStrategyUnitRegistry;
+struct FMassEntityManager;
+
+/** Delegate to report that a crowd unit reached its move goal */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnStrategyCrowdUnitArrivedDelegate, int32 /* UnitId */);
+
+/** Delegate to report that a crowd unit was promoted to an actor */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnStrategyCrowdUnitPromotedDelegate, AStrategyUnit* /* Unit */);
+
+/**
+ *  Keeps strategy units outside the camera view as lightweight Mass entities drawn with a single instanced mesh.
+ *  Crowd units near the camera, or targeted by an order's interaction, are promoted to full AStrategyUnit actors.
+ *  Actors that leave the camera view are demoted back. Both keep the same unit registry id,
+ *  so selection, control groups and orders carry over, and a move in progress is handed over both ways.
+ *  Settings are read from the strategy game mode.
+ */
+UCLASS()
+class UStrategyCrowdSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	friend class UStrategyCrowdSyncProcessor;
+
+public:
+
+	/** Spawns crowd units at random navigable points around a location. They join the given team, or the unit class team if it's INDEX_NONE */
+	void SpawnCrowdUnits(int32 Count, const FVector& Center, float Radius, int32 TeamId = INDEX_NONE);
+
+	/** Promotes a crowd unit to an actor right away. Returns the unit's actor, or nullptr if it couldn't be spawned */
+	AStrategyUnit* PromoteUnit(int32 UnitId);
+
+	/** Demotes an actor to a crowd unit, handing over its move. Returns false if it couldn't be demoted */
+	bool DemoteUnit(AStrategyUnit* Unit);
+
+	/** Updates a crowd unit's selection. It carries over to the actor when the unit is promoted */
+	void SetUnitSelected(int32 UnitId, bool bSelected);
+
+	/** Gives a crowd unit a move order */
+	void MoveUnit(int32 UnitId, const FVector& Goal, float AcceptanceRadius);
+
+	/** Returns the number of crowd units */
+	int32 GetNumCrowdUnits() const { return Entities.Num(); }
+
+	/** Logs the crowd stats */
+	void DumpStats() const;
+
+	/** Called when a crowd unit reaches its move goal */
+	FOnStrategyCrowdUnitArrivedDelegate OnUnitArrived;
+
+	/** Called when a crowd unit is promoted, before it resumes its move */
+	FOnStrategyCrowdUnitPromotedDelegate OnUnitPromoted;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// UWorldSubsystem interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+protected:
+
+	/** Unit class spawned on promotion, for crowd units that don't have their own */
+	UPROPERTY(Transient)
+	TSubclassOf<AStrategyUnit> DefaultUnitClass;
+
+	/** Actor holding the instanced mesh */
+	UPROPERTY(Transient)
+	TObjectPtr<AActor> RenderActor;
+
+	/** Instanced mesh drawing the crowd units */
+	UPROPERTY(Transient)
+	TObjectPtr<UInstancedStaticMeshComponent> Instances;
+
+	/** Unit registry for this world */
+	UPROPERTY(Transient)
+	TObjectPtr<UStrategyUnitRegistry> UnitRegistry;
+
+	/** Distance outside the camera view where crowd units get promoted */
+	float PromotionMargin = 500.0f;
+
+	/** Distance outside the camera view where actors get demoted */
+	float DemotionMargin = 1500.0f;
+
+	/** Time a promoted unit stays an actor */
+	float MinPromotedTime = 2.0f;
+
+	/** Max number of promotions and demotions per frame */
+	int32 MaxConversionsPerFrame = 32;
+
+	/** Archetype shared by all crowd entities */
+	FMassArchetypeHandle Archetype;
+
+	/** Movement parameters shared by all crowd entities */
+	FMassArchetypeSharedFragmentValues SharedValues;
+
+	/** Height of a unit's origin over the ground */
+	float UnitHalfHeight = 0.0f;
+
+	/** Crowd entities, by unit id */
+	TMap<int32, FMassEntityHandle> Entities;
+
+	/** Time each promoted unit was promoted at, by unit id */
+	TMap<int32, double> PromotionTimes;
+
+	/** Instance transforms, rebuilt by the sync processor and patched on promotion and demotion */
+	TArray<FTransform> InstanceTransforms;
+
+	/** Unit id for each instance */
+	TArray<int32> InstanceUnitIds;
+
+	/** If true, the instanced mesh needs updating */
+	bool bInstancesDirty = false;
+
+	/** Crowd units that arrived since the last tick */
+	TArray<int32> PendingArrivals;
+
+	/** Lifetime stats */
+	int32 NumPromotions = 0;
+	int32 NumDemotions = 0;
+
+	/** Returns the Mass entity manager, or nullptr */
+	FMassEntityManager* GetEntityManager() const;
+
+	/** Creates the crowd archetype if needed. Returns false if Mass isn't available */
+	bool EnsureArchetype();
+
+	/** Creates an entity for a crowd unit */
+	FMassEntityHandle CreateCrowdEntity(int32 UnitId, TSubclassOf<AStrategyUnit> UnitClass, const FTransform& Transform);
+
+	/** Promotes crowd units near the camera, and demotes actors that left the camera view */
+	void UpdateConversions();
+
+	/** Pushes the instance transforms to the instanced mesh */
+	void UpdateInstances();
+};
@@ -0,0 +1,531 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyFogOfWar.h"
+#include "StrategyUnit.h"
+#include "StrategyUnitRegistry.h"
+#include "StrategyGameMode.h"
+#include "GameFramework/PlayerStart.h"
+#include "Async/ParallelFor.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "TacticsAutomation.h"
+#include "Tactics.h"
+
+bool UStrategyFogOfWar::IsLocationVisible(const FVector& Location) const
+{
+	const FIntPoint Cell = GetGridCell(Location);
+
+	if (!IsEnabled() || Cell.X < 0 || Cell.Y < 0 || Cell.X >= GridSize || Cell.Y >= GridSize)
+	{
+		return false;
+	}
+
+	const uint64 Word = VisibleBits[Cell.Y * WordsPerRow + (Cell.X >> 6)];
+	return (Word >> (Cell.X & 63)) & 1;
+}
+
+bool UStrategyFogOfWar::IsUnitVisible(int32 UnitId) const
+{
+	// without a grid everything is visible
+	if (!IsEnabled() || !UnitRegistry)
+	{
+		return true;
+	}
+
+	FVector Location;
+
+	if (!UnitRegistry->GetUnitLocation(UnitId, Location))
+	{
+		return false;
+	}
+
+	return UnitRegistry->GetUnitTeam(UnitId) == PlayerTeam || IsLocationVisible(Location);
+}
+
+void UStrategyFogOfWar::FilterVisibleUnits(TArray<AStrategyUnit*>& Units) const
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	Units.RemoveAllSwap([this](const AStrategyUnit* Unit)
+	{
+		return !IsUnitVisible(Unit->GetRegistryId());
+	}, EAllowShrinking::No);
+}
+
+void UStrategyFogOfWar::DumpStats() const
+{
+	if (!IsEnabled())
+	{
+		UE_LOG(LogTactics, Display, TEXT("Fog of war disabled"));
+		return;
+	}
+
+	int32 NumVisible = 0;
+
+	for (const uint64 Word : VisibleBits)
+	{
+		NumVisible += FMath::CountBits(Word);
+	}
+
+	UE_LOG(LogTactics, Display, TEXT("Fog of war: %dx%d cells of %.0f cm, %d visible. Last update %d changes"),
+		GridSize, GridSize, CellSize, NumVisible, LastNumChanges);
+	UE_LOG(LogTactics, Display, TEXT("Update: mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms over %d frames"),
+		UpdateStats.GetMean(), UpdateStats.GetPercentile(50.0f), UpdateStats.GetPercentile(99.0f), UpdateStats.MaxMs, UpdateStats.Count);
+}
+
+void UStrategyFogOfWar::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!IsEnabled() || !UnitRegistry)
+	{
+		return;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyFogOfWar_Tick);
+
+	UpdateGrid();
+	UpdateHiddenUnits();
+}
+
+TStatId UStrategyFogOfWar::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyFogOfWar, STATGROUP_Tickables);
+}
+
+void UStrategyFogOfWar::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// the fog of war is only used by the strategy game mode
+	const AStrategyGameMode* GameMode = Cast<AStrategyGameMode>(InWorld.GetAuthGameMode());
+
+	if (!GameMode || GameMode->GetFogGridSize() <= 0)
+	{
+		return;
+	}
+
+	UStrategyUnitRegistry* Registry = InWorld.GetSubsystem<UStrategyUnitRegistry>();
+
+	if (!Registry)
+	{
+		return;
+	}
+
+	// center the grid on the player start
+	FVector Center = FVector::ZeroVector;
+
+	for (TActorIterator<APlayerStart> It(&InWorld); It; ++It)
+	{
+		Center = It->GetActorLocation();
+		break;
+	}
+
+	InitGrid(Registry, GameMode->GetPlayerTeamId(), GameMode->GetFogCellSize(), GameMode->GetCrowdSightRadius(), GameMode->GetFogGridSize(), Center);
+}
+
+void UStrategyFogOfWar::InitGrid(UStrategyUnitRegistry* InUnitRegistry, uint8 InPlayerTeam, float InCellSize, float InCrowdSightRadius, int32 InGridSize, const FVector& Center)
+{
+	UnitRegistry = InUnitRegistry;
+	UnitRegistry->OnUnitUnregistered.AddUObject(this, &UStrategyFogOfWar::OnUnitUnregistered);
+
+	PlayerTeam = InPlayerTeam;
+	CellSize = InCellSize;
+	CrowdSightRadius = InCrowdSightRadius;
+
+	// whole words per row, and a whole number of row blocks
+	GridSize = Align(InGridSize, 64);
+	WordsPerRow = GridSize / 64;
+
+	static_assert(64 % RowsPerBlock == 0, "Row blocks must divide the grid size");
+
+	GridOrigin = FVector2D(Center) - FVector2D(GridSize * CellSize * 0.5f);
+
+	Counts.SetNumZeroed(GridSize * GridSize);
+	VisibleBits.SetNumZeroed(GridSize * WordsPerRow);
+	BlockChanges.SetNum(GridSize / RowsPerBlock);
+}
+
+void UStrategyFogOfWar::Deinitialize()
+{
+	if (UnitRegistry)
+	{
+		UnitRegistry->OnUnitUnregistered.RemoveAll(this);
+	}
+
+	Counts.Empty();
+	VisibleBits.Empty();
+	Stamps.Empty();
+	Changes.Empty();
+	BlockChanges.Empty();
+	GridSize = 0;
+
+	Super::Deinitialize();
+}
+
+void UStrategyFogOfWar::UpdateGrid()
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	GatherChanges();
+
+	LastNumChanges = Changes.Num();
+
+	if (Changes.Num() > 0)
+	{
+		ApplyChanges();
+		Changes.Reset();
+	}
+
+	UpdateStats.AddSample(static_cast<float>((FPlatformTime::Seconds() - StartTime) * 1000.0));
+}
+
+void UStrategyFogOfWar::GatherChanges()
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyFogOfWar_GatherChanges);
+
+	if (Stamps.Num() < UnitRegistry->GetMaxUnitId())
+	{
+		Stamps.SetNum(UnitRegistry->GetMaxUnitId());
+	}
+
+	for (const int32 UnitId : UnitRegistry->GetUnitIds())
+	{
+		// only the player's units reveal the fog
+		if (UnitRegistry->GetUnitTeam(UnitId) != PlayerTeam)
+		{
+			continue;
+		}
+
+		FVector Location;
+		UnitRegistry->GetUnitLocation(UnitId, Location);
+
+		const AStrategyUnit* Unit = UnitRegistry->GetUnit(UnitId);
+		const FSightStamp NewStamp = MakeStamp(Location, Unit ? Unit->GetSightRadius() : CrowdSightRadius);
+
+		// most units stay in their cell from one frame to the next
+		FSightStamp& Stamp = Stamps[UnitId];
+
+		if (!(NewStamp == Stamp))
+		{
+			Changes.Add({ Stamp, NewStamp });
+			Stamp = NewStamp;
+		}
+	}
+}
+
+void UStrategyFogOfWar::ApplyChanges()
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyFogOfWar_ApplyChanges);
+
+	// bucket the changes by the row blocks their circles touch
+	for (const int32 Block : DirtyBlocks)
+	{
+		BlockChanges[Block].Reset();
+	}
+
+	DirtyBlocks.Reset();
+
+	for (int32 ChangeIndex = 0; ChangeIndex < Changes.Num(); ++ChangeIndex)
+	{
+		for (const FSightStamp* Stamp : { &Changes[ChangeIndex].Old, &Changes[ChangeIndex].New })
+		{
+			if (!Stamp->bActive)
+			{
+				continue;
+			}
+
+			const int32 FirstBlock = FMath::Max(Stamp->Cell.Y - Stamp->Radius, 0) / RowsPerBlock;
+			const int32 LastBlock = FMath::Min(Stamp->Cell.Y + Stamp->Radius, GridSize - 1) / RowsPerBlock;
+
+			for (int32 Block = FirstBlock; Block <= LastBlock; ++Block)
+			{
+				TArray<int32>& Indices = BlockChanges[Block];
+
+				// the old and new circles usually overlap, only list the change once
+				if (Indices.Num() > 0 && Indices.Last() == ChangeIndex)
+				{
+					continue;
+				}
+
+				if (Indices.Num() == 0)
+				{
+					DirtyBlocks.Add(Block);
+				}
+
+				Indices.Add(ChangeIndex);
+			}
+		}
+	}
+
+	// each block owns its rows, so the blocks can be updated in parallel
+	ParallelFor(DirtyBlocks.Num(), [this](int32 Index)
+	{
+		const int32 Block = DirtyBlocks[Index];
+		const int32 FirstRow = Block * RowsPerBlock;
+		const int32 LastRow = FMath::Min(FirstRow + RowsPerBlock, GridSize) - 1;
+
+		int32 DirtyMin[RowsPerBlock];
+		int32 DirtyMax[RowsPerBlock];
+
+		for (int32 Row = 0; Row < RowsPerBlock; ++Row)
+		{
+			DirtyMin[Row] = GridSize;
+			DirtyMax[Row] = -1;
+		}
+
+		for (const int32 ChangeIndex : BlockChanges[Block])
+		{
+			const FSightChange& Change = Changes[ChangeIndex];
+
+			if (Change.Old.bActive)
+			{
+				StampRows(Change.Old, -1, FirstRow, LastRow, DirtyMin, DirtyMax);
+			}
+
+			if (Change.New.bActive)
+			{
+				StampRows(Change.New, 1, FirstRow, LastRow, DirtyMin, DirtyMax);
+			}
+		}
+
+		// rebuild only the words the circles touched
+		for (int32 Row = FirstRow; Row <= LastRow; ++Row)
+		{
+			const int32 LocalRow = Row - FirstRow;
+
+			if (DirtyMax[LocalRow] < DirtyMin[LocalRow])
+			{
+				continue;
+			}
+
+			const uint16* RowCounts = &Counts[Row * GridSize];
+			uint64* RowBits = &VisibleBits[Row * WordsPerRow];
+
+			for (int32 WordIndex = DirtyMin[LocalRow] >> 6; WordIndex <= (DirtyMax[LocalRow] >> 6); ++WordIndex)
+			{
+				const uint16* WordCounts = RowCounts + WordIndex * 64;
+				uint64 Word = 0;
+
+				for (int32 Bit = 0; Bit < 64; ++Bit)
+				{
+					Word |= uint64(WordCounts[Bit] != 0) << Bit;
+				}
+
+				RowBits[WordIndex] = Word;
+			}
+		}
+	});
+}
+
+void UStrategyFogOfWar::StampRows(const FSightStamp& Stamp, int32 Delta, int32 FirstRow, int32 LastRow, int32* DirtyMin, int32* DirtyMax)
+{
+	const int32 RadiusSquared = Stamp.Radius * Stamp.Radius;
+	const int32 StartRow = FMath::Max(FirstRow, Stamp.Cell.Y - Stamp.Radius);
+	const int32 EndRow = FMath::Min(LastRow, Stamp.Cell.Y + Stamp.Radius);
+
+	for (int32 Row = StartRow; Row <= EndRow; ++Row)
+	{
+		// width of the circle on this row
+		const int32 OffsetY = Row - Stamp.Cell.Y;
+		const int32 HalfWidth = FMath::FloorToInt32(FMath::Sqrt(static_cast<float>(RadiusSquared - OffsetY * OffsetY)));
+
+		const int32 StartColumn = FMath::Max(0, Stamp.Cell.X - HalfWidth);
+		const int32 EndColumn = FMath::Min(GridSize - 1, Stamp.Cell.X + HalfWidth);
+
+		if (StartColumn > EndColumn)
+		{
+			continue;
+		}
+
+		uint16* RowCounts = &Counts[Row * GridSize];
+
+		for (int32 Column = StartColumn; Column <= EndColumn; ++Column)
+		{
+			RowCounts[Column] = static_cast<uint16>(RowCounts[Column] + Delta);
+		}
+
+		const int32 LocalRow = Row - FirstRow;
+		DirtyMin[LocalRow] = FMath::Min(DirtyMin[LocalRow], StartColumn);
+		DirtyMax[LocalRow] = FMath::Max(DirtyMax[LocalRow], EndColumn);
+	}
+}
+
+void UStrategyFogOfWar::UpdateHiddenUnits()
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyFogOfWar_UpdateHiddenUnits);
+
+	for (const int32 UnitId : UnitRegistry->GetUnitIds())
+	{
+		if (UnitRegistry->GetUnitTeam(UnitId) == PlayerTeam)
+		{
+			continue;
+		}
+
+		// crowd units are outside the camera view already
+		AStrategyUnit* Unit = UnitRegistry->GetUnit(UnitId);
+
+		if (!Unit)
+		{
+			continue;
+		}
+
+		// hidden actors aren't rendered, so their animation stops too
+		const bool bHidden = !IsLocationVisible(Unit->GetActorLocation());
+
+		if (Unit->IsHidden() != bHidden)
+		{
+			Unit->SetActorHiddenInGame(bHidden);
+		}
+	}
+}
+
+UStrategyFogOfWar::FSightStamp UStrategyFogOfWar::MakeStamp(const FVector& Location, float SightRadius) const
+{
+	FSightStamp Stamp;
+	Stamp.Cell = GetGridCell(Location);
+	Stamp.Radius = FMath::FloorToInt32(SightRadius / CellSize);
+	Stamp.bActive = SightRadius > 0.0f;
+
+	return Stamp;
+}
+
+FIntPoint UStrategyFogOfWar::GetGridCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32((Location.X - GridOrigin.X) / CellSize), FMath::FloorToInt32((Location.Y - GridOrigin.Y) / CellSize));
+}
+
+void UStrategyFogOfWar::OnUnitUnregistered(int32 UnitId)
+{
+	// take the unit's circle off the grid on the next update
+	if (Stamps.IsValidIndex(UnitId) && Stamps[UnitId].bActive)
+	{
+		Changes.Add({ Stamps[UnitId], FSightStamp() });
+		Stamps[UnitId] = FSightStamp();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs FogDumpCommand(
+	TEXT("Tactics.Fog.Dump"),
+	TEXT("Logs the fog of war grid and update stats."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UStrategyFogOfWar* Fog = World ? World->GetSubsystem<UStrategyFogOfWar>() : nullptr)
+		{
+			Fog->DumpStats();
+		}
+	}));
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/** Update time the fog of war is expected to stay under at 1000 units, checked by the benchmark test */
+static constexpr float FogUpdateBudgetMs = 0.5f;
+
+bool UStrategyFogOfWar::RunBenchmark(int32 NumUnits, int32 NumIterations, FBenchmarkResult& OutResult)
+{
+	OutResult = FBenchmarkResult();
+
+	UStrategyUnitRegistry* PlaceholderRegistry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>();
+
+	if (IsEnabled() || !PlaceholderRegistry || NumUnits <= 0 || NumIterations <= 0)
+	{
+		return false;
+	}
+
+	// use the default strategy settings on a grid of our own
+	const AStrategyGameMode* GameModeDefaults = GetDefault<AStrategyGameMode>();
+	InitGrid(PlaceholderRegistry, GameModeDefaults->GetPlayerTeamId(), GameModeDefaults->GetFogCellSize(), GameModeDefaults->GetCrowdSightRadius(), GameModeDefaults->GetFogGridSize(), FVector::ZeroVector);
+
+	// scatter placeholder units of the player's team over the middle of the grid
+	const float HalfExtent = GridSize * CellSize * 0.4f;
+
+	TArray<int32> PlaceholderIds;
+	TArray<FVector> PlaceholderLocations;
+
+	for (int32 Index = 0; Index < NumUnits; ++Index)
+	{
+		const FVector Location(FMath::FRandRange(-HalfExtent, HalfExtent), FMath::FRandRange(-HalfExtent, HalfExtent), 0.0f);
+
+		PlaceholderIds.Add(UnitRegistry->RegisterCrowdUnit(Location, PlayerTeam));
+		PlaceholderLocations.Add(Location);
+	}
+
+	// the first update stamps everyone, which only happens once
+	const double StartTime = FPlatformTime::Seconds();
+	UpdateGrid();
+	OutResult.InitialMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	UpdateStats = FTimingStats();
+
+	// every unit steps into the next cell each iteration, which is the worst case
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		const FVector Offset((Iteration % 2 == 0) ? CellSize : 0.0f, 0.0f, 0.0f);
+
+		for (int32 Index = 0; Index < PlaceholderIds.Num(); ++Index)
+		{
+			UnitRegistry->SetCrowdUnitLocation(PlaceholderIds[Index], PlaceholderLocations[Index] + Offset);
+		}
+
+		UpdateGrid();
+	}
+
+	OutResult.AllMovedStats = UpdateStats;
+
+	UE_LOG(LogTactics, Display, TEXT("Fog of war, %d units: initial %.3f ms. All moved: mean %.3f ms, p99 %.3f ms, max %.3f ms"),
+		NumUnits, OutResult.InitialMs, OutResult.AllMovedStats.GetMean(), OutResult.AllMovedStats.GetPercentile(99.0f), OutResult.AllMovedStats.MaxMs);
+
+	// clear out the placeholders
+	for (const int32 UnitId : PlaceholderIds)
+	{
+		UnitRegistry->UnregisterCrowdUnit(UnitId);
+	}
+
+	UpdateGrid();
+
+	return true;
+}
+
+/** Number of placeholder units in the fog benchmark */
+static constexpr int32 FogBenchmarkUnits = 1000;
+
+/** Number of timed updates in the fog benchmark */
+static constexpr int32 FogBenchmarkIterations = 100;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFogOfWarBenchmarkTest, "Tactics.Fog.Benchmark", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFogOfWarBenchmarkTest::RunTest(const FString& Parameters)
+{
+	// the benchmark grid and its placeholders live in a scratch world, so the game's fog and units are never touched
+	UWorld* ScratchWorld = TacticsAutomation::CreateScratchWorld();
+	UStrategyFogOfWar* Fog = ScratchWorld->GetSubsystem<UStrategyFogOfWar>();
+
+	UStrategyFogOfWar::FBenchmarkResult Result;
+	const bool bRan = Fog && Fog->RunBenchmark(FogBenchmarkUnits, FogBenchmarkIterations, Result);
+
+	TacticsAutomation::DestroyScratchWorld(ScratchWorld);
+
+	if (!bRan)
+	{
+		AddError(TEXT("The fog of war benchmark couldn't set up its grid"));
+		return false;
+	}
+
+	const float P99Ms = Result.AllMovedStats.GetPercentile(99.0f);
+
+	AddInfo(FString::Printf(TEXT("%d units: initial %.3f ms. All moved: mean %.3f ms, p99 %.3f ms, max %.3f ms"),
+		FogBenchmarkUnits, Result.InitialMs, Result.AllMovedStats.GetMean(), P99Ms, Result.AllMovedStats.MaxMs));
+
+	TestEqual(TEXT("Timed updates"), Result.AllMovedStats.Count, FogBenchmarkIterations);
+	TestTrue(FString::Printf(TEXT("Update p99 %.3f ms within the %.2f ms budget"), P99Ms, FogUpdateBudgetMs), P99Ms <= FogUpdateBudgetMs);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,177 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TimingStats.h"
+#include "StrategyFogOfWar.generated.h"
+
+class AStrategyUnit;
+class UStrategyUnitRegistry;
+
+/**
+ *  Fog of war grid revealed by the sight radius of the player's units.
+ *  Each cell counts the player's units that can see it, and visible cells are packed into a bit per cell.
+ *  Only units that moved to another cell, or changed their sight, touch the grid: their old circle is removed and their new one added.
+ *  The work is split into blocks of rows that update in parallel, so no two threads write the same cells.
+ *  Units outside the player's team are hidden while they stand in the fog, and visibility queries let selection and AI skip them.
+ *  Settings are read from the strategy game mode.
+ */
+UCLASS()
+class UStrategyFogOfWar : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns true if the fog of war grid is set up */
+	bool IsEnabled() const { return GridSize > 0; }
+
+	/** Returns the team controlled by the player */
+	uint8 GetPlayerTeam() const { return PlayerTeam; }
+
+	/** Returns true if a location is revealed. Locations outside the grid are never revealed */
+	bool IsLocationVisible(const FVector& Location) const;
+
+	/** Returns true if a unit can be seen by the player. The player's own units are always visible */
+	bool IsUnitVisible(int32 UnitId) const;
+
+	/** Removes the units the player can't see */
+	void FilterVisibleUnits(TArray<AStrategyUnit*>& Units) const;
+
+#if WITH_DEV_AUTOMATION_TESTS
+	/** Timings from a benchmark run */
+	struct FBenchmarkResult
+	{
+		/** Time of the first update, which stamps every unit */
+		double InitialMs = 0.0;
+
+		/** Update times while every unit steps into another cell */
+		FTimingStats AllMovedStats;
+	};
+
+	/**
+	 *  Sets up a grid with the default strategy game mode settings, times its updates with placeholder units of the player's team and logs the results.
+	 *  The grid and the placeholders are the benchmark's own, so it's meant for the fog of a scratch world, never the game's.
+	 *  Returns false if the grid is already in use or the world has no unit registry
+	 */
+	bool RunBenchmark(int32 NumUnits, int32 NumIterations, FBenchmarkResult& OutResult);
+#endif
+
+	/** Logs the update stats */
+	void DumpStats() const;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// UWorldSubsystem interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+protected:
+
+	/** Circle of cells revealed by a unit */
+	struct FSightStamp
+	{
+		/** Center cell */
+		FIntPoint Cell = FIntPoint::ZeroValue;
+
+		/** Radius, in cells */
+		int32 Radius = 0;
+
+		/** If true, the stamp is applied to the grid */
+		bool bActive = false;
+
+		bool operator==(const FSightStamp& Other) const { return bActive == Other.bActive && (!bActive || (Cell == Other.Cell && Radius == Other.Radius)); }
+	};
+
+	/** A unit's stamp moving from one place to another */
+	struct FSightChange
+	{
+		/** Stamp to remove */
+		FSightStamp Old;
+
+		/** Stamp to add */
+		FSightStamp New;
+	};
+
+	/** Number of grid rows updated together by a worker */
+	static constexpr int32 RowsPerBlock = 16;
+
+	/** Unit registry for this world */
+	UPROPERTY(Transient)
+	TObjectPtr<UStrategyUnitRegistry> UnitRegistry;
+
+	/** Team controlled by the player */
+	uint8 PlayerTeam = 0;
+
+	/** Size of a cell */
+	float CellSize = 200.0f;
+
+	/** Number of cells along each side of the grid. Zero when the fog of war is off */
+	int32 GridSize = 0;
+
+	/** Number of 64 bit words in a row of visibility bits */
+	int32 WordsPerRow = 0;
+
+	/** World location of the grid's minimum corner */
+	FVector2D GridOrigin = FVector2D::ZeroVector;
+
+	/** Sight radius of the player's units without an actor */
+	float CrowdSightRadius = 1200.0f;
+
+	/** Number of the player's units seeing each cell, row by row */
+	TArray<uint16> Counts;
+
+	/** One bit per cell, set if the cell is visible, row by row */
+	TArray<uint64> VisibleBits;
+
+	/** Stamp currently applied for each unit, by unit id */
+	TArray<FSightStamp> Stamps;
+
+	/** Changes gathered this frame, including units that left the registry */
+	TArray<FSightChange> Changes;
+
+	/** Indices of the changes touching each row block */
+	TArray<TArray<int32>> BlockChanges;
+
+	/** Row blocks with changes this frame */
+	TArray<int32> DirtyBlocks;
+
+	/** Grid update times */
+	FTimingStats UpdateStats;
+
+	/** Number of changes applied on the last update */
+	int32 LastNumChanges = 0;
+
+	/** Sets up an empty grid centered on a location, fed by the units of a registry */
+	void InitGrid(UStrategyUnitRegistry* InUnitRegistry, uint8 InPlayerTeam, float InCellSize, float InCrowdSightRadius, int32 InGridSize, const FVector& Center);
+
+	/** Gathers the changes from the units that moved, then applies them to the grid */
+	void UpdateGrid();
+
+	/** Compares each of the player's units against its applied stamp and queues the ones that changed */
+	void GatherChanges();
+
+	/** Applies the queued changes in parallel row blocks and refreshes the visibility bits they touched */
+	void ApplyChanges();
+
+	/** Adds a stamp to the rows of a block, widening each row's dirty column range */
+	void StampRows(const FSightStamp& Stamp, int32 Delta, int32 FirstRow, int32 LastRow, int32* DirtyMin, int32* DirtyMax);
+
+	/** Hides and shows the units outside the player's team as they enter and leave the fog */
+	void UpdateHiddenUnits();
+
+	/** Returns the stamp for a unit's sight at a location */
+	FSightStamp MakeStamp(const FVector& Location, float SightRadius) const;
+
+	/** Returns the grid cell containing a location, which may be outside the grid */
+	FIntPoint GetGridCell(const FVector& Location) const;
+
+	/** Called when a unit leaves the registry */
+	void OnUnitUnregistered(int32 UnitId);
+};
@@ -0,0 +1,303 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyFormation.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+
+/** Max number of slots in a line formation row before starting a new one */
+static constexpr int32 MaxLineWidth = 20;
+
+/** Extent used to project slots onto the navmesh */
+static const FVector SlotProjectionExtent(100.0f, 100.0f, 250.0f);
+
+/** Largest group assigned optimally. 64^3 is about 260K inner steps, well under a frame; larger groups are assigned greedily */
+static constexpr int32 MaxOptimalAssignmentSize = 64;
+
+/** Assigns units to slots by taking the shortest unit and slot pairs first. O(n^2 log n), and rarely far off for formation layouts */
+static void AssignSlotsGreedy(const TArray<FVector>& UnitLocations, const TArray<FVector>& SlotLocations, TArray<int32>& OutSlotIndices)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyFormation_AssignSlotsGreedy);
+
+	const int32 Num = UnitLocations.Num();
+
+	struct FPair
+	{
+		float DistanceSquared;
+		int32 Unit;
+		int32 Slot;
+	};
+
+	TArray<FPair> Pairs;
+	Pairs.Reserve(Num * Num);
+
+	for (int32 Unit = 0; Unit < Num; ++Unit)
+	{
+		for (int32 Slot = 0; Slot < Num; ++Slot)
+		{
+			Pairs.Add({ static_cast<float>(FVector::DistSquared2D(UnitLocations[Unit], SlotLocations[Slot])), Unit, Slot });
+		}
+	}
+
+	Pairs.Sort([](const FPair& A, const FPair& B) { return A.DistanceSquared < B.DistanceSquared; });
+
+	TBitArray<> bSlotTaken(false, Num);
+	int32 NumAssigned = 0;
+
+	for (const FPair& Pair : Pairs)
+	{
+		if (OutSlotIndices[Pair.Unit] == INDEX_NONE && !bSlotTaken[Pair.Slot])
+		{
+			OutSlotIndices[Pair.Unit] = Pair.Slot;
+			bSlotTaken[Pair.Slot] = true;
+
+			if (++NumAssigned == Num)
+			{
+				break;
+			}
+		}
+	}
+}
+
+void StrategyFormation::GetSlotOffsets(EStrategyFormationShape Shape, int32 NumSlots, float Spacing, TArray<FVector2D>& OutOffsets)
+{
+	OutOffsets.Reset(NumSlots);
+
+	// box formations are roughly square
+	const int32 BoxWidth = FMath::Max(1, FMath::CeilToInt32(FMath::Sqrt(float(NumSlots))));
+
+	// fill rows front to back
+	for (int32 Row = 0; OutOffsets.Num() < NumSlots; ++Row)
+	{
+		int32 RowWidth = 1;
+
+		switch (Shape)
+		{
+		case EStrategyFormationShape::Line:
+			RowWidth = FMath::Min(NumSlots, MaxLineWidth);
+			break;
+		case EStrategyFormationShape::Box:
+			RowWidth = BoxWidth;
+			break;
+		case EStrategyFormationShape::Wedge:
+			RowWidth = Row * 2 + 1;
+			break;
+		}
+
+		// fill each row from the center out, alternating sides, so slot 0 is always at the origin
+		for (int32 Index = 0; Index < RowWidth && OutOffsets.Num() < NumSlots; ++Index)
+		{
+			const float Side = (Index % 2 == 1) ? 1.0f : -1.0f;
+			const float Column = Side * ((Index + 1) / 2);
+
+			OutOffsets.Add(FVector2D(-Row * Spacing, Column * Spacing));
+		}
+	}
+}
+
+void StrategyFormation::AssignSlots(const TArray<FVector>& UnitLocations, const TArray<FVector>& SlotLocations, TArray<int32>& OutSlotIndices)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyFormation_AssignSlots);
+
+	check(UnitLocations.Num() == SlotLocations.Num());
+
+	const int32 Num = UnitLocations.Num();
+
+	OutSlotIndices.Init(INDEX_NONE, Num);
+
+	if (Num == 0)
+	{
+		return;
+	}
+
+	// keep large groups under the frame budget
+	if (Num > MaxOptimalAssignmentSize)
+	{
+		AssignSlotsGreedy(UnitLocations, SlotLocations, OutSlotIndices);
+		return;
+	}
+
+	// travel cost for each unit and slot pair
+	TArray<double> Costs;
+	Costs.SetNumUninitialized(Num * Num);
+
+	for (int32 Unit = 0; Unit < Num; ++Unit)
+	{
+		for (int32 Slot = 0; Slot < Num; ++Slot)
+		{
+			Costs[Unit * Num + Slot] = FVector::Dist2D(UnitLocations[Unit], SlotLocations[Slot]);
+		}
+	}
+
+	// Hungarian algorithm with potentials. Rows are units and columns are slots, both 1-based with 0 as a sentinel
+	TArray<double> RowPotentials;
+	TArray<double> ColumnPotentials;
+	TArray<int32> ColumnRows;
+	TArray<int32> ColumnWays;
+	TArray<double> MinSlack;
+	TArray<bool> bColumnUsed;
+
+	RowPotentials.SetNumZeroed(Num + 1);
+	ColumnPotentials.SetNumZeroed(Num + 1);
+	ColumnRows.SetNumZeroed(Num + 1);
+	ColumnWays.SetNumZeroed(Num + 1);
+
+	for (int32 Row = 1; Row <= Num; ++Row)
+	{
+		ColumnRows[0] = Row;
+		int32 Column = 0;
+
+		MinSlack.Init(TNumericLimits<double>::Max(), Num + 1);
+		bColumnUsed.Init(false, Num + 1);
+
+		// grow the alternating tree until we reach a free column
+		do
+		{
+			bColumnUsed[Column] = true;
+
+			const int32 CurrentRow = ColumnRows[Column];
+			double Delta = TNumericLimits<double>::Max();
+			int32 NextColumn = 0;
+
+			for (int32 Other = 1; Other <= Num; ++Other)
+			{
+				if (!bColumnUsed[Other])
+				{
+					const double Slack = Costs[(CurrentRow - 1) * Num + (Other - 1)] - RowPotentials[CurrentRow] - ColumnPotentials[Other];
+
+					if (Slack < MinSlack[Other])
+					{
+						MinSlack[Other] = Slack;
+						ColumnWays[Other] = Column;
+					}
+
+					if (MinSlack[Other] < Delta)
+					{
+						Delta = MinSlack[Other];
+						NextColumn = Other;
+					}
+				}
+			}
+
+			for (int32 Other = 0; Other <= Num; ++Other)
+			{
+				if (bColumnUsed[Other])
+				{
+					RowPotentials[ColumnRows[Other]] += Delta;
+					ColumnPotentials[Other] -= Delta;
+
+				} else {
+
+					MinSlack[Other] -= Delta;
+				}
+			}
+
+			Column = NextColumn;
+
+		} while (ColumnRows[Column] != 0);
+
+		// flip the augmenting path
+		do
+		{
+			const int32 PreviousColumn = ColumnWays[Column];
+			ColumnRows[Column] = ColumnRows[PreviousColumn];
+			Column = PreviousColumn;
+
+		} while (Column != 0);
+	}
+
+	for (int32 Column = 1; Column <= Num; ++Column)
+	{
+		OutSlotIndices[ColumnRows[Column] - 1] = Column - 1;
+	}
+}
+
+void StrategyFormation::PlanFormation(const UWorld* World, const FVector& Goal, EStrategyFormationShape Shape, float Spacing, const TArray<FVector>& UnitLocations, int32 LeaderIndex, TArray<FVector>& OutUnitSlots)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyFormation_PlanFormation);
+
+	const int32 NumUnits = UnitLocations.Num();
+
+	OutUnitSlots.Init(Goal, NumUnits);
+
+	if (NumUnits < 2 || !UnitLocations.IsValidIndex(LeaderIndex))
+	{
+		return;
+	}
+
+	// face away from the center of the group
+	FVector Centroid = FVector::ZeroVector;
+
+	for (const FVector& Location : UnitLocations)
+	{
+		Centroid += Location;
+	}
+
+	Centroid /= NumUnits;
+
+	FVector Forward = (Goal - Centroid).GetSafeNormal2D();
+
+	if (Forward.IsNearlyZero())
+	{
+		Forward = FVector::ForwardVector;
+	}
+
+	const FVector Right(-Forward.Y, Forward.X, 0.0f);
+
+	// lay out the slots around the goal
+	TArray<FVector2D> Offsets;
+	GetSlotOffsets(Shape, NumUnits, Spacing, Offsets);
+
+	TArray<FNavigationProjectionWork> Workload;
+	Workload.Reserve(NumUnits);
+
+	for (const FVector2D& Offset : Offsets)
+	{
+		Workload.Emplace(Goal + Forward * Offset.X + Right * Offset.Y);
+	}
+
+	// project all the slots onto the navmesh in one batch
+	const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	const ANavigationData* NavData = NavSys ? NavSys->GetDefaultNavDataInstance() : nullptr;
+
+	if (NavData)
+	{
+		NavData->BatchProjectPoints(Workload, SlotProjectionExtent);
+	}
+
+	// slots that are off the navmesh fall back to the goal
+	TArray<FVector> SlotLocations;
+	SlotLocations.Reserve(NumUnits);
+
+	for (const FNavigationProjectionWork& Work : Workload)
+	{
+		SlotLocations.Add(!NavData ? Work.Point : (Work.bResult ? Work.OutLocation.Location : Goal));
+	}
+
+	// the leader takes the front slot, everyone else is assigned to the remaining ones
+	OutUnitSlots[LeaderIndex] = SlotLocations[0];
+
+	TArray<FVector> FollowerLocations;
+	TArray<int32> FollowerIndices;
+	FollowerLocations.Reserve(NumUnits - 1);
+	FollowerIndices.Reserve(NumUnits - 1);
+
+	for (int32 Index = 0; Index < NumUnits; ++Index)
+	{
+		if (Index != LeaderIndex)
+		{
+			FollowerLocations.Add(UnitLocations[Index]);
+			FollowerIndices.Add(Index);
+		}
+	}
+
+	TArray<FVector> FollowerSlots(SlotLocations.GetData() + 1, NumUnits - 1);
+
+	TArray<int32> Assignment;
+	AssignSlots(FollowerLocations, FollowerSlots, Assignment);
+
+	for (int32 Follower = 0; Follower < FollowerIndices.Num(); ++Follower)
+	{
+		OutUnitSlots[FollowerIndices[Follower]] = FollowerSlots[Assignment[Follower]];
+	}
+}
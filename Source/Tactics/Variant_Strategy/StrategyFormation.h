@@ -0,0 +1,35 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StrategyFormation.generated.h"
+
+/** Slot layouts for group move orders */
+UENUM(BlueprintType)
+enum class EStrategyFormationShape : uint8
+{
+	Line,
+	Box,
+	Wedge
+};
+
+/**
+ *  Formation planning helpers for group move orders.
+ *  Slots are laid out around the goal, projected onto the navmesh in a single batch,
+ *  and assigned to units so the total travel distance is as short as possible.
+ */
+namespace StrategyFormation
+{
+	/** Generates slot offsets in formation space: X points forward and Y to the right. Slot 0 is the leader's, at the origin */
+	void GetSlotOffsets(EStrategyFormationShape Shape, int32 NumSlots, float Spacing, TArray<FVector2D>& OutOffsets);
+
+	/**
+	 *  Assigns each unit to a slot so the total travel distance is minimal. Both arrays must be the same size.
+	 *  The optimal assignment is O(n^3), so groups above a fixed size are assigned greedily, shortest pairs first.
+	 */
+	void AssignSlots(const TArray<FVector>& UnitLocations, const TArray<FVector>& SlotLocations, TArray<int32>& OutSlotIndices);
+
+	/** Lays out a formation at the goal facing away from the units, and returns the slot for each unit. The leader always gets the goal slot */
+	void PlanFormation(const UWorld* World, const FVector& Goal, EStrategyFormationShape Shape, float Spacing, const TArray<FVector>& UnitLocations, int32 LeaderIndex, TArray<FVector>& OutUnitSlots);
+}
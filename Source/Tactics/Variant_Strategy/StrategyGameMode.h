@@ -6,12 +6,183 @@
 #include "GameFramework/GameModeBase.h"
 #include "StrategyGameMode.generated.h"
 
+class AStrategyUnit;
+class UStaticMesh;
+
 /**
  *  Simple GameMode for a top down strategy game.
+ *  Also holds the settings for the crowd of lightweight units kept outside the camera view,
+ *  and for the reduced tick rates of unit actors outside or near the edge of the view,
+ *  and for the fog of war that hides units outside the player's team,
+ *  and for the AI commander playing the opposing team.
  */
 UCLASS(abstract)
 class AStrategyGameMode : public AGameModeBase
 {
 	GENERATED_BODY()
-	
+
+protected:
+
+	/** Unit class spawned when a crowd unit is promoted. Demoted units remember their own class */
+	UPROPERTY(EditAnywhere, Category="Crowd")
+	TSubclassOf<AStrategyUnit> CrowdUnitClass;
+
+	/** Mesh used to draw crowd units */
+	UPROPERTY(EditAnywhere, Category="Crowd")
+	TObjectPtr<UStaticMesh> CrowdMesh;
+
+	/** Distance outside the camera view where crowd units get promoted to actors */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 0, ClampMax = 100000, Units = "cm"))
+	float CrowdPromotionMargin = 500.0f;
+
+	/** Distance outside the camera view where actors get demoted to crowd units. Larger than the promotion margin so units don't flip back and forth */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 0, ClampMax = 100000, Units = "cm"))
+	float CrowdDemotionMargin = 1500.0f;
+
+	/** Time a promoted unit stays an actor before it can be demoted again */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 0, ClampMax = 60, Units = "s"))
+	float CrowdMinPromotedTime = 2.0f;
+
+	/** Max number of promotions and demotions per frame */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 1, ClampMax = 1000))
+	int32 CrowdMaxConversionsPerFrame = 32;
+
+	/** Number of crowd units to spawn around the player start when play begins */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 0, ClampMax = 100000))
+	int32 InitialCrowdUnits = 0;
+
+	/** Radius around the player start to spawn the initial crowd units in */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 0, ClampMax = 1000000, Units = "cm"))
+	float InitialCrowdRadius = 10000.0f;
+
+	/** Band around the camera view where units tick at the edge rate, as a fraction of the view width. Scales with the camera zoom */
+	UPROPERTY(EditAnywhere, Category="Significance", meta = (ClampMin = 0, ClampMax = 2))
+	float SignificanceEdgeMargin = 0.25f;
+
+	/** Tick interval for units near the edge of the camera view */
+	UPROPERTY(EditAnywhere, Category="Significance", meta = (ClampMin = 0, ClampMax = 1, Units = "s"))
+	float EdgeTickInterval = 0.1f;
+
+	/** Tick interval for units outside the camera view */
+	UPROPERTY(EditAnywhere, Category="Significance", meta = (ClampMin = 0, ClampMax = 5, Units = "s"))
+	float OffscreenTickInterval = 0.5f;
+
+	/** Team controlled by the player. Its units reveal the fog of war, everyone else is hidden by it */
+	UPROPERTY(EditAnywhere, Category="Fog of War")
+	uint8 PlayerTeamId = 0;
+
+	/** Size of a fog of war cell */
+	UPROPERTY(EditAnywhere, Category="Fog of War", meta = (ClampMin = 10, ClampMax = 10000, Units = "cm"))
+	float FogCellSize = 200.0f;
+
+	/** Number of fog of war cells along each side of the grid, centered on the player start. Rounded up to a multiple of 64. Zero disables the fog of war */
+	UPROPERTY(EditAnywhere, Category="Fog of War", meta = (ClampMin = 0, ClampMax = 4096))
+	int32 FogGridSize = 512;
+
+	/** Sight radius of the player's crowd units, which have no actor to read it from */
+	UPROPERTY(EditAnywhere, Category="Fog of War", meta = (ClampMin = 0, ClampMax = 100000, Units = "cm"))
+	float CrowdSightRadius = 1200.0f;
+
+	/** If true, an AI commander plays the opposing team */
+	UPROPERTY(EditAnywhere, Category="AI Commander")
+	bool bEnableAICommander = false;
+
+	/** Team played by the AI commander. Must differ from the player's team */
+	UPROPERTY(EditAnywhere, Category="AI Commander", meta = (EditCondition = "bEnableAICommander"))
+	uint8 AICommanderTeamId = 1;
+
+	/** Time between the starts of two AI commander plans */
+	UPROPERTY(EditAnywhere, Category="AI Commander", meta = (EditCondition = "bEnableAICommander", ClampMin = 0.1, ClampMax = 30, Units = "s"))
+	float AICommanderPlanInterval = 1.0f;
+
+	/** Worker thread time a single plan may take. Groups left over are planned next time. Overridden by Tactics.AICommander.BudgetMs */
+	UPROPERTY(EditAnywhere, Category="AI Commander", meta = (EditCondition = "bEnableAICommander", ClampMin = 0.1, ClampMax = 100, Units = "ms"))
+	float AICommanderPlanBudget = 2.0f;
+
+	/** Radius of the area AI commander units are grouped in */
+	UPROPERTY(EditAnywhere, Category="AI Commander", meta = (EditCondition = "bEnableAICommander", ClampMin = 100, ClampMax = 100000, Units = "cm"))
+	float AICommanderGroupRadius = 1500.0f;
+
+	/** Max number of units in an AI commander group */
+	UPROPERTY(EditAnywhere, Category="AI Commander", meta = (EditCondition = "bEnableAICommander", ClampMin = 1, ClampMax = 500))
+	int32 AICommanderMaxGroupSize = 16;
+
+	/** Max number of orders applied from a single plan, to bound the game thread cost */
+	UPROPERTY(EditAnywhere, Category="AI Commander", meta = (EditCondition = "bEnableAICommander", ClampMin = 1, ClampMax = 100))
+	int32 AICommanderMaxOrdersPerPlan = 8;
+
+	/** Time after which units still carrying out an AI commander order can be given a new one */
+	UPROPERTY(EditAnywhere, Category="AI Commander", meta = (EditCondition = "bEnableAICommander", ClampMin = 1, ClampMax = 600, Units = "s"))
+	float AICommanderOrderTimeout = 30.0f;
+
+public:
+
+	/** Returns the unit class spawned when a crowd unit is promoted */
+	TSubclassOf<AStrategyUnit> GetCrowdUnitClass() const { return CrowdUnitClass; }
+
+	/** Returns the mesh used to draw crowd units */
+	UStaticMesh* GetCrowdMesh() const { return CrowdMesh; }
+
+	/** Returns the distance outside the camera view where crowd units get promoted */
+	float GetCrowdPromotionMargin() const { return CrowdPromotionMargin; }
+
+	/** Returns the distance outside the camera view where actors get demoted */
+	float GetCrowdDemotionMargin() const { return CrowdDemotionMargin; }
+
+	/** Returns the time a promoted unit stays an actor */
+	float GetCrowdMinPromotedTime() const { return CrowdMinPromotedTime; }
+
+	/** Returns the max number of promotions and demotions per frame */
+	int32 GetCrowdMaxConversionsPerFrame() const { return CrowdMaxConversionsPerFrame; }
+
+	/** Returns the number of crowd units to spawn when play begins */
+	int32 GetInitialCrowdUnits() const { return InitialCrowdUnits; }
+
+	/** Returns the radius to spawn the initial crowd units in */
+	float GetInitialCrowdRadius() const { return InitialCrowdRadius; }
+
+	/** Returns the edge band around the camera view, as a fraction of the view width */
+	float GetSignificanceEdgeMargin() const { return SignificanceEdgeMargin; }
+
+	/** Returns the tick interval for units near the edge of the camera view */
+	float GetEdgeTickInterval() const { return EdgeTickInterval; }
+
+	/** Returns the tick interval for units outside the camera view */
+	float GetOffscreenTickInterval() const { return OffscreenTickInterval; }
+
+	/** Returns the team controlled by the player */
+	uint8 GetPlayerTeamId() const { return PlayerTeamId; }
+
+	/** Returns the size of a fog of war cell */
+	float GetFogCellSize() const { return FogCellSize; }
+
+	/** Returns the number of fog of war cells along each side of the grid */
+	int32 GetFogGridSize() const { return FogGridSize; }
+
+	/** Returns the sight radius of the player's crowd units */
+	float GetCrowdSightRadius() const { return CrowdSightRadius; }
+
+	/** Returns true if an AI commander plays the opposing team */
+	bool IsAICommanderEnabled() const { return bEnableAICommander; }
+
+	/** Returns the team played by the AI commander */
+	uint8 GetAICommanderTeamId() const { return AICommanderTeamId; }
+
+	/** Returns the time between AI commander plans */
+	float GetAICommanderPlanInterval() const { return AICommanderPlanInterval; }
+
+	/** Returns the worker thread time budget of an AI commander plan, in milliseconds */
+	float GetAICommanderPlanBudget() const { return AICommanderPlanBudget; }
+
+	/** Returns the radius AI commander units are grouped in */
+	float GetAICommanderGroupRadius() const { return AICommanderGroupRadius; }
+
+	/** Returns the max number of units in an AI commander group */
+	int32 GetAICommanderMaxGroupSize() const { return AICommanderMaxGroupSize; }
+
+	/** Returns the max number of orders applied from a single plan */
+	int32 GetAICommanderMaxOrdersPerPlan() const { return AICommanderMaxOrdersPerPlan; }
+
+	/** Returns the time after which ordered units can be ordered again */
+	float GetAICommanderOrderTimeout() const { return AICommanderOrderTimeout; }
 };
@@ -0,0 +1,101 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyOrder.h"
+#include "StrategyUnit.h"
+#include "StrategyUnitRegistry.h"
+#include "StrategyCrowdSubsystem.h"
+
+/** Returns the actor for a unit id, promoting crowd units */
+static AStrategyUnit* ResolveActor(const UStrategyUnitRegistry* Registry, UStrategyCrowdSubsystem* Crowd, int32 UnitId)
+{
+	AStrategyUnit* Unit = Registry->GetUnit(UnitId);
+
+	if (!Unit && Crowd && Registry->IsCrowdUnit(UnitId))
+	{
+		Unit = Crowd->PromoteUnit(UnitId);
+	}
+
+	return Unit;
+}
+
+void FStrategyOrder::RecordTargets(const UStrategyUnitRegistry* Registry, float Radius)
+{
+	Targets.Empty();
+
+	if (!Registry)
+	{
+		return;
+	}
+
+	// query the registry grid around the goal
+	TArray<int32> FoundIds;
+	Registry->GetUnitIdsInRadius(Location, Radius, FoundIds);
+
+	for (const int32 UnitId : FoundIds)
+	{
+		// units can't interact with their own group
+		if (!Units.Contains(UnitId))
+		{
+			Targets.Add(UnitId);
+		}
+	}
+}
+
+void FStrategyOrder::ResolveInteraction(const UStrategyUnitRegistry* Registry, UStrategyCrowdSubsystem* Crowd, int32 InteractorId, float Radius)
+{
+	// only the first arrival gets to interact
+	if (!bAllowInteraction)
+	{
+		return;
+	}
+
+	bAllowInteraction = false;
+
+	// is the unit close enough to the goal?
+	FVector InteractorLocation;
+
+	if (!Registry || !Registry->GetUnitLocation(InteractorId, InteractorLocation) || FVector::Dist2D(Location, InteractorLocation) >= Radius)
+	{
+		return;
+	}
+
+	// keep the targets that are still registered and haven't wandered off
+	const float RadiusSquared = FMath::Square(Radius);
+	TArray<int32> TargetIds;
+
+	Targets.ForEachId([&](int32 UnitId)
+	{
+		FVector TargetLocation;
+
+		if (UnitId != InteractorId && Registry->GetUnitLocation(UnitId, TargetLocation) && FVector::DistSquared2D(Location, TargetLocation) <= RadiusSquared)
+		{
+			TargetIds.Add(UnitId);
+		}
+	});
+
+	Targets.Empty();
+
+	if (TargetIds.Num() == 0)
+	{
+		return;
+	}
+
+	// interactions play on actors, so crowd units taking part get promoted
+	AStrategyUnit* Interactor = ResolveActor(Registry, Crowd, InteractorId);
+
+	if (!IsValid(Interactor))
+	{
+		return;
+	}
+
+	for (const int32 UnitId : TargetIds)
+	{
+		AStrategyUnit* CurrentUnit = ResolveActor(Registry, Crowd, UnitId);
+
+		if (IsValid(CurrentUnit))
+		{
+			CurrentUnit->Interact(Interactor);
+		}
+	}
+}
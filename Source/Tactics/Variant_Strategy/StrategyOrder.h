@@ -0,0 +1,40 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StrategyUnitSet.h"
+
+class AStrategyUnit;
+class UStrategyUnitRegistry;
+class UStrategyCrowdSubsystem;
+
+/**
+ *  Group move order issued by the player or an AI commander.
+ *  The units around the goal are recorded once when the order is issued. The first unit to arrive
+ *  resolves them through the unit registry and interacts with them, so later arrivals are free.
+ *  Units are tracked by registry id, so crowd units take part too. They're promoted if they need to interact.
+ */
+struct FStrategyOrder
+{
+	/** Goal of the order */
+	FVector Location = FVector::ZeroVector;
+
+	/** Units still carrying out the order */
+	FStrategyUnitSet Units;
+
+	/** Units near the goal when the order was issued */
+	FStrategyUnitSet Targets;
+
+	/** If true, the order can still trigger an interaction. Cleared by the first arrival */
+	bool bAllowInteraction = true;
+
+	/** World time the order was issued */
+	double IssueTime = 0.0;
+
+	/** Records the units within the radius of the goal, skipping the ordered units */
+	void RecordTargets(const UStrategyUnitRegistry* Registry, float Radius);
+
+	/** Called when a unit arrives. The first arrival interacts with the targets still in range if it's close enough to the goal */
+	void ResolveInteraction(const UStrategyUnitRegistry* Registry, UStrategyCrowdSubsystem* Crowd, int32 InteractorId, float Radius);
+};
@@ -0,0 +1,336 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyOrderExecutor.h"
+#include "StrategyUnit.h"
+#include "StrategyUnitRegistry.h"
+#include "StrategyCrowdSubsystem.h"
+#include "StrategyCommand.h"
+#include "Engine/World.h"
+
+void UStrategyOrderExecutor::Initialize(UWorld* World, float InInteractionRadius, EStrategyFormationShape InFormationShape, float InFormationSpacing, TFunction<bool(int32)> InCanSelectUnit)
+{
+	InteractionRadius = InInteractionRadius;
+	FormationShape = InFormationShape;
+	FormationSpacing = InFormationSpacing;
+	CanSelectUnit = MoveTemp(InCanSelectUnit);
+
+	// drop destroyed units from the orders before the registry hands their ids to other units
+	UnitRegistry = World->GetSubsystem<UStrategyUnitRegistry>();
+
+	if (UnitRegistry)
+	{
+		UnitRegistry->OnUnitUnregistered.AddUObject(this, &UStrategyOrderExecutor::OnUnitUnregistered);
+	}
+
+	// follow ordered units in and out of the crowd
+	CrowdSubsystem = World->GetSubsystem<UStrategyCrowdSubsystem>();
+
+	if (CrowdSubsystem)
+	{
+		CrowdSubsystem->OnUnitPromoted.AddUObject(this, &UStrategyOrderExecutor::OnUnitPromoted);
+		CrowdSubsystem->OnUnitArrived.AddUObject(this, &UStrategyOrderExecutor::OnCrowdUnitArrived);
+	}
+}
+
+void UStrategyOrderExecutor::Shutdown()
+{
+	if (UnitRegistry)
+	{
+		UnitRegistry->OnUnitUnregistered.RemoveAll(this);
+	}
+
+	if (CrowdSubsystem)
+	{
+		CrowdSubsystem->OnUnitPromoted.RemoveAll(this);
+		CrowdSubsystem->OnUnitArrived.RemoveAll(this);
+	}
+
+	ActiveOrders.Empty();
+}
+
+bool UStrategyOrderExecutor::ExecuteCommand(const FStrategyCommand& Command, FStrategyUnitSet& Selection)
+{
+	// replayed ids may not exist if the stream doesn't match the map
+	auto IsSelectable = [this](int32 UnitId)
+	{
+		return UnitRegistry && UnitRegistry->IsRegistered(UnitId) && (!CanSelectUnit || CanSelectUnit(UnitId));
+	};
+
+	switch (Command.Type)
+	{
+	case EStrategyCommandType::Select:
+	{
+		bool bChanged = false;
+
+		Command.Units.ForEachId([&Selection, &IsSelectable, &bChanged](int32 UnitId)
+		{
+			bChanged |= IsSelectable(UnitId) && Selection.Add(UnitId);
+		});
+
+		return bChanged;
+	}
+
+	case EStrategyCommandType::Deselect:
+	{
+		bool bChanged = false;
+
+		Command.Units.ForEachId([&Selection, &bChanged](int32 UnitId)
+		{
+			bChanged |= Selection.Remove(UnitId);
+		});
+
+		return bChanged;
+	}
+
+	case EStrategyCommandType::DeselectAll:
+		Selection.Empty();
+		return true;
+
+	case EStrategyCommandType::SetSelection:
+	{
+		Selection.Empty();
+
+		Command.Units.ForEachId([&Selection, &IsSelectable](int32 UnitId)
+		{
+			if (IsSelectable(UnitId))
+			{
+				Selection.Add(UnitId);
+			}
+		});
+
+		return true;
+	}
+
+	case EStrategyCommandType::Move:
+		return MoveUnits(Selection, Command.Location, Command.bInteract);
+
+	default:
+		// control groups and the camera are up to the owner
+		return false;
+	}
+}
+
+bool UStrategyOrderExecutor::MoveUnits(const FStrategyUnitSet& Units, const FVector& Goal, bool bInteract)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyOrderExecutor_MoveUnits);
+
+	if (!UnitRegistry || Units.Num() == 0)
+	{
+		return false;
+	}
+
+	// gather the units to move. Crowd units don't resolve to actors
+	TArray<AStrategyUnit*> MovingUnits;
+	Units.GetUnits(UnitRegistry, MovingUnits);
+
+	TArray<FVector> UnitLocations;
+	int32 LeaderIndex = INDEX_NONE;
+	float LeaderDistance = 0.0f;
+
+	for (int32 Index = 0; Index < MovingUnits.Num(); ++Index)
+	{
+		UnitLocations.Add(MovingUnits[Index]->GetActorLocation());
+
+		// the closest unit to the goal leads
+		const float Distance = FVector::DistSquared2D(Goal, UnitLocations[Index]);
+
+		if (LeaderIndex == INDEX_NONE || Distance < LeaderDistance)
+		{
+			LeaderIndex = Index;
+			LeaderDistance = Distance;
+		}
+	}
+
+	// stop the units first. Aborting a move reports it as completed, which must not count towards the new order
+	for (AStrategyUnit* CurrentUnit : MovingUnits)
+	{
+		CurrentUnit->StopMoving();
+	}
+
+	// record the order and its interaction targets before any unit can arrive
+	IssueOrder(Goal, Units, bInteract);
+
+	// crowd units head straight for the goal as crowd units
+	if (CrowdSubsystem)
+	{
+		Units.ForEachId([this, &Goal](int32 UnitId)
+		{
+			if (UnitRegistry->IsCrowdUnit(UnitId))
+			{
+				CrowdSubsystem->MoveUnit(UnitId, Goal, InteractionRadius * 0.66f);
+			}
+		});
+	}
+
+	if (MovingUnits.Num() == 0)
+	{
+		return true;
+	}
+
+	// lay out the formation slots at the goal and assign a slot to each unit
+	TArray<FVector> UnitSlots;
+	StrategyFormation::PlanFormation(GetWorld(), Goal, FormationShape, FormationSpacing, UnitLocations, LeaderIndex, UnitSlots);
+
+	AStrategyUnit* Leader = MovingUnits[LeaderIndex];
+	bool bMoveFailed = false;
+
+	for (int32 Index = 0; Index < MovingUnits.Num(); ++Index)
+	{
+		AStrategyUnit* CurrentUnit = MovingUnits[Index];
+
+		CurrentUnit->OnMoveCompleted.AddUniqueDynamic(this, &UStrategyOrderExecutor::OnMoveCompleted);
+
+		if (Index == LeaderIndex)
+		{
+			// only the lead unit pathfinds to the goal
+			bMoveFailed = !CurrentUnit->MoveToLocation(Goal, InteractionRadius * 0.66f);
+
+		} else {
+
+			// everyone else follows the leader to their slot
+			CurrentUnit->FollowFormation(Leader, UnitSlots[Index] - UnitSlots[LeaderIndex], UnitSlots[Index], FormationSpacing * 0.25f);
+		}
+	}
+
+	return !bMoveFailed;
+}
+
+void UStrategyOrderExecutor::ExpireOrders(float Timeout)
+{
+	const double ExpiryTime = GetWorld()->GetTimeSeconds() - Timeout;
+
+	ActiveOrders.RemoveAllSwap([ExpiryTime](const FStrategyOrder& Order)
+	{
+		return Order.IssueTime < ExpiryTime;
+	}, EAllowShrinking::No);
+}
+
+void UStrategyOrderExecutor::GetOrderedUnits(FStrategyUnitSet& OutUnits) const
+{
+	for (const FStrategyOrder& Order : ActiveOrders)
+	{
+		Order.Units.ForEachId([&OutUnits](int32 UnitId)
+		{
+			OutUnits.Add(UnitId);
+		});
+	}
+}
+
+void UStrategyOrderExecutor::IssueOrder(const FVector& Goal, const FStrategyUnitSet& Units, bool bInteract)
+{
+	FStrategyOrder NewOrder;
+	NewOrder.Location = Goal;
+	NewOrder.Units = Units;
+	NewOrder.bAllowInteraction = bInteract;
+	NewOrder.IssueTime = GetWorld()->GetTimeSeconds();
+
+	// take the units off their previous orders, dropping the orders left empty
+	for (int32 Index = ActiveOrders.Num() - 1; Index >= 0; --Index)
+	{
+		FStrategyOrder& Order = ActiveOrders[Index];
+
+		Units.ForEachId([&Order](int32 UnitId)
+		{
+			Order.Units.Remove(UnitId);
+		});
+
+		if (Order.Units.Num() == 0)
+		{
+			ActiveOrders.RemoveAtSwap(Index, EAllowShrinking::No);
+		}
+	}
+
+	// look up the targets once for the whole group
+	if (bInteract)
+	{
+		NewOrder.RecordTargets(UnitRegistry, InteractionRadius);
+	}
+
+	ActiveOrders.Add(MoveTemp(NewOrder));
+}
+
+int32 UStrategyOrderExecutor::FindOrderIndex(int32 UnitId) const
+{
+	return ActiveOrders.IndexOfByPredicate([UnitId](const FStrategyOrder& Order)
+	{
+		return Order.Units.Contains(UnitId);
+	});
+}
+
+void UStrategyOrderExecutor::OnMoveCompleted(AStrategyUnit* MovedUnit)
+{
+	if (IsValid(MovedUnit))
+	{
+		MovedUnit->OnMoveCompleted.RemoveDynamic(this, &UStrategyOrderExecutor::OnMoveCompleted);
+
+		HandleUnitArrived(MovedUnit->GetRegistryId());
+	}
+}
+
+void UStrategyOrderExecutor::OnCrowdUnitArrived(int32 UnitId)
+{
+	HandleUnitArrived(UnitId);
+}
+
+void UStrategyOrderExecutor::HandleUnitArrived(int32 UnitId)
+{
+	// other commanders' units arrive here too, and aren't on any of our orders
+	const int32 OrderIndex = FindOrderIndex(UnitId);
+
+	if (OrderIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	FStrategyOrder& Order = ActiveOrders[OrderIndex];
+
+	Order.Units.Remove(UnitId);
+
+	// the first arrival takes the interaction out of the order, since resolving it can promote units and land back here
+	FStrategyOrder Interaction;
+	Interaction.bAllowInteraction = Order.bAllowInteraction;
+
+	if (Order.bAllowInteraction)
+	{
+		Interaction.Location = Order.Location;
+		Interaction.Targets = Order.Targets;
+
+		Order.bAllowInteraction = false;
+		Order.Targets.Empty();
+	}
+
+	// drop the order once everyone has arrived
+	if (Order.Units.Num() == 0)
+	{
+		ActiveOrders.RemoveAtSwap(OrderIndex, EAllowShrinking::No);
+	}
+
+	// interact with the recorded targets, later arrivals skip this
+	Interaction.ResolveInteraction(UnitRegistry, CrowdSubsystem, UnitId, InteractionRadius);
+}
+
+void UStrategyOrderExecutor::OnUnitPromoted(AStrategyUnit* Unit)
+{
+	// keep listening for the unit's arrival if it's still carrying out one of our orders
+	if (FindOrderIndex(Unit->GetRegistryId()) != INDEX_NONE)
+	{
+		Unit->OnMoveCompleted.AddUniqueDynamic(this, &UStrategyOrderExecutor::OnMoveCompleted);
+	}
+}
+
+void UStrategyOrderExecutor::OnUnitUnregistered(int32 UnitId)
+{
+	// drop the id from the orders, so a reused id doesn't inherit them
+	for (int32 Index = ActiveOrders.Num() - 1; Index >= 0; --Index)
+	{
+		FStrategyOrder& Order = ActiveOrders[Index];
+
+		Order.Targets.Remove(UnitId);
+
+		if (Order.Units.Remove(UnitId) && Order.Units.Num() == 0)
+		{
+			ActiveOrders.RemoveAtSwap(Index, EAllowShrinking::No);
+		}
+	}
+}
@@ -0,0 +1,99 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "StrategyUnitSet.h"
+#include "StrategyFormation.h"
+#include "StrategyOrder.h"
+#include "StrategyOrderExecutor.generated.h"
+
+class AStrategyUnit;
+class UStrategyUnitRegistry;
+class UStrategyCrowdSubsystem;
+struct FStrategyCommand;
+
+/**
+ *  Applies the selection and move commands of one commander, player or AI.
+ *  Moves go out in formation behind the unit closest to the goal, while crowd units head straight for it.
+ *  Each move becomes an order that follows its units until they arrive, through promotions in and out of the crowd.
+ *  The first arrival resolves the order's interaction.
+ *  Each commander owns its own executor, so orders never mix between teams.
+ */
+UCLASS()
+class UStrategyOrderExecutor : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Subscribes to the world's registry and crowd, and sets up the move settings */
+	void Initialize(UWorld* World, float InInteractionRadius, EStrategyFormationShape InFormationShape, float InFormationSpacing, TFunction<bool(int32)> InCanSelectUnit);
+
+	/** Unsubscribes and drops the active orders */
+	void Shutdown();
+
+	/**
+	 *  Applies a selection or move command to the given selection, filtered by the owner's selection rule.
+	 *  Returns false if it had no effect, a move couldn't be started, or it isn't a selection or move command.
+	 */
+	bool ExecuteCommand(const FStrategyCommand& Command, FStrategyUnitSet& Selection);
+
+	/** Moves units to a goal in formation. Returns false if the leader's move request failed */
+	bool MoveUnits(const FStrategyUnitSet& Units, const FVector& Goal, bool bInteract);
+
+	/** Drops the orders that have run for longer than the given time, so their units count as idle again */
+	void ExpireOrders(float Timeout);
+
+	/** Adds the units still carrying out an order to the set */
+	void GetOrderedUnits(FStrategyUnitSet& OutUnits) const;
+
+	/** Returns the number of orders with units still on their way */
+	int32 GetNumActiveOrders() const { return ActiveOrders.Num(); }
+
+protected:
+
+	/** Unit registry for this world */
+	UPROPERTY(Transient)
+	TObjectPtr<UStrategyUnitRegistry> UnitRegistry;
+
+	/** Crowd of units outside the camera view */
+	UPROPERTY(Transient)
+	TObjectPtr<UStrategyCrowdSubsystem> CrowdSubsystem;
+
+	/** Max distance to look for targets around an interaction goal */
+	float InteractionRadius = 250.0f;
+
+	/** Slot layout and spacing used for group moves */
+	EStrategyFormationShape FormationShape = EStrategyFormationShape::Box;
+	float FormationSpacing = 150.0f;
+
+	/** Returns false for units the owner isn't allowed to select */
+	TFunction<bool(int32)> CanSelectUnit;
+
+	/** Move orders with units still on their way */
+	TArray<FStrategyOrder> ActiveOrders;
+
+	/** Starts a move order for the given units, taking them off any previous order, and records its interaction targets */
+	void IssueOrder(const FVector& Goal, const FStrategyUnitSet& Units, bool bInteract);
+
+	/** Returns the index of the active order carrying the unit, or INDEX_NONE */
+	int32 FindOrderIndex(int32 UnitId) const;
+
+	/** Called when a unit move is completed */
+	UFUNCTION()
+	void OnMoveCompleted(AStrategyUnit* MovedUnit);
+
+	/** Called when a crowd unit reaches its move goal */
+	void OnCrowdUnitArrived(int32 UnitId);
+
+	/** Takes an arrived unit off its order. The first arrival resolves the order's interaction */
+	void HandleUnitArrived(int32 UnitId);
+
+	/** Called when a crowd unit is promoted to an actor */
+	void OnUnitPromoted(AStrategyUnit* Unit);
+
+	/** Called when a unit leaves the registry */
+	void OnUnitUnregistered(int32 UnitId);
+};
@@ -0,0 +1,781 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyPathCache.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "NavMesh/NavMeshPath.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Algo/Reverse.h"
+#include "Tactics.h"
+
+static TAutoConsoleVariable<float> CVarPathCacheBuildBudgetMs(
+	TEXT("Tactics.PathCache.BuildBudgetMs"),
+	0.5f,
+	TEXT("Game thread time the strategy path cache can spend building clusters each frame, in milliseconds."));
+
+bool UStrategyPathCache::IsLongMove(const FVector& Start, const FVector& Goal) const
+{
+	// moves within the same or a neighbouring cluster go straight to the navmesh
+	const FIntPoint Delta = GetCluster(Goal) - GetCluster(Start);
+
+	return FMath::Max(FMath::Abs(Delta.X), FMath::Abs(Delta.Y)) > 1;
+}
+
+UStrategyPathCache::ERouteResult UStrategyPathCache::FindRoute(const FVector& Start, const FVector& Goal, TArray<FVector>& OutWaypoints)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyPathCache_FindRoute);
+
+	const FRouteKey Key(GetCluster(Start), GetCluster(Goal));
+
+	// reuse the route if we've already searched between these clusters
+	if (const FCachedRoute* Cached = Routes.Find(Key))
+	{
+		++RouteHits;
+		OutWaypoints = Cached->Waypoints;
+
+		// it's now the most recently used route
+		RouteUseOrder.RemoveSingle(Key);
+		RouteUseOrder.Add(Key);
+
+		return ERouteResult::Found;
+	}
+
+	FCachedRoute Route;
+	const ERouteResult Result = SearchRoute(Start, Goal, Route);
+
+	// only count finished lookups, not the retries of requests waiting for clusters
+	if (Result == ERouteResult::Pending)
+	{
+		return Result;
+	}
+
+	++RouteMisses;
+
+	if (Result == ERouteResult::NotFound)
+	{
+		return Result;
+	}
+
+	// make room by dropping the least recently used route
+	if (RouteUseOrder.Num() >= MaxCachedRoutes)
+	{
+		Routes.Remove(RouteUseOrder[0]);
+		RouteUseOrder.RemoveAt(0);
+	}
+
+	OutWaypoints = Route.Waypoints;
+	Routes.Add(Key, MoveTemp(Route));
+	RouteUseOrder.Add(Key);
+
+	return ERouteResult::Found;
+}
+
+uint32 UStrategyPathCache::RequestPath(const FVector& Start, const FVector& Goal, const AActor* Querier, TSubclassOf<UNavigationQueryFilter> FilterClass, ENavQueryPriority Priority, FNavQueryPathDelegate Callback)
+{
+	const uint32 RequestId = NextRequestId++;
+
+	// skip the invalid id when wrapping around
+	if (NextRequestId == INVALID_NAVQUERYID)
+	{
+		++NextRequestId;
+	}
+
+	FRoutedRequest& Request = Requests.Add(RequestId);
+	Request.Start = Start;
+	Request.Goal = Goal;
+	Request.Querier = Querier;
+	Request.FilterClass = FilterClass;
+	Request.Priority = Priority;
+	Request.Callback = MoveTemp(Callback);
+
+	RouteRequest(RequestId, Request);
+
+	return RequestId;
+}
+
+void UStrategyPathCache::CancelRequest(uint32 RequestId)
+{
+	FRoutedRequest Request;
+
+	if (Requests.RemoveAndCopyValue(RequestId, Request))
+	{
+		if (UNavQueryBroker* Broker = GetWorld()->GetSubsystem<UNavQueryBroker>())
+		{
+			for (const uint32 QueryId : Request.LegQueryIds)
+			{
+				Broker->CancelQuery(QueryId);
+			}
+		}
+	}
+}
+
+void UStrategyPathCache::InvalidateArea(const FBox& Bounds)
+{
+	if (!Bounds.IsValid)
+	{
+		return;
+	}
+
+	const FIntPoint MinCluster = GetCluster(Bounds.Min);
+	const FIntPoint MaxCluster = GetCluster(Bounds.Max);
+
+	// returns true if a cluster overlaps the dirty area, grown by a number of clusters
+	auto IsInArea = [&MinCluster, &MaxCluster](const FIntPoint& Cluster, int32 Margin)
+	{
+		return Cluster.X >= MinCluster.X - Margin && Cluster.X <= MaxCluster.X + Margin && Cluster.Y >= MinCluster.Y - Margin && Cluster.Y <= MaxCluster.Y + Margin;
+	};
+
+	// the borders of dirty clusters need new portals
+	TArray<FIntVector> DirtyBorders;
+
+	for (const TPair<FIntVector, TArray<int32>>& Pair : Borders)
+	{
+		const FIntPoint ClusterA(Pair.Key.X, Pair.Key.Y);
+		const FIntPoint ClusterB = ClusterA + (Pair.Key.Z == 0 ? FIntPoint(1, 0) : FIntPoint(0, 1));
+
+		if (IsInArea(ClusterA, 0) || IsInArea(ClusterB, 0))
+		{
+			DirtyBorders.Add(Pair.Key);
+		}
+	}
+
+	for (const FIntVector& Border : DirtyBorders)
+	{
+		RemoveBorder(Border);
+	}
+
+	// dirty clusters and their neighbours share those borders, so their costs need rebuilding
+	for (auto It = Clusters.CreateIterator(); It; ++It)
+	{
+		if (IsInArea(It.Key(), 1))
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	// clusters being built may hold portals from the dropped borders, so start them over
+	for (FClusterBuild& Build : BuildQueue)
+	{
+		if (IsInArea(Build.Cluster, 1))
+		{
+			Build.Result = FCluster();
+			Build.NextSide = 0;
+			Build.NextRow = 0;
+		}
+	}
+
+	// drop the routes through any of them
+	for (auto It = Routes.CreateIterator(); It; ++It)
+	{
+		for (const FIntPoint& Cluster : It.Value().Clusters)
+		{
+			if (IsInArea(Cluster, 1))
+			{
+				RouteUseOrder.RemoveSingle(It.Key());
+				It.RemoveCurrent();
+				break;
+			}
+		}
+	}
+}
+
+void UStrategyPathCache::DumpStats() const
+{
+	const int32 Lookups = RouteHits + RouteMisses;
+
+	UE_LOG(LogTactics, Display, TEXT("Strategy path cache: %d clusters (%d queued), %d borders, %d portals, %d routes, %d pending requests. Route hits %d / %d (%.1f%%)"),
+		Clusters.Num(), BuildQueue.Num(), Borders.Num(), Portals.Num(), Routes.Num(), Requests.Num(), RouteHits, Lookups, Lookups > 0 ? 100.0f * RouteHits / Lookups : 0.0f);
+}
+
+FIntPoint UStrategyPathCache::GetCluster(const FVector& Location)
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / ClusterSize), FMath::FloorToInt32(Location.Y / ClusterSize));
+}
+
+void UStrategyPathCache::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (BuildQueue.Num() == 0)
+	{
+		return;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyPathCache_Tick);
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double Budget = CVarPathCacheBuildBudgetMs.GetValueOnGameThread() / 1000.0;
+
+	// build clusters a step at a time until we run out of budget. Always take one step so the queue can't stall
+	while (BuildQueue.Num() > 0)
+	{
+		if (StepClusterBuild(BuildQueue[0]))
+		{
+			Clusters.Add(BuildQueue[0].Cluster, MoveTemp(BuildQueue[0].Result));
+			BuildQueue.RemoveAt(0);
+		}
+
+		if (FPlatformTime::Seconds() - StartTime > Budget)
+		{
+			break;
+		}
+	}
+
+	if (BuildQueue.Num() > 0)
+	{
+		return;
+	}
+
+	// every queued cluster is built, so retry the waiting requests. They may queue more clusters further along
+	TArray<uint32> WaitingIds;
+
+	for (const TPair<uint32, FRoutedRequest>& Pair : Requests)
+	{
+		if (Pair.Value.bWaitingForRoute)
+		{
+			WaitingIds.Add(Pair.Key);
+		}
+	}
+
+	for (const uint32 RequestId : WaitingIds)
+	{
+		if (FRoutedRequest* Request = Requests.Find(RequestId))
+		{
+			RouteRequest(RequestId, *Request);
+		}
+	}
+}
+
+TStatId UStrategyPathCache::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyPathCache, STATGROUP_Tickables);
+}
+
+void UStrategyPathCache::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// listen for navmesh changes so we only drop the clusters they touch
+	NavigationDirtyHandle = UNavigationSystemV1::NavigationDirtyEvent.AddUObject(this, &UStrategyPathCache::OnNavigationDirty);
+}
+
+void UStrategyPathCache::Deinitialize()
+{
+	UNavigationSystemV1::NavigationDirtyEvent.Remove(NavigationDirtyHandle);
+
+	// cancel the legs still waiting in the broker
+	TArray<uint32> RequestIds;
+	Requests.GetKeys(RequestIds);
+
+	for (const uint32 RequestId : RequestIds)
+	{
+		CancelRequest(RequestId);
+	}
+
+	Portals.Empty();
+	Borders.Empty();
+	Clusters.Empty();
+	BuildQueue.Empty();
+	Routes.Empty();
+	RouteUseOrder.Empty();
+	PendingDirtyAreas.Empty();
+
+	Super::Deinitialize();
+}
+
+void UStrategyPathCache::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// the navigation system exists by now
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(&InWorld))
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &UStrategyPathCache::OnNavigationGenerationFinished);
+	}
+}
+
+void UStrategyPathCache::QueueCluster(const FIntPoint& Cluster, float SampleHeight)
+{
+	if (!BuildQueue.ContainsByPredicate([&Cluster](const FClusterBuild& Build) { return Build.Cluster == Cluster; }))
+	{
+		FClusterBuild& Build = BuildQueue.AddDefaulted_GetRef();
+		Build.Cluster = Cluster;
+		Build.SampleHeight = SampleHeight;
+	}
+}
+
+bool UStrategyPathCache::StepClusterBuild(FClusterBuild& Build)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyPathCache_BuildCluster);
+
+	FCluster& Cluster = Build.Result;
+
+	// gather the portals on all four borders, one border per step
+	constexpr int32 NumSides = 4;
+
+	const FIntVector Sides[NumSides] =
+	{
+		FIntVector(Build.Cluster.X, Build.Cluster.Y, 0),
+		FIntVector(Build.Cluster.X, Build.Cluster.Y, 1),
+		FIntVector(Build.Cluster.X - 1, Build.Cluster.Y, 0),
+		FIntVector(Build.Cluster.X, Build.Cluster.Y - 1, 1)
+	};
+
+	if (Build.NextSide < NumSides)
+	{
+		Cluster.PortalIds.Append(EnsureBorder(Sides[Build.NextSide], Build.SampleHeight));
+
+		if (++Build.NextSide == NumSides)
+		{
+			Cluster.Costs.Init(MAX_flt, Cluster.PortalIds.Num() * Cluster.PortalIds.Num());
+		}
+
+		return Build.NextSide == NumSides && Cluster.PortalIds.Num() == 0;
+	}
+
+	// compute the path cost from one portal to the ones after it, one row per step
+	const int32 NumPortals = Cluster.PortalIds.Num();
+
+	if (Build.NextRow < NumPortals)
+	{
+		const int32 From = Build.NextRow++;
+		const ANavigationData* NavData = GetNavData();
+
+		Cluster.Costs[From * NumPortals + From] = 0.0f;
+
+		for (int32 To = From + 1; To < NumPortals && NavData; ++To)
+		{
+			FVector::FReal Length = 0.0;
+
+			if (NavData->CalcPathLength(Portals[Cluster.PortalIds[From]].Location, Portals[Cluster.PortalIds[To]].Location, Length) == ENavigationQueryResult::Success)
+			{
+				Cluster.Costs[From * NumPortals + To] = static_cast<float>(Length);
+				Cluster.Costs[To * NumPortals + From] = static_cast<float>(Length);
+			}
+		}
+	}
+
+	return Build.NextRow >= NumPortals;
+}
+
+const TArray<int32>& UStrategyPathCache::EnsureBorder(const FIntVector& Border, float SampleHeight)
+{
+	if (const TArray<int32>* Existing = Borders.Find(Border))
+	{
+		return *Existing;
+	}
+
+	TArray<int32> PortalIds;
+
+	if (const ANavigationData* NavData = GetNavData())
+	{
+		const FIntPoint ClusterA(Border.X, Border.Y);
+		const FIntPoint ClusterB = ClusterA + (Border.Z == 0 ? FIntPoint(1, 0) : FIntPoint(0, 1));
+
+		// the border runs along Y for side 0 and along X for side 1
+		const FVector LineStart = Border.Z == 0
+			? FVector((Border.X + 1) * ClusterSize, Border.Y * ClusterSize, 0.0f)
+			: FVector(Border.X * ClusterSize, (Border.Y + 1) * ClusterSize, 0.0f);
+
+		const FVector LineDirection = Border.Z == 0 ? FVector::RightVector : FVector::ForwardVector;
+
+		const int32 NumSamples = FMath::FloorToInt32(ClusterSize / PortalSampleSpacing);
+		const FVector Extent(PortalSampleSpacing * 0.5f, PortalSampleSpacing * 0.5f, ClusterSize * 0.5f);
+
+		// project samples along the border and find the runs where the navmesh crosses it
+		struct FSpan
+		{
+			int32 First = 0;
+			int32 Num = 0;
+		};
+
+		TArray<FSpan> Spans;
+		TArray<FVector> Samples;
+		Samples.SetNumUninitialized(NumSamples);
+
+		bool bInSpan = false;
+
+		// each border starts from its own height, then follows the navmesh as it rises and falls along the border
+		float Height = SampleHeight;
+
+		for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+		{
+			FVector SampleLocation = LineStart + LineDirection * ((Sample + 0.5f) * PortalSampleSpacing);
+			SampleLocation.Z = Height;
+
+			FNavLocation Projected;
+			const bool bNavigable = NavData->ProjectPoint(SampleLocation, Projected, Extent);
+
+			Samples[Sample] = Projected.Location;
+
+			if (bNavigable)
+			{
+				Height = Projected.Location.Z;
+
+				if (!bInSpan)
+				{
+					Spans.Add(FSpan{ Sample, 0 });
+				}
+
+				++Spans.Last().Num;
+			}
+
+			bInSpan = bNavigable;
+		}
+
+		// keep the widest crossings, with a portal in the middle of each
+		Spans.Sort([](const FSpan& A, const FSpan& B) { return A.Num > B.Num; });
+		Spans.SetNum(FMath::Min(Spans.Num(), MaxPortalsPerBorder));
+
+		for (const FSpan& Span : Spans)
+		{
+			FPortal Portal;
+			Portal.Location = Samples[Span.First + Span.Num / 2];
+			Portal.ClusterA = ClusterA;
+			Portal.ClusterB = ClusterB;
+
+			PortalIds.Add(Portals.Add(Portal));
+		}
+	}
+
+	return Borders.Add(Border, MoveTemp(PortalIds));
+}
+
+UStrategyPathCache::ERouteResult UStrategyPathCache::SearchRoute(const FVector& Start, const FVector& Goal, FCachedRoute& OutRoute)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyPathCache_SearchRoute);
+
+	const FIntPoint StartCluster = GetCluster(Start);
+	const FIntPoint GoalCluster = GetCluster(Goal);
+
+	// A* over the portal graph, with the straight line distance as the heuristic
+	struct FOpenEntry
+	{
+		float Estimate;
+		int32 PortalId;
+
+		bool operator<(const FOpenEntry& Other) const { return Estimate < Other.Estimate; }
+	};
+
+	TArray<FOpenEntry> Open;
+	TMap<int32, float> CostSoFar;
+	TMap<int32, int32> CameFrom;
+	TSet<int32> Closed;
+
+	auto Relax = [&](int32 PortalId, float Cost, int32 Parent)
+	{
+		float* Existing = CostSoFar.Find(PortalId);
+
+		if (!Existing || Cost < *Existing)
+		{
+			CostSoFar.Add(PortalId, Cost);
+			CameFrom.Add(PortalId, Parent);
+			Open.HeapPush(FOpenEntry{ Cost + static_cast<float>(FVector::Dist(Portals[PortalId].Location, Goal)), PortalId });
+		}
+	};
+
+	// leave the start cluster through any of its portals, once it's built
+	const FCluster* Cluster = Clusters.Find(StartCluster);
+
+	if (!Cluster)
+	{
+		QueueCluster(StartCluster, static_cast<float>(Start.Z));
+		return ERouteResult::Pending;
+	}
+
+	for (const int32 PortalId : Cluster->PortalIds)
+	{
+		Relax(PortalId, static_cast<float>(FVector::Dist(Start, Portals[PortalId].Location)), INDEX_NONE);
+	}
+
+	float BestCost = MAX_flt;
+	int32 BestPortal = INDEX_NONE;
+
+	// set when the search reaches clusters that aren't built yet
+	bool bMissingClusters = false;
+
+	while (Open.Num() > 0)
+	{
+		FOpenEntry Entry;
+		Open.HeapPop(Entry, EAllowShrinking::No);
+
+		// nothing left can beat the best route to the goal
+		if (Entry.Estimate >= BestCost)
+		{
+			break;
+		}
+
+		bool bAlreadyClosed = false;
+		Closed.Add(Entry.PortalId, &bAlreadyClosed);
+
+		if (bAlreadyClosed)
+		{
+			continue;
+		}
+
+		if (Closed.Num() > MaxSearchNodes)
+		{
+			break;
+		}
+
+		const FPortal Portal = Portals[Entry.PortalId];
+		const float Cost = CostSoFar.FindChecked(Entry.PortalId);
+
+		// portals on the goal cluster can finish the route
+		if (Portal.ClusterA == GoalCluster || Portal.ClusterB == GoalCluster)
+		{
+			const float GoalCost = Cost + static_cast<float>(FVector::Dist(Portal.Location, Goal));
+
+			if (GoalCost < BestCost)
+			{
+				BestCost = GoalCost;
+				BestPortal = Entry.PortalId;
+			}
+		}
+
+		// move across either of the clusters the portal connects
+		for (const FIntPoint& ClusterId : { Portal.ClusterA, Portal.ClusterB })
+		{
+			Cluster = Clusters.Find(ClusterId);
+
+			// queue unbuilt clusters and keep searching, so one pass finds as many of them as it can
+			if (!Cluster)
+			{
+				QueueCluster(ClusterId, static_cast<float>(Portal.Location.Z));
+				bMissingClusters = true;
+				continue;
+			}
+
+			const int32 NumPortals = Cluster->PortalIds.Num();
+			const int32 From = Cluster->PortalIds.Find(Entry.PortalId);
+
+			for (int32 To = 0; To < NumPortals && From != INDEX_NONE; ++To)
+			{
+				const float EdgeCost = Cluster->Costs[From * NumPortals + To];
+
+				if (To != From && EdgeCost < MAX_flt && !Closed.Contains(Cluster->PortalIds[To]))
+				{
+					Relax(Cluster->PortalIds[To], Cost + EdgeCost, Entry.PortalId);
+				}
+			}
+		}
+	}
+
+	// the unbuilt clusters may hold a better route
+	if (bMissingClusters)
+	{
+		return ERouteResult::Pending;
+	}
+
+	if (BestPortal == INDEX_NONE)
+	{
+		return ERouteResult::NotFound;
+	}
+
+	// walk back from the goal
+	OutRoute.Waypoints.Reset();
+	OutRoute.Clusters.Reset();
+
+	for (int32 PortalId = BestPortal; PortalId != INDEX_NONE; PortalId = CameFrom.FindChecked(PortalId))
+	{
+		const FPortal& Portal = Portals[PortalId];
+
+		OutRoute.Waypoints.Add(Portal.Location);
+		OutRoute.Clusters.AddUnique(Portal.ClusterA);
+		OutRoute.Clusters.AddUnique(Portal.ClusterB);
+	}
+
+	Algo::Reverse(OutRoute.Waypoints);
+
+	return ERouteResult::Found;
+}
+
+void UStrategyPathCache::RemoveBorder(const FIntVector& Border)
+{
+	TArray<int32> PortalIds;
+
+	if (Borders.RemoveAndCopyValue(Border, PortalIds))
+	{
+		for (const int32 PortalId : PortalIds)
+		{
+			Portals.RemoveAt(PortalId);
+		}
+	}
+}
+
+void UStrategyPathCache::RouteRequest(uint32 RequestId, FRoutedRequest& Request)
+{
+	TArray<FVector> Waypoints;
+	const ERouteResult Result = FindRoute(Request.Start, Request.Goal, Waypoints);
+
+	// wait for the clusters along the way, the request is retried once they're built
+	Request.bWaitingForRoute = Result == ERouteResult::Pending;
+
+	if (Request.bWaitingForRoute)
+	{
+		return;
+	}
+
+	// go through the portals if we have a route, otherwise path straight to the goal
+	TArray<FVector> Points;
+	Points.Add(Request.Start);
+
+	if (Result == ERouteResult::Found)
+	{
+		Points.Append(Waypoints);
+
+	} else {
+
+		Request.bDirect = true;
+	}
+
+	Points.Add(Request.Goal);
+
+	RequestLegs(RequestId, Request, Points);
+}
+
+void UStrategyPathCache::RequestLegs(uint32 RequestId, FRoutedRequest& Request, const TArray<FVector>& Points)
+{
+	UNavQueryBroker* Broker = GetWorld()->GetSubsystem<UNavQueryBroker>();
+	check(Broker);
+
+	const int32 NumLegs = Points.Num() - 1;
+
+	Request.LegQueryIds.Reset(NumLegs);
+	Request.LegPaths.Init(nullptr, NumLegs);
+	Request.LegsLeft = NumLegs;
+
+	// legs are short, so the broker can run them side by side
+	for (int32 Leg = 0; Leg < NumLegs; ++Leg)
+	{
+		Request.LegQueryIds.Add(Broker->RequestPath(Points[Leg], Points[Leg + 1], Request.Querier.Get(), Request.FilterClass, Request.Priority,
+			FNavQueryPathDelegate::CreateUObject(this, &UStrategyPathCache::OnLegPathFound, RequestId, Leg)));
+	}
+}
+
+void UStrategyPathCache::OnLegPathFound(uint32 QueryId, bool bSuccess, FNavPathSharedPtr Path, uint32 RequestId, int32 LegIndex)
+{
+	FRoutedRequest* Request = Requests.Find(RequestId);
+
+	// ignore legs of cancelled or restarted requests
+	if (!Request || !Request->LegQueryIds.IsValidIndex(LegIndex) || Request->LegQueryIds[LegIndex] != QueryId)
+	{
+		return;
+	}
+
+	// legs before the last one have to reach their portal, otherwise the stitched path would have gaps
+	const bool bLastLeg = LegIndex == Request->LegQueryIds.Num() - 1;
+
+	if (!bSuccess || (!bLastLeg && Path->IsPartial()))
+	{
+		// fall back to a direct path
+		if (!Request->bDirect)
+		{
+			if (UNavQueryBroker* Broker = GetWorld()->GetSubsystem<UNavQueryBroker>())
+			{
+				for (const uint32 LegQueryId : Request->LegQueryIds)
+				{
+					Broker->CancelQuery(LegQueryId);
+				}
+			}
+
+			Request->bDirect = true;
+			RequestLegs(RequestId, *Request, { Request->Start, Request->Goal });
+			return;
+		}
+
+		FNavQueryPathDelegate Callback = MoveTemp(Request->Callback);
+		Requests.Remove(RequestId);
+
+		Callback.ExecuteIfBound(RequestId, false, nullptr);
+		return;
+	}
+
+	Request->LegPaths[LegIndex] = Path;
+
+	if (--Request->LegsLeft > 0)
+	{
+		return;
+	}
+
+	FNavPathSharedPtr Combined = Request->LegPaths[0];
+
+	if (Request->LegPaths.Num() > 1)
+	{
+		// join the legs into a new path to the final goal. It's registered with the navigation data,
+		// and carries every leg's corridor, so a navmesh change along any of the legs invalidates it
+		FPathFindingQueryData QueryData = Combined->GetQueryData();
+		QueryData.EndLocation = Request->Goal;
+
+		Combined = Combined->GetNavigationDataUsed()->CreatePathInstance<FNavMeshPath>(QueryData);
+
+		TArray<FNavPathPoint>& CombinedPoints = Combined->GetPathPoints();
+		FNavMeshPath* CombinedMeshPath = Combined->CastPath<FNavMeshPath>();
+
+		for (int32 Leg = 0; Leg < Request->LegPaths.Num(); ++Leg)
+		{
+			const FNavigationPath& LegPath = *Request->LegPaths[Leg];
+			const TArray<FNavPathPoint>& LegPoints = LegPath.GetPathPoints();
+
+			// skip the duplicate point where the legs meet
+			for (int32 Point = Leg > 0 ? 1 : 0; Point < LegPoints.Num(); ++Point)
+			{
+				CombinedPoints.Add(LegPoints[Point]);
+			}
+
+			if (const FNavMeshPath* LegMeshPath = LegPath.CastPath<FNavMeshPath>())
+			{
+				CombinedMeshPath->PathCorridor.Append(LegMeshPath->PathCorridor);
+				CombinedMeshPath->PathCorridorCost.Append(LegMeshPath->PathCorridorCost);
+			}
+		}
+
+		Combined->SetIsPartial(Request->LegPaths.Last()->IsPartial());
+		Combined->MarkReady();
+	}
+
+	// repathing on our own would path the whole way on the navmesh, so the mover asks the cache for a new route instead
+	Combined->EnableRecalculationOnInvalidation(false);
+
+	FNavQueryPathDelegate Callback = MoveTemp(Request->Callback);
+	Requests.Remove(RequestId);
+
+	Callback.ExecuteIfBound(RequestId, true, Combined);
+}
+
+const ANavigationData* UStrategyPathCache::GetNavData() const
+{
+	const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	return NavSys ? NavSys->GetDefaultNavDataInstance() : nullptr;
+}
+
+void UStrategyPathCache::OnNavigationDirty(const FBox& Bounds)
+{
+	InvalidateArea(Bounds);
+
+	// tiles in the area may still be rebuilding, so drop it again once they're done
+	PendingDirtyAreas.Add(Bounds);
+}
+
+void UStrategyPathCache::OnNavigationGenerationFinished(ANavigationData* NavData)
+{
+	for (const FBox& Bounds : PendingDirtyAreas)
+	{
+		InvalidateArea(Bounds);
+	}
+
+	PendingDirtyAreas.Reset();
+}
+
+static FAutoConsoleCommandWithWorldAndArgs StrategyPathCacheDumpCommand(
+	TEXT("Tactics.PathCache.Dump"),
+	TEXT("Logs the strategy path cache contents and route hit rate."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UStrategyPathCache* PathCache = World ? World->GetSubsystem<UStrategyPathCache>() : nullptr)
+		{
+			PathCache->DumpStats();
+		}
+	}));
@@ -0,0 +1,242 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NavQueryBroker.h"
+#include "StrategyPathCache.generated.h"
+
+class ANavigationData;
+
+/**
+ *  Hierarchical path cache for long strategy moves, in the style of HPA*.
+ *  The navmesh is split into square clusters. Portals are placed where the navmesh crosses
+ *  the border between two clusters, and the path cost between every pair of portals in a
+ *  cluster is computed the first time a search reaches the cluster.
+ *  Clusters are built a step at a time on tick, within a frame budget, and requests that
+ *  reach unbuilt clusters wait until they're ready.
+ *  Long moves search the portal graph instead of the full navmesh. The resulting routes are
+ *  cached by start and goal cluster, then each leg is refined with a short path query and
+ *  the legs are joined into a new path to the goal.
+ *  Routed paths don't repath on their own. When the navmesh under one changes, the mover asks for a new route.
+ *  When the navmesh changes, only the clusters in the dirty area and their neighbours are dropped.
+ */
+UCLASS()
+class UStrategyPathCache : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Size of a cluster, in world units */
+	static constexpr float ClusterSize = 2000.0f;
+
+	/** Distance between the navmesh samples taken along a cluster border */
+	static constexpr float PortalSampleSpacing = 100.0f;
+
+	/** Max number of portals on a single cluster border */
+	static constexpr int32 MaxPortalsPerBorder = 3;
+
+	/** Max number of portals expanded by a route search */
+	static constexpr int32 MaxSearchNodes = 4096;
+
+	/** Max number of cached routes */
+	static constexpr int32 MaxCachedRoutes = 256;
+
+	/** Outcome of a route lookup */
+	enum class ERouteResult : uint8
+	{
+		/** The route was found */
+		Found,
+
+		/** There's no route between the clusters */
+		NotFound,
+
+		/** Clusters along the way still need to be built. Try again once they are */
+		Pending
+	};
+
+	/** Returns true if a move is long enough to go through the cluster graph */
+	bool IsLongMove(const FVector& Start, const FVector& Goal) const;
+
+	/** Finds the portal waypoints between two points, using the route cache. Queues any clusters the search still needs */
+	ERouteResult FindRoute(const FVector& Start, const FVector& Goal, TArray<FVector>& OutWaypoints);
+
+	/** Finds the route, refines each leg through the navigation query broker and returns the stitched path. Returns the request id */
+	uint32 RequestPath(const FVector& Start, const FVector& Goal, const AActor* Querier, TSubclassOf<UNavigationQueryFilter> FilterClass, ENavQueryPriority Priority, FNavQueryPathDelegate Callback);
+
+	/** Cancels a path request. Its callback won't be called */
+	void CancelRequest(uint32 RequestId);
+
+	/** Drops the clusters overlapping the bounds, the neighbouring clusters' portal costs, and the routes through them */
+	void InvalidateArea(const FBox& Bounds);
+
+	/** Logs the cache contents and hit rate */
+	void DumpStats() const;
+
+	/** Returns the cluster containing a location */
+	static FIntPoint GetCluster(const FVector& Location);
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// UWorldSubsystem interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+protected:
+
+	/** Navigable crossing between two neighbouring clusters */
+	struct FPortal
+	{
+		/** Location on the navmesh */
+		FVector Location = FVector::ZeroVector;
+
+		/** Clusters on either side */
+		FIntPoint ClusterA = FIntPoint::ZeroValue;
+		FIntPoint ClusterB = FIntPoint::ZeroValue;
+	};
+
+	/** Portals of a cluster and the path costs between them */
+	struct FCluster
+	{
+		/** Portals on the cluster's borders */
+		TArray<int32> PortalIds;
+
+		/** Path cost between each pair of portals, MAX_flt if there's no path */
+		TArray<float> Costs;
+	};
+
+	/** Cluster being built over several frames */
+	struct FClusterBuild
+	{
+		/** Cluster to build */
+		FIntPoint Cluster = FIntPoint::ZeroValue;
+
+		/** Height the border samples start from, taken from the point the search reached the cluster at */
+		float SampleHeight = 0.0f;
+
+		/** Portals and costs gathered so far */
+		FCluster Result;
+
+		/** Next border to gather portals from */
+		int32 NextSide = 0;
+
+		/** Next row of portal costs to compute, once all borders are gathered */
+		int32 NextRow = 0;
+	};
+
+	/** Start and goal cluster of a route */
+	using FRouteKey = TPair<FIntPoint, FIntPoint>;
+
+	/** Cached route between two clusters */
+	struct FCachedRoute
+	{
+		/** Portal locations, in order */
+		TArray<FVector> Waypoints;
+
+		/** Clusters the route goes through */
+		TArray<FIntPoint> Clusters;
+	};
+
+	/** Path request being refined leg by leg */
+	struct FRoutedRequest
+	{
+		/** Broker queries for each leg */
+		TArray<uint32> LegQueryIds;
+
+		/** Refined path for each leg */
+		TArray<FNavPathSharedPtr> LegPaths;
+
+		/** Number of legs still waiting for a path */
+		int32 LegsLeft = 0;
+
+		/** Query parameters, kept to fall back to a direct path */
+		FVector Start = FVector::ZeroVector;
+		FVector Goal = FVector::ZeroVector;
+		TWeakObjectPtr<const AActor> Querier;
+		TSubclassOf<UNavigationQueryFilter> FilterClass;
+		ENavQueryPriority Priority = ENavQueryPriority::Normal;
+
+		/** If true, this is already the direct fallback path */
+		bool bDirect = false;
+
+		/** If true, the request is waiting for the clusters along its route to be built */
+		bool bWaitingForRoute = false;
+
+		FNavQueryPathDelegate Callback;
+	};
+
+	/** Portals, indexed by portal id */
+	TSparseArray<FPortal> Portals;
+
+	/** Portal ids on each border. Keyed by cluster and side: 0 is the border with the +X neighbour, 1 with the +Y neighbour */
+	TMap<FIntVector, TArray<int32>> Borders;
+
+	/** Clusters built so far */
+	TMap<FIntPoint, FCluster> Clusters;
+
+	/** Clusters waiting to be built, in order. The first one is in progress */
+	TArray<FClusterBuild> BuildQueue;
+
+	/** Cached routes, keyed by start and goal cluster */
+	TMap<FRouteKey, FCachedRoute> Routes;
+
+	/** Cached route keys, least recently used first */
+	TArray<FRouteKey> RouteUseOrder;
+
+	/** Areas dirtied since the navmesh last finished building. Clusters rebuilt in the meantime may have used stale tiles */
+	TArray<FBox> PendingDirtyAreas;
+
+	/** Path requests being refined, by request id */
+	TMap<uint32, FRoutedRequest> Requests;
+
+	/** Id of the next path request */
+	uint32 NextRequestId = 1;
+
+	/** Route cache hits and misses */
+	int32 RouteHits = 0;
+	int32 RouteMisses = 0;
+
+	/** Handle for the navigation dirty event */
+	FDelegateHandle NavigationDirtyHandle;
+
+	/** Queues a cluster to be built, unless it's already queued */
+	void QueueCluster(const FIntPoint& Cluster, float SampleHeight);
+
+	/** Runs the next step of a cluster build: one border, or one row of portal costs. Returns true once the cluster is complete */
+	bool StepClusterBuild(FClusterBuild& Build);
+
+	/** Builds the portals on a border if needed, and returns their ids. Samples start at the given height and follow the navmesh along the border */
+	const TArray<int32>& EnsureBorder(const FIntVector& Border, float SampleHeight);
+
+	/** Searches the portal graph between two points, queueing the clusters it reaches that aren't built yet */
+	ERouteResult SearchRoute(const FVector& Start, const FVector& Goal, FCachedRoute& OutRoute);
+
+	/** Finds the route for a request and queues its legs, or leaves it waiting for the route's clusters */
+	void RouteRequest(uint32 RequestId, FRoutedRequest& Request);
+
+	/** Removes a border and its portals */
+	void RemoveBorder(const FIntVector& Border);
+
+	/** Queues a broker query for each leg of a request */
+	void RequestLegs(uint32 RequestId, FRoutedRequest& Request, const TArray<FVector>& Points);
+
+	/** Called by the broker when a leg's path is ready */
+	void OnLegPathFound(uint32 QueryId, bool bSuccess, FNavPathSharedPtr Path, uint32 RequestId, int32 LegIndex);
+
+	/** Returns the navigation data the cache is built on */
+	const ANavigationData* GetNavData() const;
+
+	/** Called when an area of the navmesh is dirtied */
+	void OnNavigationDirty(const FBox& Bounds);
+
+	/** Called when the navmesh finishes building */
+	UFUNCTION()
+	void OnNavigationGenerationFinished(ANavigationData* NavData);
+};
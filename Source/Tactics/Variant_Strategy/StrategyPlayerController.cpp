@@ -14,13 +14,78 @@
 #include "Engine/CollisionProfile.h"
 #include "Kismet/GameplayStatics.h"
 #include "StrategyUnit.h"
+#include "StrategyUnitRegistry.h"
+#include "StrategyCrowdSubsystem.h"
+#include "StrategyFogOfWar.h"
+#include "StrategyCommand.h"
+#include "StrategyReplaySubsystem.h"
+#include "StrategyAICommander.h"
+#include "StrategyOrderExecutor.h"
+#include "StrategyGameMode.h"
 #include "NavigationSystem.h"
-#include "Engine/OverlapResult.h"
+#include "CursorCacheSubsystem.h"
 
 AStrategyPlayerController::AStrategyPlayerController()
 {
 	// mouse cursor should always be shown
 	bShowMouseCursor = true;
+
+	// one action slot per control group
+	ControlGroupActions.SetNumZeroed(NumControlGroups);
+}
+
+void AStrategyPlayerController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// subscribe to the unit registry so destroyed units leave the selection and control groups
+	UnitRegistry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>();
+
+	if (UnitRegistry)
+	{
+		UnitRegistry->OnUnitUnregistered.AddUObject(this, &AStrategyPlayerController::OnUnitUnregistered);
+	}
+
+	// follow units in and out of the crowd
+	CrowdSubsystem = GetWorld()->GetSubsystem<UStrategyCrowdSubsystem>();
+
+	if (CrowdSubsystem)
+	{
+		CrowdSubsystem->OnUnitPromoted.AddUObject(this, &AStrategyPlayerController::OnUnitPromoted);
+	}
+
+	// commands go through the replay subsystem so they can be recorded or replayed
+	ReplaySubsystem = GetWorld()->GetSubsystem<UStrategyReplaySubsystem>();
+
+	// the AI commander's units are off limits
+	AICommander = GetWorld()->GetSubsystem<UStrategyAICommander>();
+
+	// selection and move commands go through the same executor as the AI commander's
+	OrderExecutor = NewObject<UStrategyOrderExecutor>(this);
+	OrderExecutor->Initialize(GetWorld(), InteractionRadius, FormationShape, FormationSpacing, [this](int32 UnitId)
+	{
+		return CanSelectUnit(UnitId);
+	});
+
+	// our commands are stamped with the player's team
+	if (const AStrategyGameMode* GameMode = Cast<AStrategyGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		PlayerTeamId = GameMode->GetPlayerTeamId();
+	}
+}
+
+void AStrategyPlayerController::PlayerTick(float DeltaTime)
+{
+	// apply this frame's replayed commands the same way live input would be
+	if (ReplaySubsystem && ReplaySubsystem->IsReplaying())
+	{
+		ReplaySubsystem->ApplyDueCommands(PlayerTeamId, [this](const FStrategyCommand& Command)
+		{
+			return ExecuteCommand(Command);
+		});
+	}
+
+	Super::PlayerTick(DeltaTime);
 }
 
 void AStrategyPlayerController::SetupInputComponent()
@@ -72,7 +137,6 @@ void AStrategyPlayerController::SetupInputComponent()
 			EnhancedInputComponent->BindAction(InteractHoldAction, ETriggerEvent::Started, this, &AStrategyPlayerController::InteractHoldStarted);
 			EnhancedInputComponent->BindAction(InteractHoldAction, ETriggerEvent::Triggered, this, &AStrategyPlayerController::InteractHoldTriggered);
 
-			EnhancedInputComponent->BindAction(InteractClickAction, ETriggerEvent::Started, this, &AStrategyPlayerController::InteractClickStarted);
 			EnhancedInputComponent->BindAction(InteractClickAction, ETriggerEvent::Completed, this, &AStrategyPlayerController::InteractClickCompleted);
 
 			// Touch Interaction
@@ -87,6 +151,20 @@ void AStrategyPlayerController::SetupInputComponent()
 			EnhancedInputComponent->BindAction(TouchSecondaryAction, ETriggerEvent::Canceled, this, &AStrategyPlayerController::TouchSecondaryCompleted);
 
 			EnhancedInputComponent->BindAction(TouchDoubleTapAction, ETriggerEvent::Triggered, this, &AStrategyPlayerController::TouchDoubleTap);
+
+			// Control Groups
+			EnhancedInputComponent->BindAction(ControlGroupModifierAction, ETriggerEvent::Triggered, this, &AStrategyPlayerController::ControlGroupModifier);
+			EnhancedInputComponent->BindAction(ControlGroupModifierAction, ETriggerEvent::Completed, this, &AStrategyPlayerController::ControlGroupModifier);
+			EnhancedInputComponent->BindAction(ControlGroupModifierAction, ETriggerEvent::Canceled, this, &AStrategyPlayerController::ControlGroupModifier);
+
+			for (int32 GroupIndex = 0; GroupIndex < FMath::Min(ControlGroupActions.Num(), NumControlGroups); ++GroupIndex)
+			{
+				if (ControlGroupActions[GroupIndex])
+				{
+					// pass the group index as the binding payload
+					EnhancedInputComponent->BindAction(ControlGroupActions[GroupIndex], ETriggerEvent::Started, this, &AStrategyPlayerController::ControlGroupPressed, GroupIndex);
+				}
+			}
 		}
 	}
 }
@@ -112,24 +190,76 @@ void AStrategyPlayerController::DragSelectUnits(const TArray<AStrategyUnit*>& Un
 	// do we have units in the list?
 	if (Units.Num() > 0)
 	{
-		// ensure any previous units are deselected
-		DoDeselectAllCommand();
+		// build the new selection
+		FStrategyUnitSet NewSelection;
 
-		// select each new unit
-		for (AStrategyUnit* CurrentUnit : Units)
+		for (const AStrategyUnit* CurrentUnit : Units)
 		{
-			// add the unit to the selection list
-			ControlledUnits.Add(CurrentUnit);
+			if (CanSelectUnit(CurrentUnit->GetRegistryId()))
+			{
+				NewSelection.Add(CurrentUnit->GetRegistryId());
+			}
+		}
 
-			// select the unit
-			CurrentUnit->UnitSelected();
+		// swap it in, notifying only the units that entered or left the box. The box is redrawn every frame, so skip unchanged selections
+		if (!(NewSelection == ControlledUnits))
+		{
+			FStrategyCommand Command(EStrategyCommandType::SetSelection);
+			Command.Units = MoveTemp(NewSelection);
+
+			SubmitCommand(Command);
+		}
+	}
+}
+
+void AStrategyPlayerController::GetUnitsInScreenRect(const FVector2D& ScreenStart, const FVector2D& ScreenEnd, TArray<AStrategyUnit*>& OutUnits) const
+{
+	if (const UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>())
+	{
+		// turn the screen rectangle into a world space quad at the units' height and query the grid
+		FVector2D Corners[4];
+
+		if (UStrategyUnitRegistry::GetScreenRectQuad(this, ScreenStart, ScreenEnd, Registry->GetAverageUnitHeight(), Corners))
+		{
+			Registry->GetUnitsInQuad(Corners, OutUnits);
+		}
+
+		// units in the fog of war can't be selected
+		if (const UStrategyFogOfWar* Fog = GetWorld()->GetSubsystem<UStrategyFogOfWar>())
+		{
+			Fog->FilterVisibleUnits(OutUnits);
+		}
+	}
+}
+
+const TArray<TObjectPtr<AStrategyUnit>>& AStrategyPlayerController::GetSelectedUnits()
+{
+	// rebuild the list only when the selection has changed
+	if (bSelectedUnitsListDirty)
+	{
+		bSelectedUnitsListDirty = false;
+		SelectedUnitsList.Reset();
+
+		if (UnitRegistry)
+		{
+			ControlledUnits.ForEachId([this](int32 UnitId)
+			{
+				if (AStrategyUnit* CurrentUnit = UnitRegistry->GetUnit(UnitId))
+				{
+					SelectedUnitsList.Add(CurrentUnit);
+				}
+			});
 		}
 	}
+
+	return SelectedUnitsList;
 }
 
-const TArray<AStrategyUnit*>& AStrategyPlayerController::GetSelectedUnits()
+void AStrategyPlayerController::MarkSelectionChanged()
 {
-	return ControlledUnits;
+	// the pointer list is rebuilt lazily, the serial lets other systems spot the change
+	bSelectedUnitsListDirty = true;
+	++SelectionSerial;
 }
 
 void AStrategyPlayerController::MoveCamera(const FInputActionValue& Value)
@@ -156,24 +286,38 @@ void AStrategyPlayerController::MoveCamera(const FInputActionValue& Value)
 void AStrategyPlayerController::ZoomCamera(const FInputActionValue& Value)
 {
 	// scale the input and subtract from the current zoom level
-	float ZoomLevel = CameraZoom - (Value.Get<float>() * ZoomScaling);
-
-	// clamp to min/max zoom levels
-	CameraZoom = FMath::Clamp(ZoomLevel, MinZoomLevel, MaxZoomLevel);
-
-	// update the pawn's camera
-	ControlledPawn->SetZoomModifier(CameraZoom);
+	FStrategyCommand Command(EStrategyCommandType::CameraZoom);
+	Command.Zoom = CameraZoom - (Value.Get<float>() * ZoomScaling);
 
+	SubmitCommand(Command);
 }
 
 void AStrategyPlayerController::ResetCamera(const FInputActionValue& Value)
 {
 	// reset zoom level to its initial value
-	CameraZoom = DefaultZoom;
+	FStrategyCommand Command(EStrategyCommandType::CameraZoom);
+	Command.Zoom = DefaultZoom;
 
-	// update the pawn's camera
-	ControlledPawn->SetZoomModifier(DefaultZoom);
+	SubmitCommand(Command);
+}
+
+void AStrategyPlayerController::ControlGroupModifier(const FInputActionValue& Value)
+{
+	// update the control group modifier flag
+	bControlGroupModifier = Value.Get<bool>();
+}
+
+void AStrategyPlayerController::ControlGroupPressed(const FInputActionValue& Value, int32 GroupIndex)
+{
+	// save the group if the modifier is held, recall it otherwise
+	if (bControlGroupModifier)
+	{
+		DoSaveControlGroupCommand(GroupIndex);
+
+	} else {
 
+		DoRecallControlGroupCommand(GroupIndex);
+	}
 }
 
 void AStrategyPlayerController::SelectHoldStarted(const FInputActionValue& Value)
@@ -233,13 +377,6 @@ void AStrategyPlayerController::InteractHoldTriggered(const FInputActionValue& V
 	DoDragScrollCommand();
 }
 
-void AStrategyPlayerController::InteractClickStarted(const FInputActionValue& Value)
-{
-
-	// reset the interaction flag
-	ResetInteraction();
-}
-
 void AStrategyPlayerController::InteractClickCompleted(const FInputActionValue& Value)
 {
 
@@ -342,6 +479,84 @@ void AStrategyPlayerController::TouchDoubleTap(const FInputActionValue& Value)
 	}
 }
 
+bool AStrategyPlayerController::SubmitCommand(const FStrategyCommand& Command)
+{
+	// stamp the command with our team, so the replay can tell it apart from the AI commander's
+	FStrategyCommand TeamCommand = Command;
+	TeamCommand.TeamId = PlayerTeamId;
+
+	if (ReplaySubsystem)
+	{
+		// the replay owns the game, live input would make it diverge
+		if (ReplaySubsystem->IsReplaying())
+		{
+			return false;
+		}
+
+		ReplaySubsystem->RecordCommand(TeamCommand);
+	}
+
+	return ExecuteCommand(TeamCommand);
+}
+
+bool AStrategyPlayerController::ExecuteCommand(const FStrategyCommand& Command)
+{
+	switch (Command.Type)
+	{
+	case EStrategyCommandType::SaveControlGroup:
+		if (Command.GroupIndex >= 0 && Command.GroupIndex < NumControlGroups)
+		{
+			// copy the selection bits
+			ControlGroups[Command.GroupIndex] = ControlledUnits;
+			return true;
+		}
+		return false;
+
+	case EStrategyCommandType::RecallControlGroup:
+		if (Command.GroupIndex >= 0 && Command.GroupIndex < NumControlGroups)
+		{
+			SetSelection(ControlGroups[Command.GroupIndex]);
+			return true;
+		}
+		return false;
+
+	case EStrategyCommandType::CameraLocation:
+		if (ControlledPawn)
+		{
+			ControlledPawn->SetActorLocation(Command.Location);
+			return true;
+		}
+		return false;
+
+	case EStrategyCommandType::CameraZoom:
+		if (ControlledPawn)
+		{
+			SetCameraZoom(Command.Zoom);
+			return true;
+		}
+		return false;
+
+	default:
+	{
+		if (!OrderExecutor)
+		{
+			return false;
+		}
+
+		// selections and moves are shared with the AI commander. Apply them to a copy, so only the units that changed are notified
+		FStrategyUnitSet NewSelection = ControlledUnits;
+		const bool bResult = OrderExecutor->ExecuteCommand(Command, NewSelection);
+
+		if (!(NewSelection == ControlledUnits))
+		{
+			SetSelection(NewSelection);
+		}
+
+		return bResult;
+	}
+	}
+}
+
 void AStrategyPlayerController::DoSelectionCommand()
 {
 
@@ -378,29 +593,24 @@ void AStrategyPlayerController::DoSelectionCommand()
 		// update the target unit
 		TargetUnit = Cast<AStrategyUnit>(OutHit.GetActor());
 
-		if (TargetUnit)
-		{
-
-			// is the unit already in the controlled list?
-			if (ControlledUnits.Contains(TargetUnit))
-			{
-
-				// remove the units from the controlled list
-				ControlledUnits.Remove(TargetUnit);
+		// units in the fog of war can't be selected
+		const UStrategyFogOfWar* Fog = GetWorld()->GetSubsystem<UStrategyFogOfWar>();
 
-				// tell the unit it's been deselected
-				TargetUnit->UnitDeselected();
+		if (TargetUnit && Fog && !Fog->IsUnitVisible(TargetUnit->GetRegistryId()))
+		{
+			TargetUnit = nullptr;
+		}
 
-			}
-			else {
+		if (TargetUnit)
+		{
 
-				// add the unit to the controlled list
-				ControlledUnits.Add(TargetUnit);
+			// toggle the unit's selection
+			const bool bSelected = ControlledUnits.Contains(TargetUnit->GetRegistryId());
 
-				// tell the unit it's been selected
-				TargetUnit->UnitSelected();
+			FStrategyCommand Command(bSelected ? EStrategyCommandType::Deselect : EStrategyCommandType::Select);
+			Command.Units.Add(TargetUnit->GetRegistryId());
 
-			}
+			SubmitCommand(Command);
 		}
 
 	} else {
@@ -429,51 +639,162 @@ void AStrategyPlayerController::DoSelectionCommand()
 void AStrategyPlayerController::DoSelectAllOnScreenCommand()
 {
 
-	// find all NPCs currently on screen
-	TArray<AActor*> FoundActors;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AStrategyUnit::StaticClass(), FoundActors);
+	UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>();
 
-	// process each actor found
-	for (AActor* CurrentActor : FoundActors)
+	if (!Registry || !ControlledPawn)
 	{
-		// cast back to our unit class
-		if (AStrategyUnit* CurrentUnit = Cast<AStrategyUnit>(CurrentActor))
-		{
-			// has the actor been recently rendered?
-			if (CurrentActor->WasRecentlyRendered(0.2f))
-			{
+		return;
+	}
 
-				// is the actor not on our controlled units list?
-				if (!ControlledUnits.Contains(CurrentUnit))
-				{
-					// add it to the controlled units list
-					ControlledUnits.Add(CurrentUnit);
+	// use the viewport aspect ratio if we have one, otherwise fall back to the camera's
+	int32 ViewportX = 0;
+	int32 ViewportY = 0;
+	GetViewportSize(ViewportX, ViewportY);
 
-					// notify it of selection
-					CurrentUnit->UnitSelected();
-				}
-			}
-		}		
+	const UCameraComponent* Camera = ControlledPawn->GetCamera();
+	const float AspectRatio = (ViewportX > 0 && ViewportY > 0) ? float(ViewportX) / float(ViewportY) : Camera->AspectRatio;
+
+	// find all units inside the camera's view volume
+	TArray<AStrategyUnit*> FoundUnits;
+	Registry->GetUnitsInView(Camera, AspectRatio, FoundUnits);
+
+	// skip the units in the fog of war
+	if (const UStrategyFogOfWar* Fog = GetWorld()->GetSubsystem<UStrategyFogOfWar>())
+	{
+		Fog->FilterVisibleUnits(FoundUnits);
 	}
 
+	// select each unit found. Units already selected are skipped
+	FStrategyCommand Command(EStrategyCommandType::Select);
+
+	for (const AStrategyUnit* CurrentUnit : FoundUnits)
+	{
+		if (!ControlledUnits.Contains(CurrentUnit->GetRegistryId()))
+		{
+			Command.Units.Add(CurrentUnit->GetRegistryId());
+		}
+	}
+
+	if (Command.Units.Num() > 0)
+	{
+		SubmitCommand(Command);
+	}
 }
 
 void AStrategyPlayerController::DoDeselectAllCommand()
 {
+	// nothing to record if nothing is selected
+	if (ControlledUnits.Num() > 0)
+	{
+		SubmitCommand(FStrategyCommand(EStrategyCommandType::DeselectAll));
+	}
+}
+
+void AStrategyPlayerController::DoSaveControlGroupCommand(int32 GroupIndex)
+{
+	FStrategyCommand Command(EStrategyCommandType::SaveControlGroup);
+	Command.GroupIndex = GroupIndex;
+
+	SubmitCommand(Command);
+}
+
+void AStrategyPlayerController::DoRecallControlGroupCommand(int32 GroupIndex)
+{
+	// ignore empty groups so a stray key press doesn't clear the selection
+	if (GroupIndex >= 0 && GroupIndex < NumControlGroups && ControlGroups[GroupIndex].Num() > 0)
+	{
+		FStrategyCommand Command(EStrategyCommandType::RecallControlGroup);
+		Command.GroupIndex = GroupIndex;
+
+		SubmitCommand(Command);
+	}
+}
+
+void AStrategyPlayerController::SetSelection(const FStrategyUnitSet& NewSelection)
+{
+	// copy the new selection bits, keeping the old ones to diff against
+	const FStrategyUnitSet PreviousSelection = ControlledUnits;
+	ControlledUnits = NewSelection;
+	MarkSelectionChanged();
 
-	// tell each controlled unit it's been deselected
-	for (AStrategyUnit* CurrentUnit : ControlledUnits)
+	if (!UnitRegistry)
 	{
-		// ensure the unit hasn't been destroyed
-		if (IsValid(CurrentUnit))
+		return;
+	}
+
+	// notify the units that left the selection
+	PreviousSelection.ForEachId([this](int32 UnitId)
+	{
+		if (!ControlledUnits.Contains(UnitId))
+		{
+			NotifyUnitSelection(UnitId, false);
+		}
+	});
+
+	// notify the units that joined the selection
+	ControlledUnits.ForEachId([this, &PreviousSelection](int32 UnitId)
+	{
+		if (!PreviousSelection.Contains(UnitId))
+		{
+			NotifyUnitSelection(UnitId, true);
+		}
+	});
+}
+
+bool AStrategyPlayerController::CanSelectUnit(int32 UnitId) const
+{
+	return !AICommander || !AICommander->ControlsUnit(UnitId);
+}
+
+void AStrategyPlayerController::OnUnitUnregistered(int32 UnitId)
+{
+	// drop the id before the registry hands it to another unit
+	if (ControlledUnits.Remove(UnitId))
+	{
+		MarkSelectionChanged();
+	}
+
+	for (FStrategyUnitSet& Group : ControlGroups)
+	{
+		Group.Remove(UnitId);
+	}
+}
+
+void AStrategyPlayerController::NotifyUnitSelection(int32 UnitId, bool bSelected)
+{
+	if (!UnitRegistry)
+	{
+		return;
+	}
+
+	if (AStrategyUnit* CurrentUnit = UnitRegistry->GetUnit(UnitId))
+	{
+		if (bSelected)
 		{
+			CurrentUnit->UnitSelected();
+
+		} else {
 
 			CurrentUnit->UnitDeselected();
 		}
+
+	} else if (CrowdSubsystem) {
+
+		// crowd units keep their selection, and are notified once they're promoted
+		CrowdSubsystem->SetUnitSelected(UnitId, bSelected);
 	}
+}
 
-	// clear the controlled units list
-	ControlledUnits.Empty();
+void AStrategyPlayerController::OnUnitPromoted(AStrategyUnit* Unit)
+{
+	const int32 UnitId = Unit->GetRegistryId();
+
+	// restore the selection on the new actor
+	if (ControlledUnits.Contains(UnitId))
+	{
+		Unit->UnitSelected();
+		MarkSelectionChanged();
+	}
 }
 
 void AStrategyPlayerController::DoDragScrollCommand()
@@ -528,140 +849,22 @@ void AStrategyPlayerController::DoMoveUnitsCommand()
 
 	}
 
-	// get the closest selected unit to the move goal. This will be our lead unit
-	AStrategyUnit* Closest = GetClosestSelectedUnitToLocation(CurrentMoveGoal);
-
-	// this will be set to true if any of the move requests fail
-	bool bInteractionFailed = false;
-
-	// process each unit in the controlled list
-	for (AStrategyUnit* CurrentUnit : ControlledUnits)
-	{
-		if (IsValid(CurrentUnit))
-		{
-
-			// stop the unit
-			CurrentUnit->StopMoving();
-
-			// move the lead unit to the goal, all other units to random navigable points around it
-			FVector MoveGoal = CurrentMoveGoal;
-
-			if (CurrentUnit != Closest)
-			{
-
-				UNavigationSystemV1::K2_GetRandomLocationInNavigableRadius(GetWorld(), CurrentMoveGoal, MoveGoal, InteractionRadius * 0.66f);
-			}
-
-			// subscribe to the unit's move completed delegate
-			CurrentUnit->OnMoveCompleted.AddDynamic(this, &AStrategyPlayerController::OnMoveCompleted);
-
-			// set up movement to the goal location
-			if (!CurrentUnit->MoveToLocation(MoveGoal, InteractionRadius * 0.66f))
-			{
-				// the move request failed, so flag it
-				bInteractionFailed = true;
-			}
-		}
+	FStrategyCommand Command(EStrategyCommandType::Move);
+	Command.Location = CurrentMoveGoal;
 
-	}
+	const bool bMoveSucceeded = SubmitCommand(Command);
 
 	// play the cursor feedback depending on whether our move succeeded or not
-	BP_CursorFeedback(CachedInteraction, !bInteractionFailed);
-
-}
-
-void AStrategyPlayerController::OnMoveCompleted(AStrategyUnit* MovedUnit)
-{
-	// is the unit valid?
-	if (IsValid(MovedUnit))
-	{
-		// unsubscribe from the delegate
-		MovedUnit->OnMoveCompleted.RemoveDynamic(this, &AStrategyPlayerController::OnMoveCompleted);
-		
-		// skip if interactions are locked
-		if (!bAllowInteraction)
-		{
-			return;
-		}
-
-		// disallow additional interactions until we reset
-		bAllowInteraction = false;
-
-		// is the unit close enough to the cached interaction location?
-		if(FVector::Dist2D(CachedInteraction, MovedUnit->GetActorLocation()) < InteractionRadius)
-		{
-
-			// do an overlap test to find nearby interactive objects
-			TArray<FOverlapResult> OutOverlaps;
-
-			FCollisionShape CollisionSphere;
-			CollisionSphere.SetSphere(InteractionRadius);
-
-			FCollisionObjectQueryParams ObjectParams;
-			ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
-			
-			FCollisionQueryParams QueryParams;
-
-			QueryParams.AddIgnoredActor(MovedUnit);
-
-			for(const AStrategyUnit* CurSelected : ControlledUnits)
-			{
-				QueryParams.AddIgnoredActor(CurSelected);
-			}
-
-			if (GetWorld()->OverlapMultiByObjectType(OutOverlaps, CachedInteraction, FQuat::Identity, ObjectParams, CollisionSphere, QueryParams))
-			{
-				for (const FOverlapResult& CurrentOverlap : OutOverlaps)
-				{
-					if (AStrategyUnit* CurrentUnit = Cast<AStrategyUnit>(CurrentOverlap.GetActor()))
-					{
-						CurrentUnit->Interact(MovedUnit);
-					}
-				}
-			}
-		}
-	}
+	BP_CursorFeedback(CachedInteraction, bMoveSucceeded);
 }
 
-AStrategyUnit* AStrategyPlayerController::GetClosestSelectedUnitToLocation(FVector TargetLocation)
+void AStrategyPlayerController::SetCameraZoom(float Zoom)
 {
-	// closest unit and distance
-	AStrategyUnit* OutUnit = nullptr;
-	float Closest = 0.0f;
-
-	// process each unit on the list
-	for (AStrategyUnit* CurrentUnit : ControlledUnits)
-	{
-		if (CurrentUnit != nullptr)
-		{
-			// have we selected a unit already?
-			if (OutUnit != nullptr)
-			{
-				// calculate the squared distance to the target location
-				float Dist = FVector::DistSquared2D(TargetLocation, CurrentUnit->GetActorLocation());
-
-				// is this unit closer?
-				if (Dist < Closest)
-				{
-					// update the closest unit and distance
-					OutUnit = CurrentUnit;
-					Closest = Dist;
-				}
-
-			} else {
-
-				// no previously selected unit, so use this one
-				OutUnit = CurrentUnit;
-
-				// initialize the closest distance
-				Closest = FVector::DistSquared2D(TargetLocation, CurrentUnit->GetActorLocation());
-			}
-		}
-		
-	}
+	// clamp to min/max zoom levels
+	CameraZoom = FMath::Clamp(Zoom, MinZoomLevel, MaxZoomLevel);
 
-	// return the selected unit
-	return OutUnit;
+	// update the pawn's camera
+	ControlledPawn->SetZoomModifier(CameraZoom);
 }
 
 FVector2D AStrategyPlayerController::GetMouseLocation()
@@ -680,10 +883,13 @@ FVector2D AStrategyPlayerController::GetMouseLocation()
 
 bool AStrategyPlayerController::GetLocationUnderCursor(FVector& Location)
 {
-	// trace the visibility channel at the cursor location
+	// trace the selection channel at the cursor location, reusing this frame's trace if there is one
 	FHitResult OutHit;
 
-	GetHitResultUnderCursorByChannel(SelectionTraceChannel, true, OutHit);
+	if (UCursorCacheSubsystem* CursorCache = UCursorCacheSubsystem::Get(this))
+	{
+		CursorCache->GetCursorHit(UEngineTypes::ConvertToCollisionChannel(SelectionTraceChannel), OutHit);
+	}
 
 	// if there was a blocking hit, return the hit location
 	if (OutHit.bBlockingHit)
@@ -719,7 +925,3 @@ FVector AStrategyPlayerController::ProjectTouchPointToWorldSpace()
 	return FVector::ZeroVector;
 }
 
-void AStrategyPlayerController::ResetInteraction()
-{
-	bAllowInteraction = true;
-}
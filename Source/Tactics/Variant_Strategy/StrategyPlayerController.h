@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
+#include "StrategyUnitSet.h"
+#include "StrategyFormation.h"
 #include "StrategyPlayerController.generated.h"
 
 class AStrategyPawn;
@@ -13,6 +15,12 @@ struct FInputActionValue;
 class AStrategyHUD;
 class AStrategyNPC;
 class UInputAction;
+class UStrategyUnitRegistry;
+class UStrategyCrowdSubsystem;
+class UStrategyReplaySubsystem;
+class UStrategyAICommander;
+class UStrategyOrderExecutor;
+struct FStrategyCommand;
 
 /** Enum to determine the last used input type */
 UENUM(BlueprintType)
@@ -26,6 +34,7 @@ enum EStrategyInputMode : uint8
  *  Player Controller for a top-down strategy game.
  *  Handles unit selection and commands.
  *  Implements both mouse and touch controls.
+ *  Input is resolved into strategy commands, which are applied in one place so they can be recorded and replayed.
  */
 UCLASS(abstract)
 class AStrategyPlayerController : public APlayerController
@@ -58,9 +67,6 @@ protected:
 	/** If true, double-tap touch select all mode is active */
 	bool bDoubleTapActive = false;
 
-	/** If true, allow the player to interact with game objects */
-	bool bAllowInteraction = true;
-
 	/** Input Action for moving the camera */
 	UPROPERTY(EditAnywhere, Category="Input")
 	UInputAction* MoveCameraAction;
@@ -109,6 +115,17 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Input")
 	UInputAction* TouchDoubleTapAction;
 
+	/** Input Actions for the control group keys, one per group */
+	UPROPERTY(EditAnywhere, Category="Input", meta = (EditFixedSize))
+	TArray<UInputAction*> ControlGroupActions;
+
+	/** Input Action for the modifier that saves a control group instead of recalling it */
+	UPROPERTY(EditAnywhere, Category="Input")
+	UInputAction* ControlGroupModifierAction;
+
+	/** If true, control group keys save the current selection */
+	bool bControlGroupModifier = false;
+
 	/** Max distance to look for nearby units when doing a click or touch interaction */
 	UPROPERTY(EditAnywhere, Category="Input", meta = (ClampMin = 0, ClampMax = 10000, Units = "cm"))
 	float InteractionRadius = 250.0f;
@@ -160,6 +177,14 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Camera", meta = (ClampMin = 0, ClampMax = 10000))
 	float DragMultiplier = 0.1f;
 
+	/** Slot layout used for group move orders */
+	UPROPERTY(EditAnywhere, Category = "Formation")
+	EStrategyFormationShape FormationShape = EStrategyFormationShape::Box;
+
+	/** Distance between formation slots */
+	UPROPERTY(EditAnywhere, Category = "Formation", meta = (ClampMin = 0, ClampMax = 1000, Units = "cm"))
+	float FormationSpacing = 150.0f;
+
 	/** Trace channel to use for selection trace checks */
 	UPROPERTY(EditAnywhere, Category = "Selection")
 	TEnumAsByte<ETraceTypeQuery> SelectionTraceChannel;
@@ -167,8 +192,47 @@ protected:
 	/** Currently selected unit */
 	AStrategyUnit* TargetUnit = nullptr;
 
-	/** Currently selected unit list */
-	TArray<AStrategyUnit*> ControlledUnits;
+	/** Unit registry for this world */
+	UPROPERTY(Transient)
+	TObjectPtr<UStrategyUnitRegistry> UnitRegistry;
+
+	/** Crowd of units outside the camera view */
+	UPROPERTY(Transient)
+	TObjectPtr<UStrategyCrowdSubsystem> CrowdSubsystem;
+
+	/** Command recorder and replayer */
+	UPROPERTY(Transient)
+	TObjectPtr<UStrategyReplaySubsystem> ReplaySubsystem;
+
+	/** Computer opponent, whose units can't be selected */
+	UPROPERTY(Transient)
+	TObjectPtr<UStrategyAICommander> AICommander;
+
+	/** Applies selection and move commands, and follows the player's move orders */
+	UPROPERTY(Transient)
+	TObjectPtr<UStrategyOrderExecutor> OrderExecutor;
+
+	/** Team this player controls, stamped on its commands */
+	uint8 PlayerTeamId = 0;
+
+	/** Currently selected units */
+	FStrategyUnitSet ControlledUnits;
+
+	/** Number of control groups */
+	static constexpr int32 NumControlGroups = 9;
+
+	/** Saved control groups */
+	FStrategyUnitSet ControlGroups[NumControlGroups];
+
+	/** Selected units resolved to pointers, rebuilt when the selection changes */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<AStrategyUnit>> SelectedUnitsList;
+
+	/** If true, the selected units list needs to be rebuilt */
+	bool bSelectedUnitsListDirty = false;
+
+	/** Incremented every time the selection changes */
+	uint32 SelectionSerial = 0;
 
 public:
 
@@ -181,13 +245,33 @@ public:
 	/** Pawn initialization */
 	virtual void OnPossess(APawn* InPawn);
 
+protected:
+
+	/** Subscribes to the unit registry and the crowd */
+	virtual void BeginPlay() override;
+
+	/** Applies replayed commands before the rest of the frame runs */
+	virtual void PlayerTick(float DeltaTime) override;
+
 public:
 
-	/** Updates selected units from the HUD's drag select box */
+	/** Updates selected units from the HUD's drag select box. Only units entering or leaving the selection are notified */
 	void DragSelectUnits(const TArray<AStrategyUnit*>& Units);
 
-	/** Passes the list of selected units */
-	const TArray<AStrategyUnit*>& GetSelectedUnits();
+	/** Finds the units inside a screen space rectangle through the unit registry */
+	void GetUnitsInScreenRect(const FVector2D& ScreenStart, const FVector2D& ScreenEnd, TArray<AStrategyUnit*>& OutUnits) const;
+
+	/** Passes the list of selected units, in registry id order */
+	const TArray<TObjectPtr<AStrategyUnit>>& GetSelectedUnits();
+
+	/** Returns the selected unit ids, including crowd units */
+	const FStrategyUnitSet& GetSelectedUnitIds() const { return ControlledUnits; }
+
+	/** Returns a number that changes every time the selection changes */
+	uint32 GetSelectionSerial() const { return SelectionSerial; }
+
+	/** Applies a strategy command. Returns false if it had no effect, or a move couldn't be started */
+	bool ExecuteCommand(const FStrategyCommand& Command);
 
 protected:
 
@@ -200,6 +284,12 @@ protected:
 	/** Resets the camera to its initial value */
 	void ResetCamera(const FInputActionValue& Value);
 
+	/** Presses or releases the control group modifier key */
+	void ControlGroupModifier(const FInputActionValue& Value);
+
+	/** Control group key pressed */
+	void ControlGroupPressed(const FInputActionValue& Value, int32 GroupIndex);
+
 	/** Start a select and hold input */
 	void SelectHoldStarted(const FInputActionValue& Value);
 	
@@ -221,9 +311,6 @@ protected:
 	/** Interaction hold input triggered */
 	void InteractHoldTriggered(const FInputActionValue& Value);
 
-	/** Interaction click input started */
-	void InteractClickStarted(const FInputActionValue& Value);
-
 	/** Interaction click input completed */
 	void InteractClickCompleted(const FInputActionValue& Value);
 
@@ -248,6 +335,9 @@ protected:
 	/** Touch primary finger double tap triggered */
 	void TouchDoubleTap(const FInputActionValue& Value);
 
+	/** Records a command resolved from player input and applies it. Live input is ignored while replaying */
+	bool SubmitCommand(const FStrategyCommand& Command);
+
 	/** Attempt to select or deselect units at the cached location */
 	void DoSelectionCommand();
 
@@ -257,18 +347,38 @@ protected:
 	/** Deselect all controlled units */
 	void DoDeselectAllCommand();
 
+	/** Saves the current selection into a control group */
+	void DoSaveControlGroupCommand(int32 GroupIndex);
+
+	/** Replaces the current selection with a control group */
+	void DoRecallControlGroupCommand(int32 GroupIndex);
+
+	/** Replaces the current selection, notifying only the units that were added or removed */
+	void SetSelection(const FStrategyUnitSet& NewSelection);
+
+	/** Returns false for units the player isn't allowed to select, such as the AI commander's */
+	bool CanSelectUnit(int32 UnitId) const;
+
+	/** Called when a unit leaves the registry */
+	void OnUnitUnregistered(int32 UnitId);
+
+	/** Flags the selected units list for a rebuild and bumps the selection serial */
+	void MarkSelectionChanged();
+
+	/** Tells a unit it was selected or deselected, whether it's an actor or a crowd unit */
+	void NotifyUnitSelection(int32 UnitId, bool bSelected);
+
+	/** Called when a crowd unit is promoted to an actor */
+	void OnUnitPromoted(AStrategyUnit* Unit);
+
 	/** Drag scroll the camera */
 	void DoDragScrollCommand();
 
-	/** Move all selected units */
+	/** Move all selected units to the cached interaction or selection location */
 	void DoMoveUnitsCommand();
 
-	/** Called when a unit move is completed */
-	UFUNCTION()
-	void OnMoveCompleted(AStrategyUnit* MovedUnit);
-
-	/** Sorts all controlled units based on their distance to the provided world location */
-	AStrategyUnit* GetClosestSelectedUnitToLocation(FVector TargetLocation);
+	/** Sets the camera zoom level, clamped to the allowed range */
+	void SetCameraZoom(float Zoom);
 
 	/** Calculates and returns the current mouse location */
 	FVector2D GetMouseLocation();
@@ -282,7 +392,4 @@ protected:
 	/** Spawns the positive cursor effect */
 	UFUNCTION(BlueprintImplementableEvent, Category="Cursor", meta = (DisplayName="Cursor Feedback"))
 	void BP_CursorFeedback(FVector Location, bool bPositive);
-
-	/** Resets the interaction flag */
-	void ResetInteraction();
 };
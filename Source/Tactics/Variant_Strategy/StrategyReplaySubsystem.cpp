@@ -0,0 +1,333 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyReplaySubsystem.h"
+#include "StrategyGameMode.h"
+#include "StrategyUnitRegistry.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "RenderCore.h"
+#include "Tactics.h"
+
+/** Camera movement below this isn't worth a command */
+static constexpr float CameraLocationTolerance = 0.1f;
+
+uint32 UStrategyReplaySubsystem::GetFrame() const
+{
+	return static_cast<uint32>(GFrameCounter - StartFrame);
+}
+
+void UStrategyReplaySubsystem::RecordCommand(const FStrategyCommand& Command)
+{
+	if (!IsRecording())
+	{
+		return;
+	}
+
+	FStrategyCommand& Recorded = Stream.Commands.Add_GetRef(Command);
+	Recorded.Frame = GetFrame();
+}
+
+void UStrategyReplaySubsystem::ApplyDueCommands(uint8 TeamId, TFunctionRef<bool(const FStrategyCommand&)> Execute)
+{
+	if (!IsReplaying())
+	{
+		return;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyReplaySubsystem_ApplyDueCommands);
+
+	const uint32 Frame = GetFrame();
+	int32& NextCommand = NextCommands.FindOrAdd(TeamId);
+
+	// the player and the commanders apply their commands at different points of the frame, so they walk the stream separately
+	while (Stream.Commands.IsValidIndex(NextCommand) && Stream.Commands[NextCommand].Frame <= Frame)
+	{
+		if (Stream.Commands[NextCommand].TeamId == TeamId)
+		{
+			Execute(Stream.Commands[NextCommand]);
+			++NumAppliedCommands;
+		}
+
+		++NextCommand;
+	}
+}
+
+bool UStrategyReplaySubsystem::SaveRecording() const
+{
+	if (!IsRecording())
+	{
+		return false;
+	}
+
+	if (!Stream.SaveToFile(StreamFileName))
+	{
+		UE_LOG(LogTactics, Error, TEXT("Failed to write the strategy command stream to %s"), *StreamFileName);
+		return false;
+	}
+
+	UE_LOG(LogTactics, Display, TEXT("Strategy command stream written to %s: %d commands over %u frames"), *StreamFileName, Stream.Commands.Num(), GetFrame());
+	return true;
+}
+
+void UStrategyReplaySubsystem::DumpStats() const
+{
+	const int32 NumUnits = UnitRegistry ? UnitRegistry->GetNumUnits() : 0;
+
+	switch (Mode)
+	{
+	case EStrategyReplayMode::Recording:
+		UE_LOG(LogTactics, Display, TEXT("Strategy recording: %d commands over %u frames, seed %d, timestep %.4f s, %d units"),
+			Stream.Commands.Num(), GetFrame(), Stream.Seed, Stream.FixedDeltaTime, NumUnits);
+		break;
+
+	case EStrategyReplayMode::Replaying:
+		UE_LOG(LogTactics, Display, TEXT("=== STRATEGY REPLAY ==="));
+		UE_LOG(LogTactics, Display, TEXT("%s on %s: %d of %d commands applied, frame %u, seed %d, timestep %.4f s, %d units. %.2f s wall time"),
+			*StreamFileName, *Stream.MapName, NumAppliedCommands, Stream.Commands.Num(), GetFrame(), Stream.Seed, Stream.FixedDeltaTime, NumUnits, FPlatformTime::Seconds() - StartTime);
+		UE_LOG(LogTactics, Display, TEXT("Frame: mean %.2f ms, p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms"),
+			FrameStats.GetMean(), FrameStats.GetPercentile(50.0f), FrameStats.GetPercentile(95.0f), FrameStats.GetPercentile(99.0f), FrameStats.MaxMs);
+		UE_LOG(LogTactics, Display, TEXT("Game thread: mean %.2f ms, p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms"),
+			GameThreadStats.GetMean(), GameThreadStats.GetPercentile(50.0f), GameThreadStats.GetPercentile(95.0f), GameThreadStats.GetPercentile(99.0f), GameThreadStats.MaxMs);
+		break;
+
+	default:
+		UE_LOG(LogTactics, Display, TEXT("Strategy replay idle. Start with -StrategyRecord or -StrategyReplay=File"));
+		break;
+	}
+}
+
+void UStrategyReplaySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyReplaySubsystem_Tick);
+
+	if (IsRecording())
+	{
+		RecordCamera();
+		return;
+	}
+
+	if (!IsReplaying() || bReplayFinished)
+	{
+		return;
+	}
+
+	// the first tick has no previous frame to measure
+	const double Now = FPlatformTime::Seconds();
+
+	if (LastTickTime > 0.0)
+	{
+		FrameStats.AddSample(static_cast<float>((Now - LastTickTime) * 1000.0));
+		GameThreadStats.AddSample(static_cast<float>(FPlatformTime::ToMilliseconds(GGameThreadTime)));
+	}
+
+	LastTickTime = Now;
+
+	// keep going for a while after the last command so its effects are measured too
+	const uint32 LastFrame = Stream.Commands.Num() > 0 ? Stream.Commands.Last().Frame : 0;
+
+	if (GetFrame() < LastFrame + TailFrames)
+	{
+		return;
+	}
+
+	bReplayFinished = true;
+	DumpStats();
+
+	// the replay no longer needs to step the same way as the recording
+	RestoreTimeStep();
+
+	// headless runs exit once the replay is done
+	if (FParse::Param(FCommandLine::Get(), TEXT("StrategyReplayExit")))
+	{
+		FPlatformMisc::RequestExitWithStatus(false, 0);
+	}
+}
+
+TStatId UStrategyReplaySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyReplaySubsystem, STATGROUP_Tickables);
+}
+
+void UStrategyReplaySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// commands only make sense in the strategy game mode
+	const AStrategyGameMode* GameMode = Cast<AStrategyGameMode>(InWorld.GetAuthGameMode());
+
+	if (!GameMode)
+	{
+		Mode = EStrategyReplayMode::None;
+		return;
+	}
+
+	PlayerTeamId = GameMode->GetPlayerTeamId();
+
+	UnitRegistry = InWorld.GetSubsystem<UStrategyUnitRegistry>();
+
+	// frames are counted from here in both modes
+	StartFrame = GFrameCounter;
+	StartTime = FPlatformTime::Seconds();
+
+	if (IsReplaying())
+	{
+		FParse::Value(FCommandLine::Get(), TEXT("StrategyReplayTail="), TailFrames);
+
+		const FString MapName = UWorld::RemovePIEPrefix(InWorld.GetMapName());
+
+		if (MapName != Stream.MapName)
+		{
+			UE_LOG(LogTactics, Warning, TEXT("Strategy command stream was recorded on %s, but is replaying on %s"), *Stream.MapName, *MapName);
+		}
+
+		UE_LOG(LogTactics, Display, TEXT("Replaying %d strategy commands from %s"), Stream.Commands.Num(), *StreamFileName);
+
+	} else if (IsRecording()) {
+
+		Stream.MapName = UWorld::RemovePIEPrefix(InWorld.GetMapName());
+
+		UE_LOG(LogTactics, Display, TEXT("Recording strategy commands to %s"), *StreamFileName);
+	}
+}
+
+void UStrategyReplaySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const UWorld* World = GetWorld();
+
+	if (!World || !World->IsGameWorld())
+	{
+		return;
+	}
+
+	FString FileName;
+
+	if (FParse::Value(FCommandLine::Get(), TEXT("StrategyReplay="), FileName))
+	{
+		StreamFileName = GetStreamPath(FileName);
+
+		if (!Stream.LoadFromFile(StreamFileName))
+		{
+			UE_LOG(LogTactics, Error, TEXT("Failed to read a strategy command stream from %s"), *StreamFileName);
+			return;
+		}
+
+		Mode = EStrategyReplayMode::Replaying;
+
+	} else if (FParse::Value(FCommandLine::Get(), TEXT("StrategyRecord="), FileName) || FParse::Param(FCommandLine::Get(), TEXT("StrategyRecord"))) {
+
+		StreamFileName = GetStreamPath(FileName.IsEmpty() ? FString::Printf(TEXT("StrategyCommands-%s.bin"), *FDateTime::Now().ToString()) : FileName);
+
+		FParse::Value(FCommandLine::Get(), TEXT("StrategySeed="), Stream.Seed);
+
+		float FixedDeltaTime = 0.0f;
+
+		if (FParse::Value(FCommandLine::Get(), TEXT("StrategyFixedStep="), FixedDeltaTime) && FixedDeltaTime > 0.0f)
+		{
+			Stream.FixedDeltaTime = FixedDeltaTime;
+		}
+
+		Mode = EStrategyReplayMode::Recording;
+
+	} else {
+
+		return;
+	}
+
+	// seed and fix the timestep before anything spawns, so both runs start from the same state and step the same way
+	FMath::RandInit(Stream.Seed);
+	FMath::SRandInit(Stream.Seed);
+
+	bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	bFixedTimeStepSet = true;
+
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(Stream.FixedDeltaTime);
+}
+
+void UStrategyReplaySubsystem::Deinitialize()
+{
+	// keep what was recorded when play ends
+	SaveRecording();
+
+	RestoreTimeStep();
+
+	Mode = EStrategyReplayMode::None;
+
+	Super::Deinitialize();
+}
+
+void UStrategyReplaySubsystem::RestoreTimeStep()
+{
+	if (bFixedTimeStepSet)
+	{
+		bFixedTimeStepSet = false;
+
+		FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+	}
+}
+
+void UStrategyReplaySubsystem::RecordCamera()
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	const APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+
+	if (!Pawn)
+	{
+		return;
+	}
+
+	// the camera moves through pawn movement and drag scrolling, so record where it ended up
+	const FVector CameraLocation = Pawn->GetActorLocation();
+
+	if (!bHasCameraLocation || !CameraLocation.Equals(LastCameraLocation, CameraLocationTolerance))
+	{
+		FStrategyCommand Command(EStrategyCommandType::CameraLocation);
+		Command.TeamId = PlayerTeamId;
+		Command.Location = CameraLocation;
+
+		RecordCommand(Command);
+
+		LastCameraLocation = CameraLocation;
+		bHasCameraLocation = true;
+	}
+}
+
+FString UStrategyReplaySubsystem::GetStreamPath(const FString& FileName)
+{
+	return FPaths::IsRelative(FileName) ? FPaths::ProjectSavedDir() / TEXT("Replays") / FileName : FileName;
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ReplaySaveCommand(
+	TEXT("Tactics.Replay.Save"),
+	TEXT("Writes the strategy commands recorded so far. Recording is started with -StrategyRecord[=File]."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UStrategyReplaySubsystem* Replay = World ? World->GetSubsystem<UStrategyReplaySubsystem>() : nullptr)
+		{
+			Replay->SaveRecording();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs ReplayDumpCommand(
+	TEXT("Tactics.Replay.Dump"),
+	TEXT("Logs the strategy recording or replay stats."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UStrategyReplaySubsystem* Replay = World ? World->GetSubsystem<UStrategyReplaySubsystem>() : nullptr)
+		{
+			Replay->DumpStats();
+		}
+	}));
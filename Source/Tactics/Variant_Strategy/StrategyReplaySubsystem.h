@@ -0,0 +1,134 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyCommand.h"
+#include "TimingStats.h"
+#include "StrategyReplaySubsystem.generated.h"
+
+class UStrategyUnitRegistry;
+
+/** What the replay subsystem is doing with the command stream */
+enum class EStrategyReplayMode : uint8
+{
+	None,
+	Recording,
+	Replaying
+};
+
+/**
+ *  Records the commands of the strategy player and the AI commanders into a frame stamped stream, and replays them.
+ *  Both modes are started from the command line, so the random seed and fixed timestep are set before anything spawns:
+ *  -StrategyRecord[=File] records the session, with an optional -StrategySeed= and -StrategyFixedStep=.
+ *  -StrategyReplay=File replays a recording on the same map, ignoring live input. Add -StrategyReplayExit to quit
+ *  once it's done, which together with -nullrhi makes a repeatable headless benchmark.
+ *  Relative file names are in Saved/Replays.
+ */
+UCLASS()
+class UStrategyReplaySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns true while recording */
+	bool IsRecording() const { return Mode == EStrategyReplayMode::Recording; }
+
+	/** Returns true while replaying */
+	bool IsReplaying() const { return Mode == EStrategyReplayMode::Replaying; }
+
+	/** Returns the current frame, counted from the start of play */
+	uint32 GetFrame() const;
+
+	/** Stamps a command with the current frame and adds it to the recording */
+	void RecordCommand(const FStrategyCommand& Command);
+
+	/** Applies the recorded commands of a team that are due this frame. Each team keeps its own place in the stream */
+	void ApplyDueCommands(uint8 TeamId, TFunctionRef<bool(const FStrategyCommand&)> Execute);
+
+	/** Writes the recording to its file. Returns false if it couldn't be written */
+	bool SaveRecording() const;
+
+	/** Logs the recording or replay stats */
+	void DumpStats() const;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// UWorldSubsystem interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	// USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+protected:
+
+	/** Unit registry for this world */
+	UPROPERTY(Transient)
+	TObjectPtr<UStrategyUnitRegistry> UnitRegistry;
+
+	/** Current mode */
+	EStrategyReplayMode Mode = EStrategyReplayMode::None;
+
+	/** Stream being recorded or replayed */
+	FStrategyCommandStream Stream;
+
+	/** File the stream is saved to or loaded from */
+	FString StreamFileName;
+
+	/** Engine frame play started on */
+	uint64 StartFrame = 0;
+
+	/** Index of the next command to replay, by team */
+	TMap<uint8, int32> NextCommands;
+
+	/** Number of commands replayed */
+	int32 NumAppliedCommands = 0;
+
+	/** Frames to keep running after the last replayed command, so its effects are measured too */
+	int32 TailFrames = 300;
+
+	/** If true, the replay is over and its stats were reported */
+	bool bReplayFinished = false;
+
+	/** Team of the local player, for the camera commands */
+	uint8 PlayerTeamId = 0;
+
+	/** Last camera location written to the recording */
+	FVector LastCameraLocation = FVector::ZeroVector;
+
+	/** If true, the camera location was recorded at least once */
+	bool bHasCameraLocation = false;
+
+	/** Wall clock time of the previous tick, for the frame time stats */
+	double LastTickTime = 0.0;
+
+	/** Time when play started */
+	double StartTime = 0.0;
+
+	/** Wall clock frame times */
+	FTimingStats FrameStats;
+
+	/** Game thread frame times */
+	FTimingStats GameThreadStats;
+
+	/** If true, we fixed the engine timestep and have to put it back */
+	bool bFixedTimeStepSet = false;
+
+	/** Engine timestep settings from before recording or replaying */
+	bool bPreviousUseFixedTimeStep = false;
+	double PreviousFixedDeltaTime = 0.0;
+
+	/** Puts back the engine timestep settings we replaced, if any */
+	void RestoreTimeStep();
+
+	/** Adds a command for the camera location whenever the camera moved */
+	void RecordCamera();
+
+	/** Resolves a stream file name from the command line into a full path */
+	static FString GetStreamPath(const FString& FileName);
+};
@@ -6,7 +6,14 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Components/SphereComponent.h"
+#include "Components/SkeletalMeshComponent.h"
 #include "Navigation/PathFollowingComponent.h"
+#include "StrategyUnitRegistry.h"
+#include "NavQueryBroker.h"
+#include "StrategyPathCache.h"
+
+/** Distance a settling formation follower has to close on its slot to count as making progress */
+static constexpr float FormationMinProgress = 10.0f;
 
 AStrategyUnit::AStrategyUnit()
 {
@@ -39,6 +46,36 @@ AStrategyUnit::AStrategyUnit()
 	GetCharacterMovement()->SetFixedBrakingDistance(true);
 }
 
+void AStrategyUnit::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// remember the mesh's animation tick option, so it can be restored at full rate
+	DefaultAnimTickOption = GetMesh()->VisibilityBasedAnimTickOption;
+
+	// add ourselves to the unit registry
+	if (UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>())
+	{
+		RegistryId = Registry->RegisterUnit(this);
+	}
+}
+
+void AStrategyUnit::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// drop any path query still in flight
+	CancelPathQuery();
+
+	// remove ourselves from the unit registry
+	if (UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>())
+	{
+		Registry->UnregisterUnit(this);
+	}
+
+	RegistryId = INDEX_NONE;
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AStrategyUnit::NotifyControllerChanged()
 {
 	// validate and save a copy of the AI controller reference
@@ -55,20 +92,72 @@ void AStrategyUnit::NotifyControllerChanged()
 	}
 }
 
+void AStrategyUnit::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// steer towards our formation slot
+	if (bFollowingFormation)
+	{
+		UpdateFormationMove(DeltaSeconds);
+	}
+}
+
 void AStrategyUnit::StopMoving()
 {
 	// use the character movement component to stop movement
 	GetCharacterMovement()->StopMovementImmediately();
+
+	// abort any pending path query, path following and formation moves
+	CancelPathQuery();
+
+	if (AIController)
+	{
+		AIController->StopMovement();
+	}
+
+	bFollowingFormation = false;
+	FormationLeader.Reset();
+}
+
+void AStrategyUnit::SetSignificance(EStrategyUnitSignificance Tier, float TickInterval)
+{
+	if (Tier == Significance)
+	{
+		return;
+	}
+
+	Significance = Tier;
+
+	// throttle the actor, its movement and its animation together
+	SetActorTickInterval(TickInterval);
+	GetCharacterMovement()->SetComponentTickInterval(TickInterval);
+	GetMesh()->SetComponentTickInterval(TickInterval);
+
+	// offscreen units don't need their pose updated until they're rendered again
+	GetMesh()->VisibilityBasedAnimTickOption = (Tier == EStrategyUnitSignificance::Offscreen) ? EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered : DefaultAnimTickOption;
+}
+
+void AStrategyUnit::RestoreFullRate()
+{
+	SetSignificance(EStrategyUnitSignificance::Full, 0.0f);
 }
 
 void AStrategyUnit::UnitSelected()
 {
+	bSelected = true;
+
+	// selected units tick at full rate wherever they are
+	RestoreFullRate();
+
 	// pass control to BP
 	BP_UnitSelected();
 }
 
 void AStrategyUnit::UnitDeselected()
 {
+	bSelected = false;
+
 	// pass control to BP
 	BP_UnitDeselected();
 }
@@ -78,6 +167,10 @@ void AStrategyUnit::Interact(AStrategyUnit* Interactor)
 	// ensure the interactor is valid
 	if (IsValid(Interactor))
 	{
+		// play the interaction at full rate
+		RestoreFullRate();
+		Interactor->RestoreFullRate();
+
 		// rotate towards the actor we're interacting with
 		SetActorRotation(UKismetMathLibrary::FindLookAtRotation(GetActorLocation(), Interactor->GetActorLocation()));
 
@@ -92,8 +185,61 @@ void AStrategyUnit::Interact(AStrategyUnit* Interactor)
 
 bool AStrategyUnit::MoveToLocation(const FVector& Location, float AcceptanceRadius)
 {
-	// ensure we have a valid AI Controller
-	if (AIController)
+	// ensure we have a valid AI Controller and query broker
+	UNavQueryBroker* Broker = GetWorld()->GetSubsystem<UNavQueryBroker>();
+
+	if (AIController && Broker)
+	{
+		// already at goal. Return true and call the move completed delegate
+		if (FVector::Dist2D(GetActorLocation(), Location) <= AcceptanceRadius)
+		{
+			OnMoveCompleted.Broadcast(this);
+			return true;
+		}
+
+		// replace any previous path query
+		CancelPathQuery();
+
+		MoveGoal = Location;
+		MoveAcceptanceRadius = AcceptanceRadius;
+
+		// ordered units tick at full rate wherever they are
+		RestoreFullRate();
+
+		// queue the path query, the move request is made once the path is ready
+		FNavQueryPathDelegate Callback = FNavQueryPathDelegate::CreateUObject(this, &AStrategyUnit::OnMovePathFound, Location, AcceptanceRadius);
+
+		// long moves go through the cluster graph and only refine short legs on the navmesh
+		UStrategyPathCache* PathCache = GetWorld()->GetSubsystem<UStrategyPathCache>();
+		bPendingPathRouted = PathCache && PathCache->IsLongMove(GetActorLocation(), Location);
+
+		if (bPendingPathRouted)
+		{
+			PendingPathQueryId = PathCache->RequestPath(GetActorLocation(), Location, this, AIController->GetDefaultNavigationFilterClass(), ENavQueryPriority::High, MoveTemp(Callback));
+
+		} else {
+
+			PendingPathQueryId = Broker->RequestPath(GetActorLocation(), Location, this, AIController->GetDefaultNavigationFilterClass(), ENavQueryPriority::High, MoveTemp(Callback));
+		}
+
+		return true;
+	}
+
+	// the move could not be completed
+	return false;
+}
+
+void AStrategyUnit::OnMovePathFound(uint32 QueryId, bool bSuccess, FNavPathSharedPtr Path, FVector Location, float AcceptanceRadius)
+{
+	// ignore superseded queries
+	if (QueryId != PendingPathQueryId)
+	{
+		return;
+	}
+
+	PendingPathQueryId = INVALID_NAVQUERYID;
+
+	if (bSuccess && AIController)
 	{
 		// set up the AI Move Request
 		FAIMoveRequest MoveReq;
@@ -102,45 +248,151 @@ bool AStrategyUnit::MoveToLocation(const FVector& Location, float AcceptanceRadi
 		MoveReq.SetAcceptanceRadius(AcceptanceRadius);
 		MoveReq.SetAllowPartialPath(true);
 		MoveReq.SetUsePathfinding(true);
-		MoveReq.SetProjectGoalLocation(true);
-		MoveReq.SetRequireNavigableEndLocation(true);
 		MoveReq.SetNavigationFilter(AIController->GetDefaultNavigationFilterClass());
 		MoveReq.SetCanStrafe(false);
 
-		// request a move to the AI Controller
-		FNavPathSharedPtr FollowedPath;
-		const FPathFollowingRequestResult ResultData = AIController->MoveTo(MoveReq, &FollowedPath);
-		
-		// check the move result
-		switch (ResultData.Code)
+		// follow the path we were given
+		if (AIController->RequestMove(MoveReq, Path).IsValid())
 		{
-			// failed. Return false
-			case EPathFollowingRequestResult::Failed:
-
-				return false;
-				break;
+			return;
+		}
+	}
 
-			// already at goal. Return true and call the move completed delegate
-			case EPathFollowingRequestResult::AlreadyAtGoal:
+	// no path, so the move is over
+	OnMoveCompleted.Broadcast(this);
+}
 
-				OnMoveCompleted.Broadcast(this);
-				return true;
-				break;
+void AStrategyUnit::CancelPathQuery()
+{
+	if (PendingPathQueryId != INVALID_NAVQUERYID)
+	{
+		if (bPendingPathRouted)
+		{
+			if (UStrategyPathCache* PathCache = GetWorld()->GetSubsystem<UStrategyPathCache>())
+			{
+				PathCache->CancelRequest(PendingPathQueryId);
+			}
 
-			// move successfully scheduled. Return true
-			case EPathFollowingRequestResult::RequestSuccessful:
+		} else if (UNavQueryBroker* Broker = GetWorld()->GetSubsystem<UNavQueryBroker>()) {
 
-				return true;
-				break;
+			Broker->CancelQuery(PendingPathQueryId);
 		}
+
+		PendingPathQueryId = INVALID_NAVQUERYID;
+	}
+}
+
+void AStrategyUnit::FollowFormation(AStrategyUnit* Leader, const FVector& Offset, const FVector& Slot, float AcceptanceRadius)
+{
+	// save the formation data, the movement happens on tick
+	FormationLeader = Leader;
+	FormationOffset = Offset;
+	FormationSlot = Slot;
+	FormationAcceptanceRadius = AcceptanceRadius;
+	FormationBestDistance = TNumericLimits<float>::Max();
+	FormationStuckTimer = 0.0f;
+	bFollowingFormation = true;
+
+	// ordered units tick at full rate wherever they are
+	RestoreFullRate();
+}
+
+bool AStrategyUnit::IsFollowingPath() const
+{
+	return PendingPathQueryId != INVALID_NAVQUERYID || (AIController && AIController->GetMoveStatus() == EPathFollowingStatus::Moving);
+}
+
+bool AStrategyUnit::GetMoveGoal(FVector& OutGoal, float& OutAcceptanceRadius) const
+{
+	// formation followers head for their slot
+	if (bFollowingFormation)
+	{
+		OutGoal = FormationSlot;
+		OutAcceptanceRadius = FormationAcceptanceRadius;
+		return true;
+	}
+
+	if (IsFollowingPath())
+	{
+		OutGoal = MoveGoal;
+		OutAcceptanceRadius = MoveAcceptanceRadius;
+		return true;
 	}
 
-	// the move could not be completed
 	return false;
 }
 
+void AStrategyUnit::UpdateFormationMove(float DeltaSeconds)
+{
+	// track the leader's offset while it's still moving, then settle on the final slot
+	const AStrategyUnit* Leader = FormationLeader.Get();
+	const bool bLeaderMoving = Leader && Leader->IsFollowingPath();
+
+	const FVector Target = bLeaderMoving ? Leader->GetActorLocation() + FormationOffset : FormationSlot;
+
+	FVector ToTarget = Target - GetActorLocation();
+	ToTarget.Z = 0.0f;
+
+	const float Distance = ToTarget.Size();
+
+	// have we arrived at the final slot?
+	if (!bLeaderMoving && Distance < FormationAcceptanceRadius)
+	{
+		bFollowingFormation = false;
+		FormationLeader.Reset();
+
+		// call the delegate
+		OnMoveCompleted.Broadcast(this);
+		return;
+	}
+
+	// the slot is fixed once the leader stops, so a follower that stops closing in on it is blocked
+	if (bLeaderMoving)
+	{
+		FormationBestDistance = TNumericLimits<float>::Max();
+		FormationStuckTimer = 0.0f;
+
+	} else if (Distance < FormationBestDistance - FormationMinProgress) {
+
+		FormationBestDistance = Distance;
+		FormationStuckTimer = 0.0f;
+
+	} else {
+
+		FormationStuckTimer += DeltaSeconds;
+	}
+
+	if (FormationStuckTimer > FormationStuckTime)
+	{
+		bFollowingFormation = false;
+		FormationLeader.Reset();
+
+		// path around whatever is in the way. The path move reports completion when it ends, even if it fails
+		if (!MoveToLocation(FormationSlot, FormationAcceptanceRadius))
+		{
+			OnMoveCompleted.Broadcast(this);
+		}
+
+		return;
+	}
+
+	if (Distance > UE_KINDA_SMALL_NUMBER)
+	{
+		// slow down as we get close so we don't overshoot the slot
+		const float Scale = FormationSlowdownDistance > 0.0f ? FMath::Clamp(Distance / FormationSlowdownDistance, 0.1f, 1.0f) : 1.0f;
+
+		AddMovementInput(ToTarget / Distance, Scale);
+	}
+}
+
 void AStrategyUnit::OnMoveFinished(FAIRequestID RequestID, const FPathFollowingResult& Result)
 {
+	// routed paths don't repath on their own, so ask the path cache for a new route when the navmesh under them changes
+	if (bPendingPathRouted && Result.HasFlag(FPathFollowingResultFlags::InvalidPath) && MoveToLocation(MoveGoal, MoveAcceptanceRadius))
+	{
+		return;
+	}
+
 	// call the delegate
 	OnMoveCompleted.Broadcast(this);
 }
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "AIController.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "StrategyUnitSignificance.h"
 #include "StrategyUnit.generated.h"
 
 class USphereComponent;
@@ -32,6 +34,67 @@ protected:
 	/** Cast reference to the AI Controlling this unit */
 	TObjectPtr<AAIController> AIController;
 
+	/** Id assigned by the unit registry */
+	int32 RegistryId = INDEX_NONE;
+
+	/** Team this unit belongs to. Units outside the player's team are hidden by the fog of war */
+	UPROPERTY(EditAnywhere, Category="Team")
+	uint8 TeamId = 0;
+
+	/** Distance this unit reveals the fog of war around it, if it's on the player's team */
+	UPROPERTY(EditAnywhere, Category="Team", meta = (ClampMin = 0, ClampMax = 100000, Units = "cm"))
+	float SightRadius = 1200.0f;
+
+	/** Distance to the formation slot where followers start slowing down */
+	UPROPERTY(EditAnywhere, Category="Formation", meta = (ClampMin = 0, ClampMax = 10000, Units = "cm"))
+	float FormationSlowdownDistance = 200.0f;
+
+	/** Time a follower can settle without getting closer to its slot before it gives up steering and paths there instead */
+	UPROPERTY(EditAnywhere, Category="Formation", meta = (ClampMin = 0, ClampMax = 30, Units = "s"))
+	float FormationStuckTime = 2.0f;
+
+	/** Closest the follower has been to its final slot since it started settling */
+	float FormationBestDistance = TNumericLimits<float>::Max();
+
+	/** Time spent settling without getting closer to the final slot */
+	float FormationStuckTimer = 0.0f;
+
+	/** Unit this unit is following in formation */
+	TWeakObjectPtr<AStrategyUnit> FormationLeader;
+
+	/** Offset from the leader to this unit's formation slot */
+	FVector FormationOffset = FVector::ZeroVector;
+
+	/** Final formation slot, projected onto the navmesh */
+	FVector FormationSlot = FVector::ZeroVector;
+
+	/** Distance to the final formation slot that counts as arrived */
+	float FormationAcceptanceRadius = 0.0f;
+
+	/** If true, this unit is moving to a formation slot */
+	bool bFollowingFormation = false;
+
+	/** Path query waiting in the navigation query broker or the path cache */
+	uint32 PendingPathQueryId = INVALID_NAVQUERYID;
+
+	/** If true, the last path query went through the path cache, and its path has to be requested again if it's invalidated */
+	bool bPendingPathRouted = false;
+
+	/** Goal of the last move request */
+	FVector MoveGoal = FVector::ZeroVector;
+
+	/** Acceptance radius of the last move request */
+	float MoveAcceptanceRadius = 0.0f;
+
+	/** If true, this unit is in the player's selection */
+	bool bSelected = false;
+
+	/** Current tick rate tier */
+	EStrategyUnitSignificance Significance = EStrategyUnitSignificance::Full;
+
+	/** Mesh animation tick option to restore at full rate */
+	EVisibilityBasedAnimTickOption DefaultAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+
 public:
 
 	/** Constructor */
@@ -39,10 +102,48 @@ public:
 
 protected:
 
+	/** Registers this unit */
+	virtual void BeginPlay() override;
+
+	/** Unregisters this unit */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void NotifyControllerChanged() override;
 
 public:
 
+	/** Steers towards the formation slot, if following one */
+	virtual void Tick(float DeltaSeconds) override;
+
+public:
+
+	/** Returns the id assigned by the unit registry, or INDEX_NONE if not registered */
+	int32 GetRegistryId() const { return RegistryId; }
+
+	/** Takes over a crowd unit's registry id when it's promoted. Must be called before BeginPlay */
+	void ClaimRegistryId(int32 UnitId) { RegistryId = UnitId; }
+
+	/** Returns the team this unit belongs to */
+	uint8 GetTeamId() const { return TeamId; }
+
+	/** Sets the team. Must be called before BeginPlay, so the unit registers with it */
+	void SetTeamId(uint8 InTeamId) { TeamId = InTeamId; }
+
+	/** Returns the distance this unit reveals the fog of war around it */
+	float GetSightRadius() const { return SightRadius; }
+
+	/** Returns true if this unit is in the player's selection */
+	bool IsSelected() const { return bSelected; }
+
+	/** Returns the current tick rate tier */
+	EStrategyUnitSignificance GetSignificance() const { return Significance; }
+
+	/** Sets the tick rate tier, applying the tick interval to the actor, its movement and its mesh */
+	void SetSignificance(EStrategyUnitSignificance Tier, float TickInterval);
+
+	/** Returns true if this unit must tick at full rate wherever it is, because it's selected or following an order */
+	bool NeedsFullRate() const { return bSelected || bFollowingFormation || IsFollowingPath(); }
+
 	/** Stops unit movement immediately */
 	void StopMoving();
 
@@ -55,14 +156,35 @@ public:
 	/** Notifies this unit that it's been interacted with by another actor */
 	void Interact(AStrategyUnit* Interactor);
 
-	/** Attempts to move this unit to its */
+	/** Attempts to move this unit to its destination. The path is found asynchronously, so the move starts once it's ready */
 	bool MoveToLocation(const FVector& Location, float AcceptanceRadius);
 
+	/** Follows a leader in formation without pathfinding, then settles on the final slot once the leader stops */
+	void FollowFormation(AStrategyUnit* Leader, const FVector& Offset, const FVector& Slot, float AcceptanceRadius);
+
+	/** Returns true if this unit is following a navigation path, or waiting for one */
+	bool IsFollowingPath() const;
+
+	/** Gets the goal of the move in progress, if any. Used to hand the move over when the unit is demoted */
+	bool GetMoveGoal(FVector& OutGoal, float& OutAcceptanceRadius) const;
+
 protected:
 
 	/** called by the AI controller when this unit has finished moving */
 	void OnMoveFinished(FAIRequestID RequestID, const FPathFollowingResult& Result);
 
+	/** called by the navigation query broker when the path for a move is ready */
+	void OnMovePathFound(uint32 QueryId, bool bSuccess, FNavPathSharedPtr Path, FVector Location, float AcceptanceRadius);
+
+	/** Cancels the pending path query, if any */
+	void CancelPathQuery();
+
+	/** Steers towards the leader's offset or the final formation slot. Falls back to a path move if the follower stops making progress */
+	void UpdateFormationMove(float DeltaSeconds);
+
+	/** Goes back to ticking every frame without waiting for the next significance pass */
+	void RestoreFullRate();
+
 protected:
 
 	/** Blueprint handler for strategy game selection */
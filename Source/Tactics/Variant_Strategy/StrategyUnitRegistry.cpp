@@ -0,0 +1,457 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyUnitRegistry.h"
+#include "StrategyUnit.h"
+#include "StrategyPawn.h"
+#include "Camera/CameraComponent.h"
+#include "GameFramework/PlayerController.h"
+
+/** Returns true if a point is inside a convex quad with corners in winding order */
+static bool IsPointInQuad(const FVector2D& Point, const FVector2D (&Corners)[4])
+{
+	bool bHasPositive = false;
+	bool bHasNegative = false;
+
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		const FVector2D& EdgeStart = Corners[Index];
+		const FVector2D& EdgeEnd = Corners[(Index + 1) % 4];
+
+		const float Cross = FVector2D::CrossProduct(EdgeEnd - EdgeStart, Point - EdgeStart);
+
+		bHasPositive |= Cross > 0.0f;
+		bHasNegative |= Cross < 0.0f;
+	}
+
+	// inside if the point is on the same side of every edge
+	return !(bHasPositive && bHasNegative);
+}
+
+int32 UStrategyUnitRegistry::RegisterUnit(AStrategyUnit* Unit)
+{
+	check(Unit);
+
+	// promoted crowd units take over the id they already had
+	const int32 ClaimedId = Unit->GetRegistryId();
+
+	if (IsCrowdUnit(ClaimedId))
+	{
+		FUnitSlot& Slot = Slots[ClaimedId];
+		Slot.Unit = Unit;
+		Slot.bCrowd = false;
+		Slot.TeamId = Unit->GetTeamId();
+
+		return ClaimedId;
+	}
+
+	const int32 UnitId = AddSlot(Unit->GetActorLocation());
+	Slots[UnitId].Unit = Unit;
+	Slots[UnitId].TeamId = Unit->GetTeamId();
+
+	return UnitId;
+}
+
+int32 UStrategyUnitRegistry::RegisterCrowdUnit(const FVector& Location, uint8 TeamId)
+{
+	const int32 UnitId = AddSlot(Location);
+	Slots[UnitId].bCrowd = true;
+	Slots[UnitId].TeamId = TeamId;
+
+	return UnitId;
+}
+
+void UStrategyUnitRegistry::UnregisterUnit(AStrategyUnit* Unit)
+{
+	if (!Unit)
+	{
+		return;
+	}
+
+	const int32 UnitId = Unit->GetRegistryId();
+
+	if (Slots.IsValidIndex(UnitId) && Slots[UnitId].Unit.Get() == Unit)
+	{
+		RemoveSlot(UnitId);
+	}
+}
+
+void UStrategyUnitRegistry::UnregisterCrowdUnit(int32 UnitId)
+{
+	if (IsCrowdUnit(UnitId))
+	{
+		RemoveSlot(UnitId);
+	}
+}
+
+void UStrategyUnitRegistry::DetachUnit(AStrategyUnit* Unit)
+{
+	if (!Unit)
+	{
+		return;
+	}
+
+	const int32 UnitId = Unit->GetRegistryId();
+
+	if (Slots.IsValidIndex(UnitId) && Slots[UnitId].Unit.Get() == Unit)
+	{
+		// the actor won't find its slot when it unregisters, so the id survives
+		FUnitSlot& Slot = Slots[UnitId];
+		Slot.Unit.Reset();
+		Slot.bCrowd = true;
+	}
+}
+
+void UStrategyUnitRegistry::SetCrowdUnitLocation(int32 UnitId, const FVector& Location)
+{
+	if (IsCrowdUnit(UnitId))
+	{
+		UpdateSlotLocation(UnitId, Location);
+	}
+}
+
+AStrategyUnit* UStrategyUnitRegistry::GetUnit(int32 UnitId) const
+{
+	return Slots.IsValidIndex(UnitId) ? Slots[UnitId].Unit.Get() : nullptr;
+}
+
+bool UStrategyUnitRegistry::GetUnitLocation(int32 UnitId, FVector& OutLocation) const
+{
+	if (!IsRegistered(UnitId))
+	{
+		return false;
+	}
+
+	OutLocation = Slots[UnitId].Location;
+	return true;
+}
+
+void UStrategyUnitRegistry::GetUnitsInQuad(const FVector2D (&Corners)[4], TArray<AStrategyUnit*>& OutUnits) const
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyUnitRegistry_GetUnitsInQuad);
+
+	// find the range of cells overlapped by the quad's bounds
+	FBox2D Bounds(ForceInit);
+	for (const FVector2D& Corner : Corners)
+	{
+		Bounds += Corner;
+	}
+
+	const FIntPoint MinCell = GetCell(FVector(Bounds.Min, 0.0f));
+	const FIntPoint MaxCell = GetCell(FVector(Bounds.Max, 0.0f));
+
+	// if the quad covers more cells than are occupied, walk the occupied cells instead
+	const int64 NumCells = int64(MaxCell.X - MinCell.X + 1) * int64(MaxCell.Y - MinCell.Y + 1);
+
+	auto GatherCell = [&](const TArray<int32>& CellIds)
+	{
+		for (const int32 UnitId : CellIds)
+		{
+			const FUnitSlot& Slot = Slots[UnitId];
+
+			if (IsPointInQuad(FVector2D(Slot.Location), Corners))
+			{
+				if (AStrategyUnit* Unit = Slot.Unit.Get())
+				{
+					OutUnits.Add(Unit);
+				}
+			}
+		}
+	};
+
+	if (NumCells > Grid.Num())
+	{
+		for (const TPair<FIntPoint, TArray<int32>>& Pair : Grid)
+		{
+			if (Pair.Key.X >= MinCell.X && Pair.Key.X <= MaxCell.X && Pair.Key.Y >= MinCell.Y && Pair.Key.Y <= MaxCell.Y)
+			{
+				GatherCell(Pair.Value);
+			}
+		}
+
+		return;
+	}
+
+	for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+	{
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			if (const TArray<int32>* CellIds = Grid.Find(FIntPoint(CellX, CellY)))
+			{
+				GatherCell(*CellIds);
+			}
+		}
+	}
+}
+
+void UStrategyUnitRegistry::GetUnitIdsInRadius(const FVector& Center, float Radius, TArray<int32>& OutUnitIds) const
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyUnitRegistry_GetUnitIdsInRadius);
+
+	// walk the cells overlapped by the circle's bounds
+	const FIntPoint MinCell = GetCell(Center - FVector(Radius, Radius, 0.0f));
+	const FIntPoint MaxCell = GetCell(Center + FVector(Radius, Radius, 0.0f));
+
+	const float RadiusSquared = FMath::Square(Radius);
+
+	for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+	{
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			if (const TArray<int32>* CellIds = Grid.Find(FIntPoint(CellX, CellY)))
+			{
+				for (const int32 UnitId : *CellIds)
+				{
+					if (FVector::DistSquared2D(Slots[UnitId].Location, Center) <= RadiusSquared)
+					{
+						OutUnitIds.Add(UnitId);
+					}
+				}
+			}
+		}
+	}
+}
+
+void UStrategyUnitRegistry::GetUnitsInView(const UCameraComponent* Camera, float ViewAspectRatio, TArray<AStrategyUnit*>& OutUnits) const
+{
+	FVector2D Corners[4];
+
+	// intersect the view volume at the height the units are standing at
+	if (GetCameraViewQuad(Camera, ViewAspectRatio, AverageUnitHeight, Corners))
+	{
+		GetUnitsInQuad(Corners, OutUnits);
+	}
+}
+
+bool UStrategyUnitRegistry::GetCameraViewQuad(const UCameraComponent* Camera, float ViewAspectRatio, float PlaneHeight, FVector2D (&OutCorners)[4])
+{
+	if (!Camera || ViewAspectRatio <= 0.0f)
+	{
+		return false;
+	}
+
+	const FTransform& CameraTransform = Camera->GetComponentTransform();
+	const FVector Forward = CameraTransform.GetUnitAxis(EAxis::X);
+	const FVector Right = CameraTransform.GetUnitAxis(EAxis::Y);
+	const FVector Up = CameraTransform.GetUnitAxis(EAxis::Z);
+	const FVector Origin = CameraTransform.GetLocation();
+
+	const bool bOrtho = Camera->ProjectionMode == ECameraProjectionMode::Orthographic;
+
+	// half extents of the view, in world units for ortho and as a slope for perspective
+	const float HalfWidth = bOrtho ? Camera->OrthoWidth * 0.5f : FMath::Tan(FMath::DegreesToRadians(Camera->FieldOfView * 0.5f));
+	const float HalfHeight = HalfWidth / ViewAspectRatio;
+
+	// corners in winding order: top left, top right, bottom right, bottom left
+	static const FVector2D CornerSigns[4] = { FVector2D(-1.0f, 1.0f), FVector2D(1.0f, 1.0f), FVector2D(1.0f, -1.0f), FVector2D(-1.0f, -1.0f) };
+
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		const FVector Offset = Right * (HalfWidth * CornerSigns[Index].X) + Up * (HalfHeight * CornerSigns[Index].Y);
+
+		// ortho rays are parallel and offset, perspective rays share the origin and fan out
+		const FVector RayStart = bOrtho ? Origin + Offset : Origin;
+		const FVector RayDirection = bOrtho ? Forward : (Forward + Offset).GetSafeNormal();
+
+		// the ray needs to point down at the plane
+		if (RayDirection.Z >= -UE_KINDA_SMALL_NUMBER)
+		{
+			return false;
+		}
+
+		const float Distance = (PlaneHeight - RayStart.Z) / RayDirection.Z;
+		OutCorners[Index] = FVector2D(RayStart + RayDirection * Distance);
+	}
+
+	return true;
+}
+
+bool UStrategyUnitRegistry::GetPlayerViewBounds(const APlayerController* PlayerController, float PlaneHeight, FBox2D& OutBounds)
+{
+	const AStrategyPawn* Pawn = PlayerController ? Cast<AStrategyPawn>(PlayerController->GetPawn()) : nullptr;
+
+	if (!Pawn)
+	{
+		return false;
+	}
+
+	int32 ViewportX = 0;
+	int32 ViewportY = 0;
+	PlayerController->GetViewportSize(ViewportX, ViewportY);
+
+	const UCameraComponent* Camera = Pawn->GetCamera();
+	const float AspectRatio = (ViewportX > 0 && ViewportY > 0) ? float(ViewportX) / float(ViewportY) : Camera->AspectRatio;
+
+	FVector2D Corners[4];
+
+	if (!GetCameraViewQuad(Camera, AspectRatio, PlaneHeight, Corners))
+	{
+		return false;
+	}
+
+	OutBounds = FBox2D(ForceInit);
+
+	for (const FVector2D& Corner : Corners)
+	{
+		OutBounds += Corner;
+	}
+
+	return true;
+}
+
+bool UStrategyUnitRegistry::GetScreenRectQuad(const APlayerController* PlayerController, const FVector2D& ScreenStart, const FVector2D& ScreenEnd, float PlaneHeight, FVector2D (&OutCorners)[4])
+{
+	if (!PlayerController)
+	{
+		return false;
+	}
+
+	// corners in winding order, regardless of the drag direction
+	const FVector2D ScreenCorners[4] = { ScreenStart, FVector2D(ScreenEnd.X, ScreenStart.Y), ScreenEnd, FVector2D(ScreenStart.X, ScreenEnd.Y) };
+
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		FVector RayStart;
+		FVector RayDirection;
+
+		// ortho deprojection gives parallel rays starting on the view plane
+		if (!PlayerController->DeprojectScreenPositionToWorld(ScreenCorners[Index].X, ScreenCorners[Index].Y, RayStart, RayDirection) || RayDirection.Z >= -UE_KINDA_SMALL_NUMBER)
+		{
+			return false;
+		}
+
+		const float Distance = (PlaneHeight - RayStart.Z) / RayDirection.Z;
+		OutCorners[Index] = FVector2D(RayStart + RayDirection * Distance);
+	}
+
+	return true;
+}
+
+FIntPoint UStrategyUnitRegistry::GetCell(const FVector& Location)
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+void UStrategyUnitRegistry::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyUnitRegistry_Tick);
+
+	float HeightSum = 0.0f;
+
+	// walk backwards so stale units can be removed in place
+	for (int32 DenseIndex = DenseIds.Num() - 1; DenseIndex >= 0; --DenseIndex)
+	{
+		const int32 UnitId = DenseIds[DenseIndex];
+		FUnitSlot& Slot = Slots[UnitId];
+
+		// crowd units push their own locations
+		if (Slot.bCrowd)
+		{
+			HeightSum += Slot.Location.Z;
+			continue;
+		}
+
+		const AStrategyUnit* Unit = Slot.Unit.Get();
+
+		// drop units that were destroyed without unregistering
+		if (!Unit)
+		{
+			RemoveSlot(UnitId);
+			continue;
+		}
+
+		// refresh the location and move the unit between cells if needed
+		UpdateSlotLocation(UnitId, Unit->GetActorLocation());
+		HeightSum += Slot.Location.Z;
+	}
+
+	AverageUnitHeight = DenseIds.Num() > 0 ? HeightSum / DenseIds.Num() : 0.0f;
+}
+
+TStatId UStrategyUnitRegistry::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyUnitRegistry, STATGROUP_Tickables);
+}
+
+void UStrategyUnitRegistry::Deinitialize()
+{
+	Slots.Empty();
+	FreeIds.Empty();
+	DenseIds.Empty();
+	Grid.Empty();
+
+	Super::Deinitialize();
+}
+
+void UStrategyUnitRegistry::AddToCell(int32 UnitId, const FIntPoint& Cell)
+{
+	Grid.FindOrAdd(Cell).Add(UnitId);
+}
+
+void UStrategyUnitRegistry::RemoveFromCell(int32 UnitId, const FIntPoint& Cell)
+{
+	if (TArray<int32>* CellIds = Grid.Find(Cell))
+	{
+		CellIds->RemoveSingleSwap(UnitId, EAllowShrinking::No);
+
+		// don't keep empty cells around
+		if (CellIds->Num() == 0)
+		{
+			Grid.Remove(Cell);
+		}
+	}
+}
+
+int32 UStrategyUnitRegistry::AddSlot(const FVector& Location)
+{
+	// reuse a free slot if we have one
+	const int32 UnitId = FreeIds.Num() > 0 ? FreeIds.Pop(EAllowShrinking::No) : Slots.AddDefaulted();
+
+	FUnitSlot& Slot = Slots[UnitId];
+	Slot.Location = Location;
+	Slot.Cell = GetCell(Location);
+	Slot.DenseIndex = DenseIds.Add(UnitId);
+
+	AddToCell(UnitId, Slot.Cell);
+
+	return UnitId;
+}
+
+void UStrategyUnitRegistry::UpdateSlotLocation(int32 UnitId, const FVector& Location)
+{
+	FUnitSlot& Slot = Slots[UnitId];
+	Slot.Location = Location;
+
+	const FIntPoint NewCell = GetCell(Location);
+
+	if (NewCell != Slot.Cell)
+	{
+		RemoveFromCell(UnitId, Slot.Cell);
+		AddToCell(UnitId, NewCell);
+		Slot.Cell = NewCell;
+	}
+}
+
+void UStrategyUnitRegistry::RemoveSlot(int32 UnitId)
+{
+	FUnitSlot& Slot = Slots[UnitId];
+
+	RemoveFromCell(UnitId, Slot.Cell);
+
+	// swap the last dense entry into the removed one's place
+	const int32 DenseIndex = Slot.DenseIndex;
+	DenseIds.RemoveAtSwap(DenseIndex, EAllowShrinking::No);
+
+	if (DenseIds.IsValidIndex(DenseIndex))
+	{
+		Slots[DenseIds[DenseIndex]].DenseIndex = DenseIndex;
+	}
+
+	Slot = FUnitSlot();
+	FreeIds.Add(UnitId);
+
+	// let unit sets drop the id before it gets reused
+	OnUnitUnregistered.Broadcast(UnitId);
+}
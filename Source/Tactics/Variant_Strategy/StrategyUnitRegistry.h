@@ -0,0 +1,162 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyUnitRegistry.generated.h"
+
+class AStrategyUnit;
+class UCameraComponent;
+class APlayerController;
+
+/** Delegate to report that a unit left the registry and its id is free for reuse */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnStrategyUnitUnregisteredDelegate, int32 /* UnitId */);
+
+/**
+ *  Keeps track of all live strategy units.
+ *  Units get a stable id when they register. They are stored in a dense array for iteration
+ *  and bucketed in a uniform grid on the XY plane for spatial queries.
+ *  Queries don't depend on rendering, so they behave the same in headless runs.
+ *  Crowd units keep their id without an actor, so the id stays the same when a unit is promoted or demoted.
+ */
+UCLASS()
+class UStrategyUnitRegistry : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Size of a grid cell, in world units */
+	static constexpr float CellSize = 500.0f;
+
+	/** Adds a unit to the registry and returns its id. Units promoted from the crowd take over their crowd id */
+	int32 RegisterUnit(AStrategyUnit* Unit);
+
+	/** Adds a crowd unit without an actor and returns its id */
+	int32 RegisterCrowdUnit(const FVector& Location, uint8 TeamId = 0);
+
+	/** Removes a crowd unit from the registry */
+	void UnregisterCrowdUnit(int32 UnitId);
+
+	/** Detaches a unit's actor before it's demoted, keeping its id as a crowd unit */
+	void DetachUnit(AStrategyUnit* Unit);
+
+	/** Updates the location of a crowd unit */
+	void SetCrowdUnitLocation(int32 UnitId, const FVector& Location);
+
+	/** Returns true if the id belongs to a registered unit or crowd unit */
+	bool IsRegistered(int32 UnitId) const { return Slots.IsValidIndex(UnitId) && Slots[UnitId].DenseIndex != INDEX_NONE; }
+
+	/** Returns true if the id belongs to a crowd unit without an actor */
+	bool IsCrowdUnit(int32 UnitId) const { return Slots.IsValidIndex(UnitId) && Slots[UnitId].bCrowd; }
+
+	/** Removes a unit from the registry */
+	void UnregisterUnit(AStrategyUnit* Unit);
+
+	/** Returns the unit with the given id, or nullptr. Crowd units have no actor */
+	AStrategyUnit* GetUnit(int32 UnitId) const;
+
+	/** Returns the team of a unit or crowd unit. Unregistered ids return team 0 */
+	uint8 GetUnitTeam(int32 UnitId) const { return IsRegistered(UnitId) ? Slots[UnitId].TeamId : 0; }
+
+	/** Gets the last known location of a unit or crowd unit. Returns false if the id isn't registered */
+	bool GetUnitLocation(int32 UnitId, FVector& OutLocation) const;
+
+	/** Returns the number of registered units */
+	int32 GetNumUnits() const { return DenseIds.Num(); }
+
+	/** Returns the ids of all registered units, packed */
+	const TArray<int32>& GetUnitIds() const { return DenseIds; }
+
+	/** Returns the upper bound of unit ids handed out so far */
+	int32 GetMaxUnitId() const { return Slots.Num(); }
+
+	/** Returns the average height of the registered units */
+	float GetAverageUnitHeight() const { return AverageUnitHeight; }
+
+	/** Finds all units inside a convex quad on the XY plane. Corners must be in winding order */
+	void GetUnitsInQuad(const FVector2D (&Corners)[4], TArray<AStrategyUnit*>& OutUnits) const;
+
+	/** Finds the ids of all units and crowd units within a radius of a location on the XY plane */
+	void GetUnitIdsInRadius(const FVector& Center, float Radius, TArray<int32>& OutUnitIds) const;
+
+	/** Finds all units inside the camera's view volume */
+	void GetUnitsInView(const UCameraComponent* Camera, float ViewAspectRatio, TArray<AStrategyUnit*>& OutUnits) const;
+
+	/** Intersects the camera's view volume with a horizontal plane. Returns false if the camera doesn't look down at the plane */
+	static bool GetCameraViewQuad(const UCameraComponent* Camera, float ViewAspectRatio, float PlaneHeight, FVector2D (&OutCorners)[4]);
+
+	/** Gets the XY bounds of the strategy camera's view at a given height. Returns false if the player has no strategy camera */
+	static bool GetPlayerViewBounds(const APlayerController* PlayerController, float PlaneHeight, FBox2D& OutBounds);
+
+	/** Deprojects a screen rectangle onto a horizontal plane. With an ortho camera the result is an oriented rectangle. Returns false if any corner misses the plane */
+	static bool GetScreenRectQuad(const APlayerController* PlayerController, const FVector2D& ScreenStart, const FVector2D& ScreenEnd, float PlaneHeight, FVector2D (&OutCorners)[4]);
+
+	/** Returns the grid cell containing a location */
+	static FIntPoint GetCell(const FVector& Location);
+
+	/** Called when a unit leaves the registry, before its id can be handed out again */
+	FOnStrategyUnitUnregisteredDelegate OnUnitUnregistered;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+protected:
+
+	/** Registry entry for a unit */
+	struct FUnitSlot
+	{
+		/** Registered unit, null for free slots */
+		TWeakObjectPtr<AStrategyUnit> Unit;
+
+		/** Last known unit location */
+		FVector Location = FVector::ZeroVector;
+
+		/** Grid cell the unit is stored in */
+		FIntPoint Cell = FIntPoint::ZeroValue;
+
+		/** Index of this unit in the dense id array */
+		int32 DenseIndex = INDEX_NONE;
+
+		/** If true, this is a crowd unit. Its location is pushed by the crowd instead of read from an actor */
+		bool bCrowd = false;
+
+		/** Team the unit belongs to, kept while it's in the crowd */
+		uint8 TeamId = 0;
+	};
+
+	/** Registry entries, indexed by unit id */
+	TArray<FUnitSlot> Slots;
+
+	/** Ids of unused slots */
+	TArray<int32> FreeIds;
+
+	/** Ids of all registered units, packed for iteration */
+	TArray<int32> DenseIds;
+
+	/** Unit ids in each occupied grid cell */
+	TMap<FIntPoint, TArray<int32>> Grid;
+
+	/** Average height of the registered units, updated every tick */
+	float AverageUnitHeight = 0.0f;
+
+	/** Adds a unit id to a grid cell */
+	void AddToCell(int32 UnitId, const FIntPoint& Cell);
+
+	/** Removes a unit id from a grid cell */
+	void RemoveFromCell(int32 UnitId, const FIntPoint& Cell);
+
+	/** Takes a new slot for a unit at the given location and returns its id */
+	int32 AddSlot(const FVector& Location);
+
+	/** Moves a unit to a new location, changing cells if needed */
+	void UpdateSlotLocation(int32 UnitId, const FVector& Location);
+
+	/** Frees a unit's slot */
+	void RemoveSlot(int32 UnitId);
+};
@@ -0,0 +1,100 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyUnitSet.h"
+#include "StrategyUnitRegistry.h"
+
+bool FStrategyUnitSet::Add(int32 UnitId)
+{
+	// ignore units that never registered
+	if (UnitId < 0)
+	{
+		return false;
+	}
+
+	// grow the bits to cover the id
+	if (UnitId >= Bits.Num())
+	{
+		Bits.Add(false, UnitId + 1 - Bits.Num());
+	}
+
+	if (Bits[UnitId])
+	{
+		return false;
+	}
+
+	Bits[UnitId] = true;
+	++Count;
+
+	return true;
+}
+
+bool FStrategyUnitSet::Remove(int32 UnitId)
+{
+	if (!Contains(UnitId))
+	{
+		return false;
+	}
+
+	Bits[UnitId] = false;
+	--Count;
+
+	return true;
+}
+
+void FStrategyUnitSet::Empty()
+{
+	// keep the allocation, sets get refilled all the time
+	Bits.Init(false, Bits.Num());
+	Count = 0;
+}
+
+bool FStrategyUnitSet::operator==(const FStrategyUnitSet& Other) const
+{
+	if (Count != Other.Count)
+	{
+		return false;
+	}
+
+	// same count, so it's enough that every id here is in the other set
+	for (TConstSetBitIterator<> It(Bits); It; ++It)
+	{
+		if (!Other.Contains(It.GetIndex()))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+FArchive& operator<<(FArchive& Ar, FStrategyUnitSet& Set)
+{
+	Ar << Set.Bits;
+
+	// the count isn't stored, rebuild it from the bits
+	if (Ar.IsLoading())
+	{
+		Set.Count = Set.Bits.CountSetBits();
+	}
+
+	return Ar;
+}
+
+void FStrategyUnitSet::GetUnits(const UStrategyUnitRegistry* Registry, TArray<AStrategyUnit*>& OutUnits) const
+{
+	if (!Registry)
+	{
+		return;
+	}
+
+	OutUnits.Reserve(OutUnits.Num() + Count);
+
+	for (TConstSetBitIterator<> It(Bits); It; ++It)
+	{
+		if (AStrategyUnit* Unit = Registry->GetUnit(It.GetIndex()))
+		{
+			OutUnits.Add(Unit);
+		}
+	}
+}
@@ -0,0 +1,60 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/BitArray.h"
+
+class AStrategyUnit;
+class UStrategyUnitRegistry;
+
+/**
+ *  Set of strategy units, stored as a bit per unit registry id.
+ *  Adding, removing and testing a unit are constant time, and copying a set is a bit copy.
+ *  Iteration goes in id order, so it's deterministic.
+ *  Only ids are stored, so destroyed units simply fail to resolve through the registry.
+ */
+struct FStrategyUnitSet
+{
+	/** Adds a unit id. Returns true if it wasn't in the set already */
+	bool Add(int32 UnitId);
+
+	/** Removes a unit id. Returns true if it was in the set */
+	bool Remove(int32 UnitId);
+
+	/** Returns true if the unit id is in the set */
+	bool Contains(int32 UnitId) const { return Bits.IsValidIndex(UnitId) && Bits[UnitId]; }
+
+	/** Removes all unit ids */
+	void Empty();
+
+	/** Returns the number of unit ids in the set */
+	int32 Num() const { return Count; }
+
+	/** Returns true if both sets hold the same unit ids */
+	bool operator==(const FStrategyUnitSet& Other) const;
+
+	/** Serializes the set as its bits */
+	friend FArchive& operator<<(FArchive& Ar, FStrategyUnitSet& Set);
+
+	/** Resolves the set through the registry, in id order. Units that no longer exist are skipped */
+	void GetUnits(const UStrategyUnitRegistry* Registry, TArray<AStrategyUnit*>& OutUnits) const;
+
+	/** Calls a function for each unit id in the set, in id order */
+	template<typename FuncType>
+	void ForEachId(FuncType Func) const
+	{
+		for (TConstSetBitIterator<> It(Bits); It; ++It)
+		{
+			Func(It.GetIndex());
+		}
+	}
+
+private:
+
+	/** One bit per unit id */
+	TBitArray<> Bits;
+
+	/** Number of set bits */
+	int32 Count = 0;
+};
@@ -0,0 +1,237 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyUnitSignificance.h"
+#include "StrategyUnit.h"
+#include "StrategyUnitRegistry.h"
+#include "StrategyGameMode.h"
+#include "StrategyFogOfWar.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "RenderCore.h"
+#include "Tactics.h"
+
+static TAutoConsoleVariable<bool> CVarSignificanceEnabled(
+	TEXT("Tactics.Significance.Enabled"),
+	true,
+	TEXT("If true, strategy units outside or near the edge of the camera view tick at reduced rates."));
+
+/** Display names of the tiers, for the stats */
+static const TCHAR* SignificanceTierNames[] = { TEXT("Full"), TEXT("Edge"), TEXT("Offscreen") };
+static_assert(UE_ARRAY_COUNT(SignificanceTierNames) == static_cast<int32>(EStrategyUnitSignificance::Num), "Missing significance tier names");
+
+/** Number of ticking objects throttled per unit: the actor, its movement component and its mesh */
+static constexpr int32 TicksPerUnit = 3;
+
+float UStrategyUnitSignificance::GetTickInterval(EStrategyUnitSignificance Tier) const
+{
+	return TickIntervals[static_cast<int32>(Tier)];
+}
+
+void UStrategyUnitSignificance::DumpStats() const
+{
+	UE_LOG(LogTactics, Display, TEXT("=== UNIT SIGNIFICANCE ==="));
+
+	for (int32 Tier = 0; Tier < static_cast<int32>(EStrategyUnitSignificance::Num); ++Tier)
+	{
+		UE_LOG(LogTactics, Display, TEXT("%s: %d units, tick interval %.2f s"), SignificanceTierNames[Tier], TierCounts[Tier], TickIntervals[Tier]);
+	}
+
+	UE_LOG(LogTactics, Display, TEXT("Estimated ticks skipped: %.0f per second"), SkippedTicksTime > 0.0 ? SkippedTicks / SkippedTicksTime : 0.0);
+
+	const double EnabledMs = EnabledFrames > 0 ? EnabledFrameMs / EnabledFrames : 0.0;
+	const double DisabledMs = DisabledFrames > 0 ? DisabledFrameMs / DisabledFrames : 0.0;
+
+	UE_LOG(LogTactics, Display, TEXT("Game thread: %.2f ms with reduced rates (%d frames), %.2f ms at full rate (%d frames)"),
+		EnabledMs, EnabledFrames, DisabledMs, DisabledFrames);
+
+	// the saving is only meaningful once both modes were sampled
+	if (EnabledFrames > 0 && DisabledFrames > 0)
+	{
+		UE_LOG(LogTactics, Display, TEXT("Game thread time saved: %.2f ms per frame"), DisabledMs - EnabledMs);
+
+	} else {
+
+		UE_LOG(LogTactics, Display, TEXT("Toggle Tactics.Significance.Enabled to sample both modes and measure the game thread time saved"));
+	}
+}
+
+void UStrategyUnitSignificance::ResetStats()
+{
+	SkippedTicks = 0.0;
+	SkippedTicksTime = 0.0;
+	EnabledFrameMs = 0.0;
+	EnabledFrames = 0;
+	DisabledFrameMs = 0.0;
+	DisabledFrames = 0;
+}
+
+void UStrategyUnitSignificance::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategyUnitSignificance_Tick);
+
+	const bool bEnabled = CVarSignificanceEnabled.GetValueOnGameThread();
+
+	if (!UnitRegistry)
+	{
+		return;
+	}
+
+	// sample the last frame's game thread time for the mode it ran in
+	if (bHasRun)
+	{
+		const double FrameMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+
+		if (bWasEnabled)
+		{
+			EnabledFrameMs += FrameMs;
+			++EnabledFrames;
+
+		} else {
+
+			DisabledFrameMs += FrameMs;
+			++DisabledFrames;
+		}
+	}
+
+	if (!bEnabled)
+	{
+		if (bWasEnabled)
+		{
+			RestoreAll();
+		}
+
+		bWasEnabled = false;
+		bHasRun = true;
+		return;
+	}
+
+	// without a strategy camera there's no view to compare against
+	FBox2D ViewBounds;
+
+	if (!UStrategyUnitRegistry::GetPlayerViewBounds(GetWorld()->GetFirstPlayerController(), UnitRegistry->GetAverageUnitHeight(), ViewBounds))
+	{
+		return;
+	}
+
+	bWasEnabled = true;
+	bHasRun = true;
+
+	// the edge band scales with the view, so it follows the camera zoom
+	const FBox2D EdgeBounds = ViewBounds.ExpandBy(ViewBounds.GetSize().X * EdgeMargin);
+
+	// units hidden by the fog of war aren't drawn, wherever they are
+	const UStrategyFogOfWar* Fog = GetWorld()->GetSubsystem<UStrategyFogOfWar>();
+	const bool bUseFog = Fog && Fog->IsEnabled();
+
+	FMemory::Memzero(TierCounts);
+
+	for (const int32 UnitId : UnitRegistry->GetUnitIds())
+	{
+		// crowd units have no actor to tick
+		AStrategyUnit* Unit = UnitRegistry->GetUnit(UnitId);
+
+		if (!Unit)
+		{
+			continue;
+		}
+
+		FVector Location;
+		UnitRegistry->GetUnitLocation(UnitId, Location);
+
+		EStrategyUnitSignificance Tier = EStrategyUnitSignificance::Offscreen;
+
+		if (Unit->NeedsFullRate())
+		{
+			Tier = EStrategyUnitSignificance::Full;
+
+		} else if (bUseFog && !Fog->IsUnitVisible(UnitId)) {
+
+			Tier = EStrategyUnitSignificance::Offscreen;
+
+		} else if (ViewBounds.IsInside(FVector2D(Location))) {
+
+			Tier = EStrategyUnitSignificance::Full;
+
+		} else if (EdgeBounds.IsInside(FVector2D(Location))) {
+
+			Tier = EStrategyUnitSignificance::Edge;
+		}
+
+		Unit->SetSignificance(Tier, GetTickInterval(Tier));
+		++TierCounts[static_cast<int32>(Tier)];
+
+		// a unit ticking every Interval seconds skips all but DeltaTime / Interval of its frame ticks
+		const float Interval = GetTickInterval(Tier);
+
+		if (Interval > DeltaTime)
+		{
+			SkippedTicks += TicksPerUnit * (1.0 - DeltaTime / Interval);
+		}
+	}
+
+	SkippedTicksTime += DeltaTime;
+}
+
+TStatId UStrategyUnitSignificance::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyUnitSignificance, STATGROUP_Tickables);
+}
+
+void UStrategyUnitSignificance::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// tiers are only used by the strategy game mode
+	const AStrategyGameMode* GameMode = Cast<AStrategyGameMode>(InWorld.GetAuthGameMode());
+
+	if (!GameMode)
+	{
+		return;
+	}
+
+	UnitRegistry = InWorld.GetSubsystem<UStrategyUnitRegistry>();
+
+	EdgeMargin = GameMode->GetSignificanceEdgeMargin();
+	TickIntervals[static_cast<int32>(EStrategyUnitSignificance::Edge)] = GameMode->GetEdgeTickInterval();
+	TickIntervals[static_cast<int32>(EStrategyUnitSignificance::Offscreen)] = FMath::Max(GameMode->GetOffscreenTickInterval(), GameMode->GetEdgeTickInterval());
+}
+
+void UStrategyUnitSignificance::RestoreAll()
+{
+	FMemory::Memzero(TierCounts);
+
+	for (const int32 UnitId : UnitRegistry->GetUnitIds())
+	{
+		if (AStrategyUnit* Unit = UnitRegistry->GetUnit(UnitId))
+		{
+			Unit->SetSignificance(EStrategyUnitSignificance::Full, GetTickInterval(EStrategyUnitSignificance::Full));
+			++TierCounts[static_cast<int32>(EStrategyUnitSignificance::Full)];
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs SignificanceDumpCommand(
+	TEXT("Tactics.Significance.Dump"),
+	TEXT("Logs the strategy unit tick tiers and the game thread time saved."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UStrategyUnitSignificance* Significance = World ? World->GetSubsystem<UStrategyUnitSignificance>() : nullptr)
+		{
+			Significance->DumpStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs SignificanceResetCommand(
+	TEXT("Tactics.Significance.Reset"),
+	TEXT("Clears the strategy unit tick tier stats."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UStrategyUnitSignificance* Significance = World ? World->GetSubsystem<UStrategyUnitSignificance>() : nullptr)
+		{
+			Significance->ResetStats();
+		}
+	}));
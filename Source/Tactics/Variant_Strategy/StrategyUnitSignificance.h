@@ -0,0 +1,94 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyUnitSignificance.generated.h"
+
+class AStrategyUnit;
+class UStrategyUnitRegistry;
+
+/** How often a unit actor ticks, based on where it is relative to the camera view */
+enum class EStrategyUnitSignificance : uint8
+{
+	/** On screen, selected or following an order. Ticks every frame */
+	Full,
+
+	/** Just outside the camera view. Ticks at the edge interval */
+	Edge,
+
+	/** Far outside the camera view. Ticks at the offscreen interval, and skips animation while not rendered */
+	Offscreen,
+
+	Num
+};
+
+/**
+ *  Lowers the tick rate of unit actors outside or near the edge of the strategy camera view.
+ *  The view bounds follow the camera's ortho width, so zooming out brings more units back to full rate.
+ *  Units restore their own full rate as soon as they're selected or ordered, so nothing waits for the next pass.
+ *  Units hidden by the fog of war tick at the offscreen rate even when they're in view.
+ *  Settings are read from the strategy game mode.
+ */
+UCLASS()
+class UStrategyUnitSignificance : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns the tick interval for a tier */
+	float GetTickInterval(EStrategyUnitSignificance Tier) const;
+
+	/** Logs the tier counts and the game thread time with and without reduced tick rates */
+	void DumpStats() const;
+
+	/** Clears the frame time stats */
+	void ResetStats();
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// UWorldSubsystem interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+protected:
+
+	/** Unit registry for this world */
+	UPROPERTY(Transient)
+	TObjectPtr<UStrategyUnitRegistry> UnitRegistry;
+
+	/** Band around the camera view where units tick at the edge rate, as a fraction of the view width */
+	float EdgeMargin = 0.25f;
+
+	/** Tick interval for each tier */
+	float TickIntervals[static_cast<int32>(EStrategyUnitSignificance::Num)] = { 0.0f, 0.1f, 0.5f };
+
+	/** If true, reduced tick rates were applied on the last pass */
+	bool bWasEnabled = false;
+
+	/** If true, a pass has run and the frame time can be sampled */
+	bool bHasRun = false;
+
+	/** Number of unit actors in each tier after the last pass */
+	int32 TierCounts[static_cast<int32>(EStrategyUnitSignificance::Num)] = {};
+
+	/** Estimated actor and component ticks skipped, summed over the sampled frames */
+	double SkippedTicks = 0.0;
+
+	/** Game time covered by the skipped ticks estimate */
+	double SkippedTicksTime = 0.0;
+
+	/** Game thread time summed over the frames with reduced tick rates on, and the number of frames */
+	double EnabledFrameMs = 0.0;
+	int32 EnabledFrames = 0;
+
+	/** Game thread time summed over the frames with reduced tick rates off, and the number of frames */
+	double DisabledFrameMs = 0.0;
+	int32 DisabledFrames = 0;
+
+	/** Puts every unit actor back at full rate */
+	void RestoreAll();
+};
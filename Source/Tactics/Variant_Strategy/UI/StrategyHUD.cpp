@@ -3,8 +3,62 @@
 
 #include "StrategyHUD.h"
 #include "StrategyUnit.h"
+#include "StrategyUnitSet.h"
 #include "StrategyPlayerController.h"
 #include "StrategyUI.h"
+#include "StrategySelectionIndicators.h"
+#include "StrategyUnitRegistry.h"
+#include "StrategyFogOfWar.h"
+#include "TacticsMinimapSubsystem.h"
+#include "Engine/StaticMesh.h"
+#include "Materials/MaterialInterface.h"
+#include "Tactics.h"
+#include "Misc/DataValidation.h"
+
+AStrategyHUD::AStrategyHUD()
+{
+	// mark selected units with a flat engine shape unless the Blueprint picks its own mesh.
+	// These are soft references preloaded with the game mode, so constructing the HUD doesn't load them
+	SelectionRingMesh = TSoftObjectPtr<UStaticMesh>(FSoftObjectPath(TEXT("/Engine/BasicShapes/Plane.Plane")));
+	SelectionRingMaterial = TSoftObjectPtr<UMaterialInterface>(FSoftObjectPath(TEXT("/Engine/BasicShapes/BasicShapeMaterial.BasicShapeMaterial")));
+}
+
+void AStrategyHUD::GetPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const
+{
+	for (const FSoftObjectPath& Path : { SelectionRingMesh.ToSoftObjectPath(), SelectionRingMaterial.ToSoftObjectPath() })
+	{
+		if (!Path.IsNull())
+		{
+			OutAssets.Add(Path);
+		}
+	}
+}
+
+#if WITH_EDITOR
+EDataValidationResult AStrategyHUD::IsDataValid(FDataValidationContext& Context) const
+{
+	// catch a missing ring mesh or material at validation and cook time instead of at runtime
+	return CombineDataValidationResults(Super::IsDataValid(Context), ValidatePreloadAssets(Context));
+}
+#endif
+
+/** Resolves a preloaded soft asset. A sync load here is a hitch, so it gets logged */
+template<typename T>
+static T* ResolvePreloadedAsset(const TSoftObjectPtr<T>& Asset)
+{
+	if (Asset.IsNull())
+	{
+		return nullptr;
+	}
+
+	if (T* Loaded = Asset.Get())
+	{
+		return Loaded;
+	}
+
+	UE_LOG(LogTactics, Warning, TEXT("%s was not preloaded, loading synchronously"), *Asset.ToString());
+	return Asset.LoadSynchronous();
+}
 
 void AStrategyHUD::BeginPlay()
 {
@@ -16,6 +70,31 @@ void AStrategyHUD::BeginPlay()
 
 	// add the UI widget to the screen
 	UIWidget->AddToViewport(0);
+
+	// set up the selection rings
+	if (UStrategySelectionIndicators* Indicators = GetWorld()->GetSubsystem<UStrategySelectionIndicators>())
+	{
+		Indicators->Configure(ResolvePreloadedAsset(SelectionRingMesh), ResolvePreloadedAsset(SelectionRingMaterial), SelectionRingScale, SelectionRingHeightOffset);
+	}
+
+	// add our units to the minimap
+	if (UTacticsMinimapSubsystem* Minimap = GetWorld()->GetSubsystem<UTacticsMinimapSubsystem>())
+	{
+		MinimapGatherHandle = Minimap->OnGatherMarkers.AddUObject(this, &AStrategyHUD::GatherMinimapMarkers);
+	}
+}
+
+void AStrategyHUD::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// stop adding units to the minimap
+	if (UTacticsMinimapSubsystem* Minimap = GetWorld()->GetSubsystem<UTacticsMinimapSubsystem>())
+	{
+		Minimap->OnGatherMarkers.Remove(MinimapGatherHandle);
+	}
+
+	MinimapGatherHandle.Reset();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AStrategyHUD::DragSelectUpdate(FVector2D Start, FVector2D WidthAndHeight, FVector2D CurrentPosition, bool bDraw)
@@ -41,37 +120,89 @@ void AStrategyHUD::DrawHUD()
 		{
 			DrawRect(SelectionBoxColor, BoxStart.X, BoxStart.Y, BoxSize.X, BoxSize.Y);
 
-			// get all the units in the selection box
+			// get all the units in the selection box from the unit registry
 			TArray<AStrategyUnit*> BoxedUnits;
-			GetActorsInSelectionRectangle(BoxStart, BoxCurrentPosition, BoxedUnits, true);
+			PC->GetUnitsInScreenRect(BoxStart, BoxCurrentPosition, BoxedUnits);
 
 			// update the unit selection on the player controller
 			PC->DragSelectUnits(BoxedUnits);
 		}
 
-		// get the currently selected units
-		TArray<AStrategyUnit*> SelectedUnits = PC->GetSelectedUnits();
+		// get the currently selected units. These include crowd units without an actor
+		const FStrategyUnitSet& SelectedUnits = PC->GetSelectedUnitIds();
 
 		// update the selection count on the UI widget
 		UIWidget->SetSelectedUnitsCount(SelectedUnits.Num());
 
-		// process each selected unit
-		for (AStrategyUnit* CurrentUnit : SelectedUnits)
+		// mark the selected units
+		if (!SelectionRingMesh.Get())
 		{
-			if (IsValid(CurrentUnit))
+			// no ring mesh, so label the selected units on screen instead
+			for (AStrategyUnit* CurrentUnit : PC->GetSelectedUnits())
 			{
-				// project the unit's location to screen coordinates
 				FVector2D ScreenCoords;
 
-				if (PC->ProjectWorldLocationToScreen(CurrentUnit->GetActorLocation(), ScreenCoords, true))
+				if (IsValid(CurrentUnit) && PC->ProjectWorldLocationToScreen(CurrentUnit->GetActorLocation(), ScreenCoords, true))
 				{
-					// draw a selection string near the unit
-					const FString SelectionString = "Selected";
-					DrawText(SelectionString, FColor::White, ScreenCoords.X - 25.0f, ScreenCoords.Y + 25.0f, nullptr, 1.5f);
+					DrawText(TEXT("Selected"), FColor::White, ScreenCoords.X - 25.0f, ScreenCoords.Y + 25.0f, nullptr, 1.5f);
 				}
 			}
-			
+
+		} else if (UStrategySelectionIndicators* Indicators = GetWorld()->GetSubsystem<UStrategySelectionIndicators>()) {
+
+			// the rings are only rebuilt when the selection changes
+			Indicators->Update(SelectedUnits, PC->GetSelectionSerial());
 		}
+
+		// show the minimap. The texture changes if the minimap is resized
+		if (UTacticsMinimapSubsystem* Minimap = GetWorld()->GetSubsystem<UTacticsMinimapSubsystem>())
+		{
+			UIWidget->SetMinimapTexture(Minimap->GetTexture());
+		}
+	}
+
+}
+
+void AStrategyHUD::GatherMinimapMarkers(FTacticsMinimapRaster& Raster)
+{
+	const UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>();
+
+	if (!Registry)
+	{
+		return;
 	}
 
+	const UStrategyFogOfWar* Fog = GetWorld()->GetSubsystem<UStrategyFogOfWar>();
+	const uint8 PlayerTeam = Fog ? Fog->GetPlayerTeam() : 0;
+
+	const AStrategyPlayerController* PC = Cast<AStrategyPlayerController>(GetOwningPlayerController());
+
+	for (const int32 UnitId : Registry->GetUnitIds())
+	{
+		// skip units hidden by the fog of war
+		if (Fog && !Fog->IsUnitVisible(UnitId))
+		{
+			continue;
+		}
+
+		FVector Location;
+
+		if (!Registry->GetUnitLocation(UnitId, Location))
+		{
+			continue;
+		}
+
+		FColor Color = MinimapEnemyColor;
+
+		if (PC && PC->GetSelectedUnitIds().Contains(UnitId))
+		{
+			Color = MinimapSelectedColor;
+
+		} else if (Registry->GetUnitTeam(UnitId) == PlayerTeam) {
+
+			Color = MinimapFriendlyColor;
+		}
+
+		Raster.AddMarker(FVector2D(Location), Color, MinimapUnitRadius);
+	}
 }
@@ -4,16 +4,23 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/HUD.h"
+#include "TacticsAssetPreloader.h"
 #include "StrategyHUD.generated.h"
 
 class UStrategyUI;
+class UStaticMesh;
+class UMaterialInterface;
+class FTacticsMinimapRaster;
 
 /**
  *  Simple strategy game HUD
  *  Draws the selection box and unit selected overlays
+ *  Selected units are marked with world space rings, drawn by the selection indicators subsystem.
+ *  Without a ring mesh, selected units get a "Selected" label instead
+ *  Adds the registered units to the minimap and passes the minimap texture to the UI widget
  */
 UCLASS(abstract)
-class AStrategyHUD : public AHUD
+class AStrategyHUD : public AHUD, public ITacticsPreloadSource
 {
 	GENERATED_BODY()
 	
@@ -42,11 +49,60 @@ protected:
 	UPROPERTY(EditAnywhere, Category="UI")
 	FLinearColor SelectionBoxColor;
 
+	/** Mesh drawn under each selected unit, preloaded by UTacticsAssetPreloader. Defaults to the engine plane. If cleared or missing, selected units are labeled on screen instead */
+	UPROPERTY(EditAnywhere, Category="UI|Selection")
+	TSoftObjectPtr<UStaticMesh> SelectionRingMesh;
+
+	/** Optional material override for the selection rings, preloaded with the mesh */
+	UPROPERTY(EditAnywhere, Category="UI|Selection")
+	TSoftObjectPtr<UMaterialInterface> SelectionRingMaterial;
+
+	/** Uniform scale of the selection rings */
+	UPROPERTY(EditAnywhere, Category="UI|Selection", meta = (ClampMin = 0.01, ClampMax = 10))
+	float SelectionRingScale = 1.0f;
+
+	/** Distance from the unit's origin down to the selection ring */
+	UPROPERTY(EditAnywhere, Category="UI|Selection", meta = (ClampMin = 0, ClampMax = 500, Units = "cm"))
+	float SelectionRingHeightOffset = 88.0f;
+
+	/** Minimap color of the player's units */
+	UPROPERTY(EditAnywhere, Category="UI|Minimap")
+	FColor MinimapFriendlyColor = FColor(60, 160, 255);
+
+	/** Minimap color of other teams' units */
+	UPROPERTY(EditAnywhere, Category="UI|Minimap")
+	FColor MinimapEnemyColor = FColor(220, 50, 40);
+
+	/** Minimap color of selected units */
+	UPROPERTY(EditAnywhere, Category="UI|Minimap")
+	FColor MinimapSelectedColor = FColor::White;
+
+	/** Radius of a unit marker on the minimap, in pixels */
+	UPROPERTY(EditAnywhere, Category="UI|Minimap", meta = (ClampMin = 0, ClampMax = 8))
+	int32 MinimapUnitRadius = 1;
+
+	/** Handle for the minimap marker gathering */
+	FDelegateHandle MinimapGatherHandle;
+
 public:
 
+	/** Constructor */
+	AStrategyHUD();
+
+	/** Get the selection ring assets to preload */
+	virtual void GetPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const override;
+
+#if WITH_EDITOR
+	/** Validate that the selection ring assets exist */
+	virtual EDataValidationResult IsDataValid(class FDataValidationContext& Context) const override;
+#endif
+
 	/** Initialization */
 	virtual void BeginPlay() override;
 
+	/** Cleanup */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/** Updates the drag selection box */
 	void DragSelectUpdate(FVector2D Start, FVector2D WidthAndHeight, FVector2D CurrentPosition, bool bDraw);
 
@@ -54,4 +110,7 @@ protected:
 
 	/** Draws the HUD */
 	virtual void DrawHUD() override;
+
+	/** Adds a marker for every registered unit the player can see to the minimap */
+	void GatherMinimapMarkers(FTacticsMinimapRaster& Raster);
 };
@@ -0,0 +1,358 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategySelectionIndicators.h"
+#include "StrategyUnitRegistry.h"
+#include "StrategyUnitSet.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+#include "TacticsAutomation.h"
+#include "Tactics.h"
+
+void UStrategySelectionIndicators::Configure(UStaticMesh* Mesh, UMaterialInterface* Material, float Scale, float HeightOffset)
+{
+	RingScale = Scale;
+	RingHeightOffset = HeightOffset;
+
+	if (EnsureRings())
+	{
+		Rings->SetStaticMesh(Mesh);
+
+		if (Material)
+		{
+			Rings->SetMaterial(0, Material);
+		}
+	}
+
+	// place the rings again with the new settings
+	BuiltSerial = MAX_uint32;
+}
+
+void UStrategySelectionIndicators::Update(const FStrategyUnitSet& Selection, uint32 SelectionSerial)
+{
+	if (!EnsureRings())
+	{
+		return;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategySelectionIndicators_Update);
+
+	if (SelectionSerial != BuiltSerial)
+	{
+		BuiltSerial = SelectionSerial;
+		Rebuild(Selection);
+
+	} else {
+
+		RefreshMoved();
+	}
+}
+
+void UStrategySelectionIndicators::Deinitialize()
+{
+	UnitIds.Empty();
+	UnitLocations.Empty();
+	RingTransforms.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UStrategySelectionIndicators::EnsureRings()
+{
+	if (Rings)
+	{
+		return true;
+	}
+
+	UWorld* World = GetWorld();
+	UnitRegistry = World->GetSubsystem<UStrategyUnitRegistry>();
+
+	if (!UnitRegistry || !World->IsGameWorld())
+	{
+		return false;
+	}
+
+	// set up the instanced mesh on a transient actor
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	RenderActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+
+	if (!RenderActor)
+	{
+		return false;
+	}
+
+	Rings = NewObject<UInstancedStaticMeshComponent>(RenderActor, TEXT("SelectionRings"));
+	Rings->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Rings->SetCanEverAffectNavigation(false);
+	Rings->SetCastShadow(false);
+	Rings->SetMobility(EComponentMobility::Movable);
+
+	RenderActor->SetRootComponent(Rings);
+	Rings->RegisterComponent();
+
+	return true;
+}
+
+void UStrategySelectionIndicators::Rebuild(const FStrategyUnitSet& Selection)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_StrategySelectionIndicators_Rebuild);
+
+	UnitIds.Reset();
+	UnitLocations.Reset();
+	RingTransforms.Reset();
+
+	Selection.ForEachId([this](int32 UnitId)
+	{
+		FVector Location;
+
+		if (UnitRegistry->GetUnitLocation(UnitId, Location))
+		{
+			UnitIds.Add(UnitId);
+			UnitLocations.Add(Location);
+			RingTransforms.Add(GetRingTransform(Location));
+		}
+	});
+
+	// reuse the instances when the count matches, otherwise start over
+	if (Rings->GetInstanceCount() == RingTransforms.Num())
+	{
+		Rings->BatchUpdateInstancesTransforms(0, RingTransforms, true, true);
+
+	} else {
+
+		Rings->ClearInstances();
+		Rings->AddInstances(RingTransforms, false, true);
+	}
+}
+
+int32 UStrategySelectionIndicators::RefreshMoved()
+{
+	const float ToleranceSquared = FMath::Square(MoveTolerance);
+	int32 NumMoved = 0;
+
+	for (int32 Index = 0; Index < UnitIds.Num(); ++Index)
+	{
+		FVector Location;
+
+		if (UnitRegistry->GetUnitLocation(UnitIds[Index], Location) && FVector::DistSquared(Location, UnitLocations[Index]) > ToleranceSquared)
+		{
+			UnitLocations[Index] = Location;
+			RingTransforms[Index] = GetRingTransform(Location);
+
+			// defer the render state update until all rings are moved
+			Rings->UpdateInstanceTransform(Index, RingTransforms[Index], true, false, true);
+			++NumMoved;
+		}
+	}
+
+	if (NumMoved > 0)
+	{
+		Rings->MarkRenderStateDirty();
+	}
+
+	return NumMoved;
+}
+
+FTransform UStrategySelectionIndicators::GetRingTransform(const FVector& UnitLocation) const
+{
+	return FTransform(FQuat::Identity, UnitLocation - FVector(0.0f, 0.0f, RingHeightOffset), FVector(RingScale));
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+bool UStrategySelectionIndicators::RunBenchmark(int32 NumUnits, int32 NumIterations, UStrategyUnitRegistry* PlaceholderRegistry, FBenchmarkResult& OutResult)
+{
+	OutResult = FBenchmarkResult();
+
+	if (!EnsureRings() || !PlaceholderRegistry || PlaceholderRegistry == UnitRegistry || NumUnits <= 0 || NumIterations <= 0)
+	{
+		return false;
+	}
+
+	// point the rings at the placeholder registry while the benchmark runs, so the placeholders never reach the game's systems
+	UStrategyUnitRegistry* GameRegistry = UnitRegistry;
+	UnitRegistry = PlaceholderRegistry;
+
+	// register placeholder units spread over a square, roughly a unit per 2m
+	const float HalfSide = FMath::Sqrt(float(NumUnits)) * 100.0f;
+
+	FStrategyUnitSet Selection;
+	TArray<int32> PlaceholderIds;
+	TArray<FVector> PlaceholderLocations;
+
+	for (int32 Index = 0; Index < NumUnits; ++Index)
+	{
+		const FVector Location(FMath::FRandRange(-HalfSide, HalfSide), FMath::FRandRange(-HalfSide, HalfSide), 0.0f);
+		const int32 UnitId = UnitRegistry->RegisterCrowdUnit(Location);
+
+		Selection.Add(UnitId);
+		PlaceholderIds.Add(UnitId);
+		PlaceholderLocations.Add(Location);
+	}
+
+	// selection changed: full rebuild
+	double StartTime = FPlatformTime::Seconds();
+
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		Rebuild(Selection);
+	}
+
+	OutResult.RebuildMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumIterations;
+	OutResult.NumRings = Rings->GetInstanceCount();
+
+	// nothing moved: only the location checks
+	StartTime = FPlatformTime::Seconds();
+
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		OutResult.NumIdleUpdates += RefreshMoved();
+	}
+
+	OutResult.IdleMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumIterations;
+
+	// everyone moved: every ring is updated. Moving the placeholders isn't timed
+	double MovedSeconds = 0.0;
+	OutResult.NumMovedUpdates = NumUnits;
+
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		const FVector Offset((Iteration % 2 == 0) ? 10.0f : 0.0f, 0.0f, 0.0f);
+
+		for (int32 Index = 0; Index < PlaceholderIds.Num(); ++Index)
+		{
+			UnitRegistry->SetCrowdUnitLocation(PlaceholderIds[Index], PlaceholderLocations[Index] + Offset);
+		}
+
+		StartTime = FPlatformTime::Seconds();
+		const int32 NumMoved = RefreshMoved();
+		MovedSeconds += FPlatformTime::Seconds() - StartTime;
+
+		OutResult.NumMovedUpdates = FMath::Min(OutResult.NumMovedUpdates, NumMoved);
+	}
+
+	OutResult.MovedMs = MovedSeconds * 1000.0 / NumIterations;
+
+	// the old HUD path for comparison: a projection and a string per unit. Canvas drawing isn't included
+	if (const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController())
+	{
+		int32 Checksum = 0;
+		StartTime = FPlatformTime::Seconds();
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			for (const FVector& Location : PlaceholderLocations)
+			{
+				FVector2D ScreenCoords;
+
+				if (PlayerController->ProjectWorldLocationToScreen(Location, ScreenCoords, true))
+				{
+					const FString SelectionString = "Selected";
+					Checksum += SelectionString.Len();
+				}
+			}
+		}
+
+		OutResult.LegacyMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumIterations;
+
+		UE_LOG(LogTactics, Verbose, TEXT("Selection indicator benchmark checksum %d"), Checksum);
+	}
+
+	UE_LOG(LogTactics, Display, TEXT("Selection indicators, %d units: rebuild %.3f ms, idle %.3f ms, all moved %.3f ms. Legacy projection and string %.3f ms"),
+		NumUnits, OutResult.RebuildMs, OutResult.IdleMs, OutResult.MovedMs, OutResult.LegacyMs);
+
+	// clear out the placeholders and go back to the game's registry. The next update rebuilds the rings for the real selection
+	for (const int32 UnitId : PlaceholderIds)
+	{
+		UnitRegistry->UnregisterCrowdUnit(UnitId);
+	}
+
+	UnitRegistry = GameRegistry;
+	BuiltSerial = MAX_uint32;
+
+	return true;
+}
+
+/** Number of timed updates per placeholder count */
+static constexpr int32 SelectionBenchmarkIterations = 100;
+
+/** Seconds the benchmark waits for a game world */
+static constexpr double SelectionBenchmarkStartTimeout = 30.0;
+
+/**
+ *  Runs the selection indicator benchmark at 50, 500 and 5000 placeholder units once a game world is up,
+ *  and checks that the rings are only touched when the selection or the units change
+ */
+class FSelectionBenchmarkCommand : public IAutomationLatentCommand
+{
+public:
+	explicit FSelectionBenchmarkCommand(FAutomationTestBase* InTest)
+		: Test(InTest)
+	{
+	}
+
+	virtual bool Update() override
+	{
+		UWorld* World = TacticsAutomation::FindGameWorld();
+		UStrategySelectionIndicators* Indicators = World && World->HasBegunPlay() ? World->GetSubsystem<UStrategySelectionIndicators>() : nullptr;
+
+		// wait for the map to start playing
+		if (!Indicators)
+		{
+			if (GetCurrentRunTime() > SelectionBenchmarkStartTimeout)
+			{
+				Test->AddError(TEXT("No game world started playing. Run the test in -game or PIE."));
+				return true;
+			}
+
+			return false;
+		}
+
+		// the placeholders go in the registry of a scratch world, so the game's registry never sees them
+		UWorld* ScratchWorld = TacticsAutomation::CreateScratchWorld();
+		UStrategyUnitRegistry* PlaceholderRegistry = ScratchWorld->GetSubsystem<UStrategyUnitRegistry>();
+
+		for (const int32 NumUnits : { 50, 500, 5000 })
+		{
+			UStrategySelectionIndicators::FBenchmarkResult Result;
+
+			if (!Indicators->RunBenchmark(NumUnits, SelectionBenchmarkIterations, PlaceholderRegistry, Result))
+			{
+				Test->AddError(TEXT("The selection rings couldn't be created"));
+				break;
+			}
+
+			Test->AddInfo(FString::Printf(TEXT("%d units: rebuild %.3f ms, idle %.3f ms, all moved %.3f ms. Legacy projection and string %.3f ms"),
+				NumUnits, Result.RebuildMs, Result.IdleMs, Result.MovedMs, Result.LegacyMs));
+
+			Test->TestEqual(FString::Printf(TEXT("Rings built for %d units"), NumUnits), Result.NumRings, NumUnits);
+			Test->TestEqual(FString::Printf(TEXT("Rings updated with %d idle units"), NumUnits), Result.NumIdleUpdates, 0);
+			Test->TestEqual(FString::Printf(TEXT("Rings updated with %d moving units"), NumUnits), Result.NumMovedUpdates, NumUnits);
+		}
+
+		TacticsAutomation::DestroyScratchWorld(ScratchWorld);
+
+		return true;
+	}
+
+private:
+	/** Test to report to */
+	FAutomationTestBase* Test;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSelectionIndicatorsBenchmarkTest, "Tactics.Selection.Benchmark", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSelectionIndicatorsBenchmarkTest::RunTest(const FString& Parameters)
+{
+	TacticsAutomation::OpenDefaultMapIfNeeded();
+
+	ADD_LATENT_AUTOMATION_COMMAND(FSelectionBenchmarkCommand(this));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
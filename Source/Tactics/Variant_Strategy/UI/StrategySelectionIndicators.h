@@ -0,0 +1,115 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategySelectionIndicators.generated.h"
+
+class UInstancedStaticMeshComponent;
+class UMaterialInterface;
+class UStaticMesh;
+class UStrategyUnitRegistry;
+struct FStrategyUnitSet;
+
+/**
+ *  Draws a ring under every selected unit with a single instanced mesh.
+ *  Ring locations come from the unit registry, so crowd units get rings too.
+ *  The instances are rebuilt only when the selection changes. Otherwise only the rings of units that moved are updated,
+ *  and the render state is marked dirty once for all of them.
+ */
+UCLASS()
+class UStrategySelectionIndicators : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+#if WITH_DEV_AUTOMATION_TESTS
+	/** Timings and ring counts from a benchmark run */
+	struct FBenchmarkResult
+	{
+		/** Average time per update, in milliseconds */
+		double RebuildMs = 0.0;
+		double IdleMs = 0.0;
+		double MovedMs = 0.0;
+
+		/** Average time of the old HUD path, a projection and a string per unit. Zero without a player controller */
+		double LegacyMs = 0.0;
+
+		/** Number of rings after a rebuild */
+		int32 NumRings = 0;
+
+		/** Total number of rings updated while no unit moved */
+		int32 NumIdleUpdates = 0;
+
+		/** Smallest number of rings updated while every unit moved */
+		int32 NumMovedUpdates = 0;
+	};
+#endif
+
+	/** Sets the ring mesh and how it's placed under each unit */
+	void Configure(UStaticMesh* Mesh, UMaterialInterface* Material, float Scale, float HeightOffset);
+
+	/** Rebuilds the rings if the selection serial changed, otherwise moves the rings of units that moved */
+	void Update(const FStrategyUnitSet& Selection, uint32 SelectionSerial);
+
+#if WITH_DEV_AUTOMATION_TESTS
+	/**
+	 *  Times the ring updates for a number of placeholder selected units and logs the results.
+	 *  The placeholders go in the given registry, which must not be the game's, so the game's units and systems aren't touched.
+	 *  Returns false if the rings can't be created
+	 */
+	bool RunBenchmark(int32 NumUnits, int32 NumIterations, UStrategyUnitRegistry* PlaceholderRegistry, FBenchmarkResult& OutResult);
+#endif
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+
+protected:
+
+	/** Actor holding the instanced mesh */
+	UPROPERTY(Transient)
+	TObjectPtr<AActor> RenderActor;
+
+	/** Instanced ring mesh */
+	UPROPERTY(Transient)
+	TObjectPtr<UInstancedStaticMeshComponent> Rings;
+
+	/** Unit registry for this world */
+	UPROPERTY(Transient)
+	TObjectPtr<UStrategyUnitRegistry> UnitRegistry;
+
+	/** Uniform scale of each ring */
+	float RingScale = 1.0f;
+
+	/** Distance from the unit's origin down to the ring */
+	float RingHeightOffset = 0.0f;
+
+	/** Distance a unit has to move before its ring is updated */
+	static constexpr float MoveTolerance = 1.0f;
+
+	/** Selection serial the rings were built for */
+	uint32 BuiltSerial = MAX_uint32;
+
+	/** Unit id for each ring */
+	TArray<int32> UnitIds;
+
+	/** Unit location each ring was placed at */
+	TArray<FVector> UnitLocations;
+
+	/** Ring transforms */
+	TArray<FTransform> RingTransforms;
+
+	/** Spawns the render actor and instanced mesh if needed. Returns false if they can't be created */
+	bool EnsureRings();
+
+	/** Rebuilds all rings for a selection */
+	void Rebuild(const FStrategyUnitSet& Selection);
+
+	/** Moves the rings of units that moved. Returns the number of rings updated */
+	int32 RefreshMoved();
+
+	/** Returns the ring transform for a unit location */
+	FTransform GetRingTransform(const FVector& UnitLocation) const;
+};
@@ -2,6 +2,8 @@
 
 
 #include "StrategyUI.h"
+#include "Components/Image.h"
+#include "Engine/Texture2D.h"
 
 void UStrategyUI::SetSelectedUnitsCount(int32 Count)
 {
@@ -17,3 +19,12 @@ void UStrategyUI::SetSelectedUnitsCount(int32 Count)
 		BP_UpdateUnitsCount();
 	}
 }
+
+void UStrategyUI::SetMinimapTexture(UTexture2D* Texture)
+{
+	// only update the brush if the texture changed
+	if (Minimap && Texture && Minimap->GetBrush().GetResourceObject() != Texture)
+	{
+		Minimap->SetBrushFromTexture(Texture);
+	}
+}
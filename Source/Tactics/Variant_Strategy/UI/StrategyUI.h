@@ -6,9 +6,13 @@
 #include "Blueprint/UserWidget.h"
 #include "StrategyUI.generated.h"
 
+class UImage;
+class UTexture2D;
+
 /**
  *  Simple UI widget for the strategy game
  *	Keeps track of the number of units currently selected
+ *	and shows the minimap texture, if the widget has a minimap image
  */
 UCLASS(abstract)
 class UStrategyUI : public UUserWidget
@@ -20,11 +24,18 @@ protected:
 	/** Number of units currently selected */
 	int32 SelectedUnitCount = 0;
 
+	/** Optional image showing the minimap */
+	UPROPERTY(meta = (BindWidgetOptional))
+	TObjectPtr<UImage> Minimap;
+
 public:
 
 	/** Sets the number of units selected */
 	void SetSelectedUnitsCount(int32 Count);
 
+	/** Sets the texture shown by the minimap image */
+	void SetMinimapTexture(UTexture2D* Texture);
+
 	/** Blueprint handler to update unit count sub-widgets */
 	UFUNCTION(BlueprintImplementableEvent, Category="UI", meta = (DisplayName="Update Units Count"))
 	void BP_UpdateUnitsCount();
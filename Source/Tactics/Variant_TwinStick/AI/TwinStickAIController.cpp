@@ -16,4 +16,16 @@ ATwinStickAIController::ATwinStickAIController()
 	// ensure we're attached to the possessed character.
 	// this is necessary for EnvQueries to work correctly
 	bAttachToPawn = true;
-}
\ No newline at end of file
+}
+
+void ATwinStickAIController::RestartStateTree()
+{
+	// restart the StateTree logic
+	StateTreeAI->RestartLogic();
+}
+
+void ATwinStickAIController::StopStateTree()
+{
+	// stop the StateTree logic
+	StateTreeAI->StopLogic(TEXT("Pooled"));
+}
@@ -25,4 +25,10 @@ public:
 
 	/** Constructor */
 	ATwinStickAIController();
+
+	/** Starts the StateTree over from its root state, so a reused NPC doesn't pick up where it left off */
+	void RestartStateTree();
+
+	/** Stops the StateTree while the NPC is out of play */
+	void StopStateTree();
 };
@@ -10,6 +10,7 @@
 #include "TwinStickPickup.h"
 #include "Engine/World.h"
 #include "TwinStickNPCDestruction.h"
+#include "TwinStickAIController.h"
 #include "TimerManager.h"
 
 ATwinStickNPC::ATwinStickNPC()
@@ -44,10 +45,7 @@ void ATwinStickNPC::BeginPlay()
 	Super::BeginPlay();
 
 	// increment the NPC counter so we can cap spawning if necessary
-	if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
-	{
-		GM->IncreaseNPCs();
-	}
+	SetCountedNPC(true);
 
 }
 
@@ -62,12 +60,53 @@ void ATwinStickNPC::EndPlay(EEndPlayReason::Type EndPlayReason)
 void ATwinStickNPC::Destroyed()
 {
 	// decrease the NPC counter so we can cap spawning if necessary
-	if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
+	SetCountedNPC(false);
+
+	Super::Destroyed();
+}
+
+void ATwinStickNPC::OnAcquiredFromPool_Implementation()
+{
+	// count towards the NPC cap again
+	SetCountedNPC(true);
+
+	// lower the hit flag
+	bHit = false;
+
+	// reactivate character movement
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->Activate(true);
+
+	// make sure we have an AI controller, in case it was lost while pooled
+	if (!GetController())
 	{
-		GM->DecreaseNPCs();
+		SpawnDefaultController();
 	}
 
-	Super::Destroyed();
+	// run the StateTree from the start
+	if (ATwinStickAIController* AIController = Cast<ATwinStickAIController>(GetController()))
+	{
+		AIController->RestartStateTree();
+	}
+}
+
+void ATwinStickNPC::OnReleasedToPool_Implementation()
+{
+	// stop counting towards the NPC cap
+	SetCountedNPC(false);
+
+	// clear the destruction timer
+	GetWorld()->GetTimerManager().ClearTimer(DestructionTimer);
+
+	// deactivate character movement
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->Deactivate();
+
+	// stop the StateTree while we're out of play
+	if (ATwinStickAIController* AIController = Cast<ATwinStickAIController>(GetController()))
+	{
+		AIController->StopStateTree();
+	}
 }
 
 void ATwinStickNPC::NotifyHit(class UPrimitiveComponent* MyComp, AActor* Other, class UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit)
@@ -100,10 +139,12 @@ void ATwinStickNPC::ProjectileImpact(const FVector& ForwardVector)
 		GM->ScoreUpdate(Score);
 	}
 
+	UActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+
 	// randomly spawn a pickup
 	if (FMath::RandRange(0, 100) < PickupSpawnChance)
 	{
-		ATwinStickPickup* Pickup = GetWorld()->SpawnActor<ATwinStickPickup>(PickupClass, GetActorTransform());
+		ATwinStickPickup* Pickup = ActorPool->AcquireActor<ATwinStickPickup>(PickupClass, GetActorTransform());
 	}
 	
 	// spawn the NPC destruction proxy
@@ -121,6 +162,29 @@ void ATwinStickNPC::ProjectileImpact(const FVector& ForwardVector)
 
 void ATwinStickNPC::DeferredDestroy()
 {
-	// destroy this actor
-	Destroy();
+	// return this actor to the pool, or destroy it if it was placed in the level
+	UActorPoolSubsystem::ReleaseOrDestroy(this);
+}
+
+void ATwinStickNPC::SetCountedNPC(bool bCounted)
+{
+	// skip if the count is already up to date
+	if (bCountedNPC == bCounted)
+	{
+		return;
+	}
+
+	if (ATwinStickGameMode* GM = Cast<ATwinStickGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		bCountedNPC = bCounted;
+
+		if (bCounted)
+		{
+			GM->IncreaseNPCs();
+
+		} else {
+
+			GM->DecreaseNPCs();
+		}
+	}
 }
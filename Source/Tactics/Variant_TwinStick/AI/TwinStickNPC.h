@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "ActorPoolSubsystem.h"
 #include "TwinStickNPC.generated.h"
 
 class ATwinStickPickup;
@@ -13,9 +14,10 @@ class ATwinStickNPCDestruction;
  *  A simple enemy NPC for a Twin Stick Shooter game
  *  It's driven by an AI Controller running a behavior tree
  *  Awards points and randomly spawns pickups on death
+ *  NPCs and their pickups are recycled through the actor pool, while destruction proxies are spawned fresh
  */
 UCLASS(abstract)
-class ATwinStickNPC : public ACharacter
+class ATwinStickNPC : public ACharacter, public IPooledActor
 {
 	GENERATED_BODY()
 
@@ -44,6 +46,9 @@ protected:
 	/** Deferred destruction timer */
 	FTimerHandle DestructionTimer;
 
+	/** If true, this NPC counts towards the game mode's NPC cap */
+	bool bCountedNPC = false;
+
 public:
 
 	/** If true, this NPC has already been hit by a projectile and is being destroyed. Exposed to BP so it can be read by StateTree */
@@ -66,6 +71,10 @@ protected:
 	/** Handle destruction */
 	virtual void Destroyed() override;
 
+	/** Pool handling */
+	virtual void OnAcquiredFromPool_Implementation() override;
+	virtual void OnReleasedToPool_Implementation() override;
+
 	/** Collision handling */
 	virtual void NotifyHit(class UPrimitiveComponent* MyComp, AActor* Other, class UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit) override;
 
@@ -78,4 +87,7 @@ protected:
 
 	/** Called from timer to complete the destruction process for this NPC */
 	void DeferredDestroy();
+
+	/** Adds or removes this NPC from the game mode's NPC count */
+	void SetCountedNPC(bool bCounted);
 };
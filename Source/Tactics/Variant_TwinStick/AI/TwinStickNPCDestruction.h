@@ -10,6 +10,7 @@
  *  A NPC destruction proxy for a Twin Stick Shooter game
  *  Replaces the NPC when it is destroyed,
  *  allowing it to play effects without affecting gameplay 
+ *  Not pooled: its broken pieces and Blueprint BeginPlay effects can't be rewound, so each death spawns a fresh proxy
  */
 UCLASS(abstract)
 class ATwinStickNPCDestruction : public AActor
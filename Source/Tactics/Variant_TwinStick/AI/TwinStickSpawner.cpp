@@ -9,6 +9,8 @@
 #include "Kismet/GameplayStatics.h"
 #include "TwinStickNPC.h"
 #include "TwinStickGameMode.h"
+#include "NavQueryBroker.h"
+#include "ActorPoolSubsystem.h"
 
 ATwinStickSpawner::ATwinStickSpawner()
 {
@@ -47,6 +49,17 @@ void ATwinStickSpawner::EndPlay(EEndPlayReason::Type EndPlayReason)
 	// clear the spawn timers
 	GetWorld()->GetTimerManager().ClearTimer(SpawnGroupTimer);
 	GetWorld()->GetTimerManager().ClearTimer(SpawnNPCTimer);
+
+	// drop the pending spawn point queries
+	if (UNavQueryBroker* Broker = GetWorld()->GetSubsystem<UNavQueryBroker>())
+	{
+		for (const uint32 QueryId : PendingSpawnQueries)
+		{
+			Broker->CancelQuery(QueryId);
+		}
+	}
+
+	PendingSpawnQueries.Reset();
 }
 
 void ATwinStickSpawner::SpawnNPCGroup()
@@ -66,16 +79,16 @@ void ATwinStickSpawner::SpawnNPCGroup()
 
 void ATwinStickSpawner::SpawnNPC()
 {
-	FTransform SpawnTransform;
-
-	// find a random point around the spawner
-	FVector SpawnLoc;
-	if (UNavigationSystemV1::K2_GetRandomReachablePointInRadius(GetWorld(), GetActorLocation(), SpawnLoc, SpawnRadius, NavData))
+	// queue a query for a random point around the spawner. Spawns can wait, so use a low priority
+	if (UNavQueryBroker* Broker = GetWorld()->GetSubsystem<UNavQueryBroker>())
 	{
-		SpawnTransform.SetLocation(SpawnLoc);
+		const uint32 QueryId = Broker->RequestRandomPoint(GetActorLocation(), SpawnRadius, true, NavData, ENavQueryPriority::Low,
+			FNavQueryPointDelegate::CreateUObject(this, &ATwinStickSpawner::OnSpawnPointFound));
 
-		// spawn the NPC
-		ATwinStickNPC* NPC = GetWorld()->SpawnActor<ATwinStickNPC>(NPCClass, SpawnTransform);
+		if (QueryId != INVALID_NAVQUERYID)
+		{
+			PendingSpawnQueries.Add(QueryId);
+		}
 	}
 
 	// increase the spawn counter
@@ -88,3 +101,19 @@ void ATwinStickSpawner::SpawnNPC()
 	}
 
 }
+
+void ATwinStickSpawner::OnSpawnPointFound(uint32 QueryId, bool bSuccess, const FVector& SpawnLoc)
+{
+	// the query is done
+	PendingSpawnQueries.RemoveSwap(QueryId);
+
+	// did we find a point around the spawner?
+	if (bSuccess)
+	{
+		FTransform SpawnTransform;
+		SpawnTransform.SetLocation(SpawnLoc);
+
+		// take the NPC from the pool, spawning it if none are free
+		ATwinStickNPC* NPC = GetWorld()->GetSubsystem<UActorPoolSubsystem>()->AcquireActor<ATwinStickNPC>(NPCClass, SpawnTransform);
+	}
+}
@@ -55,6 +55,9 @@ protected:
 	/** Pointer to the recast nav mesh actor, used to provide NPC spawn locations */
 	TObjectPtr<ARecastNavMesh> NavData;
 
+	/** Spawn point queries waiting in the navigation query broker */
+	TArray<uint32> PendingSpawnQueries;
+
 public:	
 
 	/** Constructor */
@@ -73,7 +76,10 @@ protected:
 	/** Spawns a new NPC group */
 	void SpawnNPCGroup();
 
-	/** Spawns an individual NPC */
+	/** Requests a spawn point for an individual NPC */
 	void SpawnNPC();
 
+	/** Spawns an individual NPC once its spawn point is ready */
+	void OnSpawnPointFound(uint32 QueryId, bool bSuccess, const FVector& SpawnLoc);
+
 };
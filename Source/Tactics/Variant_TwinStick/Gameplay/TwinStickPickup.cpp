@@ -6,6 +6,7 @@
 #include "Components/SphereComponent.h"
 #include "TwinStickCharacter.h"
 #include "Components/StaticMeshComponent.h"
+#include "ActorPoolSubsystem.h"
 
 ATwinStickPickup::ATwinStickPickup()
 {
@@ -43,7 +44,7 @@ void ATwinStickPickup::NotifyActorBeginOverlap(AActor* OtherActor)
 		// give the pickup to the player
 		PlayerCharacter->AddPickup();
 
-		// destroy this pickup
-		Destroy();
+		// return this pickup to the pool, or destroy it if it was placed in the level
+		UActorPoolSubsystem::ReleaseOrDestroy(this);
 	}
 }
\ No newline at end of file
@@ -12,6 +12,8 @@ class UProjectileMovementComponent;
 
 /**
  *  A simple bouncing projectile for a Twin Stick shooter game
+ *  Shots are normally simulated by the projectile subsystem, which reads its settings from this class.
+ *  The actor is only spawned when that's turned off, or the class has no mesh to draw.
  */
 UCLASS(abstract)
 class ATwinStickProjectile : public AActor
@@ -35,6 +37,15 @@ public:
 	/** Constructor */
 	ATwinStickProjectile();
 
+	/** Returns the collision sphere */
+	USphereComponent* GetCollisionSphere() const { return CollisionSphere; }
+
+	/** Returns the mesh */
+	UStaticMeshComponent* GetMesh() const { return Mesh; }
+
+	/** Returns the projectile movement component */
+	UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
+
 	/** Handles collisions */
 	virtual void NotifyHit(class UPrimitiveComponent* MyComp, AActor* Other, class UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit) override;
 
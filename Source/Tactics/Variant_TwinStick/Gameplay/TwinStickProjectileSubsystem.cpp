@@ -0,0 +1,574 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "TwinStickProjectileSubsystem.h"
+#include "TwinStickProjectile.h"
+#include "TwinStickCharacter.h"
+#include "TwinStickNPC.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/SphereComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "TacticsAutomation.h"
+#include "Tactics.h"
+
+static TAutoConsoleVariable<bool> CVarProjectilesSimulate(
+	TEXT("Tactics.Projectiles.Simulate"),
+	true,
+	TEXT("If true, Twin Stick projectiles are simulated in bulk by the projectile subsystem instead of spawning an actor per shot."));
+
+/** Game thread time a tick is expected to stay under with 2,000 live projectiles. Checked by the Tactics.Projectiles.Budget test */
+static constexpr float ProjectileTickBudgetMs = 1.0f;
+
+/** Lifetime for projectile classes without a life span, so they can't pile up */
+static constexpr float DefaultProjectileLifetime = 10.0f;
+
+/** Distance a bounced projectile is pulled off the surface it hit */
+static constexpr float BouncePullback = 0.1f;
+
+bool UTwinStickProjectileSubsystem::FireProjectile(TSubclassOf<ATwinStickProjectile> ProjectileClass, const FTransform& Transform)
+{
+	if (!CVarProjectilesSimulate.GetValueOnGameThread() || !ProjectileClass)
+	{
+		return false;
+	}
+
+	const int32 TypeIndex = FindOrAddType(ProjectileClass);
+
+	if (TypeIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FProjectileType& Type = Types[TypeIndex];
+
+	// fly along the flattened forward vector, like the projectile movement component with its rotation kept vertical
+	const FVector Direction = Transform.GetRotation().GetForwardVector().GetSafeNormal2D();
+
+	Locations.Add(Transform.GetLocation());
+	Velocities.Add(Direction * Type.Speed);
+	Lifetimes.Add(Type.Lifetime);
+	TypeIndices.Add(static_cast<uint8>(TypeIndex));
+	SweepStates.Add(ESweepState::None);
+	SweepEnds.Add(Transform.GetLocation());
+
+	++NumFired;
+	MaxProjectiles = FMath::Max(MaxProjectiles, Locations.Num());
+
+	return true;
+}
+
+void UTwinStickProjectileSubsystem::DumpStats() const
+{
+	UE_LOG(LogTactics, Display, TEXT("Projectiles: %d live, %d max, %d classes. %d fired, %d bounces, %d NPC impacts. %d late sweeps, %d stale results dropped"),
+		Locations.Num(), MaxProjectiles, Types.Num(), NumFired, NumBounces, NumImpacts, NumLateSweeps, NumStaleSweeps);
+	UE_LOG(LogTactics, Display, TEXT("Tick: mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms over %d frames. %s the %.2f ms budget"),
+		TickStats.GetMean(), TickStats.GetPercentile(50.0f), TickStats.GetPercentile(99.0f), TickStats.MaxMs, TickStats.Count,
+		TickStats.GetPercentile(99.0f) <= ProjectileTickBudgetMs ? TEXT("Within") : TEXT("Over"), ProjectileTickBudgetMs);
+}
+
+void UTwinStickProjectileSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// nothing live and nothing left on screen
+	if (Locations.Num() == 0 && SweepHits.Num() == 0 && !Types.ContainsByPredicate([](const FProjectileType& Type) { return Type.NumDrawn > 0; }))
+	{
+		return;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_TwinStickProjectileSubsystem_Tick);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	ApplySweeps();
+	RemoveDeadProjectiles(DeltaTime);
+	StartSweeps(DeltaTime);
+	UpdateInstances();
+
+	TickStats.AddSample((FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+TStatId UTwinStickProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTwinStickProjectileSubsystem, STATGROUP_Tickables);
+}
+
+void UTwinStickProjectileSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(TwinStickProjectileSweep), false);
+	SweepDelegate.BindUObject(this, &UTwinStickProjectileSubsystem::OnSweepCompleted);
+}
+
+void UTwinStickProjectileSubsystem::Deinitialize()
+{
+	// sweeps still in flight are dropped along with the delegate
+	SweepDelegate.Unbind();
+
+	Types.Empty();
+	TypeInstances.Empty();
+	Locations.Empty();
+	Velocities.Empty();
+	Lifetimes.Empty();
+	TypeIndices.Empty();
+	SweepStates.Empty();
+	SweepEnds.Empty();
+	SweepHits.Empty();
+
+	Super::Deinitialize();
+}
+
+int32 UTwinStickProjectileSubsystem::FindOrAddType(TSubclassOf<ATwinStickProjectile> ProjectileClass)
+{
+	const int32 ExistingIndex = Types.IndexOfByPredicate([ProjectileClass](const FProjectileType& Type)
+	{
+		return Type.Class == ProjectileClass;
+	});
+
+	if (ExistingIndex != INDEX_NONE)
+	{
+		return ExistingIndex;
+	}
+
+	// the type index is packed into a byte
+	if (Types.Num() > MAX_uint8)
+	{
+		return INDEX_NONE;
+	}
+
+	// read the settings off the class defaults, including what the Blueprint set on the components
+	const ATwinStickProjectile* Defaults = GetDefault<ATwinStickProjectile>(ProjectileClass);
+	const USphereComponent* SphereDefaults = Defaults->GetCollisionSphere();
+	const UStaticMeshComponent* MeshDefaults = Defaults->GetMesh();
+	const UProjectileMovementComponent* MovementDefaults = Defaults->GetProjectileMovement();
+
+	if (!SphereDefaults || !MeshDefaults || !MeshDefaults->GetStaticMesh() || !MovementDefaults)
+	{
+		return INDEX_NONE;
+	}
+
+	EnsureRenderActor();
+
+	if (!RenderActor)
+	{
+		return INDEX_NONE;
+	}
+
+	FProjectileType& Type = Types.AddDefaulted_GetRef();
+	Type.Class = ProjectileClass;
+	Type.Radius = SphereDefaults->GetUnscaledSphereRadius();
+	Type.Speed = MovementDefaults->MaxSpeed > 0.0f ? FMath::Min(MovementDefaults->InitialSpeed, MovementDefaults->MaxSpeed) : MovementDefaults->InitialSpeed;
+	Type.Lifetime = Defaults->InitialLifeSpan > 0.0f ? Defaults->InitialLifeSpan : DefaultProjectileLifetime;
+	Type.bShouldBounce = MovementDefaults->bShouldBounce;
+	Type.Bounciness = MovementDefaults->Bounciness;
+	Type.Friction = MovementDefaults->Friction;
+	Type.MinBounceSpeed = MovementDefaults->BounceVelocityStopSimulatingThreshold;
+	Type.Channel = SphereDefaults->GetCollisionObjectType();
+	Type.ResponseParams = FCollisionResponseParams(SphereDefaults->GetCollisionResponseToChannels());
+	Type.MeshTransform = MeshDefaults->GetRelativeTransform();
+
+	// set up the instanced mesh with the projectile's mesh and materials
+	UInstancedStaticMeshComponent* Instances = NewObject<UInstancedStaticMeshComponent>(RenderActor);
+	Instances->SetStaticMesh(MeshDefaults->GetStaticMesh());
+	Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Instances->SetCanEverAffectNavigation(false);
+	Instances->SetMobility(EComponentMobility::Movable);
+	Instances->SetCastShadow(MeshDefaults->CastShadow);
+
+	for (int32 MaterialIndex = 0; MaterialIndex < MeshDefaults->GetNumMaterials(); ++MaterialIndex)
+	{
+		Instances->SetMaterial(MaterialIndex, MeshDefaults->GetMaterial(MaterialIndex));
+	}
+
+	if (RenderActor->GetRootComponent())
+	{
+		Instances->SetupAttachment(RenderActor->GetRootComponent());
+
+	} else {
+
+		RenderActor->SetRootComponent(Instances);
+	}
+
+	Instances->RegisterComponent();
+	TypeInstances.Add(Instances);
+
+	return Types.Num() - 1;
+}
+
+void UTwinStickProjectileSubsystem::EnsureRenderActor()
+{
+	if (RenderActor || !GetWorld())
+	{
+		return;
+	}
+
+	// the instanced meshes live on a transient actor at the origin, so instance transforms are in world space
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	RenderActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+}
+
+void UTwinStickProjectileSubsystem::ApplySweeps()
+{
+	// sweeps that hit nothing carry their projectile to their end. A sweep that hasn't come back leaves its projectile where it is
+	for (int32 Index = 0; Index < Locations.Num(); ++Index)
+	{
+		if (SweepStates[Index] == ESweepState::Done)
+		{
+			Locations[Index] = SweepEnds[Index];
+
+		} else if (SweepStates[Index] == ESweepState::Pending) {
+
+			++NumLateSweeps;
+		}
+
+		SweepStates[Index] = ESweepState::None;
+	}
+
+	// then the few that hit something
+	for (const FSweepHit& SweepHit : SweepHits)
+	{
+		const int32 Index = SweepHit.Index;
+		const FHitResult& Hit = SweepHit.Hit;
+
+		// have we hit a NPC?
+		if (ATwinStickNPC* NPC = Cast<ATwinStickNPC>(Hit.GetActor()))
+		{
+			// tell the NPC it's been hit, and drop the projectile
+			NPC->ProjectileImpact(FVector::ZeroVector);
+			Lifetimes[Index] = 0.0f;
+
+			++NumImpacts;
+			continue;
+		}
+
+		const FProjectileType& Type = Types[TypeIndices[Index]];
+
+		// the movement component stops on anything it can't bounce off, and so do we
+		if (!Type.bShouldBounce || Hit.bStartPenetrating)
+		{
+			Lifetimes[Index] = 0.0f;
+			continue;
+		}
+
+		// bounce like the projectile movement component: friction slows the tangent part, bounciness scales the reflected normal part
+		FVector& Velocity = Velocities[Index];
+		const float VelocityDotNormal = Velocity | Hit.Normal;
+
+		if (VelocityDotNormal < 0.0f)
+		{
+			const FVector ProjectedNormal = Hit.Normal * -VelocityDotNormal;
+
+			Velocity += ProjectedNormal;
+			Velocity *= FMath::Clamp(1.0f - Type.Friction, 0.0f, 1.0f);
+			Velocity += ProjectedNormal * FMath::Max(Type.Bounciness, 0.0f);
+		}
+
+		// the rest of the step is dropped, so a bounce loses at most a frame of travel
+		Locations[Index] = Hit.Location + Hit.Normal * BouncePullback;
+
+		if (Velocity.SizeSquared() < FMath::Square(Type.MinBounceSpeed))
+		{
+			Lifetimes[Index] = 0.0f;
+		}
+
+		++NumBounces;
+	}
+
+	SweepHits.Reset();
+}
+
+void UTwinStickProjectileSubsystem::RemoveDeadProjectiles(float DeltaTime)
+{
+	// walk backwards so the projectiles swapped in have already been checked
+	for (int32 Index = Locations.Num() - 1; Index >= 0; --Index)
+	{
+		Lifetimes[Index] -= DeltaTime;
+
+		if (Lifetimes[Index] <= 0.0f)
+		{
+			Locations.RemoveAtSwap(Index, EAllowShrinking::No);
+			Velocities.RemoveAtSwap(Index, EAllowShrinking::No);
+			Lifetimes.RemoveAtSwap(Index, EAllowShrinking::No);
+			TypeIndices.RemoveAtSwap(Index, EAllowShrinking::No);
+			SweepStates.RemoveAtSwap(Index, EAllowShrinking::No);
+			SweepEnds.RemoveAtSwap(Index, EAllowShrinking::No);
+		}
+	}
+}
+
+void UTwinStickProjectileSubsystem::StartSweeps(float DeltaTime)
+{
+	// whatever is still in flight from the last batch is stale from here on
+	SweepBatchSize = 0;
+
+	UWorld* World = GetWorld();
+
+	if (!World || DeltaTime <= 0.0f)
+	{
+		return;
+	}
+
+	// tag the batch, so its results can't be mistaken for another batch's after projectiles are removed
+	SweepBatchStart = NextSweepId;
+	SweepBatchSize = Locations.Num();
+	NextSweepId += static_cast<uint32>(SweepBatchSize);
+
+	// sweep each projectile's step ahead. The results usually come back at the start of the next frame
+	for (int32 Index = 0; Index < Locations.Num(); ++Index)
+	{
+		const FProjectileType& Type = Types[TypeIndices[Index]];
+
+		SweepEnds[Index] = Locations[Index] + Velocities[Index] * DeltaTime;
+		SweepStates[Index] = ESweepState::Pending;
+
+		World->AsyncSweepByChannel(EAsyncTraceType::Single, Locations[Index], SweepEnds[Index], FQuat::Identity, Type.Channel,
+			FCollisionShape::MakeSphere(Type.Radius), QueryParams, Type.ResponseParams, &SweepDelegate, SweepBatchStart + static_cast<uint32>(Index));
+	}
+}
+
+void UTwinStickProjectileSubsystem::UpdateInstances()
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_TwinStickProjectileSubsystem_UpdateInstances);
+
+	// spare instances are collapsed instead of removed, so the instance buffer is only rebuilt when it grows
+	const FTransform CollapsedTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+
+	for (int32 TypeIndex = 0; TypeIndex < Types.Num(); ++TypeIndex)
+	{
+		FProjectileType& Type = Types[TypeIndex];
+		UInstancedStaticMeshComponent* Instances = TypeInstances[TypeIndex];
+
+		InstanceTransforms.Reset();
+
+		for (int32 Index = 0; Index < Locations.Num(); ++Index)
+		{
+			if (TypeIndices[Index] == TypeIndex)
+			{
+				// rotation follows the velocity and remains vertical
+				const FQuat Rotation(FVector::UpVector, FMath::Atan2(Velocities[Index].Y, Velocities[Index].X));
+
+				InstanceTransforms.Add(Type.MeshTransform * FTransform(Rotation, Locations[Index]));
+			}
+		}
+
+		const int32 NumDrawn = InstanceTransforms.Num();
+
+		// nothing was drawn before and nothing is drawn now
+		if (!Instances || (NumDrawn == 0 && Type.NumDrawn == 0))
+		{
+			continue;
+		}
+
+		Type.NumDrawn = NumDrawn;
+
+		while (InstanceTransforms.Num() < Type.NumInstances)
+		{
+			InstanceTransforms.Add(CollapsedTransform);
+		}
+
+		if (InstanceTransforms.Num() > Type.NumInstances)
+		{
+			Instances->ClearInstances();
+			Instances->AddInstances(InstanceTransforms, false, false);
+			Type.NumInstances = InstanceTransforms.Num();
+
+		} else {
+
+			Instances->BatchUpdateInstancesTransforms(0, InstanceTransforms, false, true, true);
+		}
+	}
+}
+
+void UTwinStickProjectileSubsystem::OnSweepCompleted(const FTraceHandle& Handle, FTraceDatum& Data)
+{
+	// a result from an older batch comes back after its projectiles were removed and swapped around, so its index means nothing anymore.
+	// The subtraction wraps along with the ids
+	const uint32 BatchOffset = Data.UserData - SweepBatchStart;
+
+	if (BatchOffset >= static_cast<uint32>(SweepBatchSize))
+	{
+		++NumStaleSweeps;
+		return;
+	}
+
+	const int32 Index = static_cast<int32>(BatchOffset);
+
+	if (!SweepStates.IsValidIndex(Index) || SweepStates[Index] != ESweepState::Pending)
+	{
+		return;
+	}
+
+	SweepStates[Index] = ESweepState::Done;
+
+	if (Data.OutHits.Num() > 0 && Data.OutHits[0].bBlockingHit)
+	{
+		SweepHits.Add({ Index, Data.OutHits[0] });
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ProjectilesSpawnCommand(
+	TEXT("Tactics.Projectiles.Spawn"),
+	TEXT("Fires Twin Stick projectiles in a ring around the player's character, to load test the projectile subsystem. Usage: Tactics.Projectiles.Spawn [Count]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UTwinStickProjectileSubsystem* Projectiles = World ? World->GetSubsystem<UTwinStickProjectileSubsystem>() : nullptr;
+		const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+		const ATwinStickCharacter* Character = PlayerController ? Cast<ATwinStickCharacter>(PlayerController->GetPawn()) : nullptr;
+
+		if (Projectiles && Character)
+		{
+			const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 2000;
+
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				const FRotator Rotation(0.0f, 360.0f * Index / FMath::Max(Count, 1), 0.0f);
+				const FVector Location = Character->GetActorLocation() + Rotation.Vector() * 100.0f;
+
+				Projectiles->FireProjectile(Character->GetProjectileClass(), FTransform(Rotation, Location));
+			}
+
+			Projectiles->DumpStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs ProjectilesDumpCommand(
+	TEXT("Tactics.Projectiles.Dump"),
+	TEXT("Logs the number of live projectiles and the projectile subsystem tick times."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UTwinStickProjectileSubsystem* Projectiles = World ? World->GetSubsystem<UTwinStickProjectileSubsystem>() : nullptr)
+		{
+			Projectiles->DumpStats();
+		}
+	}));
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/** Projectile class fired by the budget test, the one the Twin Stick character shoots */
+static const TCHAR* ProjectileBudgetClassPath = TEXT("/Game/Variant_TwinStick/Blueprints/BP_TwinStickProjectile.BP_TwinStickProjectile_C");
+
+/** Number of live projectiles the budget is set for */
+static constexpr int32 ProjectileBudgetCount = 2000;
+
+/** Number of frames measured */
+static constexpr int32 ProjectileBudgetFrames = 300;
+
+/** Seconds the test waits for a game world */
+static constexpr double ProjectileBudgetStartTimeout = 30.0;
+
+/**
+ *  Keeps 2,000 projectiles alive around the player once a game world is up, and checks the p99 tick time against the budget.
+ *  The dump is logged at the end, so every run leaves a recorded result
+ */
+class FProjectileBudgetCommand : public IAutomationLatentCommand
+{
+public:
+	explicit FProjectileBudgetCommand(FAutomationTestBase* InTest)
+		: Test(InTest)
+	{
+	}
+
+	virtual bool Update() override
+	{
+		UWorld* World = TacticsAutomation::FindGameWorld();
+		UTwinStickProjectileSubsystem* Projectiles = World && World->HasBegunPlay() ? World->GetSubsystem<UTwinStickProjectileSubsystem>() : nullptr;
+
+		if (!Projectiles)
+		{
+			if (NumFrames > 0)
+			{
+				Test->AddError(TEXT("The game world went away during the projectile budget check"));
+				return true;
+			}
+
+			// wait for the map to start playing
+			if (GetCurrentRunTime() > ProjectileBudgetStartTimeout)
+			{
+				Test->AddError(TEXT("No game world started playing. Run the test in -game or PIE."));
+				return true;
+			}
+
+			return false;
+		}
+
+		if (NumFrames == 0)
+		{
+			ProjectileClass = LoadClass<ATwinStickProjectile>(nullptr, ProjectileBudgetClassPath);
+
+			if (!ProjectileClass)
+			{
+				Test->AddError(FString::Printf(TEXT("Couldn't load %s"), ProjectileBudgetClassPath));
+				return true;
+			}
+
+			const APlayerController* PlayerController = World->GetFirstPlayerController();
+			const APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+			Origin = Pawn ? Pawn->GetActorLocation() : FVector(0.0f, 0.0f, 100.0f);
+
+			// only the measured frames count
+			Projectiles->ResetTickStats();
+		}
+
+		// top the projectiles back up every frame, so the load doesn't drop as they expire
+		for (int32 Index = Projectiles->GetNumProjectiles(); Index < ProjectileBudgetCount; ++Index)
+		{
+			const FRotator Rotation(0.0f, 360.0f * Index / ProjectileBudgetCount, 0.0f);
+
+			if (!Projectiles->FireProjectile(ProjectileClass, FTransform(Rotation, Origin + Rotation.Vector() * 100.0f)))
+			{
+				Test->AddError(TEXT("The projectile can't be simulated. Check Tactics.Projectiles.Simulate and the projectile class's mesh"));
+				return true;
+			}
+		}
+
+		if (++NumFrames <= ProjectileBudgetFrames)
+		{
+			return false;
+		}
+
+		const FTimingStats& TickStats = Projectiles->GetTickStats();
+
+		Test->AddInfo(FString::Printf(TEXT("%d projectiles over %d frames: mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms"),
+			ProjectileBudgetCount, TickStats.Count, TickStats.GetMean(), TickStats.GetPercentile(50.0f), TickStats.GetPercentile(99.0f), TickStats.MaxMs));
+
+		Projectiles->DumpStats();
+
+		Test->TestTrue(FString::Printf(TEXT("p99 tick time with %d projectiles is within %.2f ms"), ProjectileBudgetCount, ProjectileTickBudgetMs),
+			TickStats.GetPercentile(99.0f) <= ProjectileTickBudgetMs);
+
+		return true;
+	}
+
+private:
+	/** Test to report to */
+	FAutomationTestBase* Test;
+
+	/** Class fired by the test */
+	TSubclassOf<ATwinStickProjectile> ProjectileClass;
+
+	/** Center of the projectile ring */
+	FVector Origin = FVector::ZeroVector;
+
+	/** Frames run so far */
+	int32 NumFrames = 0;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FProjectileBudgetTest, "Tactics.Projectiles.Budget", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FProjectileBudgetTest::RunTest(const FString& Parameters)
+{
+	TacticsAutomation::OpenDefaultMapIfNeeded();
+
+	ADD_LATENT_AUTOMATION_COMMAND(FProjectileBudgetCommand(this));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,180 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineTypes.h"
+#include "WorldCollision.h"
+#include "TimingStats.h"
+#include "TwinStickProjectileSubsystem.generated.h"
+
+class ATwinStickProjectile;
+class UInstancedStaticMeshComponent;
+
+/**
+ *  Simulates Twin Stick projectiles in bulk, without an actor per shot.
+ *  Projectiles are kept in packed arrays of location, velocity and lifetime.
+ *  Every frame each projectile sweeps its collision sphere ahead asynchronously, and the results are applied on the next frame:
+ *  projectiles move to the end of their sweep, bounce off what they hit, or hit an NPC and go away.
+ *  A projectile whose sweep hasn't come back by then holds still for a frame, and the late result is dropped.
+ *  Each projectile class is drawn with a single instanced mesh.
+ *  Movement and collision settings are read from the projectile class defaults, so the class stays the one place to tune them.
+ */
+UCLASS()
+class UTwinStickProjectileSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Fires a projectile of the given class. Returns false if the class can't be simulated, so the caller should spawn the actor instead */
+	bool FireProjectile(TSubclassOf<ATwinStickProjectile> ProjectileClass, const FTransform& Transform);
+
+	/** Returns the number of live projectiles */
+	int32 GetNumProjectiles() const { return Locations.Num(); }
+
+	/** Logs the projectile stats */
+	void DumpStats() const;
+
+	/** Returns the game thread tick times, in milliseconds */
+	const FTimingStats& GetTickStats() const { return TickStats; }
+
+	/** Clears the tick times, so a measurement only covers the frames after it */
+	void ResetTickStats() { TickStats = FTimingStats(); }
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+protected:
+
+	/** Settings shared by all projectiles of a class */
+	struct FProjectileType
+	{
+		/** Class the settings were read from */
+		TSubclassOf<ATwinStickProjectile> Class;
+
+		/** Collision sphere radius */
+		float Radius = 0.0f;
+
+		/** Launch speed */
+		float Speed = 0.0f;
+
+		/** Time before the projectile expires */
+		float Lifetime = 0.0f;
+
+		/** Bounce settings, like the projectile movement component */
+		bool bShouldBounce = true;
+		float Bounciness = 0.0f;
+		float Friction = 0.0f;
+		float MinBounceSpeed = 0.0f;
+
+		/** Collision channel and responses of the sphere */
+		ECollisionChannel Channel = ECC_WorldDynamic;
+		FCollisionResponseParams ResponseParams;
+
+		/** Mesh transform relative to the projectile */
+		FTransform MeshTransform;
+
+		/** Number of instances in the instanced mesh. Only grows, spare instances are collapsed */
+		int32 NumInstances = 0;
+
+		/** Number of projectiles drawn by the last update */
+		int32 NumDrawn = 0;
+	};
+
+	/** A sweep that hit something, waiting to be applied */
+	struct FSweepHit
+	{
+		int32 Index = INDEX_NONE;
+		FHitResult Hit;
+	};
+
+	/** State of a projectile's sweep */
+	enum class ESweepState : uint8
+	{
+		None,
+		Pending,
+		Done
+	};
+
+	/** Projectile classes fired so far */
+	TArray<FProjectileType> Types;
+
+	/** Instanced mesh for each projectile class */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UInstancedStaticMeshComponent>> TypeInstances;
+
+	/** Actor holding the instanced meshes */
+	UPROPERTY(Transient)
+	TObjectPtr<AActor> RenderActor;
+
+	/** Packed projectile state. All arrays share the same index. A projectile whose lifetime runs out is removed */
+	TArray<FVector> Locations;
+	TArray<FVector> Velocities;
+	TArray<float> Lifetimes;
+	TArray<uint8> TypeIndices;
+
+	/** Sweep in flight for each projectile, and where it ends if nothing is hit */
+	TArray<ESweepState> SweepStates;
+	TArray<FVector> SweepEnds;
+
+	/** Sweeps that hit something since the last tick */
+	TArray<FSweepHit> SweepHits;
+
+	/**
+	 *  Id of the first sweep in the latest batch, and the number of sweeps in it.
+	 *  A sweep's user data is the first id plus its projectile's index, so a result from an older batch is told apart and dropped.
+	 */
+	uint32 SweepBatchStart = 0;
+	int32 SweepBatchSize = 0;
+
+	/** Id the next batch starts from */
+	uint32 NextSweepId = 0;
+
+	/** Instance transforms for a projectile class, rebuilt every tick */
+	TArray<FTransform> InstanceTransforms;
+
+	/** Query params shared by all sweeps */
+	FCollisionQueryParams QueryParams;
+
+	/** Sweep completion callback, shared by all sweeps */
+	FTraceDelegate SweepDelegate;
+
+	/** Game thread tick times, in milliseconds */
+	FTimingStats TickStats;
+
+	/** Lifetime stats */
+	int32 NumFired = 0;
+	int32 NumBounces = 0;
+	int32 NumImpacts = 0;
+	int32 NumLateSweeps = 0;
+	int32 NumStaleSweeps = 0;
+	int32 MaxProjectiles = 0;
+
+	/** Returns the index of the settings for a class, reading them the first time. Returns INDEX_NONE if the class has no mesh to draw */
+	int32 FindOrAddType(TSubclassOf<ATwinStickProjectile> ProjectileClass);
+
+	/** Creates the actor holding the instanced meshes */
+	void EnsureRenderActor();
+
+	/** Applies the finished sweeps and flags the projectiles that are done */
+	void ApplySweeps();
+
+	/** Counts down the lifetimes and removes the projectiles that are done */
+	void RemoveDeadProjectiles(float DeltaTime);
+
+	/** Starts the sweeps for the next step */
+	void StartSweeps(float DeltaTime);
+
+	/** Pushes the projectile transforms to the instanced meshes */
+	void UpdateInstances();
+
+	/** Called when a sweep finishes, usually at the start of the next frame. Results from an older batch are dropped */
+	void OnSweepCompleted(const FTraceHandle& Handle, FTraceDatum& Data);
+};
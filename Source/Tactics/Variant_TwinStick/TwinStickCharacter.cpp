@@ -11,8 +11,11 @@
 #include "TwinStickAoEAttack.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "TwinStickProjectile.h"
+#include "TwinStickProjectileSubsystem.h"
 #include "Engine/World.h"
 #include "TimerManager.h"
+#include "CursorCacheSubsystem.h"
+#include "InputLatencySubsystem.h"
 
 ATwinStickCharacter::ATwinStickCharacter()
 {
@@ -68,6 +71,13 @@ void ATwinStickCharacter::NotifyControllerChanged()
 
 	// set the player controller reference
 	PlayerController = Cast<APlayerController>(GetController());
+
+	// let the latency check inject synthetic movement and dashes
+	if (UInputLatencySubsystem* Latency = GetWorld()->GetSubsystem<UInputLatencySubsystem>())
+	{
+		Latency->RegisterInjectableAction(PlayerController, MoveAction, FInputActionValue(FVector2D(1.0f, 0.0f)));
+		Latency->RegisterInjectableAction(PlayerController, DashAction, FInputActionValue(true));
+	}
 }
 
 void ATwinStickCharacter::Tick(float DeltaTime)
@@ -80,11 +90,11 @@ void ATwinStickCharacter::Tick(float DeltaTime)
 	// are we aiming with the mouse?
 	if (bUsingMouse)
 	{
-		if (PlayerController)
+		if (UCursorCacheSubsystem* CursorCache = UCursorCacheSubsystem::Get(PlayerController))
 		{
-			// get the cursor world location
-			FHitResult OutHit; 
-			PlayerController->GetHitResultUnderCursorByChannel(MouseAimTraceChannel, true, OutHit);
+			// get the cursor world location from the per-frame cache
+			FHitResult OutHit;
+			CursorCache->GetCursorHit(UEngineTypes::ConvertToCollisionChannel(MouseAimTraceChannel), OutHit);
 
 			// find the aim rotation 
 			const FRotator AimRot = UKismetMathLibrary::FindLookAtRotation(GetActorLocation(), OutHit.Location);
@@ -130,6 +140,12 @@ void ATwinStickCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInput
 
 void ATwinStickCharacter::Move(const FInputActionValue& Value)
 {
+	// time the input until we start moving
+	if (UInputLatencySubsystem* Latency = GetWorld()->GetSubsystem<UInputLatencySubsystem>())
+	{
+		Latency->MarkInput(MoveAction, this);
+	}
+
 	// save the input vector
 	FVector2D InputVector = Value.Get<FVector2D>();
 
@@ -160,6 +176,12 @@ void ATwinStickCharacter::MouseAim(const FInputActionValue& Value)
 
 void ATwinStickCharacter::Dash(const FInputActionValue& Value)
 {
+	// time the input until the launch changes our velocity
+	if (UInputLatencySubsystem* Latency = GetWorld()->GetSubsystem<UInputLatencySubsystem>())
+	{
+		Latency->MarkInput(DashAction, this);
+	}
+
 	// route the input
 	DoDash();
 }
@@ -242,6 +264,15 @@ void ATwinStickCharacter::DoShoot()
 	FVector ProjectileLocation = ProjectileTransform.GetLocation() + ProjectileTransform.GetRotation().RotateVector(FVector::ForwardVector * ProjectileOffset);
 	ProjectileTransform.SetLocation(ProjectileLocation);
 
+	// let the projectile subsystem simulate the shot without spawning an actor
+	if (UTwinStickProjectileSubsystem* Projectiles = GetWorld()->GetSubsystem<UTwinStickProjectileSubsystem>())
+	{
+		if (Projectiles->FireProjectile(ProjectileClass, ProjectileTransform))
+		{
+			return;
+		}
+	}
+
 	ATwinStickProjectile* Projectile = GetWorld()->SpawnActor<ATwinStickProjectile>(ProjectileClass, ProjectileTransform);
 }
 
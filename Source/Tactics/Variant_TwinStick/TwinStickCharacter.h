@@ -202,6 +202,9 @@ public:
 	/** Gives the player a pickup item */
 	void AddPickup();
 
+	/** Returns the type of projectile spawned when shooting */
+	TSubclassOf<ATwinStickProjectile> GetProjectileClass() const { return ProjectileClass; }
+
 protected:
 
 	/** Updates the items counter on the Game Mode */
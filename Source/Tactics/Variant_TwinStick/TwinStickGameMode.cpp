@@ -6,12 +6,21 @@
 #include "Engine/World.h"
 #include "TimerManager.h"
 #include "Kismet/GameplayStatics.h"
+#include "ActorPoolSubsystem.h"
 
 void ATwinStickGameMode::BeginPlay()
 {
 	// create the UI widget and add it to the viewport
 	UIWidget = CreateWidget<UTwinStickUI>(UGameplayStatics::GetPlayerController(GetWorld(), 0), UIWidgetClass);
 	UIWidget->AddToViewport(0);
+
+	// fill the actor pools ahead of the first spawns
+	UActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+
+	for (const FActorPoolPrewarm& Prewarm : PoolPrewarm)
+	{
+		ActorPool->Prewarm(Prewarm.ActorClass, Prewarm.Count);
+	}
 }
 
 void ATwinStickGameMode::EndPlay(EEndPlayReason::Type EndPlayReason)
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "ActorPoolSubsystem.h"
 #include "TwinStickGameMode.generated.h"
 
 class UTwinStickUI;
@@ -11,6 +12,7 @@ class UTwinStickUI;
 /**
  *  Simple Game Mode for a Twin Stick Shooter game.
  *  Manages the score and UI
+ *  Fills the actor pools for NPCs and pickups at the start of play
  */
 UCLASS(abstract)
 class ATwinStickGameMode : public AGameModeBase
@@ -59,6 +61,10 @@ protected:
 	/** Current number of NPCs in the level */
 	int32 NPCCount = 0;
 
+	/** Actors to spawn into the actor pool at the start of play, so NPC spawns and deaths reuse them instead of spawning new ones */
+	UPROPERTY(EditAnywhere, Category="Twin Stick|Pooling")
+	TArray<FActorPoolPrewarm> PoolPrewarm;
+
 public:
 
 	/** Gameplay initialization */